@@ -97,6 +97,26 @@
 #define BROTLI_WINDOW_GAP 16
 #define BROTLI_MAX_BACKWARD_LIMIT(W) (((size_t)1 << (W)) - BROTLI_WINDOW_GAP)
 
+/* Chunk index, see BROTLI_PARAM_CHUNK_SIZE. It is the payload of the last
+   metadata block, followed only by an empty last meta-block (byte 0x03).
+   All numbers are little-endian:
+     header:  magic, version, window bits (+ 0x80 for large window),
+              2 reserved bytes, number of chunks (4 bytes),
+              uncompressed size (8 bytes), compressed end of the last chunk
+              (8 bytes);
+     entries: compressed offset (8 bytes), uncompressed offset (8 bytes),
+              4 last distances (4 bytes each), last 2 uncompressed bytes;
+     footer:  payload size (4 bytes), magic. */
+#define BROTLI_CHUNK_INDEX_MAGIC 0x49437242u  /* "BrCI" */
+#define BROTLI_CHUNK_INDEX_VERSION 1
+#define BROTLI_CHUNK_INDEX_HEADER_SIZE 28
+#define BROTLI_CHUNK_INDEX_ENTRY_SIZE 34
+#define BROTLI_CHUNK_INDEX_FOOTER_SIZE 8
+/* Metadata block is limited to 16MiB. */
+#define BROTLI_CHUNK_INDEX_MAX_CHUNKS                                  \
+    (((1u << 24) - BROTLI_CHUNK_INDEX_HEADER_SIZE -                   \
+      BROTLI_CHUNK_INDEX_FOOTER_SIZE) / BROTLI_CHUNK_INDEX_ENTRY_SIZE)
+
 typedef struct BrotliDistanceCodeLimit {
   uint32_t max_alphabet_size;
   uint32_t max_distance;
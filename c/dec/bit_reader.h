@@ -105,30 +105,39 @@ static BROTLI_INLINE BROTLI_BOOL BrotliCheckInputAmount(
   return TO_BROTLI_BOOL(br->avail_in >= num);
 }
 
+#if (BROTLI_64_BITS)
+/* Replaces all whole bytes consumed from accumulator with fresh input, using
+   single unaligned 64-bit load; leaves at least 57 valid bits.
+   Shift amounts are computed rather than branched on (SHRX / SHLX with BMI2).
+   Precondition: bit_pos_ >= 32, and 8 bytes of input are readable. */
+static BROTLI_INLINE void BrotliRefillBitWindow64(BrotliBitReader* const br) {
+  uint32_t drop_bits = br->bit_pos_ & ~7u;  /* 32..64 */
+  uint32_t drop_bytes = drop_bits >> 3;
+  /* Split shifts keep both amounts below 64 when drop_bits is 64 (or 0). */
+  br->val_ = ((br->val_ >> (drop_bits - 8)) >> 8) |
+      (BROTLI_UNALIGNED_LOAD64LE(br->next_in) << (64 - drop_bits));
+  br->bit_pos_ ^= drop_bits;  /* here same as -= drop_bits */
+  br->avail_in -= drop_bytes;
+  br->next_in += drop_bytes;
+}
+#endif
+
 /* Guarantees that there are at least |n_bits| + 1 bits in accumulator.
    Precondition: accumulator contains at least 1 bit.
    |n_bits| should be in the range [1..24] for regular build. For portable
-   non-64-bit little-endian build only 16 bits are safe to request. */
+   non-64-bit little-endian build only 16 bits are safe to request.
+   For 64-bit build with fast unaligned reads, 8 bytes at |next_in| are read
+   whenever accumulator is refilled. */
 static BROTLI_INLINE void BrotliFillBitWindow(
     BrotliBitReader* const br, uint32_t n_bits) {
 #if (BROTLI_64_BITS)
   if (!BROTLI_ALIGNED_READ && BROTLI_IS_CONSTANT(n_bits) && (n_bits <= 8)) {
-    if (br->bit_pos_ >= 56) {
-      br->val_ >>= 56;
-      br->bit_pos_ ^= 56;  /* here same as -= 56 because of the if condition */
-      br->val_ |= BROTLI_UNALIGNED_LOAD64LE(br->next_in) << 8;
-      br->avail_in -= 7;
-      br->next_in += 7;
-    }
+    if (br->bit_pos_ >= 56) BrotliRefillBitWindow64(br);
   } else if (
       !BROTLI_ALIGNED_READ && BROTLI_IS_CONSTANT(n_bits) && (n_bits <= 16)) {
-    if (br->bit_pos_ >= 48) {
-      br->val_ >>= 48;
-      br->bit_pos_ ^= 48;  /* here same as -= 48 because of the if condition */
-      br->val_ |= BROTLI_UNALIGNED_LOAD64LE(br->next_in) << 16;
-      br->avail_in -= 6;
-      br->next_in += 6;
-    }
+    if (br->bit_pos_ >= 48) BrotliRefillBitWindow64(br);
+  } else if (!BROTLI_ALIGNED_READ) {
+    if (br->bit_pos_ >= 32) BrotliRefillBitWindow64(br);
   } else {
     if (br->bit_pos_ >= 32) {
       br->val_ >>= 32;
@@ -162,7 +171,17 @@ static BROTLI_INLINE void BrotliFillBitWindow(
 /* Mostly like BrotliFillBitWindow, but guarantees only 16 bits and reads no
    more than BROTLI_SHORT_FILL_BIT_WINDOW_READ bytes of input. */
 static BROTLI_INLINE void BrotliFillBitWindow16(BrotliBitReader* const br) {
+#if (BROTLI_64_BITS)
+  if (br->bit_pos_ >= 32) {
+    br->val_ >>= 32;
+    br->bit_pos_ ^= 32;  /* here same as -= 32 because of the if condition */
+    br->val_ |= ((uint64_t)BROTLI_UNALIGNED_LOAD32LE(br->next_in)) << 32;
+    br->avail_in -= BROTLI_SHORT_FILL_BIT_WINDOW_READ;
+    br->next_in += BROTLI_SHORT_FILL_BIT_WINDOW_READ;
+  }
+#else
   BrotliFillBitWindow(br, 17);
+#endif
 }
 
 /* Tries to pull one byte of input to accumulator.
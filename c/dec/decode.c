@@ -75,10 +75,63 @@ BROTLI_BOOL BrotliDecoderSetParameter(
      state->save_info_for_recompression = TO_BROTLI_BOOL(!!value);
      return BROTLI_TRUE;
 
+    case BROTLI_DECODER_PARAM_HUFFMAN_CACHE_SIZE:
+      if (value > BROTLI_DECODER_MAX_HUFFMAN_CACHE_SIZE) return BROTLI_FALSE;
+      state->huffman_cache_size = value;
+      return BROTLI_TRUE;
+
+    case BROTLI_DECODER_PARAM_MAX_MEMORY:
+      state->max_memory = value;
+      return BROTLI_TRUE;
+
+    case BROTLI_DECODER_PARAM_MAX_OUTPUT_RATIO:
+      state->max_output_ratio = value;
+      return BROTLI_TRUE;
+
+    case BROTLI_DECODER_PARAM_WORD_CACHE_SIZE:
+      if (value > BROTLI_DECODER_MAX_WORD_CACHE_SIZE) return BROTLI_FALSE;
+      if (value != state->word_cache_entries) {
+        /* Cache kept by BrotliDecoderReset has a different size. */
+        BrotliDecoderFreeCounted(state, state->word_cache,
+            sizeof(BrotliDecoderWordCacheEntry) * state->word_cache_entries);
+        state->word_cache = NULL;
+        state->word_cache_entries = 0;
+      }
+      state->word_cache_size = value;
+      return BROTLI_TRUE;
+
     default: return BROTLI_FALSE;
   }
 }
 
+BROTLI_BOOL BrotliDecoderAttachDictionary(BrotliDecoderState* state,
+    BrotliSharedDictionaryType type, size_t data_size, const uint8_t* data) {
+  BrotliDecoderCompoundDictionary* addon = state->compound_dictionary;
+  if (state->state != BROTLI_STATE_UNINITED) return BROTLI_FALSE;
+  if (type != BROTLI_SHARED_DICTIONARY_RAW) return BROTLI_FALSE;
+  if (!addon) {
+    addon = (BrotliDecoderCompoundDictionary*)BROTLI_DECODER_ALLOC(
+        state, sizeof(BrotliDecoderCompoundDictionary));
+    if (!addon) return BROTLI_FALSE;
+    addon->num_chunks = 0;
+    addon->total_size = 0;
+    addon->br_length = 0;
+    addon->br_copied = 0;
+    addon->chunk_offsets[0] = 0;
+    state->compound_dictionary = addon;
+  }
+  if (addon->num_chunks == BROTLI_MAX_COMPOUND_DICTS) return BROTLI_FALSE;
+  /* Same limit as in encoder; keeps all offsets far from int overflow. */
+  if (data_size > ((size_t)1 << 30) - (size_t)addon->total_size) {
+    return BROTLI_FALSE;
+  }
+  addon->chunks[addon->num_chunks] = data;
+  addon->total_size += (int)data_size;
+  addon->chunk_offsets[addon->num_chunks + 1] = addon->total_size;
+  addon->num_chunks++;
+  return BROTLI_TRUE;
+}
+
 BrotliDecoderState* BrotliDecoderCreateInstance(
     brotli_alloc_func alloc_func, brotli_free_func free_func, void* opaque) {
   BrotliDecoderState* state = 0;
@@ -91,6 +144,9 @@ BrotliDecoderState* BrotliDecoderCreateInstance(
     BROTLI_DUMP();
     return 0;
   }
+  /* Read by BrotliDecoderStateInit; off until enabled with
+     BROTLI_DECODER_PARAM_SAVE_INFO. */
+  state->save_info_for_recompression = 0;
   if (!BrotliDecoderStateInit(state, alloc_func, free_func, opaque)) {
     BROTLI_DUMP();
     if (!alloc_func && !free_func) {
@@ -115,9 +171,19 @@ void BrotliDecoderDestroyInstance(BrotliDecoderState* state) {
   }
 }
 
+void BrotliDecoderReset(BrotliDecoderState* state) {
+  BrotliDecoderStateReset(state);
+}
+
 /* Saves error code and converts it to BrotliDecoderResult. */
 static BROTLI_NOINLINE BrotliDecoderResult SaveErrorCode(
     BrotliDecoderState* s, BrotliDecoderErrorCode e) {
+  /* Allocation failed because it was refused, not because of lack of memory;
+     see BrotliDecoderAllocCounted. */
+  if (s->memory_limit_hit && e <= BROTLI_DECODER_ERROR_ALLOC_CONTEXT_MODES &&
+      e >= BROTLI_DECODER_ERROR_ALLOC_BLOCK_TYPE_TREES) {
+    e = BROTLI_FAILURE(BROTLI_DECODER_ERROR_LIMIT_MEMORY);
+  }
   s->error_code = (int)e;
   switch (e) {
     case BROTLI_DECODER_SUCCESS:
@@ -183,6 +249,33 @@ static BROTLI_INLINE void memmove16(uint8_t* dst, uint8_t* src) {
 #endif
 }
 
+/* Copies |length| bytes from |distance| bytes back, when regions overlap,
+   i.e. |distance| < |length|. Writes up to 15 bytes past the end. */
+static BROTLI_INLINE void CopyOverlapped(
+    uint8_t* dst, int distance, int length) {
+  uint8_t* src = dst - distance;
+  int k;
+  if (distance >= 16) {
+    /* Each chunk reads only bytes written before. */
+    for (k = 0; k < length; k += 16) memmove16(dst + k, src + k);
+  } else {
+    /* Expand the period to 16 bytes, then store the pattern at offsets that
+       are multiples of the period. */
+    uint8_t pattern[16];
+    int step = 16 - 16 % distance;
+    if (distance == 1) {
+      memset(pattern, src[0], 16);
+    } else {
+      int j = 0;
+      for (k = 0; k < 16; ++k) {
+        pattern[k] = src[j];
+        if (++j == distance) j = 0;
+      }
+    }
+    for (k = 0; k < length; k += step) memcpy(dst + k, pattern, 16);
+  }
+}
+
 /* Decodes a number in the range [0..255], by reading 1 - 11 bits. */
 static BROTLI_NOINLINE BrotliDecoderErrorCode DecodeVarLenUint8(
     BrotliDecoderState* s, BrotliBitReader* br, uint32_t* value) {
@@ -740,6 +833,122 @@ static BrotliDecoderErrorCode ReadCodeLengthCodeLengths(BrotliDecoderState* s) {
   return BROTLI_DECODER_SUCCESS;
 }
 
+/* Complex prefix code is passed to helpers below as symbol chains (see
+   BrotliBuildHuffmanTable), their tails and code length histogram. */
+
+/* Fills cache key of complex prefix code and returns its size. */
+static uint32_t BuildHuffmanCacheKey(const uint16_t* symbol_lists,
+    const uint16_t* count, uint16_t* key) {
+  uint32_t size = BROTLI_HUFFMAN_MAX_CODE_LENGTH;
+  int bits;
+  for (bits = 1; bits <= BROTLI_HUFFMAN_MAX_CODE_LENGTH; ++bits) {
+    int symbol = bits - (BROTLI_HUFFMAN_MAX_CODE_LENGTH + 1);
+    uint32_t n = count[bits];
+    key[bits - 1] = (uint16_t)n;
+    while (n-- != 0) {
+      symbol = symbol_lists[symbol];
+      key[size++] = (uint16_t)symbol;
+    }
+  }
+  return size;
+}
+
+/* Checks that complex prefix code matches the cache key. */
+static BROTLI_BOOL MatchHuffmanCacheKey(const uint16_t* symbol_lists,
+    const uint16_t* count, const uint16_t* key) {
+  uint32_t size = BROTLI_HUFFMAN_MAX_CODE_LENGTH;
+  int bits;
+  for (bits = 1; bits <= BROTLI_HUFFMAN_MAX_CODE_LENGTH; ++bits) {
+    if (key[bits - 1] != count[bits]) return BROTLI_FALSE;
+  }
+  for (bits = 1; bits <= BROTLI_HUFFMAN_MAX_CODE_LENGTH; ++bits) {
+    int symbol = bits - (BROTLI_HUFFMAN_MAX_CODE_LENGTH + 1);
+    uint32_t n = count[bits];
+    while (n-- != 0) {
+      symbol = symbol_lists[symbol];
+      if (key[size++] != symbol) return BROTLI_FALSE;
+    }
+  }
+  return BROTLI_TRUE;
+}
+
+/* Hashes code length histogram, and the first and the last symbol of each
+   code length. Unlike the cache key, it is cheap to compute. */
+static uint32_t HashHuffmanCode(const uint16_t* symbol_lists,
+    const uint16_t* count, const int* next_symbol) {
+  uint32_t hash = 0;
+  int bits;
+  for (bits = 1; bits <= BROTLI_HUFFMAN_MAX_CODE_LENGTH; ++bits) {
+    int head = bits - (BROTLI_HUFFMAN_MAX_CODE_LENGTH + 1);
+    uint32_t first = symbol_lists[head];
+    uint32_t last = (uint32_t)next_symbol[bits] & 0x3FF;
+    uint32_t v = count[bits] ^ (first << 10) ^ (last << 20);
+    /* Independent products keep the loop short. */
+    hash += (v ^ (uint32_t)bits) * 0x9E3779B1u;
+    hash = (hash << 5) | (hash >> 27);
+  }
+  return hash ^ (hash >> 15);
+}
+
+/* Finds table of complex prefix code in cache, or builds it into a cache
+   entry. Cache is direct-mapped; codes are admitted to cache when seen the
+   second time in a row in their slot, so that one-off codes cost just a hash
+   calculation. Returns NULL if the code is not cached; cache allocation
+   failures are not fatal. */
+static BROTLI_NOINLINE HuffmanCode* BuildHuffmanTableCached(
+    BrotliDecoderState* s, uint16_t* symbol_lists, uint16_t* count,
+    const int* next_symbol) {
+  BrotliDecoderHuffmanCache* cache = s->huffman_cache;
+  BrotliDecoderHuffmanCacheEntry* entry;
+  uint32_t hash;
+
+  if (!cache) {
+    cache = (BrotliDecoderHuffmanCache*)BrotliDecoderAllocCounted(s,
+        sizeof(BrotliDecoderHuffmanCache) +
+        sizeof(BrotliDecoderHuffmanCacheEntry) * s->huffman_cache_size);
+    if (!cache) return NULL;
+    memset(cache, 0, sizeof(BrotliDecoderHuffmanCache));
+    cache->num_entries = s->huffman_cache_size;
+    cache->clock = 1;
+    cache->entries = (BrotliDecoderHuffmanCacheEntry*)&cache[1];
+    memset(cache->entries, 0,
+        sizeof(BrotliDecoderHuffmanCacheEntry) * cache->num_entries);
+    s->huffman_cache = cache;
+  }
+
+  hash = HashHuffmanCode(symbol_lists, count, next_symbol);
+  entry = &cache->entries[
+      (uint32_t)(((uint64_t)hash * cache->num_entries) >> 32)];
+  if (entry->table && entry->hash == hash &&
+      MatchHuffmanCacheKey(symbol_lists, count, entry->key)) {
+    entry->last_use = cache->clock;
+    cache->hits++;
+    return entry->table;
+  }
+  cache->misses++;
+  if (entry->seen_hash != hash) {
+    entry->seen_hash = hash;
+    return NULL;
+  }
+  /* Slot is used by the current metablock. */
+  if (entry->table && entry->last_use == cache->clock) return NULL;
+
+  if (!entry->table) {
+    /* Any tree fits; this way entry is never reallocated. */
+    entry->table = (HuffmanCode*)BrotliDecoderAllocCounted(s,
+        sizeof(HuffmanCode) * BROTLI_HUFFMAN_CACHE_MAX_TABLE_SIZE +
+        sizeof(uint16_t) * BROTLI_HUFFMAN_CACHE_MAX_KEY_SIZE);
+    if (!entry->table) return NULL;
+    entry->key = (uint16_t*)&entry->table[BROTLI_HUFFMAN_CACHE_MAX_TABLE_SIZE];
+  }
+  entry->hash = hash;
+  entry->last_use = cache->clock;
+  BuildHuffmanCacheKey(symbol_lists, count, entry->key);
+  BrotliBuildHuffmanTable(
+      entry->table, HUFFMAN_TABLE_BITS, symbol_lists, count);
+  return entry->table;
+}
+
 /* Decodes the Huffman tables.
    There are 2 scenarios:
     A) Huffman code contains only few symbols (1..4). Those symbols are read
@@ -750,11 +959,20 @@ static BrotliDecoderErrorCode ReadCodeLengthCodeLengths(BrotliDecoderState* s) {
     B.1) Small Huffman table is decoded; it is specified with code lengths
          encoded with predefined entropy code. 32 - 74 bits are used.
     B.2) Decoded table is used to decode code lengths of symbols in resulting
-         Huffman table. In worst case 3520 bits are read. */
+         Huffman table. In worst case 3520 bits are read.
+
+   If |opt_cached_table| is not NULL, then complex code table could be taken
+   from / built in Huffman table cache instead of |table|; in that case
+   |*opt_cached_table| is set to it, otherwise to NULL.
+
+   If |opt_deferred_code| is not NULL, then table is not built; code is
+   stored there in BROTLI_LITERAL_CODE_SIZE compact form instead. */
 static BrotliDecoderErrorCode ReadHuffmanCode(uint32_t alphabet_size_max,
                                               uint32_t alphabet_size_limit,
                                               HuffmanCode* table,
                                               uint32_t* opt_table_size,
+                                              HuffmanCode** opt_cached_table,
+                                              uint16_t* opt_deferred_code,
                                               BrotliDecoderState* s) {
   BrotliBitReader* br = &s->br;
   BrotliMetablockHeaderArena* h = &s->arena.header;
@@ -810,11 +1028,21 @@ static BrotliDecoderErrorCode ReadHuffmanCode(uint32_t alphabet_size_max,
           h->symbol += bits;
         }
         BROTLI_LOG_UINT(h->symbol);
+        if (opt_deferred_code) {
+          opt_deferred_code[0] = (uint16_t)h->symbol;
+          memcpy(&opt_deferred_code[1], h->symbols_lists_array,
+              4 * sizeof(uint16_t));
+          h->substate_huffman = BROTLI_STATE_HUFFMAN_NONE;
+          return BROTLI_DECODER_SUCCESS;
+        }
         table_size = BrotliBuildSimpleHuffmanTable(
             table, HUFFMAN_TABLE_BITS, h->symbols_lists_array, h->symbol);
         if (opt_table_size) {
           *opt_table_size = table_size;
         }
+        if (opt_cached_table) {
+          *opt_cached_table = NULL;
+        }
         h->substate_huffman = BROTLI_STATE_HUFFMAN_NONE;
         return BROTLI_DECODER_SUCCESS;
       }
@@ -859,6 +1087,32 @@ static BrotliDecoderErrorCode ReadHuffmanCode(uint32_t alphabet_size_max,
           BROTLI_LOG(("[ReadHuffmanCode] space = %d\n", (int)h->space));
           return BROTLI_FAILURE(BROTLI_DECODER_ERROR_FORMAT_HUFFMAN_SPACE);
         }
+        if (opt_deferred_code) {
+          int i;
+          opt_deferred_code[0] = BROTLI_LITERAL_CODE_COMPLEX;
+          memcpy(&opt_deferred_code[BROTLI_LITERAL_CODE_HISTO],
+              h->code_length_histo, sizeof(h->code_length_histo));
+          for (i = 0; i <= BROTLI_HUFFMAN_MAX_CODE_LENGTH; ++i) {
+            opt_deferred_code[BROTLI_LITERAL_CODE_TAILS + i] =
+                (uint16_t)h->next_symbol[i];
+          }
+          memcpy(&opt_deferred_code[BROTLI_LITERAL_CODE_LISTS],
+              h->symbols_lists_array, sizeof(uint16_t) *
+              (BROTLI_LITERAL_CODE_SIZE - BROTLI_LITERAL_CODE_LISTS));
+          h->substate_huffman = BROTLI_STATE_HUFFMAN_NONE;
+          return BROTLI_DECODER_SUCCESS;
+        }
+        if (opt_cached_table) {
+          *opt_cached_table = NULL;
+          if (s->huffman_cache_size != 0) {
+            *opt_cached_table = BuildHuffmanTableCached(
+                s, h->symbol_lists, h->code_length_histo, h->next_symbol);
+          }
+          if (*opt_cached_table) {
+            h->substate_huffman = BROTLI_STATE_HUFFMAN_NONE;
+            return BROTLI_DECODER_SUCCESS;
+          }
+        }
         table_size = BrotliBuildHuffmanTable(
             table, HUFFMAN_TABLE_BITS, h->symbol_lists, h->code_length_histo);
         if (opt_table_size) {
@@ -974,11 +1228,24 @@ static BrotliDecoderErrorCode HuffmanTreeGroupDecode(
   }
   while (h->htree_index < group->num_htrees) {
     uint32_t table_size;
-    BrotliDecoderErrorCode result = ReadHuffmanCode(group->alphabet_size_max,
-        group->alphabet_size_limit, h->next, &table_size, s);
+    HuffmanCode* cached_table = NULL;
+    uint16_t* deferred_code = NULL;
+    BrotliDecoderErrorCode result;
+    if (group == &s->literal_hgroup && s->literal_codes) {
+      /* Tree is built on first use, see PrepareLiteralDecoding. */
+      deferred_code =
+          &s->literal_codes[h->htree_index * BROTLI_LITERAL_CODE_SIZE];
+    }
+    result = ReadHuffmanCode(group->alphabet_size_max,
+        group->alphabet_size_limit, h->next, &table_size,
+        deferred_code ? NULL : &cached_table, deferred_code, s);
     if (result != BROTLI_DECODER_SUCCESS) return result;
-    group->htrees[h->htree_index] = h->next;
-    h->next += table_size;
+    if (cached_table) {
+      group->htrees[h->htree_index] = cached_table;
+    } else if (!deferred_code) {
+      group->htrees[h->htree_index] = h->next;
+      h->next += table_size;
+    }
     ++h->htree_index;
   }
   h->substate_tree_group = BROTLI_STATE_TREE_GROUP_NONE;
@@ -1011,8 +1278,11 @@ static BrotliDecoderErrorCode DecodeContextMap(uint32_t context_map_size,
       h->context_index = 0;
       BROTLI_LOG_UINT(context_map_size);
       BROTLI_LOG_UINT(*num_htrees);
-      *context_map_arg =
-          (uint8_t*)BROTLI_DECODER_ALLOC(s, (size_t)context_map_size);
+      *context_map_arg = (uint8_t*)BrotliDecoderGetBuffer(s,
+          context_map_arg == &s->context_map ?
+              BROTLI_DECODER_BUFFER_CONTEXT_MAP :
+              BROTLI_DECODER_BUFFER_DIST_CONTEXT_MAP,
+          (size_t)context_map_size);
       if (*context_map_arg == 0) {
         return BROTLI_FAILURE(BROTLI_DECODER_ERROR_ALLOC_CONTEXT_MAP);
       }
@@ -1045,7 +1315,7 @@ static BrotliDecoderErrorCode DecodeContextMap(uint32_t context_map_size,
     case BROTLI_STATE_CONTEXT_MAP_HUFFMAN: {
       uint32_t alphabet_size = *num_htrees + h->max_run_length_prefix;
       result = ReadHuffmanCode(alphabet_size, alphabet_size,
-                               h->context_map_table, NULL, s);
+                               h->context_map_table, NULL, NULL, NULL, s);
       if (result != BROTLI_DECODER_SUCCESS) return result;
       h->code = 0xFFFF;
       h->substate_context_map = BROTLI_STATE_CONTEXT_MAP_DECODE;
@@ -1184,15 +1454,140 @@ static BROTLI_INLINE void DetectTrivialLiteralBlockTypes(
   }
 }
 
+/* Building multi-symbol table takes about as long as decoding a few thousand
+   literals, so it is not built for short metablocks, e.g. in streams that are
+   flushed often. */
+#define BROTLI_MULTI_TABLE_MIN_REMAINING_LEN (1 << 13)
+
+/* Builds multi-symbol table for the current literal tree. Tables are built
+   on first use, as most trees never decode a run of literals long enough to
+   pay off the construction. Tables only speed up decoding, so allocation
+   failure is not fatal. */
+static BROTLI_NOINLINE BROTLI_BOOL BuildLiteralMultiTable(
+    BrotliDecoderState* s, int insert_len) {
+  uint32_t tree = s->context_map_slice[0];
+  HuffmanMultiCode* table;
+  s->literal_multi_tried[tree >> 5] |= 1u << (tree & 31);
+  /* Insert length is already subtracted from remaining length. */
+  if (s->meta_block_remaining_len + insert_len <
+      BROTLI_MULTI_TABLE_MIN_REMAINING_LEN) {
+    return BROTLI_FALSE;
+  }
+  if (s->literal_multi_tables == NULL) {
+    size_t size = sizeof(HuffmanMultiCode*) * s->num_literal_htrees;
+    s->literal_multi_tables =
+        (HuffmanMultiCode**)BrotliDecoderAllocCounted(s, size);
+    if (s->literal_multi_tables == NULL) return BROTLI_FALSE;
+    memset(s->literal_multi_tables, 0, size);
+  }
+  table = (HuffmanMultiCode*)BrotliDecoderAllocCounted(s,
+      sizeof(HuffmanMultiCode) * BROTLI_HUFFMAN_MULTI_TABLE_SIZE);
+  if (table == NULL) return BROTLI_FALSE;
+  if (!BrotliBuildHuffmanMultiTable(
+      table, s->literal_htree, HUFFMAN_TABLE_BITS)) {
+    BrotliDecoderFreeCounted(s, table,
+        sizeof(HuffmanMultiCode) * BROTLI_HUFFMAN_MULTI_TABLE_SIZE);
+    return BROTLI_FALSE;
+  }
+  s->literal_multi_tables[tree] = table;
+  s->literal_multi_table = table;
+  return BROTLI_TRUE;
+}
+
+static BROTLI_INLINE BROTLI_BOOL EnsureLiteralMultiTable(
+    BrotliDecoderState* s, int insert_len) {
+  uint32_t tree = s->context_map_slice[0];
+  if (s->literal_multi_table) return BROTLI_TRUE;
+  if ((s->literal_multi_tried[tree >> 5] >> (tree & 31)) & 1) {
+    return BROTLI_FALSE;
+  }
+  return BuildLiteralMultiTable(s, insert_len);
+}
+
+/* Builds literal tree from code lengths stored by ReadHuffmanCode. Stored
+   code is used up, as it is built only once. */
+static BROTLI_BOOL BuildLiteralTree(BrotliDecoderState* s, uint32_t tree) {
+  uint16_t* code = &s->literal_codes[tree * BROTLI_LITERAL_CODE_SIZE];
+  uint16_t* count = &code[BROTLI_LITERAL_CODE_HISTO];
+  uint16_t* symbol_lists =
+      &code[BROTLI_LITERAL_CODE_LISTS + BROTLI_HUFFMAN_MAX_CODE_LENGTH + 1];
+  BrotliDecoderTableChunk* chunk = s->literal_table_chunks;
+  HuffmanCode* table;
+
+  if (code[0] == BROTLI_LITERAL_CODE_COMPLEX && s->huffman_cache_size != 0) {
+    int next_symbol[BROTLI_HUFFMAN_MAX_CODE_LENGTH + 1];
+    int i;
+    for (i = 0; i <= BROTLI_HUFFMAN_MAX_CODE_LENGTH; ++i) {
+      next_symbol[i] = (int16_t)code[BROTLI_LITERAL_CODE_TAILS + i];
+    }
+    table = BuildHuffmanTableCached(s, symbol_lists, count, next_symbol);
+    if (table) {
+      s->literal_hgroup.htrees[tree] = table;
+      return BROTLI_TRUE;
+    }
+  }
+
+  if (chunk->capacity - chunk->used < BROTLI_HUFFMAN_MAX_SIZE_258) {
+    uint32_t capacity =
+        BROTLI_HUFFMAN_MAX_SIZE_258 * BROTLI_TABLE_CHUNK_MAX_TREES;
+    chunk = (BrotliDecoderTableChunk*)BrotliDecoderAllocCounted(s,
+        sizeof(BrotliDecoderTableChunk) + sizeof(HuffmanCode) * capacity);
+    if (!chunk) return BROTLI_FALSE;
+    chunk->next = s->literal_table_chunks;
+    chunk->capacity = capacity;
+    chunk->used = 0;
+    s->literal_table_chunks = chunk;
+  }
+  table = (HuffmanCode*)&chunk[1] + chunk->used;
+
+  if (code[0] == BROTLI_LITERAL_CODE_COMPLEX) {
+    chunk->used += BrotliBuildHuffmanTable(
+        table, HUFFMAN_TABLE_BITS, symbol_lists, count);
+  } else {
+    chunk->used += BrotliBuildSimpleHuffmanTable(
+        table, HUFFMAN_TABLE_BITS, &code[1], code[0]);
+  }
+  s->literal_hgroup.htrees[tree] = table;
+  return BROTLI_TRUE;
+}
+
+/* Builds literal trees used by the current block type. Building is deferred
+   from HuffmanTreeGroupDecode, as streams often declare many trees, but use
+   only a few of them. */
+static BROTLI_NOINLINE BROTLI_BOOL BuildLiteralTrees(
+    BrotliDecoderState* s, uint32_t block_type, size_t trivial) {
+  /* All contexts of trivial block type use the same tree. */
+  uint32_t num_contexts = trivial ? 1 : (1u << BROTLI_LITERAL_CONTEXT_BITS);
+  uint32_t i;
+  for (i = 0; i < num_contexts; ++i) {
+    uint32_t tree = s->context_map_slice[i];
+    if (!s->literal_hgroup.htrees[tree] && !BuildLiteralTree(s, tree)) {
+      return BROTLI_FALSE;
+    }
+  }
+  s->literal_types_ready[block_type >> 5] |= 1u << (block_type & 31);
+  return BROTLI_TRUE;
+}
+
+/* Sets |literal_htree| to NULL if trees of the block type could not be
+   built; caller reports the allocation failure. */
 static BROTLI_INLINE void PrepareLiteralDecoding(BrotliDecoderState* s) {
   uint8_t context_mode;
   size_t trivial;
   uint32_t block_type = s->block_type_rb[1];
   uint32_t context_offset = block_type << BROTLI_LITERAL_CONTEXT_BITS;
+  size_t ready = s->literal_types_ready[block_type >> 5];
   s->context_map_slice = s->context_map + context_offset;
   trivial = s->trivial_literal_contexts[block_type >> 5];
   s->trivial_literal_context = (trivial >> (block_type & 31)) & 1;
+  if (!((ready >> (block_type & 31)) & 1) &&
+      !BuildLiteralTrees(s, block_type, s->trivial_literal_context)) {
+    s->literal_htree = NULL;
+    return;
+  }
   s->literal_htree = s->literal_hgroup.htrees[s->context_map_slice[0]];
+  s->literal_multi_table = s->literal_multi_tables ?
+      s->literal_multi_tables[s->context_map_slice[0]] : NULL;
   context_mode = s->context_modes[block_type] & 3;
   s->context_lookup = BROTLI_CONTEXT_LUT(context_mode);
 }
@@ -1303,21 +1698,41 @@ static size_t UnwrittenBytes(const BrotliDecoderState* s, BROTLI_BOOL wrap) {
 static BrotliDecoderErrorCode BROTLI_NOINLINE WriteRingBuffer(
     BrotliDecoderState* s, size_t* available_out, uint8_t** next_out,
     size_t* total_out, BROTLI_BOOL force) {
-  uint8_t* start =
-      s->ringbuffer + (s->partial_pos_out & (size_t)s->ringbuffer_mask);
+  uint8_t* start;
   size_t to_write = UnwrittenBytes(s, BROTLI_TRUE);
-  size_t num_written = *available_out;
+  size_t num_written;
+  if (s->meta_block_remaining_len < 0) {
+    return BROTLI_FAILURE(BROTLI_DECODER_ERROR_FORMAT_BLOCK_LENGTH_1);
+  }
+  if (BROTLI_PREDICT_FALSE(s->output_skip != 0)) {
+    /* Drop bytes of the chunk that precede the seek offset. */
+    size_t skip = BROTLI_MIN(size_t, s->output_skip, to_write);
+    s->output_skip -= skip;
+    s->output_skipped += skip;
+    s->partial_pos_out += skip;
+    to_write -= skip;
+  }
+  start = s->ringbuffer + (s->partial_pos_out & (size_t)s->ringbuffer_mask);
+  num_written = *available_out;
   if (num_written > to_write) {
     num_written = to_write;
   }
-  if (s->meta_block_remaining_len < 0) {
-    return BROTLI_FAILURE(BROTLI_DECODER_ERROR_FORMAT_BLOCK_LENGTH_1);
+  if (s->max_output_ratio != 0 && num_written != 0) {
+    /* Bytes buffered by bit reader are counted as consumed; bytes dropped
+       by seek are not counted as output. */
+    size_t total_in =
+        s->buffer_length != 0 ? s->total_in : s->input_end - s->br.avail_in;
+    size_t produced = s->partial_pos_out - s->output_skipped + num_written;
+    if (produced / s->max_output_ratio > total_in) {
+      return BROTLI_FAILURE(BROTLI_DECODER_ERROR_LIMIT_OUTPUT_RATIO);
+    }
   }
   if (next_out && !*next_out) {
     *next_out = start;
   } else {
     if (next_out) {
-      memcpy(*next_out, start, num_written);
+      /* Data decoded directly to output is already in place. */
+      if (*next_out != start) memcpy(*next_out, start, num_written);
       *next_out += num_written;
     }
   }
@@ -1366,20 +1781,45 @@ static BROTLI_BOOL BROTLI_NOINLINE BrotliEnsureRingBuffer(
     return BROTLI_TRUE;
   }
 
-  s->ringbuffer = (uint8_t*)BROTLI_DECODER_ALLOC(s,
-      (size_t)(s->new_ringbuffer_size) + kRingBufferWriteAheadSlack);
-  if (s->ringbuffer == 0) {
-    /* Restore previous value. */
+  if (s->output_ringbuffer) {
+    /* Output is never wrapped, so masked positions are always inside the
+       window and mask could be trivial; context of the first two bytes is
+       handled in ProcessCommands. */
+    s->ringbuffer = s->output_ringbuffer;
+    s->ringbuffer_size = s->new_ringbuffer_size;
+    s->ringbuffer_mask = 0x7FFFFFFF;
+    s->ringbuffer_end = s->ringbuffer + s->ringbuffer_size;
+    return BROTLI_TRUE;
+  }
+
+  if (!old_ringbuffer && s->kept_ringbuffer) {
+    /* Buffer of the previous stream; its contents are irrelevant. */
+    old_ringbuffer = s->kept_ringbuffer;
+    s->kept_ringbuffer = NULL;
     s->ringbuffer = old_ringbuffer;
-    return BROTLI_FALSE;
   }
-  s->ringbuffer[s->new_ringbuffer_size - 2] = 0;
-  s->ringbuffer[s->new_ringbuffer_size - 1] = 0;
 
-  if (!!old_ringbuffer) {
-    memcpy(s->ringbuffer, old_ringbuffer, (size_t)s->pos);
-    BROTLI_DECODER_FREE(s, old_ringbuffer);
+  if (!!old_ringbuffer && s->ringbuffer_capacity >= s->new_ringbuffer_size) {
+    /* Grow in place; bytes past |pos| are not used yet. */
+  } else {
+    /* Fails without allocation if memory limit would be exceeded. */
+    s->ringbuffer = (uint8_t*)BrotliDecoderAllocCounted(s,
+        (size_t)(s->new_ringbuffer_size) + kRingBufferWriteAheadSlack);
+    if (s->ringbuffer == 0) {
+      /* Restore previous value. */
+      s->ringbuffer = old_ringbuffer;
+      return BROTLI_FALSE;
+    }
+    if (!!old_ringbuffer) {
+      memcpy(s->ringbuffer, old_ringbuffer, (size_t)s->pos);
+      BrotliDecoderFreeCounted(s, old_ringbuffer,
+          (size_t)s->ringbuffer_capacity + kRingBufferWriteAheadSlack);
+    }
+    s->ringbuffer_capacity = s->new_ringbuffer_size;
   }
+  /* Context of the first bytes; zero unless chunk is decoded. */
+  s->ringbuffer[s->new_ringbuffer_size - 2] = s->chunk_context[1];
+  s->ringbuffer[s->new_ringbuffer_size - 1] = s->chunk_context[0];
 
   s->ringbuffer_size = s->new_ringbuffer_size;
   s->ringbuffer_mask = s->new_ringbuffer_size - 1;
@@ -1388,6 +1828,54 @@ static BROTLI_BOOL BROTLI_NOINLINE BrotliEnsureRingBuffer(
   return BROTLI_TRUE;
 }
 
+/* Uncompressed bytes could bypass ring-buffer when everything before them is
+   already output, and output goes to the client buffer. */
+static BROTLI_INLINE BROTLI_BOOL CanPassThrough(const BrotliDecoderState* s,
+    size_t available_out, uint8_t** next_out) {
+  return TO_BROTLI_BOOL(available_out != 0 && next_out && *next_out &&
+      !s->output_ringbuffer && s->output_skip == 0 &&
+      s->max_output_ratio == 0 && !s->should_wrap_ringbuffer &&
+      s->ringbuffer_size == 1 << s->window_bits &&
+      UnwrittenBytes(s, BROTLI_FALSE) == 0);
+}
+
+/* Copies uncompressed bytes straight from input to output. Ring-buffer only
+   receives bytes that are not overwritten by the rest of the metablock, so
+   that long blocks are not copied twice. */
+static void BROTLI_NOINLINE PassThroughUncompressed(BrotliDecoderState* s,
+    size_t nbytes, size_t* available_out, uint8_t** next_out,
+    size_t* total_out) {
+  size_t size = (size_t)s->ringbuffer_size;
+  size_t remaining;
+  size_t keep;
+  size_t end;
+  uint8_t* src;
+  if (nbytes > *available_out) nbytes = *available_out;
+  BrotliCopyBytes(*next_out, &s->br, nbytes);
+  remaining = (size_t)s->meta_block_remaining_len - nbytes;
+  keep = remaining < size ? size - remaining : 0;
+  if (keep > nbytes) keep = nbytes;
+  /* Ring-buffer positions of the kept tail are [end - keep, end). */
+  src = *next_out + nbytes - keep;
+  end = ((size_t)s->pos + nbytes) & (size - 1);
+  if (keep > end) {
+    memcpy(s->ringbuffer + size - (keep - end), src, keep - end);
+    src += keep - end;
+    keep = end;
+  }
+  memcpy(s->ringbuffer + end - keep, src, keep);
+  s->rb_roundtrips += ((size_t)s->pos + nbytes) / size;
+  if ((size_t)s->pos + nbytes >= size) {
+    s->max_distance = s->max_backward_distance;
+  }
+  s->pos = (int)end;
+  s->meta_block_remaining_len -= (int)nbytes;
+  s->partial_pos_out += nbytes;
+  *next_out += nbytes;
+  *available_out -= nbytes;
+  if (total_out) *total_out = s->partial_pos_out;
+}
+
 static BrotliDecoderErrorCode BROTLI_NOINLINE CopyUncompressedBlockToOutput(
     size_t* available_out, uint8_t** next_out, size_t* total_out,
     BrotliDecoderState* s) {
@@ -1404,6 +1892,14 @@ static BrotliDecoderErrorCode BROTLI_NOINLINE CopyUncompressedBlockToOutput(
         if (nbytes > s->meta_block_remaining_len) {
           nbytes = s->meta_block_remaining_len;
         }
+        if (nbytes != 0 && CanPassThrough(s, *available_out, next_out)) {
+          PassThroughUncompressed(s, (size_t)nbytes, available_out, next_out,
+              total_out);
+          if (s->meta_block_remaining_len == 0) {
+            return BROTLI_DECODER_SUCCESS;
+          }
+          continue;
+        }
         if (s->pos + nbytes > s->ringbuffer_size) {
           nbytes = s->ringbuffer_size - s->pos;
         }
@@ -1411,7 +1907,9 @@ static BrotliDecoderErrorCode BROTLI_NOINLINE CopyUncompressedBlockToOutput(
         BrotliCopyBytes(&s->ringbuffer[s->pos], &s->br, (size_t)nbytes);
         s->pos += nbytes;
         s->meta_block_remaining_len -= nbytes;
-        if (s->pos < 1 << s->window_bits) {
+        /* Output used as ring-buffer is larger than window, but is never
+           wrapped; metablock is known to fit into it. */
+        if (s->pos < 1 << s->window_bits || s->output_ringbuffer) {
           if (s->meta_block_remaining_len == 0) {
             return BROTLI_DECODER_SUCCESS;
           }
@@ -1444,8 +1942,11 @@ static BrotliDecoderErrorCode BROTLI_NOINLINE CopyUncompressedBlockToOutput(
    If we know the data size is small, do not allocate more ring buffer
    size than needed to reduce memory usage.
 
-   When this method is called, metablock size and flags MUST be decoded. */
-static void BROTLI_NOINLINE BrotliCalculateRingBufferSize(
+   When this method is called, metablock size and flags MUST be decoded.
+
+   Returns BROTLI_FALSE if metablock does not fit into the output used as
+   ring-buffer. */
+static BROTLI_BOOL BROTLI_NOINLINE BrotliCalculateRingBufferSize(
     BrotliDecoderState* s) {
   int window_size = 1 << s->window_bits;
   int new_ringbuffer_size = window_size;
@@ -1456,12 +1957,12 @@ static void BROTLI_NOINLINE BrotliCalculateRingBufferSize(
 
   /* If maximum is already reached, no further extension is retired. */
   if (s->ringbuffer_size == window_size) {
-    return;
+    return BROTLI_TRUE;
   }
 
   /* Metadata blocks does not touch ring buffer. */
   if (s->is_metadata) {
-    return;
+    return BROTLI_TRUE;
   }
 
   if (!s->ringbuffer) {
@@ -1470,6 +1971,16 @@ static void BROTLI_NOINLINE BrotliCalculateRingBufferSize(
     output_size = s->pos;
   }
   output_size += s->meta_block_remaining_len;
+
+  if (s->output_ringbuffer) {
+    /* Ring-buffer of window size is wrapped when full; output must not be. */
+    if (s->output_ringbuffer_size == window_size) {
+      s->output_ringbuffer_size--;
+    }
+    if (output_size > s->output_ringbuffer_size) return BROTLI_FALSE;
+    s->new_ringbuffer_size = s->output_ringbuffer_size;
+    return BROTLI_TRUE;
+  }
   min_size = min_size < output_size ? output_size : min_size;
 
   if (!!s->canny_ringbuffer_allocation) {
@@ -1482,6 +1993,46 @@ static void BROTLI_NOINLINE BrotliCalculateRingBufferSize(
   }
 
   s->new_ringbuffer_size = new_ringbuffer_size;
+  return BROTLI_TRUE;
+}
+
+/* Continues one-shot decoding with own ring-buffer when the next metablock
+   does not fit into the output used as ring-buffer. Everything decoded so
+   far is already in place, so it is only accounted as written; ring-buffer
+   receives the last window of it, as if it was decoded there. */
+static BrotliDecoderErrorCode BROTLI_NOINLINE LeaveOutputRingBuffer(
+    BrotliDecoderState* s, size_t* available_out, uint8_t** next_out,
+    size_t* total_out) {
+  const uint8_t* output = s->output_ringbuffer;
+  size_t total = (size_t)s->pos;
+  size_t size;
+  size_t head;
+  if (s->ringbuffer) {
+    BrotliDecoderErrorCode result =
+        WriteRingBuffer(s, available_out, next_out, total_out, BROTLI_TRUE);
+    if (result != BROTLI_DECODER_SUCCESS) return result;
+  }
+  /* Size is chosen as if output so far was decoded into ring-buffer. */
+  s->output_ringbuffer = NULL;
+  s->ringbuffer_size = 0;
+  BrotliCalculateRingBufferSize(s);
+  s->ringbuffer = NULL;
+  if (!BrotliEnsureRingBuffer(s)) {
+    return BROTLI_FAILURE(BROTLI_DECODER_ERROR_ALLOC_RING_BUFFER_1);
+  }
+  size = (size_t)s->ringbuffer_size;
+  if (total < size) {
+    memcpy(s->ringbuffer, output, total);
+    return BROTLI_DECODER_SUCCESS;
+  }
+  /* Only a ring-buffer of window size is smaller than output so far. */
+  head = total & (size - 1);
+  memcpy(s->ringbuffer + head, output + total - size, size - head);
+  memcpy(s->ringbuffer, output + total - head, head);
+  s->pos = (int)head;
+  s->rb_roundtrips = total / size;
+  s->max_distance = s->max_backward_distance;
+  return BROTLI_DECODER_SUCCESS;
 }
 
 /* Reads 1..256 2-bit context modes. */
@@ -1755,6 +2306,53 @@ static BROTLI_INLINE BROTLI_BOOL CheckInputAmount(
   return BrotliCheckInputAmount(br, num);
 }
 
+/* Prepares copy of |length| bytes from |offset| in compound dictionary.
+   Copy is not allowed to cross the end of dictionary. */
+static BROTLI_BOOL InitializeCompoundDictionaryCopy(BrotliDecoderState* s,
+    int offset, int length) {
+  BrotliDecoderCompoundDictionary* addon = s->compound_dictionary;
+  int index = 0;
+  if (length > addon->total_size - offset) return BROTLI_FALSE;
+  while (offset >= addon->chunk_offsets[index + 1]) index++;
+  /* Update the recent distances cache. */
+  s->dist_rb[s->dist_rb_idx & 3] = s->distance_code;
+  ++s->dist_rb_idx;
+  s->meta_block_remaining_len -= length;
+  addon->br_index = index;
+  addon->br_offset = offset - addon->chunk_offsets[index];
+  addon->br_length = length;
+  addon->br_copied = 0;
+  return BROTLI_TRUE;
+}
+
+/* Continues pending compound dictionary copy, until it is complete or the end
+   of ring-buffer is reached. Returns number of bytes written. */
+static int CopyFromCompoundDictionary(BrotliDecoderState* s, int pos) {
+  BrotliDecoderCompoundDictionary* addon = s->compound_dictionary;
+  int orig_pos = pos;
+  while (addon->br_length != addon->br_copied) {
+    uint8_t* copy_dst = &s->ringbuffer[pos];
+    const uint8_t* copy_src =
+        addon->chunks[addon->br_index] + addon->br_offset;
+    int space = s->ringbuffer_size - pos;
+    int rem_chunk_length = (addon->chunk_offsets[addon->br_index + 1] -
+        addon->chunk_offsets[addon->br_index]) - addon->br_offset;
+    int length = addon->br_length - addon->br_copied;
+    if (length > rem_chunk_length) length = rem_chunk_length;
+    if (length > space) length = space;
+    memcpy(copy_dst, copy_src, (size_t)length);
+    pos += length;
+    addon->br_offset += length;
+    addon->br_copied += length;
+    if (length == rem_chunk_length) {
+      addon->br_index++;
+      addon->br_offset = 0;
+    }
+    if (pos == s->ringbuffer_size) break;
+  }
+  return pos - orig_pos;
+}
+
 #define BROTLI_SAFE(METHOD)                       \
   {                                               \
     if (safe) {                                   \
@@ -1767,13 +2365,54 @@ static BROTLI_INLINE BROTLI_BOOL CheckInputAmount(
     }                                             \
   }
 
+/* Same as BrotliTransformDictionaryWord, but looks up the result in the word
+   cache first. Writes up to 15 bytes past the end of the word. */
+static BROTLI_NOINLINE int TransformDictionaryWordCached(
+    BrotliDecoderState* s, uint8_t* dst, const uint8_t* word, int len,
+    int word_idx, int transform_idx) {
+  BrotliDecoderWordCacheEntry* entry;
+  uint32_t key = ((uint32_t)transform_idx << 20) |
+      ((uint32_t)word_idx << 5) | (uint32_t)len;
+  if (!s->word_cache) {
+    size_t size = sizeof(BrotliDecoderWordCacheEntry) * s->word_cache_size;
+    s->word_cache =
+        (BrotliDecoderWordCacheEntry*)BrotliDecoderAllocCounted(s, size);
+    /* Allocation failure is not fatal; cache is disabled then. */
+    if (!s->word_cache) {
+      s->word_cache_size = 0;
+      return BrotliTransformDictionaryWord(
+          dst, word, len, s->transforms, transform_idx);
+    }
+    memset(s->word_cache, 0, size);
+    s->word_cache_entries = s->word_cache_size;
+  }
+  entry = &s->word_cache[(uint32_t)(
+      ((uint64_t)(key * 0x1E35A7BDu) * s->word_cache_entries) >> 32)];
+  if (entry->key == key) {
+    memmove16(dst, entry->data);
+    if (entry->length > 16) memmove16(dst + 16, entry->data + 16);
+    if (entry->length > 32) {
+      memcpy(dst + 32, entry->data + 32, entry->length - 32);
+    }
+    return (int)entry->length;
+  }
+  len = BrotliTransformDictionaryWord(dst, word, len, s->transforms,
+      transform_idx);
+  if (len <= BROTLI_WORD_CACHE_MAX_LENGTH) {
+    entry->key = key;
+    entry->length = (uint32_t)len;
+    memcpy(entry->data, dst, (size_t)len);
+  }
+  return len;
+}
+
 static BROTLI_INLINE BrotliDecoderErrorCode ProcessCommandsInternal(
     int safe, BrotliDecoderState* s) {
   int pos = s->pos;
   int i = s->loop_counter;
   BrotliDecoderErrorCode result = BROTLI_DECODER_SUCCESS;
   BrotliBitReader* br = &s->br;
-  if (!CheckInputAmount(safe, br, 28)) {
+  if (!CheckInputAmount(safe, br, 32)) {
     result = BROTLI_DECODER_NEEDS_MORE_INPUT;
     goto saveStateAndReturn;
   }
@@ -1798,7 +2437,7 @@ CommandBegin:
   if (safe) {
     s->state = BROTLI_STATE_COMMAND_BEGIN;
   }
-  if (!CheckInputAmount(safe, br, 28)) {  /* 156 bits + 7 bytes */
+  if (!CheckInputAmount(safe, br, 32)) {  /* 156 bits + 12 bytes */
     s->state = BROTLI_STATE_COMMAND_BEGIN;
     result = BROTLI_DECODER_NEEDS_MORE_INPUT;
     goto saveStateAndReturn;
@@ -1825,18 +2464,74 @@ CommandInner:
     s->state = BROTLI_STATE_COMMAND_INNER;
   }
   /* Read the literals in the command. */
-  if (s->trivial_literal_context) {
+  if (!safe && s->trivial_literal_context && i >= 8 &&
+      EnsureLiteralMultiTable(s, i)) {
+    const HuffmanMultiCode* multi_table = s->literal_multi_table;
+    do {
+      int n = 0;
+      if (!CheckInputAmount(safe, br, 32)) {  /* 162 bits + 11 bytes */
+        s->state = BROTLI_STATE_COMMAND_INNER;
+        result = BROTLI_DECODER_NEEDS_MORE_INPUT;
+        goto saveStateAndReturn;
+      }
+      if (BROTLI_PREDICT_FALSE(s->block_length[0] == 0)) {
+        BROTLI_SAFE(DecodeLiteralBlockSwitch(s, pos));
+        if (BROTLI_PREDICT_FALSE(!s->literal_htree)) {
+          result = BROTLI_FAILURE(BROTLI_DECODER_ERROR_ALLOC_TREE_GROUPS);
+          goto saveStateAndReturn;
+        }
+        goto CommandInner;
+      }
+      {
+        /* Decode pairs while both literals fit into the command, block and
+           ring buffer. Local copy of bit reader does not alias the output,
+           so it stays in registers. */
+        BrotliBitReader fast_br = *br;
+        uint8_t* out = &s->ringbuffer[pos];
+        int limit = BROTLI_MIN(int, i, (int)s->block_length[0]);
+        limit = BROTLI_MIN(int, limit, s->ringbuffer_size - pos) - 1;
+        while (n < limit && BrotliCheckInputAmount(&fast_br, 32)) {
+          HuffmanMultiCode entry = multi_table[
+              BrotliGetBits(&fast_br, BROTLI_HUFFMAN_MULTI_TABLE_BITS)];
+          if (BROTLI_PREDICT_FALSE(BROTLI_HMC_COUNT(entry) == 0)) break;
+          BrotliDropBits(&fast_br, BROTLI_HMC_BITS(entry));
+          /* Unused second literal is harmless: ring buffer byte right after
+             the last one is out of window. */
+          out[n] = (uint8_t)entry;
+          out[n + 1] = (uint8_t)(entry >> 8);
+          n += (int)BROTLI_HMC_COUNT(entry);
+        }
+        *br = fast_br;
+      }
+      if (n == 0) {
+        /* Long code, or the last literal before the limit. */
+        s->ringbuffer[pos] = (uint8_t)ReadSymbol(s->literal_htree, br);
+        n = 1;
+      }
+      s->block_length[0] -= (uint32_t)n;
+      pos += n;
+      i -= n;
+      if (BROTLI_PREDICT_FALSE(pos == s->ringbuffer_size)) {
+        s->state = BROTLI_STATE_COMMAND_INNER_WRITE;
+        goto saveStateAndReturn;
+      }
+    } while (i != 0);
+  } else if (s->trivial_literal_context) {
     uint32_t bits;
     uint32_t value;
     PreloadSymbol(safe, s->literal_htree, br, &bits, &value);
     do {
-      if (!CheckInputAmount(safe, br, 28)) {  /* 162 bits + 7 bytes */
+      if (!CheckInputAmount(safe, br, 32)) {  /* 162 bits + 11 bytes */
         s->state = BROTLI_STATE_COMMAND_INNER;
         result = BROTLI_DECODER_NEEDS_MORE_INPUT;
         goto saveStateAndReturn;
       }
       if (BROTLI_PREDICT_FALSE(s->block_length[0] == 0)) {
         BROTLI_SAFE(DecodeLiteralBlockSwitch(s, pos));
+        if (BROTLI_PREDICT_FALSE(!s->literal_htree)) {
+          result = BROTLI_FAILURE(BROTLI_DECODER_ERROR_ALLOC_TREE_GROUPS);
+          goto saveStateAndReturn;
+        }
         PreloadSymbol(safe, s->literal_htree, br, &bits, &value);
         if (!s->trivial_literal_context) goto CommandInner;
       }
@@ -1861,18 +2556,29 @@ CommandInner:
       }
     } while (--i != 0);
   } else {
-    uint8_t p1 = s->ringbuffer[(pos - 1) & s->ringbuffer_mask];
-    uint8_t p2 = s->ringbuffer[(pos - 2) & s->ringbuffer_mask];
+    uint8_t p1 = 0;
+    uint8_t p2 = 0;
+    if (BROTLI_PREDICT_TRUE(pos >= 2) || !s->output_ringbuffer) {
+      p1 = s->ringbuffer[(pos - 1) & s->ringbuffer_mask];
+      p2 = s->ringbuffer[(pos - 2) & s->ringbuffer_mask];
+    } else if (pos == 1) {
+      /* Output is not wrapped, there is no tail to take context from. */
+      p1 = s->ringbuffer[0];
+    }
     do {
       const HuffmanCode* hc;
       uint8_t context;
-      if (!CheckInputAmount(safe, br, 28)) {  /* 162 bits + 7 bytes */
+      if (!CheckInputAmount(safe, br, 32)) {  /* 162 bits + 11 bytes */
         s->state = BROTLI_STATE_COMMAND_INNER;
         result = BROTLI_DECODER_NEEDS_MORE_INPUT;
         goto saveStateAndReturn;
       }
       if (BROTLI_PREDICT_FALSE(s->block_length[0] == 0)) {
         BROTLI_SAFE(DecodeLiteralBlockSwitch(s, pos));
+        if (BROTLI_PREDICT_FALSE(!s->literal_htree)) {
+          result = BROTLI_FAILURE(BROTLI_DECODER_ERROR_ALLOC_TREE_GROUPS);
+          goto saveStateAndReturn;
+        }
         if (s->trivial_literal_context) goto CommandInner;
       }
       context = BROTLI_CONTEXT(p1, p2, s->context_lookup);
@@ -1949,7 +2655,33 @@ CommandPostDecodeLiterals:
           pos, s->distance_code, i, s->meta_block_remaining_len));
       return BROTLI_FAILURE(BROTLI_DECODER_ERROR_FORMAT_DISTANCE);
     }
-    if (i >= BROTLI_MIN_DICTIONARY_WORD_LENGTH &&
+    if (BROTLI_PREDICT_FALSE(s->chunk_offset != 0)) {
+      /* Bytes preceding the chunk are counted by dictionary addresses, but
+         could not be referenced. */
+      int base = s->max_distance;
+      if (base != s->max_backward_distance) {
+        base = BROTLI_MIN(int, pos + s->chunk_offset,
+            s->max_backward_distance);
+      }
+      if (s->distance_code <= base) {
+        return BROTLI_FAILURE(BROTLI_DECODER_ERROR_FORMAT_DISTANCE);
+      }
+      s->distance_code -= base - s->max_distance;
+    }
+    if (s->compound_dictionary && s->distance_code - s->max_distance - 1 <
+        s->compound_dictionary->total_size) {
+      /* Reference to the custom dictionary that precedes the stream. */
+      int address = s->distance_code - s->max_distance - 1;
+      if (!InitializeCompoundDictionaryCopy(s,
+          s->compound_dictionary->total_size - 1 - address, i)) {
+        return BROTLI_FAILURE(BROTLI_DECODER_ERROR_COMPOUND_DICTIONARY);
+      }
+      pos += CopyFromCompoundDictionary(s, pos);
+      if (pos >= s->ringbuffer_size) {
+        s->state = BROTLI_STATE_COMMAND_POST_WRITE_1;
+        goto saveStateAndReturn;
+      }
+    } else if (i >= BROTLI_MIN_DICTIONARY_WORD_LENGTH &&
         i <= BROTLI_MAX_DICTIONARY_WORD_LENGTH) {
       int address = s->distance_code - s->max_distance - 1;
       const BrotliDictionary* words = s->dictionary;
@@ -1958,8 +2690,14 @@ CommandPostDecodeLiterals:
       uint32_t shift = s->dictionary->size_bits_by_length[i];
 
       int mask = (int)BitMask(shift);
-      int word_idx = address & mask;
-      int transform_idx = address >> shift;
+      int word_idx;
+      int transform_idx;
+      /* Static dictionary follows the custom one. */
+      if (s->compound_dictionary) {
+        address -= s->compound_dictionary->total_size;
+      }
+      word_idx = address & mask;
+      transform_idx = address >> shift;
       /* Compensate double distance-ring-buffer roll. */
       s->dist_rb_idx += s->distance_context;
       offset += word_idx * i;
@@ -1973,6 +2711,9 @@ CommandPostDecodeLiterals:
           memcpy(&s->ringbuffer[pos], word, (size_t)len);
           BROTLI_LOG(("[ProcessCommandsInternal] dictionary word: [%.*s]\n",
                       len, word));
+        } else if (s->word_cache_size != 0) {
+          len = TransformDictionaryWordCached(s, &s->ringbuffer[pos], word,
+              len, word_idx, transform_idx);
         } else {
           len = BrotliTransformDictionaryWord(&s->ringbuffer[pos], word, len,
               transforms, transform_idx);
@@ -2014,6 +2755,13 @@ CommandPostDecodeLiterals:
     memmove16(copy_dst, copy_src);
     if (src_end > pos && dst_end > src_start) {
       /* Regions intersect. */
+      if (src_start < pos && dst_end < s->ringbuffer_size) {
+        /* Source precedes destination: repeating pattern. Overshoot stays
+           within 16 bytes past the end, like the first guess above. */
+        CopyOverlapped(copy_dst, s->distance_code, i);
+        pos += i;
+        goto CommandPostCopy;
+      }
       goto CommandPostWrapCopy;
     }
     if (dst_end >= s->ringbuffer_size || src_end >= s->ringbuffer_size) {
@@ -2031,6 +2779,7 @@ CommandPostDecodeLiterals:
       }
     }
   }
+CommandPostCopy:
   BROTLI_LOG_UINT(s->meta_block_remaining_len);
   if (s->meta_block_remaining_len <= 0) {
     /* Next metablock, if any. */
@@ -2092,26 +2841,41 @@ BrotliDecoderResult BrotliDecoderDecompress(
   const uint8_t* next_in = encoded_buffer;
   size_t available_out = *decoded_size;
   uint8_t* next_out = decoded_buffer;
+  /* Output is used as ring-buffer while decoded data and write-ahead slack
+     fit into it; then decoder continues with own ring-buffer. Window is
+     limited so that positions do not overflow. */
+  size_t direct_size = BROTLI_MIN(size_t, available_out, 1u << 30);
+  BROTLI_BOOL direct = TO_BROTLI_BOOL(!save_info_for_recompression &&
+      direct_size > kRingBufferWriteAheadSlack + 2);
+
   s.save_info_for_recompression = save_info_for_recompression;
 
   if (!BrotliDecoderStateInit(&s, 0, 0, 0)) {
     return BROTLI_DECODER_RESULT_ERROR;
   }
+  if (direct) {
+    s.output_ringbuffer = decoded_buffer;
+    s.output_ringbuffer_size = (int)(direct_size - kRingBufferWriteAheadSlack);
+  }
   result = BrotliDecoderDecompressStream(
       &s, &available_in, &next_in, &available_out, &next_out, &total_out);
   *decoded_size = total_out;
-  BrotliDecoderStateCleanup(&s);
-  if (result != BROTLI_DECODER_RESULT_SUCCESS) {
-    result = BROTLI_DECODER_RESULT_ERROR;
-  }
+  if (s.ringbuffer == decoded_buffer) s.ringbuffer = NULL;
   if (s.save_info_for_recompression) {
+    /* Ownership passes to the caller, so cleanup must not free them. */
     *backward_references = s.commands;
     *backward_references_size = s.commands_size;
     *literals_block_splits = s.literals_block_splits;
     *insert_copy_length_block_splits = s.insert_copy_length_block_splits;
+    s.commands = NULL;
+    memset(&s.literals_block_splits, 0, sizeof(BlockSplitFromDecoder));
+    memset(&s.insert_copy_length_block_splits, 0,
+        sizeof(BlockSplitFromDecoder));
+  }
+  BrotliDecoderStateCleanup(&s);
+  if (result != BROTLI_DECODER_RESULT_SUCCESS) {
+    result = BROTLI_DECODER_RESULT_ERROR;
   }
-
-
   return result;
 }
 
@@ -2135,6 +2899,8 @@ BrotliDecoderResult BrotliDecoderDecompressStream(
   if (s->save_info_for_recompression && !s->commands) {
     s->commands = (BackwardReferenceFromDecoder*)BROTLI_DECODER_ALLOC(
          s, sizeof(BackwardReferenceFromDecoder) * (int)((float)*available_in));
+    /* Flag could be set with BrotliDecoderSetParameter after init. */
+    BrotliDecoderStateInitBlockSplits(s);
   }
   /* Ensure that |total_out| is set, even if no data will ever be pushed out. */
   if (total_out) {
@@ -2149,6 +2915,7 @@ BrotliDecoderResult BrotliDecoderDecompressStream(
         s, BROTLI_FAILURE(BROTLI_DECODER_ERROR_INVALID_ARGUMENTS));
   }
   if (!*available_out) next_out = 0;
+  s->input_end = s->total_in + *available_in;
   if (s->buffer_length == 0) {  /* Just connect bit reader to input stream. */
     br->avail_in = *available_in;
     br->next_in = *next_in;
@@ -2266,10 +3033,13 @@ BrotliDecoderResult BrotliDecoderDecompressStream(
         /* Maximum distance, see section 9.1. of the spec. */
         s->max_backward_distance = (1 << s->window_bits) - BROTLI_WINDOW_GAP;
 
-        /* Allocate memory for both block_type_trees and block_len_trees. */
-        s->block_type_trees = (HuffmanCode*)BROTLI_DECODER_ALLOC(s,
-            sizeof(HuffmanCode) * 3 *
-                (BROTLI_HUFFMAN_MAX_SIZE_258 + BROTLI_HUFFMAN_MAX_SIZE_26));
+        /* Allocate memory for both block_type_trees and block_len_trees;
+           it is kept by BrotliDecoderReset. */
+        if (!s->block_type_trees) {
+          s->block_type_trees = (HuffmanCode*)BrotliDecoderAllocCounted(s,
+              sizeof(HuffmanCode) * 3 *
+                  (BROTLI_HUFFMAN_MAX_SIZE_258 + BROTLI_HUFFMAN_MAX_SIZE_26));
+        }
         if (s->block_type_trees == 0) {
           result = BROTLI_FAILURE(BROTLI_DECODER_ERROR_ALLOC_BLOCK_TYPE_TREES);
           break;
@@ -2309,7 +3079,11 @@ BrotliDecoderResult BrotliDecoderDecompressStream(
           s->state = BROTLI_STATE_METABLOCK_DONE;
           break;
         }
-        BrotliCalculateRingBufferSize(s);
+        if (!BrotliCalculateRingBufferSize(s)) {
+          /* Only in one-shot mode. */
+          result = LeaveOutputRingBuffer(s, available_out, next_out, total_out);
+          if (result != BROTLI_DECODER_SUCCESS) break;
+        }
         if (s->is_uncompressed) {
           s->state = BROTLI_STATE_UNCOMPRESSED;
           break;
@@ -2355,7 +3129,7 @@ BrotliDecoderResult BrotliDecoderDecompressStream(
         uint32_t alphabet_size = s->num_block_types[s->loop_counter] + 2;
         int tree_offset = s->loop_counter * BROTLI_HUFFMAN_MAX_SIZE_258;
         result = ReadHuffmanCode(alphabet_size, alphabet_size,
-            &s->block_type_trees[tree_offset], NULL, s);
+            &s->block_type_trees[tree_offset], NULL, NULL, NULL, s);
         if (result != BROTLI_DECODER_SUCCESS) break;
         s->state = BROTLI_STATE_HUFFMAN_CODE_2;
       }
@@ -2365,7 +3139,7 @@ BrotliDecoderResult BrotliDecoderDecompressStream(
         uint32_t alphabet_size = BROTLI_NUM_BLOCK_LEN_SYMBOLS;
         int tree_offset = s->loop_counter * BROTLI_HUFFMAN_MAX_SIZE_26;
         result = ReadHuffmanCode(alphabet_size, alphabet_size,
-            &s->block_len_trees[tree_offset], NULL, s);
+            &s->block_len_trees[tree_offset], NULL, NULL, NULL, s);
         if (result != BROTLI_DECODER_SUCCESS) break;
         s->state = BROTLI_STATE_HUFFMAN_CODE_3;
       }
@@ -2419,8 +3193,9 @@ BrotliDecoderResult BrotliDecoderDecompressStream(
         s->num_direct_distance_codes = bits << s->distance_postfix_bits;
         BROTLI_LOG_UINT(s->num_direct_distance_codes);
         BROTLI_LOG_UINT(s->distance_postfix_bits);
-        s->context_modes =
-            (uint8_t*)BROTLI_DECODER_ALLOC(s, (size_t)s->num_block_types[0]);
+        s->context_modes = (uint8_t*)BrotliDecoderGetBuffer(s,
+            BROTLI_DECODER_BUFFER_CONTEXT_MODES,
+            (size_t)s->num_block_types[0]);
         if (s->context_modes == 0) {
           result = BROTLI_FAILURE(BROTLI_DECODER_ERROR_ALLOC_CONTEXT_MODES);
           break;
@@ -2469,15 +3244,25 @@ BrotliDecoderResult BrotliDecoderDecompressStream(
         if (result != BROTLI_DECODER_SUCCESS) {
           break;
         }
+        if (s->num_block_types[0] > 1) {
+          allocation_success &= BrotliDecoderLiteralTreeGroupInit(
+              s, &s->literal_hgroup, s->num_literal_htrees);
+        } else {
+          /* The only block type uses all trees right away. */
+          allocation_success &= BrotliDecoderHuffmanTreeGroupInit(
+              s, &s->literal_hgroup, BROTLI_DECODER_BUFFER_LITERAL_GROUP,
+              BROTLI_NUM_LITERAL_SYMBOLS, BROTLI_NUM_LITERAL_SYMBOLS,
+              s->num_literal_htrees);
+          s->literal_types_ready[0] = 1;
+        }
         allocation_success &= BrotliDecoderHuffmanTreeGroupInit(
-            s, &s->literal_hgroup, BROTLI_NUM_LITERAL_SYMBOLS,
-            BROTLI_NUM_LITERAL_SYMBOLS, s->num_literal_htrees);
-        allocation_success &= BrotliDecoderHuffmanTreeGroupInit(
-            s, &s->insert_copy_hgroup, BROTLI_NUM_COMMAND_SYMBOLS,
-            BROTLI_NUM_COMMAND_SYMBOLS, s->num_block_types[1]);
+            s, &s->insert_copy_hgroup, BROTLI_DECODER_BUFFER_COMMAND_GROUP,
+            BROTLI_NUM_COMMAND_SYMBOLS, BROTLI_NUM_COMMAND_SYMBOLS,
+            s->num_block_types[1]);
         allocation_success &= BrotliDecoderHuffmanTreeGroupInit(
-            s, &s->distance_hgroup, distance_alphabet_size_max,
-            distance_alphabet_size_limit, s->num_dist_htrees);
+            s, &s->distance_hgroup, BROTLI_DECODER_BUFFER_DISTANCE_GROUP,
+            distance_alphabet_size_max, distance_alphabet_size_limit,
+            s->num_dist_htrees);
         if (!allocation_success) {
           return SaveErrorCode(s,
               BROTLI_FAILURE(BROTLI_DECODER_ERROR_ALLOC_TREE_GROUPS));
@@ -2508,6 +3293,10 @@ BrotliDecoderResult BrotliDecoderDecompressStream(
 
       case BROTLI_STATE_BEFORE_COMPRESSED_METABLOCK_BODY:
         PrepareLiteralDecoding(s);
+        if (!s->literal_htree) {
+          result = BROTLI_FAILURE(BROTLI_DECODER_ERROR_ALLOC_TREE_GROUPS);
+          break;
+        }
         s->dist_context_map_slice = s->dist_context_map;
         s->htree_command = s->insert_copy_hgroup.htrees[0];
         if (!BrotliEnsureRingBuffer(s)) {
@@ -2546,6 +3335,11 @@ BrotliDecoderResult BrotliDecoderDecompressStream(
           s->max_distance = s->max_backward_distance;
         }
         if (s->state == BROTLI_STATE_COMMAND_POST_WRITE_1) {
+          BrotliDecoderCompoundDictionary* addon = s->compound_dictionary;
+          if (addon && (addon->br_length != addon->br_copied)) {
+            s->pos += CopyFromCompoundDictionary(s, s->pos);
+            if (s->pos >= s->ringbuffer_size) continue;
+          }
           if (s->meta_block_remaining_len == 0) {
             /* Next metablock, if any. */
             s->state = BROTLI_STATE_METABLOCK_DONE;
@@ -2573,6 +3367,12 @@ BrotliDecoderResult BrotliDecoderDecompressStream(
           result = BROTLI_FAILURE(BROTLI_DECODER_ERROR_FORMAT_BLOCK_LENGTH_2);
           break;
         }
+        if (BROTLI_PREDICT_FALSE(s->eager_output) && s->ringbuffer != 0) {
+          /* Otherwise ring-buffer is filled before output is requested. */
+          result = WriteRingBuffer(
+              s, available_out, next_out, total_out, BROTLI_TRUE);
+          if (result != BROTLI_DECODER_SUCCESS) break;
+        }
         BrotliDecoderStateCleanupAfterMetablock(s);
         if (!s->is_last_metablock) {
           s->state = BROTLI_STATE_METABLOCK_BEGIN;
@@ -2598,9 +3398,11 @@ BrotliDecoderResult BrotliDecoderDecompressStream(
             break;
           }
         }
+        s->total_in = s->input_end - *available_in;
         return SaveErrorCode(s, result);
     }
   }
+  s->total_in = s->input_end - *available_in;
   return SaveErrorCode(s, result);
 }
 
@@ -2638,6 +3440,12 @@ const uint8_t* BrotliDecoderTakeOutput(BrotliDecoderState* s, size_t* size) {
   return result;
 }
 
+void BrotliDecoderGetHuffmanCacheStats(
+    const BrotliDecoderState* s, uint64_t* hits, uint64_t* misses) {
+  *hits = s->huffman_cache ? s->huffman_cache->hits : 0;
+  *misses = s->huffman_cache ? s->huffman_cache->misses : 0;
+}
+
 BROTLI_BOOL BrotliDecoderIsUsed(const BrotliDecoderState* s) {
   return TO_BROTLI_BOOL(s->state != BROTLI_STATE_UNINITED ||
       BrotliGetAvailableBits(&s->br) != 0);
@@ -2664,6 +3472,261 @@ const char* BrotliDecoderErrorString(BrotliDecoderErrorCode c) {
   }
 }
 
+static uint64_t LoadChunkIndexNumber(const uint8_t* p, size_t size) {
+  uint64_t value = 0;
+  while (size-- != 0) value = (value << 8) | p[size];
+  return value;
+}
+
+/* Index header holds compressed and uncompressed size of chunked data;
+   entry holds compressed and uncompressed offset of chunk. Chunk ends where
+   the next one starts, the last one ends at the sizes from header. */
+#define CHUNK_INDEX_ENTRY(P, I) \
+  ((P) + BROTLI_CHUNK_INDEX_HEADER_SIZE + (I) * BROTLI_CHUNK_INDEX_ENTRY_SIZE)
+
+/* Checks that chunk |index| starts before the next one, ends within sizes
+   from header and, if it is the first one, starts at the start of the
+   stream. Empty last chunk is allowed, as stream could end right after
+   a chunk boundary. */
+static BROTLI_BOOL IsChunkValid(const uint8_t* payload, size_t num_chunks,
+    size_t index) {
+  const uint8_t* entry = CHUNK_INDEX_ENTRY(payload, index);
+  uint64_t compressed_offset = LoadChunkIndexNumber(entry, 8);
+  uint64_t uncompressed_offset = LoadChunkIndexNumber(entry + 8, 8);
+  uint64_t compressed_size = LoadChunkIndexNumber(payload + 20, 8);
+  uint64_t uncompressed_size = LoadChunkIndexNumber(payload + 12, 8);
+  uint64_t compressed_end = compressed_size;
+  uint64_t uncompressed_end = uncompressed_size;
+  if (index == 0 && (compressed_offset != 0 || uncompressed_offset != 0)) {
+    return BROTLI_FALSE;
+  }
+  if (index + 1 != num_chunks) {
+    entry += BROTLI_CHUNK_INDEX_ENTRY_SIZE;
+    compressed_end = LoadChunkIndexNumber(entry, 8);
+    uncompressed_end = LoadChunkIndexNumber(entry + 8, 8);
+    if (compressed_end <= compressed_offset ||
+        uncompressed_end <= uncompressed_offset) {
+      return BROTLI_FALSE;
+    }
+  }
+  return TO_BROTLI_BOOL(compressed_offset <= compressed_end &&
+      compressed_end <= compressed_size &&
+      uncompressed_offset <= uncompressed_end &&
+      uncompressed_end <= uncompressed_size);
+}
+
+/* Returns the payload of the chunk index that ends the stream, or NULL if
+   there is no valid one. Entries are not checked, see IsChunkValid. */
+static const uint8_t* FindChunkIndex(size_t encoded_size,
+    const uint8_t* encoded, size_t* num_chunks) {
+  const uint8_t* footer;
+  const uint8_t* payload;
+  size_t payload_size;
+  size_t n;
+  uint64_t uncompressed_size;
+  if (encoded_size < BROTLI_CHUNK_INDEX_HEADER_SIZE +
+      BROTLI_CHUNK_INDEX_FOOTER_SIZE + 1) {
+    return NULL;
+  }
+  /* Index is followed only by an empty last meta-block. */
+  if (encoded[encoded_size - 1] != 3) return NULL;
+  footer = encoded + encoded_size - 1 - BROTLI_CHUNK_INDEX_FOOTER_SIZE;
+  if (LoadChunkIndexNumber(footer + 4, 4) != BROTLI_CHUNK_INDEX_MAGIC) {
+    return NULL;
+  }
+  payload_size = (size_t)LoadChunkIndexNumber(footer, 4);
+  if (payload_size < BROTLI_CHUNK_INDEX_HEADER_SIZE +
+      BROTLI_CHUNK_INDEX_FOOTER_SIZE || payload_size > encoded_size - 1) {
+    return NULL;
+  }
+  payload = encoded + encoded_size - 1 - payload_size;
+  if (LoadChunkIndexNumber(payload, 4) != BROTLI_CHUNK_INDEX_MAGIC ||
+      payload[4] != BROTLI_CHUNK_INDEX_VERSION) {
+    return NULL;
+  }
+  n = (size_t)LoadChunkIndexNumber(payload + 8, 4);
+  if (n == 0 || n > BROTLI_CHUNK_INDEX_MAX_CHUNKS ||
+      payload_size != BROTLI_CHUNK_INDEX_HEADER_SIZE +
+          n * BROTLI_CHUNK_INDEX_ENTRY_SIZE + BROTLI_CHUNK_INDEX_FOOTER_SIZE) {
+    return NULL;
+  }
+  /* Chunks precede the index, and decoded data fits into memory. */
+  uncompressed_size = LoadChunkIndexNumber(payload + 12, 8);
+  if (LoadChunkIndexNumber(payload + 20, 8) > (uint64_t)(payload - encoded) ||
+      (size_t)uncompressed_size != uncompressed_size) {
+    return NULL;
+  }
+  *num_chunks = n;
+  return payload;
+}
+
+size_t BrotliDecoderGetChunkCount(size_t encoded_size,
+    const uint8_t* encoded) {
+  size_t num_chunks = 0;
+  const uint8_t* payload =
+      FindChunkIndex(encoded_size, encoded, &num_chunks);
+  size_t i;
+  if (!payload) return 0;
+  /* Whole index is checked once here, so that chunks of a consistent index
+     are disjoint; BrotliDecoderGetChunk only checks the requested one. */
+  for (i = 0; i < num_chunks; ++i) {
+    if (!IsChunkValid(payload, num_chunks, i)) return 0;
+  }
+  return num_chunks;
+}
+
+BROTLI_BOOL BrotliDecoderGetChunk(size_t encoded_size,
+    const uint8_t* encoded, size_t index, BrotliDecoderChunk* chunk) {
+  size_t num_chunks = 0;
+  const uint8_t* payload =
+      FindChunkIndex(encoded_size, encoded, &num_chunks);
+  const uint8_t* entry;
+  const uint8_t* end;
+  uint64_t compressed_offset;
+  uint64_t uncompressed_offset;
+  uint64_t compressed_end;
+  uint64_t uncompressed_end;
+  int i;
+  if (!payload || index >= num_chunks ||
+      !IsChunkValid(payload, num_chunks, index)) {
+    return BROTLI_FALSE;
+  }
+  entry = CHUNK_INDEX_ENTRY(payload, index);
+  compressed_offset = LoadChunkIndexNumber(entry, 8);
+  uncompressed_offset = LoadChunkIndexNumber(entry + 8, 8);
+  if (index + 1 < num_chunks) {
+    end = entry + BROTLI_CHUNK_INDEX_ENTRY_SIZE;
+  } else {
+    /* Ends of the last chunk are kept in the index header. */
+    end = payload + 20;
+  }
+  compressed_end = LoadChunkIndexNumber(end, 8);
+  uncompressed_end = LoadChunkIndexNumber(end == payload + 20 ? payload + 12 :
+      end + 8, 8);
+  chunk->compressed_offset = (size_t)compressed_offset;
+  chunk->compressed_size = (size_t)(compressed_end - compressed_offset);
+  chunk->uncompressed_offset = (size_t)uncompressed_offset;
+  chunk->uncompressed_size = (size_t)(uncompressed_end - uncompressed_offset);
+  chunk->window_bits = payload[5] & 0x7F;
+  chunk->large_window = TO_BROTLI_BOOL(payload[5] & 0x80);
+  for (i = 0; i < 4; ++i) {
+    uint64_t distance = LoadChunkIndexNumber(entry + 16 + 4 * i, 4);
+    if (distance > BROTLI_MAX_ALLOWED_DISTANCE) return BROTLI_FALSE;
+    chunk->distances[i] = (int)distance;
+  }
+  chunk->context[0] = entry[32];
+  chunk->context[1] = entry[33];
+  return BROTLI_TRUE;
+}
+
+BROTLI_BOOL BrotliDecoderStartChunk(
+    BrotliDecoderState* s, const BrotliDecoderChunk* chunk) {
+  /* Regular streams have 10..24 window bits. */
+  const int max_window_bits =
+      chunk->large_window ? BROTLI_LARGE_MAX_WBITS : 24;
+  int max_backward_distance;
+  int i;
+  if (BrotliDecoderIsUsed(s)) return BROTLI_FALSE;
+  if (chunk->window_bits < BROTLI_LARGE_MIN_WBITS ||
+      chunk->window_bits > max_window_bits) {
+    return BROTLI_FALSE;
+  }
+  if (chunk->large_window && !s->large_window) return BROTLI_FALSE;
+  for (i = 0; i < 4; ++i) {
+    if (chunk->distances[i] <= 0 ||
+        chunk->distances[i] > BROTLI_MAX_ALLOWED_DISTANCE) {
+      return BROTLI_FALSE;
+    }
+  }
+  /* The first chunk starts with the stream header. */
+  if (chunk->compressed_offset == 0) return BROTLI_TRUE;
+
+  s->large_window = chunk->large_window;
+  s->window_bits = (uint32_t)chunk->window_bits;
+  s->state = BROTLI_STATE_INITIALIZE;
+  max_backward_distance = (1 << chunk->window_bits) - BROTLI_WINDOW_GAP;
+  s->chunk_offset = chunk->uncompressed_offset < (size_t)max_backward_distance ?
+      (int)chunk->uncompressed_offset : max_backward_distance;
+  /* |dist_rb_idx| is 0, thus the last distance is in the last slot. */
+  for (i = 0; i < 4; ++i) s->dist_rb[3 - i] = chunk->distances[i];
+  s->chunk_context[0] = chunk->context[0];
+  s->chunk_context[1] = chunk->context[1];
+  return BROTLI_TRUE;
+}
+
+BROTLI_BOOL BrotliDecoderSeek(BrotliDecoderState* s, size_t encoded_size,
+    const uint8_t* encoded, size_t offset, size_t* input_offset) {
+  size_t num_chunks = BrotliDecoderGetChunkCount(encoded_size, encoded);
+  size_t lo = 0;
+  size_t hi = num_chunks;
+  BrotliDecoderChunk chunk;
+  if (num_chunks == 0) return BROTLI_FALSE;
+  /* Find the last chunk that starts at or before the offset. */
+  while (hi - lo > 1) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (!BrotliDecoderGetChunk(encoded_size, encoded, mid, &chunk)) {
+      return BROTLI_FALSE;
+    }
+    if (chunk.uncompressed_offset <= offset) {
+      lo = mid;
+    } else {
+      hi = mid;
+    }
+  }
+  if (!BrotliDecoderGetChunk(encoded_size, encoded, lo, &chunk) ||
+      offset - chunk.uncompressed_offset > chunk.uncompressed_size) {
+    return BROTLI_FALSE;
+  }
+  BrotliDecoderStateReset(s);
+  if (!BrotliDecoderStartChunk(s, &chunk)) return BROTLI_FALSE;
+  s->output_skip = offset - chunk.uncompressed_offset;
+  s->eager_output = 1;
+  *input_offset = chunk.compressed_offset;
+  return BROTLI_TRUE;
+}
+
+BrotliDecoderResult BrotliDecoderDecompressRange(size_t encoded_size,
+    const uint8_t* encoded_buffer, size_t offset, size_t* decoded_size,
+    uint8_t* decoded_buffer) {
+  BrotliDecoderState s;
+  BrotliDecoderResult result;
+  size_t input_offset;
+  size_t available_in;
+  const uint8_t* next_in;
+  size_t available_out = *decoded_size;
+  uint8_t* next_out = decoded_buffer;
+  *decoded_size = 0;
+  s.save_info_for_recompression = 0;
+  if (!BrotliDecoderStateInit(&s, 0, 0, 0)) {
+    return BROTLI_DECODER_RESULT_ERROR;
+  }
+  s.large_window = BROTLI_TRUE;
+  if (!BrotliDecoderSeek(&s, encoded_size, encoded_buffer, offset,
+      &input_offset)) {
+    BrotliDecoderStateCleanup(&s);
+    return BROTLI_DECODER_RESULT_ERROR;
+  }
+  if (available_out == 0) {
+    BrotliDecoderStateCleanup(&s);
+    return BROTLI_DECODER_RESULT_SUCCESS;
+  }
+  available_in = encoded_size - input_offset;
+  next_in = encoded_buffer + input_offset;
+  result = BrotliDecoderDecompressStream(
+      &s, &available_in, &next_in, &available_out, &next_out, NULL);
+  *decoded_size = (size_t)(next_out - decoded_buffer);
+  BrotliDecoderStateCleanup(&s);
+  /* Decoding stops as soon as the range is filled. */
+  if (result == BROTLI_DECODER_RESULT_NEEDS_MORE_OUTPUT &&
+      available_out == 0) {
+    result = BROTLI_DECODER_RESULT_SUCCESS;
+  }
+  if (result != BROTLI_DECODER_RESULT_SUCCESS) {
+    result = BROTLI_DECODER_RESULT_ERROR;
+  }
+  return result;
+}
+
 uint32_t BrotliDecoderVersion() {
   return BROTLI_VERSION;
 }
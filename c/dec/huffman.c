@@ -334,6 +334,63 @@ uint32_t BrotliBuildSimpleHuffmanTable(HuffmanCode* table,
   return goal_size;
 }
 
+/* Decodes the symbol which code is in the lowest |num_bits| of |key|.
+   Returns code length, or 0xFF if the code is longer than |num_bits|. */
+static uint32_t DecodeMultiTableSymbol(const HuffmanCode* table,
+    int root_bits, uint32_t key, uint32_t num_bits, uint32_t* symbol) {
+  uint32_t length;
+  BROTLI_HC_MARK_TABLE_FOR_FAST_LOAD(table);
+  BROTLI_HC_ADJUST_TABLE_INDEX(table, key & ((1u << root_bits) - 1));
+  length = BROTLI_HC_FAST_LOAD_BITS(table);
+  if (length > (uint32_t)root_bits) {
+    uint32_t sub_bits = length - (uint32_t)root_bits;
+    if (length > num_bits) return 0xFF;
+    BROTLI_HC_ADJUST_TABLE_INDEX(table, BROTLI_HC_FAST_LOAD_VALUE(table) +
+        ((key >> root_bits) & ((1u << sub_bits) - 1)));
+    length = (uint32_t)root_bits + BROTLI_HC_FAST_LOAD_BITS(table);
+  }
+  if (length > num_bits) return 0xFF;
+  *symbol = BROTLI_HC_FAST_LOAD_VALUE(table);
+  return length;
+}
+
+BROTLI_BOOL BrotliBuildHuffmanMultiTable(HuffmanMultiCode* multi_table,
+    const HuffmanCode* root_table, int root_bits) {
+  const uint32_t kNumBits = BROTLI_HUFFMAN_MULTI_TABLE_BITS;
+  uint32_t key;
+  uint32_t num_pairs = 0;
+  /* First pass: single literal entries. */
+  for (key = 0; key < BROTLI_HUFFMAN_MULTI_TABLE_SIZE; ++key) {
+    uint32_t symbol;
+    uint32_t bits = DecodeMultiTableSymbol(
+        root_table, root_bits, key, kNumBits, &symbol);
+    multi_table[key] = (bits == 0xFF) ? 0 :
+        symbol | (bits << 16) | (bits << 20) | (1u << 24);
+  }
+  /* Second pass: second literal is decoded from the remaining bits, i.e.
+     from the single literal entry of a smaller key; going downwards keeps
+     those entries intact. */
+  key = BROTLI_HUFFMAN_MULTI_TABLE_SIZE;
+  while (key-- != 0) {
+    HuffmanMultiCode first = multi_table[key];
+    HuffmanMultiCode second;
+    uint32_t first_bits = BROTLI_HMC_FIRST_BITS(first);
+    if (BROTLI_HMC_COUNT(first) == 0) continue;
+    second = multi_table[key >> first_bits];
+    if (BROTLI_HMC_COUNT(second) == 0 ||
+        first_bits + BROTLI_HMC_FIRST_BITS(second) > kNumBits) {
+      continue;
+    }
+    num_pairs++;
+    multi_table[key] = (first & 0xFF) | ((second & 0xFF) << 8) |
+        (first_bits << 16) |
+        ((first_bits + BROTLI_HMC_FIRST_BITS(second)) << 20) | (2u << 24);
+  }
+  /* Keys are uniformly distributed bit strings, so this is the probability
+     to decode a pair of literals per lookup. */
+  return TO_BROTLI_BOOL(2 * num_pairs >= BROTLI_HUFFMAN_MULTI_TABLE_SIZE);
+}
+
 #if defined(__cplusplus) || defined(c_plusplus)
 }  /* extern "C" */
 #endif
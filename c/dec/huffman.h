@@ -110,6 +110,27 @@ BROTLI_INTERNAL uint32_t BrotliBuildHuffmanTable(HuffmanCode* root_table,
 BROTLI_INTERNAL uint32_t BrotliBuildSimpleHuffmanTable(HuffmanCode* table,
     int root_bits, uint16_t* symbols, uint32_t num_symbols);
 
+/* Multi-symbol lookup table for literal trees with short codes. Entry is
+   indexed by the next BROTLI_HUFFMAN_MULTI_TABLE_BITS bits of input and
+   decodes up to 2 literals at once: bits 0..15 hold literals (first one in
+   the lowest byte), bits 16..19 hold code length of the first literal, bits
+   20..23 hold total code length, bits 24..25 hold number of literals;
+   0 literals means that the first code is longer than the table key. */
+#define BROTLI_HUFFMAN_MULTI_TABLE_BITS 11
+#define BROTLI_HUFFMAN_MULTI_TABLE_SIZE (1u << BROTLI_HUFFMAN_MULTI_TABLE_BITS)
+typedef uint32_t HuffmanMultiCode;
+
+#define BROTLI_HMC_FIRST_BITS(E) (((E) >> 16) & 0xF)
+#define BROTLI_HMC_BITS(E) (((E) >> 20) & 0xF)
+#define BROTLI_HMC_COUNT(E) ((E) >> 24)
+
+/* Builds multi-symbol table from Huffman lookup table of 8-bit alphabet.
+   Returns BROTLI_FALSE if the tree does not qualify, i.e. less than half of
+   lookups would decode more than one literal. */
+BROTLI_INTERNAL BROTLI_BOOL BrotliBuildHuffmanMultiTable(
+    HuffmanMultiCode* multi_table, const HuffmanCode* root_table,
+    int root_bits);
+
 /* Contains a collection of Huffman trees with the same alphabet size. */
 /* alphabet_size_limit is needed due to simple codes, since
    log2(alphabet_size_max) could be greater than log2(alphabet_size_limit). */
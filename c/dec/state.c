@@ -7,6 +7,7 @@
 #include "./state.h"
 
 #include <stdlib.h>  /* free, malloc */
+#include <string.h>  /* memset */
 
 #include <brotli/types.h>
 #include "./huffman.h"
@@ -15,23 +16,13 @@
 extern "C" {
 #endif
 
-BROTLI_BOOL BrotliDecoderStateInit(BrotliDecoderState* s,
-    brotli_alloc_func alloc_func, brotli_free_func free_func, void* opaque) {
-  if (!alloc_func) {
-    s->alloc_func = BrotliDefaultAllocFunc;
-    s->free_func = BrotliDefaultFreeFunc;
-    s->memory_manager_opaque = 0;
-  } else {
-    s->alloc_func = alloc_func;
-    s->free_func = free_func;
-    s->memory_manager_opaque = opaque;
-  }
-
+/* Sets stream-related fields to the initial values; parameters, dictionaries
+   and owned memory are not touched. */
+static void BrotliDecoderStateInitStream(BrotliDecoderState* s) {
   s->error_code = 0; /* BROTLI_DECODER_NO_ERROR */
 
   BrotliInitBitReader(&s->br);
   s->state = BROTLI_STATE_UNINITED;
-  s->large_window = 0;
   s->substate_metablock_header = BROTLI_STATE_METABLOCK_HEADER_NONE;
   s->substate_uncompressed = BROTLI_STATE_UNCOMPRESSED_NONE;
   s->substate_decode_uint8 = BROTLI_STATE_DECODE_UINT8_NONE;
@@ -42,35 +33,13 @@ BROTLI_BOOL BrotliDecoderStateInit(BrotliDecoderState* s,
   s->pos = 0;
   s->rb_roundtrips = 0;
   s->partial_pos_out = 0;
-
-  s->commands = NULL;
-  s->commands_size = 0;
-  if (s->save_info_for_recompression) {
-    s->literals_block_splits.types = (uint8_t*)BROTLI_DECODER_ALLOC(s, sizeof(uint8_t) * 20000);
-    s->literals_block_splits.positions_begin = (uint32_t*)BROTLI_DECODER_ALLOC(s, sizeof(uint32_t) * 20000);
-    s->literals_block_splits.positions_end = (uint32_t*)BROTLI_DECODER_ALLOC(s, sizeof(uint32_t) * 20000);
-    s->literals_block_splits.num_types = 0;
-    s->literals_block_splits.num_types_prev_metablocks = 0;
-    s->literals_block_splits.num_blocks = 0;
-    s->literals_block_splits.types_alloc_size = 20000;
-    s->literals_block_splits.positions_alloc_size = 20000;
-
-    s->insert_copy_length_block_splits.types = (uint8_t*)BROTLI_DECODER_ALLOC(s, sizeof(uint8_t) * 20000);
-    s->insert_copy_length_block_splits.positions_begin = (uint32_t*)BROTLI_DECODER_ALLOC(s, sizeof(uint32_t) * 20000);
-    s->insert_copy_length_block_splits.positions_end = (uint32_t*)BROTLI_DECODER_ALLOC(s, sizeof(uint32_t) * 20000);
-    s->insert_copy_length_block_splits.num_types = 0;
-    s->insert_copy_length_block_splits.num_types_prev_metablocks = 0;
-    s->insert_copy_length_block_splits.num_blocks = 0;
-    s->insert_copy_length_block_splits.types_alloc_size = 20000;
-    s->insert_copy_length_block_splits.positions_alloc_size = 20000;
-  }
-
+  s->total_in = 0;
+  s->input_end = 0;
+  s->memory_limit_hit = 0;
 
   s->saved_position_literals_begin = BROTLI_FALSE;
   s->saved_position_lengths_begin = BROTLI_FALSE;
 
-  s->block_type_trees = NULL;
-  s->block_len_trees = NULL;
   s->ringbuffer = NULL;
   s->ringbuffer_size = 0;
   s->new_ringbuffer_size = 0;
@@ -81,6 +50,9 @@ BROTLI_BOOL BrotliDecoderStateInit(BrotliDecoderState* s,
   s->dist_context_map = NULL;
   s->context_map_slice = NULL;
   s->dist_context_map_slice = NULL;
+  s->literal_multi_tables = NULL;
+  s->literal_codes = NULL;
+  s->literal_table_chunks = NULL;
 
   s->literal_hgroup.codes = NULL;
   s->literal_hgroup.htrees = NULL;
@@ -93,7 +65,7 @@ BROTLI_BOOL BrotliDecoderStateInit(BrotliDecoderState* s,
   s->is_uncompressed = 0;
   s->is_metadata = 0;
   s->should_wrap_ringbuffer = 0;
-  s->canny_ringbuffer_allocation = 1;
+  s->eager_output = 0;
 
   s->window_bits = 0;
   s->max_distance = 0;
@@ -102,13 +74,86 @@ BROTLI_BOOL BrotliDecoderStateInit(BrotliDecoderState* s,
   s->dist_rb[2] = 11;
   s->dist_rb[3] = 4;
   s->dist_rb_idx = 0;
-  s->block_type_trees = NULL;
-  s->block_len_trees = NULL;
+
+  s->chunk_offset = 0;
+  s->chunk_context[0] = 0;
+  s->chunk_context[1] = 0;
+  s->output_skip = 0;
+  s->output_skipped = 0;
 
   s->mtf_upper_bound = 63;
+}
+
+static void InitBlockSplit(BrotliDecoderState* s,
+    BlockSplitFromDecoder* split) {
+  split->types = (uint8_t*)BROTLI_DECODER_ALLOC(s, sizeof(uint8_t) * 20000);
+  split->positions_begin =
+      (uint32_t*)BROTLI_DECODER_ALLOC(s, sizeof(uint32_t) * 20000);
+  split->positions_end =
+      (uint32_t*)BROTLI_DECODER_ALLOC(s, sizeof(uint32_t) * 20000);
+  split->num_types = 0;
+  split->num_types_prev_metablocks = 0;
+  split->num_blocks = 0;
+  split->types_alloc_size = 20000;
+  split->positions_alloc_size = 20000;
+}
+
+static void FreeBlockSplit(BrotliDecoderState* s,
+    BlockSplitFromDecoder* split) {
+  BROTLI_DECODER_FREE(s, split->types);
+  BROTLI_DECODER_FREE(s, split->positions_begin);
+  BROTLI_DECODER_FREE(s, split->positions_end);
+}
+
+void BrotliDecoderStateInitBlockSplits(BrotliDecoderState* s) {
+  if (s->literals_block_splits.types) return;
+  InitBlockSplit(s, &s->literals_block_splits);
+  InitBlockSplit(s, &s->insert_copy_length_block_splits);
+}
+
+BROTLI_BOOL BrotliDecoderStateInit(BrotliDecoderState* s,
+    brotli_alloc_func alloc_func, brotli_free_func free_func, void* opaque) {
+  if (!alloc_func) {
+    s->alloc_func = BrotliDefaultAllocFunc;
+    s->free_func = BrotliDefaultFreeFunc;
+    s->memory_manager_opaque = 0;
+  } else {
+    s->alloc_func = alloc_func;
+    s->free_func = free_func;
+    s->memory_manager_opaque = opaque;
+  }
+
+  BrotliDecoderStateInitStream(s);
+  s->large_window = 0;
+  s->canny_ringbuffer_allocation = 1;
+  s->max_memory = 0;
+  s->memory_usage = 0;
+  s->max_output_ratio = 0;
+
+  s->commands = NULL;
+  s->commands_size = 0;
+  memset(&s->literals_block_splits, 0, sizeof(BlockSplitFromDecoder));
+  memset(&s->insert_copy_length_block_splits, 0,
+      sizeof(BlockSplitFromDecoder));
+  if (s->save_info_for_recompression) BrotliDecoderStateInitBlockSplits(s);
+
+  s->block_type_trees = NULL;
+  s->block_len_trees = NULL;
+  s->ringbuffer_capacity = 0;
+  s->kept_ringbuffer = NULL;
+  s->output_ringbuffer = NULL;
+  s->output_ringbuffer_size = 0;
+  s->huffman_cache = NULL;
+  s->huffman_cache_size = 0;
+  s->word_cache = NULL;
+  s->word_cache_size = 0;
+  s->word_cache_entries = 0;
+  memset(s->buffers, 0, sizeof(s->buffers));
+  memset(s->buffer_sizes, 0, sizeof(s->buffer_sizes));
 
   s->dictionary = BrotliGetDictionary();
   s->transforms = BrotliGetTransforms();
+  s->compound_dictionary = NULL;
 
   return BROTLI_TRUE;
 }
@@ -132,6 +177,12 @@ void BrotliDecoderStateMetablockBegin(BrotliDecoderState* s) {
   s->dist_context_map = NULL;
   s->context_map_slice = NULL;
   s->literal_htree = NULL;
+  s->literal_multi_table = NULL;
+  s->literal_multi_tables = NULL;
+  if (s->huffman_cache) s->huffman_cache->clock++;
+  memset(s->literal_multi_tried, 0, sizeof(s->literal_multi_tried));
+  s->literal_codes = NULL;
+  memset(s->literal_types_ready, 0, sizeof(s->literal_types_ready));
   s->dist_context_map_slice = NULL;
   s->dist_htree_index = 0;
   s->context_lookup = NULL;
@@ -155,12 +206,33 @@ void BrotliDecoderStateMetablockBegin(BrotliDecoderState* s) {
 }
 
 void BrotliDecoderStateCleanupAfterMetablock(BrotliDecoderState* s) {
-  BROTLI_DECODER_FREE(s, s->context_modes);
-  BROTLI_DECODER_FREE(s, s->context_map);
-  BROTLI_DECODER_FREE(s, s->dist_context_map);
-  BROTLI_DECODER_FREE(s, s->literal_hgroup.htrees);
-  BROTLI_DECODER_FREE(s, s->insert_copy_hgroup.htrees);
-  BROTLI_DECODER_FREE(s, s->distance_hgroup.htrees);
+  /* Context maps and tree groups are owned by |buffers|. */
+  s->context_modes = NULL;
+  s->context_map = NULL;
+  s->dist_context_map = NULL;
+  /* The last chunk and |literal_codes| share allocation with |htrees|. */
+  while (s->literal_table_chunks && s->literal_table_chunks->next) {
+    BrotliDecoderTableChunk* next = s->literal_table_chunks->next;
+    BrotliDecoderFreeCounted(s, s->literal_table_chunks,
+        sizeof(BrotliDecoderTableChunk) +
+            sizeof(HuffmanCode) * s->literal_table_chunks->capacity);
+    s->literal_table_chunks = next;
+  }
+  s->literal_table_chunks = NULL;
+  s->literal_codes = NULL;
+  s->literal_hgroup.htrees = NULL;
+  if (s->literal_multi_tables) {
+    uint32_t i;
+    for (i = 0; i < s->num_literal_htrees; ++i) {
+      BrotliDecoderFreeCounted(s, s->literal_multi_tables[i],
+          sizeof(HuffmanMultiCode) * BROTLI_HUFFMAN_MULTI_TABLE_SIZE);
+    }
+    BrotliDecoderFreeCounted(s, s->literal_multi_tables,
+        sizeof(HuffmanMultiCode*) * s->num_literal_htrees);
+    s->literal_multi_tables = NULL;
+  }
+  s->insert_copy_hgroup.htrees = NULL;
+  s->distance_hgroup.htrees = NULL;
 
   /* If needed save the end of a last in metablock block */
   if (s->save_info_for_recompression) {
@@ -181,22 +253,99 @@ void BrotliDecoderStateCleanupAfterMetablock(BrotliDecoderState* s) {
 }
 
 void BrotliDecoderStateCleanup(BrotliDecoderState* s) {
+  int i;
   BrotliDecoderStateCleanupAfterMetablock(s);
 
+  for (i = 0; i < BROTLI_DECODER_NUM_BUFFERS; ++i) {
+    BROTLI_DECODER_FREE(s, s->buffers[i]);
+  }
   BROTLI_DECODER_FREE(s, s->ringbuffer);
+  BROTLI_DECODER_FREE(s, s->kept_ringbuffer);
   BROTLI_DECODER_FREE(s, s->block_type_trees);
+  BROTLI_DECODER_FREE(s, s->compound_dictionary);
+  BROTLI_DECODER_FREE(s, s->commands);
+  FreeBlockSplit(s, &s->literals_block_splits);
+  FreeBlockSplit(s, &s->insert_copy_length_block_splits);
+  BrotliDecoderFreeCounted(s, s->word_cache,
+      sizeof(BrotliDecoderWordCacheEntry) * s->word_cache_entries);
+  s->word_cache = NULL;
+  if (s->huffman_cache) {
+    uint32_t i;
+    for (i = 0; i < s->huffman_cache->num_entries; ++i) {
+      BROTLI_DECODER_FREE(s, s->huffman_cache->entries[i].table);
+    }
+    BROTLI_DECODER_FREE(s, s->huffman_cache);
+  }
+}
+
+void BrotliDecoderStateReset(BrotliDecoderState* s) {
+  BrotliDecoderStateCleanupAfterMetablock(s);
+  /* Ring-buffer is reused by BrotliEnsureRingBuffer if it is large enough;
+     contents of the previous stream are never referenced. */
+  if (s->ringbuffer) {
+    s->kept_ringbuffer = s->ringbuffer;
+  }
+  /* Attached dictionaries are kept, but not a copy from them in progress. */
+  if (s->compound_dictionary) {
+    s->compound_dictionary->br_length = 0;
+    s->compound_dictionary->br_copied = 0;
+  }
+  /* Size of command array depends on the input of the first call, so it is
+     allocated anew for the next stream. Block split arrays are reused. */
+  BROTLI_DECODER_FREE(s, s->commands);
+  s->commands_size = 0;
+  if (s->literals_block_splits.types) {
+    s->literals_block_splits.num_types = 0;
+    s->literals_block_splits.num_types_prev_metablocks = 0;
+    s->literals_block_splits.num_blocks = 0;
+    s->insert_copy_length_block_splits.num_types = 0;
+    s->insert_copy_length_block_splits.num_types_prev_metablocks = 0;
+    s->insert_copy_length_block_splits.num_blocks = 0;
+  }
+  BrotliDecoderStateInitStream(s);
+}
+
+void* BrotliDecoderAllocCounted(BrotliDecoderState* s, size_t size) {
+  void* p;
+  if (s->max_memory != 0 &&
+      (size > s->max_memory || s->memory_usage > s->max_memory - size)) {
+    s->memory_limit_hit = 1;
+    return NULL;
+  }
+  p = BROTLI_DECODER_ALLOC(s, size);
+  if (p) s->memory_usage += size;
+  return p;
+}
+
+void BrotliDecoderFreeCounted(BrotliDecoderState* s, void* p, size_t size) {
+  if (!p) return;
+  s->memory_usage -= size;
+  BROTLI_DECODER_FREE(s, p);
+}
+
+void* BrotliDecoderGetBuffer(BrotliDecoderState* s, BrotliDecoderBufferId id,
+    size_t size) {
+  if (s->buffer_sizes[id] < size) {
+    BrotliDecoderFreeCounted(s, s->buffers[id], s->buffer_sizes[id]);
+    s->buffer_sizes[id] = 0;
+    s->buffers[id] = BrotliDecoderAllocCounted(s, size);
+    if (!s->buffers[id]) return NULL;
+    s->buffer_sizes[id] = size;
+  }
+  return s->buffers[id];
 }
 
 BROTLI_BOOL BrotliDecoderHuffmanTreeGroupInit(BrotliDecoderState* s,
-    HuffmanTreeGroup* group, uint32_t alphabet_size_max,
-    uint32_t alphabet_size_limit, uint32_t ntrees) {
+    HuffmanTreeGroup* group, BrotliDecoderBufferId id,
+    uint32_t alphabet_size_max, uint32_t alphabet_size_limit,
+    uint32_t ntrees) {
   /* Pack two allocations into one */
   const size_t max_table_size =
       kMaxHuffmanTableSize[(alphabet_size_limit + 31) >> 5];
   const size_t code_size = sizeof(HuffmanCode) * ntrees * max_table_size;
   const size_t htree_size = sizeof(HuffmanCode*) * ntrees;
   /* Pointer alignment is, hopefully, wider than sizeof(HuffmanCode). */
-  HuffmanCode** p = (HuffmanCode**)BROTLI_DECODER_ALLOC(s,
+  HuffmanCode** p = (HuffmanCode**)BrotliDecoderGetBuffer(s, id,
       code_size + htree_size);
   group->alphabet_size_max = (uint16_t)alphabet_size_max;
   group->alphabet_size_limit = (uint16_t)alphabet_size_limit;
@@ -206,6 +355,34 @@ BROTLI_BOOL BrotliDecoderHuffmanTreeGroupInit(BrotliDecoderState* s,
   return !!p;
 }
 
+BROTLI_BOOL BrotliDecoderLiteralTreeGroupInit(BrotliDecoderState* s,
+    HuffmanTreeGroup* group, uint32_t ntrees) {
+  /* Trees are built on first use; allocate space for code lengths, and for
+     the first few tables. */
+  const uint32_t capacity = BROTLI_HUFFMAN_MAX_SIZE_258 *
+      BROTLI_MIN(uint32_t, ntrees, BROTLI_TABLE_CHUNK_MAX_TREES);
+  const size_t htree_size = sizeof(HuffmanCode*) * ntrees;
+  const size_t chunk_size =
+      sizeof(BrotliDecoderTableChunk) + sizeof(HuffmanCode) * capacity;
+  const size_t code_size = sizeof(uint16_t) * ntrees * BROTLI_LITERAL_CODE_SIZE;
+  HuffmanCode** p = (HuffmanCode**)BrotliDecoderGetBuffer(s,
+      BROTLI_DECODER_BUFFER_LITERAL_GROUP, htree_size + chunk_size + code_size);
+  BrotliDecoderTableChunk* chunk = (BrotliDecoderTableChunk*)(&p[ntrees]);
+  group->alphabet_size_max = BROTLI_NUM_LITERAL_SYMBOLS;
+  group->alphabet_size_limit = BROTLI_NUM_LITERAL_SYMBOLS;
+  group->num_htrees = (uint16_t)ntrees;
+  group->htrees = p;
+  group->codes = NULL;
+  if (!p) return BROTLI_FALSE;
+  memset(p, 0, htree_size);
+  chunk->next = NULL;
+  chunk->capacity = capacity;
+  chunk->used = 0;
+  s->literal_table_chunks = chunk;
+  s->literal_codes = (uint16_t*)((uint8_t*)chunk + chunk_size);
+  return BROTLI_TRUE;
+}
+
 #if defined(__cplusplus) || defined(c_plusplus)
 }  /* extern "C" */
 #endif
@@ -190,6 +190,106 @@ typedef enum {
   BROTLI_STATE_READ_BLOCK_LENGTH_SUFFIX
 } BrotliRunningReadBlockLengthState;
 
+/* Up to this many chunks could be attached to a single decoder. */
+#define BROTLI_MAX_COMPOUND_DICTS 15
+
+/* LZ77 prefix dictionary; chunks are owned by the caller. Logically chunks
+   are concatenated and placed right before the first byte of the stream. */
+typedef struct BrotliDecoderCompoundDictionary {
+  int num_chunks;
+  int total_size;
+  /* State of the current copy: chunk index, offset in chunk, copy length and
+     number of already copied bytes. */
+  int br_index;
+  int br_offset;
+  int br_length;
+  int br_copied;
+  const uint8_t* chunks[BROTLI_MAX_COMPOUND_DICTS];
+  int chunk_offsets[BROTLI_MAX_COMPOUND_DICTS + 1];
+} BrotliDecoderCompoundDictionary;
+
+/* Longest transformed static dictionary word: 5 prefix + 24 base + 8 suffix;
+   entries are padded for 16-byte copies. */
+#define BROTLI_WORD_CACHE_MAX_LENGTH 37
+#define BROTLI_WORD_CACHE_ENTRY_DATA_SIZE 48
+
+/* Static dictionary word with transform applied. Key packs transform index,
+   word index and word length; 0 for empty entry. */
+typedef struct BrotliDecoderWordCacheEntry {
+  uint32_t key;
+  uint32_t length;
+  uint8_t data[BROTLI_WORD_CACHE_ENTRY_DATA_SIZE];
+} BrotliDecoderWordCacheEntry;
+
+/* Key of complex prefix code: code length histogram (lengths 1..15) followed
+   by symbols sorted by code length. */
+#define BROTLI_HUFFMAN_CACHE_MAX_KEY_SIZE \
+  (BROTLI_HUFFMAN_MAX_CODE_LENGTH + BROTLI_NUM_COMMAND_SYMBOLS)
+/* Table size for the largest alphabet. */
+#define BROTLI_HUFFMAN_CACHE_MAX_TABLE_SIZE \
+  kMaxHuffmanTableSize[(BROTLI_NUM_COMMAND_SYMBOLS + 31) >> 5]
+
+/* Huffman table built for a current or previous metablock. */
+typedef struct BrotliDecoderHuffmanCacheEntry {
+  uint32_t hash;
+  /* Hash of the last code that missed this slot. */
+  uint32_t seen_hash;
+  /* Metablock that used the entry last. */
+  uint32_t last_use;
+  /* |key| shares allocation with |table|; NULL for empty entry. */
+  HuffmanCode* table;
+  uint16_t* key;
+} BrotliDecoderHuffmanCacheEntry;
+
+/* Tables of complex prefix codes that are reused across metablocks when
+   encoder repeats the same code lengths. Tree groups point to cached tables
+   directly, so entries used by the current metablock are not replaced. */
+typedef struct BrotliDecoderHuffmanCache {
+  uint32_t num_entries;
+  /* Current metablock. */
+  uint32_t clock;
+  uint64_t hits;
+  uint64_t misses;
+  BrotliDecoderHuffmanCacheEntry* entries;
+} BrotliDecoderHuffmanCache;
+
+/* Literal tree that is not built yet. Simple prefix code is stored as the
+   number of symbols (as in BrotliBuildSimpleHuffmanTable) followed by
+   symbols. Complex one is stored as BROTLI_LITERAL_CODE_COMPLEX followed by
+   code length histogram, tails of symbol chains and symbol chains, copied
+   from BrotliMetablockHeaderArena. */
+#define BROTLI_LITERAL_CODE_COMPLEX 0xFFFF
+#define BROTLI_LITERAL_CODE_HISTO 1
+#define BROTLI_LITERAL_CODE_TAILS \
+  (BROTLI_LITERAL_CODE_HISTO + BROTLI_HUFFMAN_MAX_CODE_LENGTH + 1)
+#define BROTLI_LITERAL_CODE_LISTS \
+  (BROTLI_LITERAL_CODE_TAILS + BROTLI_HUFFMAN_MAX_CODE_LENGTH + 1)
+#define BROTLI_LITERAL_CODE_SIZE (BROTLI_LITERAL_CODE_LISTS + \
+  BROTLI_HUFFMAN_MAX_CODE_LENGTH + 1 + BROTLI_NUM_LITERAL_SYMBOLS)
+
+/* Storage for literal tables built on first use. Tables are allocated
+   sequentially; the first chunk shares allocation with literal tree group,
+   the rest are allocated on demand. */
+typedef struct BrotliDecoderTableChunk {
+  struct BrotliDecoderTableChunk* next;
+  /* Sizes in HuffmanCode units; entries follow the header. */
+  uint32_t capacity;
+  uint32_t used;
+} BrotliDecoderTableChunk;
+#define BROTLI_TABLE_CHUNK_MAX_TREES 8
+
+/* Per-metablock buffers; state keeps them between metablocks and streams, see
+   BrotliDecoderGetBuffer. */
+typedef enum {
+  BROTLI_DECODER_BUFFER_CONTEXT_MODES,
+  BROTLI_DECODER_BUFFER_CONTEXT_MAP,
+  BROTLI_DECODER_BUFFER_DIST_CONTEXT_MAP,
+  BROTLI_DECODER_BUFFER_LITERAL_GROUP,
+  BROTLI_DECODER_BUFFER_COMMAND_GROUP,
+  BROTLI_DECODER_BUFFER_DISTANCE_GROUP,
+  BROTLI_DECODER_NUM_BUFFERS
+} BrotliDecoderBufferId;
+
 typedef struct BrotliMetablockHeaderArena {
   BrotliRunningTreeGroupState substate_tree_group;
   BrotliRunningContextMapState substate_context_map;
@@ -300,6 +400,8 @@ struct BrotliDecoderStateStruct {
   uint32_t num_dist_htrees;
   uint8_t* dist_context_map;
   HuffmanCode* literal_htree;
+  /* Multi-symbol table for |literal_htree|, or NULL. */
+  HuffmanMultiCode* literal_multi_table;
   uint8_t dist_htree_index;
 
   int copy_length;
@@ -328,10 +430,26 @@ struct BrotliDecoderStateStruct {
   unsigned int canny_ringbuffer_allocation : 1;
   unsigned int large_window : 1;
   unsigned int save_info_for_recompression : 1;
+  /* Set when allocation is refused because of |max_memory|. */
+  unsigned int memory_limit_hit : 1;
+  /* Set by BrotliDecoderSeek: output is pushed after every metablock, so that
+     decoding stops soon after the output buffer is full. */
+  unsigned int eager_output : 1;
   unsigned int size_nibbles : 8;
   uint32_t window_bits;
 
   int new_ringbuffer_size;
+  /* Allocated size of |ringbuffer| (without write-ahead slack); ring-buffer
+     grows in place while it fits. */
+  int ringbuffer_capacity;
+  /* Ring-buffer of the previous stream, see BrotliDecoderStateReset. */
+  uint8_t* kept_ringbuffer;
+
+  /* Caller output buffer used as ring-buffer by one-shot decoding, or NULL;
+     |output_ringbuffer_size| bytes of it are used as window, the rest is
+     write-ahead slack. */
+  uint8_t* output_ringbuffer;
+  int output_ringbuffer_size;
 
   uint32_t num_literal_htrees;
   uint8_t* context_map;
@@ -339,8 +457,58 @@ struct BrotliDecoderStateStruct {
 
   const BrotliDictionary* dictionary;
   const BrotliTransforms* transforms;
+  BrotliDecoderCompoundDictionary* compound_dictionary;
+  /* Allocated on first use if |huffman_cache_size| is not 0. */
+  BrotliDecoderHuffmanCache* huffman_cache;
+  uint32_t huffman_cache_size;
+
+  /* Direct-mapped cache of transformed dictionary words; allocated on first
+     use if |word_cache_size| is not 0. Words do not depend on the stream, so
+     it survives BrotliDecoderReset. |word_cache_entries| is the size it was
+     allocated with; cache is dropped when parameter changes. */
+  BrotliDecoderWordCacheEntry* word_cache;
+  uint32_t word_cache_size;
+  uint32_t word_cache_entries;
 
   uint32_t trivial_literal_contexts[8];  /* 256 bits */
+  /* Multi-symbol tables of literal trees, indexed by tree; NULL if not built
+     yet or the tree does not qualify. */
+  HuffmanMultiCode** literal_multi_tables;
+  uint32_t literal_multi_tried[8];  /* 256 bits */
+  /* Literal trees are built on first use by a block type, see
+     PrepareLiteralDecoding; |literal_codes| holds code lengths of trees, and
+     |literal_hgroup| holds NULL for trees that are not built yet. */
+  uint16_t* literal_codes;
+  BrotliDecoderTableChunk* literal_table_chunks;
+  uint32_t literal_types_ready[8];  /* 256 bits */
+
+  /* Limits set with BROTLI_DECODER_PARAM_MAX_MEMORY and
+     BROTLI_DECODER_PARAM_MAX_OUTPUT_RATIO; 0 means no limit. |memory_usage|
+     counts memory allocated with BrotliDecoderAllocCounted. */
+  size_t max_memory;
+  size_t memory_usage;
+  uint32_t max_output_ratio;
+  /* Input consumed by finished calls of BrotliDecoderDecompressStream, and
+     the value it would have if the current call consumed all input. */
+  size_t total_in;
+  size_t input_end;
+
+  /* Set by BrotliDecoderStartChunk: number of bytes that precede the chunk,
+     capped by |max_backward_distance|; they are not available, but shift the
+     base of dictionary references. |chunk_context| holds the last and the
+     one before last of them, used as literal context for the first bytes. */
+  int chunk_offset;
+  uint8_t chunk_context[2];
+  /* Set by BrotliDecoderSeek: number of decoded bytes to drop before output
+     reaches the requested offset. */
+  size_t output_skip;
+  /* Bytes dropped so far; they are not output, so they are not counted
+     against |max_output_ratio|. */
+  size_t output_skipped;
+
+  /* Owners of context maps and tree groups memory. */
+  void* buffers[BROTLI_DECODER_NUM_BUFFERS];
+  size_t buffer_sizes[BROTLI_DECODER_NUM_BUFFERS];
 
   union {
     BrotliMetablockHeaderArena header;
@@ -354,12 +522,23 @@ typedef struct BrotliDecoderStateStruct BrotliDecoderStateInternal;
 BROTLI_INTERNAL BROTLI_BOOL BrotliDecoderStateInit(BrotliDecoderState* s,
     brotli_alloc_func alloc_func, brotli_free_func free_func, void* opaque);
 BROTLI_INTERNAL void BrotliDecoderStateCleanup(BrotliDecoderState* s);
+BROTLI_INTERNAL void BrotliDecoderStateReset(BrotliDecoderState* s);
+BROTLI_INTERNAL void BrotliDecoderStateInitBlockSplits(
+    BrotliDecoderState* s);
 BROTLI_INTERNAL void BrotliDecoderStateMetablockBegin(BrotliDecoderState* s);
 BROTLI_INTERNAL void BrotliDecoderStateCleanupAfterMetablock(
     BrotliDecoderState* s);
+BROTLI_INTERNAL void* BrotliDecoderAllocCounted(BrotliDecoderState* s,
+    size_t size);
+BROTLI_INTERNAL void BrotliDecoderFreeCounted(BrotliDecoderState* s, void* p,
+    size_t size);
+BROTLI_INTERNAL void* BrotliDecoderGetBuffer(BrotliDecoderState* s,
+    BrotliDecoderBufferId id, size_t size);
 BROTLI_INTERNAL BROTLI_BOOL BrotliDecoderHuffmanTreeGroupInit(
-    BrotliDecoderState* s, HuffmanTreeGroup* group, uint32_t alphabet_size_max,
-    uint32_t alphabet_size_limit, uint32_t ntrees);
+    BrotliDecoderState* s, HuffmanTreeGroup* group, BrotliDecoderBufferId id,
+    uint32_t alphabet_size_max, uint32_t alphabet_size_limit, uint32_t ntrees);
+BROTLI_INTERNAL BROTLI_BOOL BrotliDecoderLiteralTreeGroupInit(
+    BrotliDecoderState* s, HuffmanTreeGroup* group, uint32_t ntrees);
 
 #define BROTLI_DECODER_ALLOC(S, L) S->alloc_func(S->memory_manager_opaque, L)
 
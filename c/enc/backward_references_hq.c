@@ -30,6 +30,9 @@ extern "C" {
 /* BrotliCalculateDistanceCodeLimit(BROTLI_MAX_ALLOWED_DISTANCE, 3, 120). */
 #define BROTLI_MAX_EFFECTIVE_DISTANCE_ALPHABET_SIZE 544
 
+/* Limit of custom dictionary matches per position. */
+#define MAX_COMPOUND_DICTIONARY_MATCHES 64
+
 static const float kInfinity = 1.7e38f;  /* ~= 2 ^ 127 */
 
 static const uint32_t kDistanceCacheIndex[] = {
@@ -49,6 +52,39 @@ void BrotliInitZopfliNodes(ZopfliNode* array, size_t length) {
   for (i = 0; i < length; ++i) array[i] = stub;
 }
 
+void BrotliInitZopfliWorkspace(ZopfliWorkspace* self) {
+  self->nodes = NULL;
+  self->nodes_size = 0;
+  self->literal_costs = NULL;
+  self->literal_costs_size = 0;
+  self->cost_dist = NULL;
+  self->cost_dist_size = 0;
+  self->num_matches = NULL;
+  self->num_matches_size = 0;
+  self->matches = NULL;
+  self->matches_size = 0;
+}
+
+void BrotliDestroyZopfliWorkspace(MemoryManager* m, ZopfliWorkspace* self) {
+  BROTLI_FREE(m, self->nodes);
+  BROTLI_FREE(m, self->literal_costs);
+  BROTLI_FREE(m, self->cost_dist);
+  BROTLI_FREE(m, self->num_matches);
+  BROTLI_FREE(m, self->matches);
+  BrotliInitZopfliWorkspace(self);
+}
+
+/* Unlike BROTLI_ENSURE_CAPACITY, grows to exactly R elements and does not
+   preserve contents. */
+#define ZOPFLI_RESERVE(M, T, A, C, R) {                            \
+  if (C < (R)) {                                                   \
+    BROTLI_FREE((M), A);                                           \
+    C = 0;                                                         \
+    A = BROTLI_ALLOC((M), T, (R));                                 \
+    if (!BROTLI_IS_OOM(M) && !BROTLI_IS_NULL(A)) C = (R);          \
+  }                                                                \
+}
+
 static BROTLI_INLINE uint32_t ZopfliNodeCopyLength(const ZopfliNode* self) {
   return self->length & 0x1FFFFFF;
 }
@@ -85,19 +121,29 @@ typedef struct ZopfliCostModel {
   size_t num_bytes_;
 } ZopfliCostModel;
 
+/* Cost model arrays are borrowed from |workspace|. */
 static void InitZopfliCostModel(
     MemoryManager* m, ZopfliCostModel* self, const BrotliDistanceParams* dist,
-    size_t num_bytes) {
+    size_t num_bytes, ZopfliWorkspace* workspace) {
+  ZOPFLI_RESERVE(m, float, workspace->literal_costs,
+      workspace->literal_costs_size, num_bytes + 2);
+  ZOPFLI_RESERVE(m, float, workspace->cost_dist,
+      workspace->cost_dist_size, dist->alphabet_size_limit);
+  if (BROTLI_IS_OOM(m)) return;
   self->num_bytes_ = num_bytes;
-  self->literal_costs_ = BROTLI_ALLOC(m, float, num_bytes + 2);
-  self->cost_dist_ = BROTLI_ALLOC(m, float, dist->alphabet_size_limit);
+  self->literal_costs_ = workspace->literal_costs;
+  self->cost_dist_ = workspace->cost_dist;
   self->distance_histogram_size = dist->alphabet_size_limit;
-  if (BROTLI_IS_OOM(m)) return;
 }
 
-static void CleanupZopfliCostModel(MemoryManager* m, ZopfliCostModel* self) {
-  BROTLI_FREE(m, self->literal_costs_);
-  BROTLI_FREE(m, self->cost_dist_);
+/* Sets up |workspace->nodes| for a block of |num_bytes|. */
+static ZopfliNode* PrepareZopfliNodes(
+    MemoryManager* m, size_t num_bytes, ZopfliWorkspace* workspace) {
+  ZOPFLI_RESERVE(m, ZopfliNode, workspace->nodes, workspace->nodes_size,
+      num_bytes + 1);
+  if (BROTLI_IS_OOM(m)) return NULL;
+  BrotliInitZopfliNodes(workspace->nodes, num_bytes + 1);
+  return workspace->nodes;
 }
 
 static void SetCost(const uint32_t* histogram, size_t histogram_size,
@@ -409,7 +455,11 @@ static size_t UpdateNodes(
   const size_t stream_offset = params->stream_offset;
   const size_t cur_ix = block_start + pos;
   const size_t cur_ix_masked = cur_ix & ringbuffer_mask;
-  const size_t max_distance = BROTLI_MIN(size_t, cur_ix, max_backward_limit);
+  /* References must not cross the start of the current chunk. */
+  const size_t chunk_start =
+      params->chunk_size != 0 ? block_start - params->chunk_prefix : 0;
+  const size_t max_distance =
+      BROTLI_MIN(size_t, cur_ix - chunk_start, max_backward_limit);
   const size_t dictionary_start = BROTLI_MIN(size_t,
       cur_ix + stream_offset, max_backward_limit);
   const size_t max_len = num_bytes - pos;
@@ -418,7 +468,7 @@ static size_t UpdateNodes(
   size_t min_len;
   size_t result = 0;
   size_t k;
-  size_t gap = 0;
+  const size_t gap = params->dictionary.compound.total_size;
 
   EvaluateNode(block_start + stream_offset, pos, max_backward_limit, gap,
       starting_dist_cache, model, queue, nodes);
@@ -577,7 +627,7 @@ void BrotliZopfliCreateCommands(const size_t num_bytes,
   size_t pos = 0;
   uint32_t offset = nodes[0].u.next;
   size_t i;
-  size_t gap = 0;
+  const size_t gap = params->dictionary.compound.total_size;
   for (i = 0; offset != BROTLI_UINT32_MAX; i++) {
     const ZopfliNode* next = &nodes[pos + offset];
     size_t copy_length = ZopfliNodeCopyLength(next);
@@ -653,33 +703,81 @@ static size_t ZopfliIterate(size_t num_bytes, size_t position,
   return ComputeShortestPathFromNodes(num_bytes, nodes);
 }
 
-/* REQUIRES: nodes != NULL and len(nodes) >= num_bytes + 1 */
+/* Merges two lists sorted by length (and by distance for equal lengths) into
+   |dst|. |dst| may overlap the lists, as long as it starts far enough before
+   them not to overwrite unread items. */
+static size_t MergeMatches(BackwardMatch* dst,
+    const BackwardMatch* src1, size_t len1,
+    const BackwardMatch* src2, size_t len2) {
+  size_t l = 0;
+  size_t i = 0;
+  size_t j = 0;
+  while (i < len1 && j < len2) {
+    const size_t l1 = BackwardMatchLength(&src1[i]);
+    const size_t l2 = BackwardMatchLength(&src2[j]);
+    if (l1 < l2 || (l1 == l2 && src1[i].distance < src2[j].distance)) {
+      dst[l++] = src1[i++];
+    } else {
+      dst[l++] = src2[j++];
+    }
+  }
+  while (i < len1) dst[l++] = src1[i++];
+  while (j < len2) dst[l++] = src2[j++];
+  return l;
+}
+
+/* Appends custom dictionary matches to |num_matches| matches that start at
+   |lz_matches|, and merges the result into |dst|. Dictionary matches are
+   always further than stream ones, so only longer ones are worth trying. */
+static size_t AddCompoundDictionaryMatches(
+    const BrotliEncoderParams* params, const uint8_t* ringbuffer,
+    size_t ringbuffer_mask, size_t pos, size_t max_length,
+    size_t dictionary_start, BackwardMatch* dst,
+    BackwardMatch* lz_matches, size_t num_matches) {
+  const size_t min_length = num_matches > 0 ?
+      BackwardMatchLength(&lz_matches[num_matches - 1]) : 3;
+  const size_t cd_matches = LookupAllCompoundDictionaryMatches(
+      &params->dictionary.compound, ringbuffer, ringbuffer_mask, pos,
+      min_length, max_length, dictionary_start, params->dist.max_distance,
+      &lz_matches[num_matches], MAX_COMPOUND_DICTIONARY_MATCHES);
+  return MergeMatches(dst, lz_matches, num_matches,
+      &lz_matches[num_matches], cd_matches);
+}
+
 size_t BrotliZopfliComputeShortestPath(MemoryManager* m, size_t num_bytes,
     size_t position, const uint8_t* ringbuffer, size_t ringbuffer_mask,
     ContextLut literal_context_lut, const BrotliEncoderParams* params,
-    const int* dist_cache, Hasher* hasher, ZopfliNode* nodes) {
+    const int* dist_cache, Hasher* hasher, ZopfliWorkspace* workspace) {
   const size_t stream_offset = params->stream_offset;
   const size_t max_backward_limit = BROTLI_MAX_BACKWARD_LIMIT(params->lgwin);
+  const size_t chunk_start =
+      params->chunk_size != 0 ? position - params->chunk_prefix : 0;
   const size_t max_zopfli_len = MaxZopfliLen(params);
   ZopfliCostModel model;
   StartPosQueue queue;
   BackwardMatch matches[2 * (MAX_NUM_MATCHES_H10 + 64)];
+  const BROTLI_BOOL has_compound =
+      TO_BROTLI_BOOL(params->dictionary.compound.num_chunks != 0);
   const size_t store_end = num_bytes >= StoreLookaheadH10() ?
       position + num_bytes - StoreLookaheadH10() + 1 : position;
   size_t i;
-  size_t gap = 0;
-  size_t lz_matches_offset = 0;
+  const size_t gap = params->dictionary.compound.total_size;
+  const size_t lz_matches_offset =
+      has_compound ? MAX_COMPOUND_DICTIONARY_MATCHES : 0;
+  ZopfliNode* nodes = PrepareZopfliNodes(m, num_bytes, workspace);
   BROTLI_UNUSED(literal_context_lut);
+  if (BROTLI_IS_OOM(m)) return 0;
   nodes[0].length = 0;
   nodes[0].u.cost = 0;
-  InitZopfliCostModel(m, &model, &params->dist, num_bytes);
+  InitZopfliCostModel(m, &model, &params->dist, num_bytes, workspace);
   if (BROTLI_IS_OOM(m)) return 0;
   ZopfliCostModelSetFromLiteralCosts(
       &model, position, ringbuffer, ringbuffer_mask);
   InitStartPosQueue(&queue);
   for (i = 0; i + HashTypeLengthH10() - 1 < num_bytes; i++) {
     const size_t pos = position + i;
-    const size_t max_distance = BROTLI_MIN(size_t, pos, max_backward_limit);
+    const size_t max_distance =
+        BROTLI_MIN(size_t, pos - chunk_start, max_backward_limit);
     const size_t dictionary_start = BROTLI_MIN(size_t,
         pos + stream_offset, max_backward_limit);
     size_t skip;
@@ -688,6 +786,11 @@ size_t BrotliZopfliComputeShortestPath(MemoryManager* m, size_t num_bytes,
         &params->dictionary,
         ringbuffer, ringbuffer_mask, pos, num_bytes - i, max_distance,
         dictionary_start + gap, params, &matches[lz_matches_offset]);
+    if (has_compound) {
+      num_matches = AddCompoundDictionaryMatches(params, ringbuffer,
+          ringbuffer_mask, pos, num_bytes - i, dictionary_start, matches,
+          &matches[lz_matches_offset], num_matches);
+    }
     if (num_matches > 0 &&
         BackwardMatchLength(&matches[num_matches - 1]) > max_zopfli_len) {
       matches[0] = matches[num_matches - 1];
@@ -715,7 +818,6 @@ size_t BrotliZopfliComputeShortestPath(MemoryManager* m, size_t num_bytes,
       }
     }
   }
-  CleanupZopfliCostModel(m, &model);
   return ComputeShortestPathFromNodes(num_bytes, nodes);
 }
 
@@ -723,28 +825,27 @@ void BrotliCreateZopfliBackwardReferences(MemoryManager* m, size_t num_bytes,
     size_t position, const uint8_t* ringbuffer, size_t ringbuffer_mask,
     ContextLut literal_context_lut, const BrotliEncoderParams* params,
     Hasher* hasher, int* dist_cache, size_t* last_insert_len,
-    Command* commands, size_t* num_commands, size_t* num_literals) {
-  ZopfliNode* nodes = BROTLI_ALLOC(m, ZopfliNode, num_bytes + 1);
-  if (BROTLI_IS_OOM(m) || BROTLI_IS_NULL(nodes)) return;
-  BrotliInitZopfliNodes(nodes, num_bytes + 1);
+    Command* commands, size_t* num_commands, size_t* num_literals,
+    ZopfliWorkspace* workspace) {
   *num_commands += BrotliZopfliComputeShortestPath(m, num_bytes,
       position, ringbuffer, ringbuffer_mask, literal_context_lut, params,
-      dist_cache, hasher, nodes);
+      dist_cache, hasher, workspace);
   if (BROTLI_IS_OOM(m)) return;
-  BrotliZopfliCreateCommands(num_bytes, position, nodes, dist_cache,
+  BrotliZopfliCreateCommands(num_bytes, position, workspace->nodes, dist_cache,
       last_insert_len, params, commands, num_literals);
-  BROTLI_FREE(m, nodes);
 }
 
 void BrotliCreateHqZopfliBackwardReferences(MemoryManager* m, size_t num_bytes,
     size_t position, const uint8_t* ringbuffer, size_t ringbuffer_mask,
     ContextLut literal_context_lut, const BrotliEncoderParams* params,
     Hasher* hasher, int* dist_cache, size_t* last_insert_len,
-    Command* commands, size_t* num_commands, size_t* num_literals) {
+    Command* commands, size_t* num_commands, size_t* num_literals,
+    ZopfliWorkspace* workspace) {
   const size_t stream_offset = params->stream_offset;
   const size_t max_backward_limit = BROTLI_MAX_BACKWARD_LIMIT(params->lgwin);
-  uint32_t* num_matches = BROTLI_ALLOC(m, uint32_t, num_bytes);
-  size_t matches_size = 4 * num_bytes;
+  const size_t chunk_start =
+      params->chunk_size != 0 ? position - params->chunk_prefix : 0;
+  uint32_t* num_matches;
   const size_t store_end = num_bytes >= StoreLookaheadH10() ?
       position + num_bytes - StoreLookaheadH10() + 1 : position;
   size_t cur_match_pos = 0;
@@ -755,17 +856,25 @@ void BrotliCreateHqZopfliBackwardReferences(MemoryManager* m, size_t num_bytes,
   size_t orig_num_commands;
   ZopfliCostModel model;
   ZopfliNode* nodes;
-  BackwardMatch* matches = BROTLI_ALLOC(m, BackwardMatch, matches_size);
-  size_t gap = 0;
-  size_t shadow_matches = 0;
+  BackwardMatch* matches;
+  const size_t gap = params->dictionary.compound.total_size;
+  const BROTLI_BOOL has_compound =
+      TO_BROTLI_BOOL(params->dictionary.compound.num_chunks != 0);
+  /* Gap that lets dictionary matches be merged in place. */
+  const size_t shadow_matches =
+      has_compound ? MAX_COMPOUND_DICTIONARY_MATCHES : 0;
   BROTLI_UNUSED(literal_context_lut);
-  if (BROTLI_IS_OOM(m) || BROTLI_IS_NULL(num_matches) ||
-      BROTLI_IS_NULL(matches)) {
-    return;
-  }
+  ZOPFLI_RESERVE(m, uint32_t, workspace->num_matches,
+      workspace->num_matches_size, num_bytes);
+  ZOPFLI_RESERVE(m, BackwardMatch, workspace->matches,
+      workspace->matches_size, 4 * num_bytes);
+  if (BROTLI_IS_OOM(m)) return;
+  num_matches = workspace->num_matches;
+  matches = workspace->matches;
   for (i = 0; i + HashTypeLengthH10() - 1 < num_bytes; ++i) {
     const size_t pos = position + i;
-    size_t max_distance = BROTLI_MIN(size_t, pos, max_backward_limit);
+    size_t max_distance =
+        BROTLI_MIN(size_t, pos - chunk_start, max_backward_limit);
     size_t dictionary_start = BROTLI_MIN(size_t,
         pos + stream_offset, max_backward_limit);
     size_t max_length = num_bytes - i;
@@ -773,14 +882,22 @@ void BrotliCreateHqZopfliBackwardReferences(MemoryManager* m, size_t num_bytes,
     size_t cur_match_end;
     size_t j;
     /* Ensure that we have enough free slots. */
-    BROTLI_ENSURE_CAPACITY(m, BackwardMatch, matches, matches_size,
-        cur_match_pos + MAX_NUM_MATCHES_H10 + shadow_matches);
+    BROTLI_ENSURE_CAPACITY(m, BackwardMatch, workspace->matches,
+        workspace->matches_size,
+        cur_match_pos + MAX_NUM_MATCHES_H10 + 2 * shadow_matches);
     if (BROTLI_IS_OOM(m)) return;
+    matches = workspace->matches;
     num_found_matches = FindAllMatchesH10(&hasher->privat._H10,
         &params->dictionary,
         ringbuffer, ringbuffer_mask, pos, max_length,
         max_distance, dictionary_start + gap, params,
         &matches[cur_match_pos + shadow_matches]);
+    if (has_compound) {
+      num_found_matches = AddCompoundDictionaryMatches(params, ringbuffer,
+          ringbuffer_mask, pos, max_length, dictionary_start,
+          &matches[cur_match_pos], &matches[cur_match_pos + shadow_matches],
+          num_found_matches);
+    }
     cur_match_end = cur_match_pos + num_found_matches;
     for (j = cur_match_pos; j + 1 < cur_match_end; ++j) {
       BROTLI_DCHECK(BackwardMatchLength(&matches[j]) <=
@@ -808,9 +925,9 @@ void BrotliCreateHqZopfliBackwardReferences(MemoryManager* m, size_t num_bytes,
   orig_last_insert_len = *last_insert_len;
   memcpy(orig_dist_cache, dist_cache, 4 * sizeof(dist_cache[0]));
   orig_num_commands = *num_commands;
-  nodes = BROTLI_ALLOC(m, ZopfliNode, num_bytes + 1);
-  if (BROTLI_IS_OOM(m) || BROTLI_IS_NULL(nodes)) return;
-  InitZopfliCostModel(m, &model, &params->dist, num_bytes);
+  nodes = PrepareZopfliNodes(m, num_bytes, workspace);
+  if (BROTLI_IS_OOM(m)) return;
+  InitZopfliCostModel(m, &model, &params->dist, num_bytes, workspace);
   if (BROTLI_IS_OOM(m)) return;
   for (i = 0; i < 2; i++) {
     BrotliInitZopfliNodes(nodes, num_bytes + 1);
@@ -832,10 +949,6 @@ void BrotliCreateHqZopfliBackwardReferences(MemoryManager* m, size_t num_bytes,
     BrotliZopfliCreateCommands(num_bytes, position, nodes, dist_cache,
         last_insert_len, params, commands, num_literals);
   }
-  CleanupZopfliCostModel(m, &model);
-  BROTLI_FREE(m, nodes);
-  BROTLI_FREE(m, matches);
-  BROTLI_FREE(m, num_matches);
 }
 
 #if defined(__cplusplus) || defined(c_plusplus)
@@ -23,20 +23,6 @@
 extern "C" {
 #endif
 
-BROTLI_INTERNAL void BrotliCreateZopfliBackwardReferences(MemoryManager* m,
-    size_t num_bytes,
-    size_t position, const uint8_t* ringbuffer, size_t ringbuffer_mask,
-    ContextLut literal_context_lut, const BrotliEncoderParams* params,
-    Hasher* hasher, int* dist_cache, size_t* last_insert_len,
-    Command* commands, size_t* num_commands, size_t* num_literals);
-
-BROTLI_INTERNAL void BrotliCreateHqZopfliBackwardReferences(MemoryManager* m,
-    size_t num_bytes,
-    size_t position, const uint8_t* ringbuffer, size_t ringbuffer_mask,
-    ContextLut literal_context_lut, const BrotliEncoderParams* params,
-    Hasher* hasher, int* dist_cache, size_t* last_insert_len,
-    Command* commands, size_t* num_commands, size_t* num_literals);
-
 typedef struct ZopfliNode {
   /* Best length to get up to this byte (not including this byte itself)
      highest 7 bit is used to reconstruct the length code. */
@@ -64,6 +50,47 @@ typedef struct ZopfliNode {
 
 BROTLI_INTERNAL void BrotliInitZopfliNodes(ZopfliNode* array, size_t length);
 
+/* Scratch memory of Zopfli search. Kept between input blocks of one
+   metablock to avoid per-block allocations; arrays grow to exactly the
+   biggest block seen, so memory is bounded by input block size. Owner frees
+   it before the metablock is built, so that it does not add to peak memory
+   of metablock building. */
+typedef struct ZopfliWorkspace {
+  /* num_bytes + 1 nodes of the last search. */
+  ZopfliNode* nodes;
+  size_t nodes_size;
+  /* Cost model. */
+  float* literal_costs;
+  size_t literal_costs_size;
+  float* cost_dist;
+  size_t cost_dist_size;
+  /* Match lists of HQ search. */
+  uint32_t* num_matches;
+  size_t num_matches_size;
+  BackwardMatch* matches;
+  size_t matches_size;
+} ZopfliWorkspace;
+
+BROTLI_INTERNAL void BrotliInitZopfliWorkspace(ZopfliWorkspace* self);
+BROTLI_INTERNAL void BrotliDestroyZopfliWorkspace(
+    MemoryManager* m, ZopfliWorkspace* self);
+
+BROTLI_INTERNAL void BrotliCreateZopfliBackwardReferences(MemoryManager* m,
+    size_t num_bytes,
+    size_t position, const uint8_t* ringbuffer, size_t ringbuffer_mask,
+    ContextLut literal_context_lut, const BrotliEncoderParams* params,
+    Hasher* hasher, int* dist_cache, size_t* last_insert_len,
+    Command* commands, size_t* num_commands, size_t* num_literals,
+    ZopfliWorkspace* workspace);
+
+BROTLI_INTERNAL void BrotliCreateHqZopfliBackwardReferences(MemoryManager* m,
+    size_t num_bytes,
+    size_t position, const uint8_t* ringbuffer, size_t ringbuffer_mask,
+    ContextLut literal_context_lut, const BrotliEncoderParams* params,
+    Hasher* hasher, int* dist_cache, size_t* last_insert_len,
+    Command* commands, size_t* num_commands, size_t* num_literals,
+    ZopfliWorkspace* workspace);
+
 /* Computes the shortest path of commands from position to at most
    position + num_bytes.
 
@@ -71,7 +98,7 @@ BROTLI_INTERNAL void BrotliInitZopfliNodes(ZopfliNode* array, size_t length);
    length of the i-th command (copy length plus insert length).
    Note that the sum of the lengths of all commands can be less than num_bytes.
 
-   On return, the nodes[0..num_bytes] array will have the following
+   On return, the workspace->nodes[0..num_bytes] array will have the following
    "ZopfliNode array invariant":
    For each i in [1..num_bytes], if nodes[i].cost < kInfinity, then
      (1) nodes[i].copy_length() >= 2
@@ -81,7 +108,7 @@ BROTLI_INTERNAL size_t BrotliZopfliComputeShortestPath(
     MemoryManager* m, size_t num_bytes,
     size_t position, const uint8_t* ringbuffer, size_t ringbuffer_mask,
     ContextLut literal_context_lut, const BrotliEncoderParams* params,
-    const int* dist_cache, Hasher* hasher, ZopfliNode* nodes);
+    const int* dist_cache, Hasher* hasher, ZopfliWorkspace* workspace);
 
 BROTLI_INTERNAL void BrotliZopfliCreateCommands(
     const size_t num_bytes, const size_t block_start, const ZopfliNode* nodes,
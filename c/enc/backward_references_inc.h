@@ -19,6 +19,9 @@ static BROTLI_NOINLINE void EXPORT_FN(CreateBackwardReferences)(
   /* Set maximum distance, see section 9.1. of the spec. */
   const size_t max_backward_limit = BROTLI_MAX_BACKWARD_LIMIT(params->lgwin);
   const size_t position_offset = params->stream_offset;
+  /* References must not cross the start of the current chunk. */
+  const size_t chunk_start =
+      params->chunk_size != 0 ? position - params->chunk_prefix : 0;
 
   const Command* const orig_commands = commands;
   size_t insert_length = *last_insert_len;
@@ -30,7 +33,8 @@ static BROTLI_NOINLINE void EXPORT_FN(CreateBackwardReferences)(
   const size_t random_heuristics_window_size =
       LiteralSpreeLengthForSparseSearch(params);
   size_t apply_random_heuristics = position + random_heuristics_window_size;
-  const size_t gap = 0;
+  const CompoundDictionary* addon = &params->dictionary.compound;
+  const size_t gap = addon->total_size;
 
   /* Minimum score to accept a backward reference. */
   const score_t kMinScore = BROTLI_SCORE_BASE + 100;
@@ -41,7 +45,8 @@ static BROTLI_NOINLINE void EXPORT_FN(CreateBackwardReferences)(
 
   while (position + FN(HashTypeLength)() < pos_end) {
     size_t max_length = pos_end - position;
-    size_t max_distance = BROTLI_MIN(size_t, position, max_backward_limit);
+    size_t max_distance =
+        BROTLI_MIN(size_t, position - chunk_start, max_backward_limit);
     size_t dictionary_start = BROTLI_MIN(size_t,
         position + position_offset, max_backward_limit);
     HasherSearchResult sr;
@@ -54,6 +59,11 @@ static BROTLI_NOINLINE void EXPORT_FN(CreateBackwardReferences)(
         ringbuffer, ringbuffer_mask, dist_cache, position, max_length,
         max_distance, dictionary_start + gap, params->dist.max_distance,
         backward_references, back_refs_position, back_refs_size, &sr);
+    if (addon->num_chunks != 0 && !sr.used_stored) {
+      LookupCompoundDictionaryMatch(addon, ringbuffer, ringbuffer_mask,
+          dist_cache, position, max_length, dictionary_start,
+          params->dist.max_distance, &sr);
+    }
     if (sr.score > kMinScore) {
       /* Found a match. Let's look for something even better ahead. */
       int delayed_backward_references_in_row = 0;
@@ -70,7 +80,8 @@ static BROTLI_NOINLINE void EXPORT_FN(CreateBackwardReferences)(
             sr2.distance = 0;
             sr2.score = kMinScore;
             sr2.used_stored = BROTLI_FALSE;
-            max_distance = BROTLI_MIN(size_t, position + 1, max_backward_limit);
+            max_distance = BROTLI_MIN(size_t,
+                position + 1 - chunk_start, max_backward_limit);
             dictionary_start = BROTLI_MIN(size_t,
                 position + 1 + position_offset, max_backward_limit);
             FN(FindLongestMatch)(privat,
@@ -78,6 +89,11 @@ static BROTLI_NOINLINE void EXPORT_FN(CreateBackwardReferences)(
                 ringbuffer, ringbuffer_mask, dist_cache, position + 1, max_length,
                 max_distance, dictionary_start + gap, params->dist.max_distance,
                 backward_references, back_refs_position, back_refs_size, &sr2);
+            if (addon->num_chunks != 0 && !sr2.used_stored) {
+              LookupCompoundDictionaryMatch(addon, ringbuffer,
+                  ringbuffer_mask, dist_cache, position + 1, max_length,
+                  dictionary_start, params->dist.max_distance, &sr2);
+            }
             if (sr2.score >= sr.score + cost_diff_lazy || sr2.used_stored) {
               /* Ok, let's just write one byte for now and start a match from the
                  next byte. */
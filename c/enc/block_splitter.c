@@ -357,6 +357,27 @@ static BROTLI_INLINE double BitCost(size_t count) {
 #define HISTOGRAMS_PER_BATCH 64
 #define CLUSTERS_PER_BATCH 16
 
+/* Width of a lane group in FindBlocks cost rows. One lane group maps to one
+   byte of the switch signal bitmap, so this must stay 8. */
+#define COST_LANES 8
+
+/* FindBlocks costs are fixed-point numbers with this many fractional bits.
+   Real costs stay far below 2^22, which leaves room to append an 8-bit
+   histogram index to a cost without overflowing 32 bits. */
+#define COST_FRACTION_BITS 14
+
+/* Cost of coding any symbol with a padding (non-existent) histogram; never
+   selected as the minimum. */
+static const uint32_t kPaddingCost = 1u << 22;
+
+static BROTLI_INLINE size_t CostRowSize(size_t num_histograms) {
+  return (num_histograms + COST_LANES - 1) & ~(size_t)(COST_LANES - 1);
+}
+
+static BROTLI_INLINE uint32_t ToFixedPointCost(double bits) {
+  return (uint32_t)(bits * (1u << COST_FRACTION_BITS) + 0.5);
+}
+
 #define FN(X) X ## Literal
 #define DataType uint8_t
 /* NOLINTNEXTLINE(build/include) */
@@ -376,6 +397,9 @@ static BROTLI_INLINE double BitCost(size_t count) {
 #undef DataType
 #undef FN
 
+#undef COST_LANES
+#undef COST_FRACTION_BITS
+
 void BrotliInitBlockSplit(BlockSplit* self) {
   self->num_types = 0;
   self->num_blocks = 0;
@@ -62,17 +62,24 @@ static void FN(RefineEntropyCodes)(const DataType* data, size_t length,
 
 /* Assigns a block id from the range [0, num_histograms) to each data element
    in data[0..length) and fills in block_id[0..length) with the assigned values.
-   Returns the number of blocks, i.e. one plus the number of block switches. */
+   Returns the number of blocks, i.e. one plus the number of block switches.
+
+   Costs are fixed-point (see COST_FRACTION_BITS) and each row is padded to a
+   multiple of COST_LANES entries; the inner loops work on whole lane groups,
+   so the compiler can vectorize both the cost update and the min selection.
+   The min selection key holds the cost in the high bits and the histogram
+   index in the low 8 bits, so ties resolve to the lowest index. */
 static size_t FN(FindBlocks)(const DataType* data, const size_t length,
                              const double block_switch_bitcost,
                              const size_t num_histograms,
                              const HistogramType* histograms,
-                             double* insert_cost,
-                             double* cost,
+                             uint32_t* BROTLI_RESTRICT insert_cost,
+                             uint32_t* BROTLI_RESTRICT cost,
                              uint8_t* switch_signal,
                              uint8_t* block_id) {
   const size_t data_size = FN(HistogramDataSize)();
-  const size_t bitmaplen = (num_histograms + 7) >> 3;
+  const size_t row_size = CostRowSize(num_histograms);
+  const size_t bitmaplen = row_size / COST_LANES;
   size_t num_blocks = 1;
   size_t i;
   size_t j;
@@ -83,19 +90,18 @@ static size_t FN(FindBlocks)(const DataType* data, const size_t length,
     }
     return 1;
   }
-  memset(insert_cost, 0, sizeof(insert_cost[0]) * data_size * num_histograms);
-  for (i = 0; i < num_histograms; ++i) {
-    insert_cost[i] = FastLog2((uint32_t)histograms[i].total_count_);
-  }
-  for (i = data_size; i != 0;) {
-    --i;
+  for (i = 0; i < data_size; ++i) {
+    uint32_t* row = &insert_cost[i * row_size];
     for (j = 0; j < num_histograms; ++j) {
-      insert_cost[i * num_histograms + j] =
-          insert_cost[j] - BitCost(histograms[j].data_[i]);
+      row[j] = ToFixedPointCost(
+          FastLog2((uint32_t)histograms[j].total_count_) -
+          BitCost(histograms[j].data_[i]));
+    }
+    for (; j < row_size; ++j) {
+      row[j] = kPaddingCost;
     }
   }
-  memset(cost, 0, sizeof(cost[0]) * num_histograms);
-  memset(switch_signal, 0, sizeof(switch_signal[0]) * length * bitmaplen);
+  memset(cost, 0, sizeof(cost[0]) * row_size);
   /* After each iteration of this loop, cost[k] will contain the difference
      between the minimum cost of arriving at the current byte position using
      entropy code k, and the minimum cost of arriving at the current byte
@@ -104,31 +110,51 @@ static size_t FN(FindBlocks)(const DataType* data, const size_t length,
      position, we need to switch here. */
   for (i = 0; i < length; ++i) {
     const size_t byte_ix = i;
-    size_t ix = byte_ix * bitmaplen;
-    size_t insert_cost_ix = data[byte_ix] * num_histograms;
-    double min_cost = 1e99;
+    const size_t ix = byte_ix * bitmaplen;
+    const uint32_t* insert_row = &insert_cost[data[byte_ix] * row_size];
+    uint32_t lane_min[COST_LANES];
+    uint32_t min_key;
+    uint32_t min_cost;
     double block_switch_cost = block_switch_bitcost;
+    uint32_t switch_cost;
     size_t k;
-    for (k = 0; k < num_histograms; ++k) {
-      /* We are coding the symbol in data[byte_ix] with entropy code k. */
-      cost[k] += insert_cost[insert_cost_ix + k];
-      if (cost[k] < min_cost) {
-        min_cost = cost[k];
-        block_id[byte_ix] = (uint8_t)k;
+    size_t l;
+    for (l = 0; l < COST_LANES; ++l) {
+      lane_min[l] = BROTLI_UINT32_MAX;
+    }
+    for (k = 0; k < row_size; k += COST_LANES) {
+      for (l = 0; l < COST_LANES; ++l) {
+        /* We are coding the symbol in data[byte_ix] with entropy code k + l. */
+        const uint32_t c = cost[k + l] + insert_row[k + l];
+        const uint32_t key = (c << 8) | (uint32_t)(k + l);
+        cost[k + l] = c;
+        lane_min[l] = key < lane_min[l] ? key : lane_min[l];
       }
     }
+    min_key = lane_min[0];
+    for (l = 1; l < COST_LANES; ++l) {
+      min_key = lane_min[l] < min_key ? lane_min[l] : min_key;
+    }
+    min_cost = min_key >> 8;
+    BROTLI_DCHECK((min_key & 0xFF) < num_histograms);
+    block_id[byte_ix] = (uint8_t)(min_key & 0xFF);
     /* More blocks for the beginning. */
     if (byte_ix < 2000) {
       block_switch_cost *= 0.77 + 0.07 * (double)byte_ix / 2000;
     }
-    for (k = 0; k < num_histograms; ++k) {
-      cost[k] -= min_cost;
-      if (cost[k] >= block_switch_cost) {
-        const uint8_t mask = (uint8_t)(1u << (k & 7));
-        cost[k] = block_switch_cost;
-        BROTLI_DCHECK((k >> 3) < bitmaplen);
-        switch_signal[ix + (k >> 3)] |= mask;
+    switch_cost = ToFixedPointCost(block_switch_cost);
+    for (k = 0; k < row_size; k += COST_LANES) {
+      for (l = 0; l < COST_LANES; ++l) {
+        const uint32_t c = cost[k + l] - min_cost;
+        cost[k + l] = c < switch_cost ? c : switch_cost;
+      }
+    }
+    for (k = 0; k < row_size; k += COST_LANES) {
+      uint32_t bits = 0;
+      for (l = 0; l < COST_LANES; ++l) {
+        bits |= (uint32_t)(cost[k + l] == switch_cost) << l;
       }
+      switch_signal[ix + k / COST_LANES] = (uint8_t)bits;
     }
   }
   {  /* Trace back from the last position and switch at the marked places. */
@@ -403,9 +429,10 @@ static void FN(SplitByteVector)(MemoryManager* m,
     /* Find a good path through literals with the good entropy codes. */
     uint8_t* block_ids = BROTLI_ALLOC(m, uint8_t, length);
     size_t num_blocks = 0;
-    const size_t bitmaplen = (num_histograms + 7) >> 3;
-    double* insert_cost = BROTLI_ALLOC(m, double, data_size * num_histograms);
-    double* cost = BROTLI_ALLOC(m, double, num_histograms);
+    const size_t row_size = CostRowSize(num_histograms);
+    const size_t bitmaplen = row_size / COST_LANES;
+    uint32_t* insert_cost = BROTLI_ALLOC(m, uint32_t, data_size * row_size);
+    uint32_t* cost = BROTLI_ALLOC(m, uint32_t, row_size);
     uint8_t* switch_signal = BROTLI_ALLOC(m, uint8_t, length * bitmaplen);
     uint16_t* new_id = BROTLI_ALLOC(m, uint16_t, num_histograms);
     const size_t iters = params->quality < HQ_ZOPFLIFICATION_QUALITY ? 3 : 10;
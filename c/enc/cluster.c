@@ -27,6 +27,78 @@ static BROTLI_INLINE BROTLI_BOOL HistogramPairIsLess(
   return TO_BROTLI_BOOL((p1->idx2 - p1->idx1) > (p2->idx2 - p2->idx1));
 }
 
+/* Pairs queue is a binary heap with the best pair (see HistogramPairIsLess)
+   at pairs[0]. */
+static BROTLI_INLINE void HistogramPairSiftUp(HistogramPair* pairs, size_t i) {
+  HistogramPair p = pairs[i];
+  while (i > 0) {
+    size_t parent = (i - 1) >> 1;
+    if (!HistogramPairIsLess(&pairs[parent], &p)) break;
+    pairs[i] = pairs[parent];
+    i = parent;
+  }
+  pairs[i] = p;
+}
+
+static BROTLI_INLINE void HistogramPairSiftDown(
+    HistogramPair* pairs, size_t num_pairs, size_t i) {
+  HistogramPair p = pairs[i];
+  for (;;) {
+    size_t child = 2 * i + 1;
+    if (child >= num_pairs) break;
+    if (child + 1 < num_pairs &&
+        HistogramPairIsLess(&pairs[child], &pairs[child + 1])) {
+      ++child;
+    }
+    if (!HistogramPairIsLess(&p, &pairs[child])) break;
+    pairs[i] = pairs[child];
+    i = child;
+  }
+  pairs[i] = p;
+}
+
+static BROTLI_INLINE void HistogramPairHeapPop(
+    HistogramPair* pairs, size_t* num_pairs) {
+  --(*num_pairs);
+  if (*num_pairs > 0) {
+    pairs[0] = pairs[*num_pairs];
+    HistogramPairSiftDown(pairs, *num_pairs, 0);
+  }
+}
+
+/* A pair is stale once either of its clusters took part in a merge. Clusters
+   that were merged away have size 0. */
+static BROTLI_INLINE BROTLI_BOOL HistogramPairIsStale(
+    const HistogramPair* p, const uint32_t* cluster_size) {
+  return TO_BROTLI_BOOL(cluster_size[p->idx1] != p->size1 ||
+                        cluster_size[p->idx2] != p->size2);
+}
+
+/* Pops stale pairs until the top of the queue is valid. */
+static BROTLI_INLINE void HistogramPairHeapPopStale(HistogramPair* pairs,
+    size_t* num_pairs, const uint32_t* cluster_size) {
+  while (*num_pairs > 0 && HistogramPairIsStale(&pairs[0], cluster_size)) {
+    HistogramPairHeapPop(pairs, num_pairs);
+  }
+}
+
+/* Drops all stale pairs and restores the heap property. */
+static BROTLI_NOINLINE void HistogramPairHeapCompact(HistogramPair* pairs,
+    size_t* num_pairs, const uint32_t* cluster_size) {
+  size_t copy_to_idx = 0;
+  size_t i;
+  for (i = 0; i < *num_pairs; ++i) {
+    if (!HistogramPairIsStale(&pairs[i], cluster_size)) {
+      pairs[copy_to_idx++] = pairs[i];
+    }
+  }
+  *num_pairs = copy_to_idx;
+  for (i = copy_to_idx >> 1; i != 0;) {
+    --i;
+    HistogramPairSiftDown(pairs, copy_to_idx, i);
+  }
+}
+
 /* Returns entropy reduction of the context map when we combine two clusters. */
 static BROTLI_INLINE double ClusterCostDiff(size_t size_a, size_t size_b) {
   size_t size_c = size_a + size_b;
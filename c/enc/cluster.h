@@ -21,6 +21,10 @@ extern "C" {
 typedef struct HistogramPair {
   uint32_t idx1;
   uint32_t idx2;
+  /* Sizes of both clusters when the pair was evaluated; cluster size grows
+     with every merge, so it serves as a cluster version. */
+  uint32_t size1;
+  uint32_t size2;
   double cost_combo;
   double cost_diff;
 } HistogramPair;
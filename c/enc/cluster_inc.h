@@ -10,7 +10,10 @@
 #define HistogramType FN(Histogram)
 
 /* Computes the bit cost reduction by combining out[idx1] and out[idx2] and if
-   it is below a threshold, stores the pair (idx1, idx2) in the *pairs queue. */
+   it is below a threshold, stores the pair (idx1, idx2) in the *pairs queue.
+   The queue is a binary heap; it may contain stale pairs, which are skipped
+   lazily when they reach the top. When the queue is full, stale pairs are
+   dropped first; if it is still full, a better pair replaces the top. */
 BROTLI_INTERNAL void FN(BrotliCompareAndPushToQueue)(
     const HistogramType* out, const uint32_t* cluster_size, uint32_t idx1,
     uint32_t idx2, size_t max_num_pairs, HistogramPair* pairs,
@@ -29,6 +32,8 @@ BROTLI_INTERNAL void FN(BrotliCompareAndPushToQueue)(
   }
   p.idx1 = idx1;
   p.idx2 = idx2;
+  p.size1 = cluster_size[idx1];
+  p.size2 = cluster_size[idx2];
   p.cost_diff = 0.5 * ClusterCostDiff(cluster_size[idx1], cluster_size[idx2]);
   p.cost_diff -= out[idx1].bit_cost_;
   p.cost_diff -= out[idx2].bit_cost_;
@@ -53,16 +58,15 @@ BROTLI_INTERNAL void FN(BrotliCompareAndPushToQueue)(
   }
   if (is_good_pair) {
     p.cost_diff += p.cost_combo;
-    if (*num_pairs > 0 && HistogramPairIsLess(&pairs[0], &p)) {
-      /* Replace the top of the queue if needed. */
-      if (*num_pairs < max_num_pairs) {
-        pairs[*num_pairs] = pairs[0];
-        ++(*num_pairs);
-      }
-      pairs[0] = p;
-    } else if (*num_pairs < max_num_pairs) {
+    if (*num_pairs == max_num_pairs) {
+      HistogramPairHeapCompact(pairs, num_pairs, cluster_size);
+    }
+    if (*num_pairs < max_num_pairs) {
       pairs[*num_pairs] = p;
-      ++(*num_pairs);
+      HistogramPairSiftUp(pairs, (*num_pairs)++);
+    } else if (*num_pairs > 0 && HistogramPairIsLess(&pairs[0], &p)) {
+      /* Replace the top of the queue; p is better than every pair in it. */
+      pairs[0] = p;
     }
   }
 })
@@ -81,7 +85,7 @@ BROTLI_INTERNAL size_t FN(BrotliHistogramCombine)(HistogramType* out,
   size_t num_pairs = 0;
 
   {
-    /* We maintain a vector of histogram pairs, with the property that the pair
+    /* We maintain a heap of histogram pairs, with the property that the pair
        with the maximum bit cost reduction is the first. */
     size_t idx1;
     for (idx1 = 0; idx1 < num_clusters; ++idx1) {
@@ -97,9 +101,11 @@ BROTLI_INTERNAL size_t FN(BrotliHistogramCombine)(HistogramType* out,
     uint32_t best_idx1;
     uint32_t best_idx2;
     size_t i;
-    if (pairs[0].cost_diff >= cost_diff_threshold) {
+    HistogramPairHeapPopStale(pairs, &num_pairs, cluster_size);
+    if (num_pairs == 0 || pairs[0].cost_diff >= cost_diff_threshold) {
       cost_diff_threshold = 1e99;
       min_cluster_size = max_clusters;
+      if (num_pairs == 0) break;
       continue;
     }
     /* Take the best pair from the top of heap. */
@@ -108,6 +114,8 @@ BROTLI_INTERNAL size_t FN(BrotliHistogramCombine)(HistogramType* out,
     FN(HistogramAddHistogram)(&out[best_idx1], &out[best_idx2]);
     out[best_idx1].bit_cost_ = pairs[0].cost_combo;
     cluster_size[best_idx1] += cluster_size[best_idx2];
+    /* Invalidates all queued pairs with either cluster. */
+    cluster_size[best_idx2] = 0;
     for (i = 0; i < symbols_size; ++i) {
       if (symbols[i] == best_idx2) {
         symbols[i] = best_idx1;
@@ -121,28 +129,8 @@ BROTLI_INTERNAL size_t FN(BrotliHistogramCombine)(HistogramType* out,
       }
     }
     --num_clusters;
-    {
-      /* Remove pairs intersecting the just combined best pair. */
-      size_t copy_to_idx = 0;
-      for (i = 0; i < num_pairs; ++i) {
-        HistogramPair* p = &pairs[i];
-        if (p->idx1 == best_idx1 || p->idx2 == best_idx1 ||
-            p->idx1 == best_idx2 || p->idx2 == best_idx2) {
-          /* Remove invalid pair from the queue. */
-          continue;
-        }
-        if (HistogramPairIsLess(&pairs[0], p)) {
-          /* Replace the top of the queue if needed. */
-          HistogramPair front = pairs[0];
-          pairs[0] = *p;
-          pairs[copy_to_idx] = front;
-        } else {
-          pairs[copy_to_idx] = *p;
-        }
-        ++copy_to_idx;
-      }
-      num_pairs = copy_to_idx;
-    }
+    HistogramPairHeapPop(pairs, &num_pairs);
+    HistogramPairHeapPopStale(pairs, &num_pairs, cluster_size);
 
     /* Push new pairs formed with the combined histogram to the heap. */
     for (i = 0; i < num_clusters; ++i) {
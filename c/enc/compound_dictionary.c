@@ -0,0 +1,240 @@
+/* Copyright 2026 The Brotli Authors. All Rights Reserved.
+
+   Distributed under MIT license.
+   See file LICENSE for detail or copy at https://opensource.org/licenses/MIT
+*/
+
+#include "./compound_dictionary.h"
+
+#include <string.h>  /* memset */
+
+#include "../common/platform.h"
+#include <brotli/types.h>
+#include "./memory.h"
+
+#if defined(__cplusplus) || defined(c_plusplus)
+extern "C" {
+#endif
+
+/* Index positions are stored as uint32_t "position + 1". */
+#define MAX_PREPARED_DICTIONARY_SIZE ((size_t)1 << 30)
+/* Sanity limits for serialized images; prepared indices are well below. */
+#define MAX_BUCKET_BITS 24
+#define MAX_SEARCH_DEPTH 4096
+
+static uint32_t ComputeBucketBits(size_t source_size, int quality) {
+  uint32_t max_bits = quality < 5 ? 16 : (quality < 10 ? 20 : 22);
+  uint32_t bits = 10;
+  while (bits < max_bits && ((size_t)1 << bits) < source_size) ++bits;
+  return bits;
+}
+
+static uint32_t ComputeSearchDepth(int quality) {
+  if (quality < 5) return 4;
+  if (quality < 7) return 16;
+  if (quality < 10) return 32;
+  return 64;
+}
+
+PreparedDictionary* BrotliCreatePreparedDictionary(
+    MemoryManager* m, const uint8_t* source, size_t source_size, int quality) {
+  const uint32_t bucket_bits = ComputeBucketBits(source_size, quality);
+  const size_t num_buckets = (size_t)1 << bucket_bits;
+  PreparedDictionary* result;
+  uint32_t* heads;
+  uint32_t* chain;
+  size_t i;
+  if (source_size > MAX_PREPARED_DICTIONARY_SIZE) return NULL;
+  result = (PreparedDictionary*)BROTLI_ALLOC(m, uint8_t,
+      sizeof(PreparedDictionary) +
+      (num_buckets + source_size) * sizeof(uint32_t));
+  if (BROTLI_IS_OOM(m) || BROTLI_IS_NULL(result)) return NULL;
+  result->magic = BROTLI_PREPARED_DICTIONARY_MAGIC;
+  result->source_size = (uint32_t)source_size;
+  result->bucket_bits = bucket_bits;
+  result->search_depth = ComputeSearchDepth(quality);
+  result->source = source;
+  result->free_func = m->free_func;
+  result->opaque = m->opaque;
+  heads = (uint32_t*)&result[1];
+  chain = heads + num_buckets;
+  result->heads = heads;
+  result->chain = chain;
+  memset(heads, 0, num_buckets * sizeof(uint32_t));
+  memset(chain, 0, source_size * sizeof(uint32_t));
+  for (i = 0; i + BROTLI_PREPARED_DICTIONARY_HASH_LENGTH <= source_size; ++i) {
+    const uint32_t h = PreparedDictionaryHash(&source[i], bucket_bits);
+    chain[i] = heads[h];
+    heads[h] = (uint32_t)(i + 1);
+  }
+  return result;
+}
+
+static const uint64_t kSourceHashMul =
+    BROTLI_MAKE_UINT64_T(0x9E3779B9u, 0x7F4A7C15u);
+
+static BROTLI_INLINE uint64_t SourceHashMix(uint64_t h, uint64_t v) {
+  h = (h ^ v) * kSourceHashMul;
+  return h ^ (h >> 29);
+}
+
+uint64_t BrotliPreparedDictionarySourceHash(const uint8_t* data, size_t size) {
+  /* 4 independent lanes hide the multiplication latency. */
+  uint64_t h0 = 1;
+  uint64_t h1 = 2;
+  uint64_t h2 = 3;
+  uint64_t h3 = 4;
+  uint64_t result = SourceHashMix(0, (uint64_t)size);
+  size_t i = 0;
+  for (; i + 32 <= size; i += 32) {
+    h0 = SourceHashMix(h0, BROTLI_UNALIGNED_LOAD64LE(&data[i]));
+    h1 = SourceHashMix(h1, BROTLI_UNALIGNED_LOAD64LE(&data[i + 8]));
+    h2 = SourceHashMix(h2, BROTLI_UNALIGNED_LOAD64LE(&data[i + 16]));
+    h3 = SourceHashMix(h3, BROTLI_UNALIGNED_LOAD64LE(&data[i + 24]));
+  }
+  for (; i < size; ++i) h0 = SourceHashMix(h0, data[i]);
+  result = SourceHashMix(result, h0);
+  result = SourceHashMix(result, h1);
+  result = SourceHashMix(result, h2);
+  result = SourceHashMix(result, h3);
+  return result;
+}
+
+static void StoreU32LE(uint8_t* p, uint32_t v) {
+  p[0] = (uint8_t)v;
+  p[1] = (uint8_t)(v >> 8);
+  p[2] = (uint8_t)(v >> 16);
+  p[3] = (uint8_t)(v >> 24);
+}
+
+static void StoreU64LE(uint8_t* p, uint64_t v) {
+  StoreU32LE(p, (uint32_t)v);
+  StoreU32LE(p + 4, (uint32_t)(v >> 32));
+}
+
+static BROTLI_BOOL IsValidPreparedDictionary(const PreparedDictionary* self) {
+  return TO_BROTLI_BOOL(self &&
+      self->magic == BROTLI_PREPARED_DICTIONARY_MAGIC);
+}
+
+size_t BrotliPreparedDictionarySerializedSize(
+    const PreparedDictionary* dictionary) {
+  if (!IsValidPreparedDictionary(dictionary)) return 0;
+  return BROTLI_SERIALIZED_DICTIONARY_HEADER_SIZE + sizeof(uint32_t) *
+      (((size_t)1 << dictionary->bucket_bits) + dictionary->source_size);
+}
+
+void BrotliSerializePreparedDictionary(
+    const PreparedDictionary* dictionary, uint8_t* output) {
+  const size_t num_buckets = (size_t)1 << dictionary->bucket_bits;
+  uint8_t* p = output + BROTLI_SERIALIZED_DICTIONARY_HEADER_SIZE;
+  size_t i;
+  StoreU32LE(output, BROTLI_SERIALIZED_DICTIONARY_MAGIC);
+  StoreU32LE(output + 4, BROTLI_SERIALIZED_DICTIONARY_VERSION);
+  StoreU32LE(output + 8, dictionary->source_size);
+  StoreU32LE(output + 12, dictionary->bucket_bits);
+  StoreU32LE(output + 16, dictionary->search_depth);
+  StoreU32LE(output + 20, 0);
+  StoreU64LE(output + 24, BrotliPreparedDictionarySourceHash(
+      dictionary->source, dictionary->source_size));
+  StoreU64LE(output + 32, BrotliPreparedDictionarySourceHash(output, 32));
+  for (i = 0; i < num_buckets; ++i, p += 4) {
+    StoreU32LE(p, dictionary->heads[i]);
+  }
+  for (i = 0; i < dictionary->source_size; ++i, p += 4) {
+    StoreU32LE(p, dictionary->chain[i]);
+  }
+}
+
+PreparedDictionary* BrotliLoadPreparedDictionary(
+    MemoryManager* m, const uint8_t* image, size_t image_size,
+    const uint8_t* source, size_t source_size) {
+  const uint8_t* index = image + BROTLI_SERIALIZED_DICTIONARY_HEADER_SIZE;
+  PreparedDictionary* result;
+  uint32_t bucket_bits;
+  uint32_t search_depth;
+  size_t index_size;
+  BROTLI_BOOL in_place;
+  if (image_size < BROTLI_SERIALIZED_DICTIONARY_HEADER_SIZE) return NULL;
+  if (BROTLI_UNALIGNED_LOAD32LE(image) != BROTLI_SERIALIZED_DICTIONARY_MAGIC ||
+      BROTLI_UNALIGNED_LOAD32LE(image + 4) !=
+          BROTLI_SERIALIZED_DICTIONARY_VERSION ||
+      BROTLI_UNALIGNED_LOAD64LE(image + 32) !=
+          BrotliPreparedDictionarySourceHash(image, 32)) {
+    return NULL;
+  }
+  bucket_bits = BROTLI_UNALIGNED_LOAD32LE(image + 12);
+  search_depth = BROTLI_UNALIGNED_LOAD32LE(image + 16);
+  if (source_size > MAX_PREPARED_DICTIONARY_SIZE ||
+      BROTLI_UNALIGNED_LOAD32LE(image + 8) != source_size ||
+      bucket_bits < 1 || bucket_bits > MAX_BUCKET_BITS ||
+      search_depth < 1 || search_depth > MAX_SEARCH_DEPTH) {
+    return NULL;
+  }
+  /* Sizes are limited above, so there is no overflow even in 32-bit size_t. */
+  index_size = image_size - BROTLI_SERIALIZED_DICTIONARY_HEADER_SIZE;
+  if ((index_size & (sizeof(uint32_t) - 1)) != 0 ||
+      index_size / sizeof(uint32_t) !=
+          ((size_t)1 << bucket_bits) + source_size) {
+    return NULL;
+  }
+  /* Makes sure the index was built for this very dictionary. */
+  if (BROTLI_UNALIGNED_LOAD64LE(image + 24) !=
+      BrotliPreparedDictionarySourceHash(source, source_size)) {
+    return NULL;
+  }
+  in_place = TO_BROTLI_BOOL(BROTLI_LITTLE_ENDIAN &&
+      ((size_t)index & (sizeof(uint32_t) - 1)) == 0);
+  result = (PreparedDictionary*)BROTLI_ALLOC(m, uint8_t,
+      sizeof(PreparedDictionary) + (in_place ? 0 : index_size));
+  if (BROTLI_IS_OOM(m) || BROTLI_IS_NULL(result)) return NULL;
+  result->magic = BROTLI_PREPARED_DICTIONARY_MAGIC;
+  result->source_size = (uint32_t)source_size;
+  result->bucket_bits = bucket_bits;
+  result->search_depth = search_depth;
+  result->source = source;
+  result->free_func = m->free_func;
+  result->opaque = m->opaque;
+  if (in_place) {
+    result->heads = (const uint32_t*)index;
+  } else {
+    uint32_t* copy = (uint32_t*)&result[1];
+    size_t i;
+    for (i = 0; i < index_size / sizeof(uint32_t); ++i) {
+      copy[i] = BROTLI_UNALIGNED_LOAD32LE(index + i * sizeof(uint32_t));
+    }
+    result->heads = copy;
+  }
+  result->chain = result->heads + ((size_t)1 << bucket_bits);
+  return result;
+}
+
+void BrotliInitCompoundDictionary(CompoundDictionary* self) {
+  self->num_chunks = 0;
+  self->total_size = 0;
+  self->chunk_offsets[0] = 0;
+}
+
+BROTLI_BOOL BrotliAttachPreparedDictionary(
+    CompoundDictionary* self, const PreparedDictionary* dictionary) {
+  size_t index;
+  if (!dictionary) return BROTLI_FALSE;
+  if (dictionary->magic != BROTLI_PREPARED_DICTIONARY_MAGIC) {
+    return BROTLI_FALSE;
+  }
+  if (self->num_chunks == BROTLI_MAX_COMPOUND_DICTS) return BROTLI_FALSE;
+  if (dictionary->source_size >
+      MAX_PREPARED_DICTIONARY_SIZE - self->total_size) {
+    return BROTLI_FALSE;
+  }
+  index = self->num_chunks;
+  self->chunks[index] = dictionary;
+  self->total_size += dictionary->source_size;
+  self->chunk_offsets[index + 1] = self->total_size;
+  self->num_chunks++;
+  return BROTLI_TRUE;
+}
+
+#if defined(__cplusplus) || defined(c_plusplus)
+}  /* extern "C" */
+#endif
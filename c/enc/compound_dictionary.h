@@ -0,0 +1,128 @@
+/* Copyright 2026 The Brotli Authors. All Rights Reserved.
+
+   Distributed under MIT license.
+   See file LICENSE for detail or copy at https://opensource.org/licenses/MIT
+*/
+
+/* Custom LZ77 dictionaries ("prefix" dictionaries) for the encoder. */
+
+#ifndef BROTLI_ENC_COMPOUND_DICTIONARY_H_
+#define BROTLI_ENC_COMPOUND_DICTIONARY_H_
+
+#include "../common/platform.h"
+#include <brotli/types.h>
+#include "./memory.h"
+
+#if defined(__cplusplus) || defined(c_plusplus)
+extern "C" {
+#endif
+
+/* "BRPD" in little endian. */
+#define BROTLI_PREPARED_DICTIONARY_MAGIC 0x44505242u
+
+/* Up to this many chunks could be attached to a single encoder. */
+#define BROTLI_MAX_COMPOUND_DICTS 15
+
+/* Bytes hashed to find candidate positions; also the shortest match. */
+#define BROTLI_PREPARED_DICTIONARY_HASH_LENGTH 4
+
+/* Immutable hash chain index over a piece of caller-owned data.
+
+   Index consists of
+     uint32_t heads[1 << bucket_bits];
+     uint32_t chain[source_size];
+   heads[h] is 1 + the last position with hash |h| (0 = none), chain[p] is
+   1 + the previous position with the same hash as |p| (0 = none); so walking
+   a chain visits positions from the end of dictionary, i.e. from shorter
+   to longer distances.
+
+   Index either follows the header in the same allocation, or lives in the
+   caller-owned serialized image (see BrotliLoadPreparedDictionary). Index
+   is only a hint: every candidate is verified against |source|, and
+   positions are range-checked, so a damaged index could not produce
+   invalid output. */
+typedef struct PreparedDictionary {
+  uint32_t magic;
+  uint32_t source_size;
+  uint32_t bucket_bits;
+  /* Number of chain entries inspected per lookup. */
+  uint32_t search_depth;
+  const uint8_t* source;
+  const uint32_t* heads;
+  const uint32_t* chain;
+  brotli_free_func free_func;
+  void* opaque;
+} PreparedDictionary;
+
+static BROTLI_INLINE const uint32_t* PreparedDictionaryHeads(
+    const PreparedDictionary* self) {
+  return self->heads;
+}
+
+static BROTLI_INLINE const uint32_t* PreparedDictionaryChain(
+    const PreparedDictionary* self) {
+  return self->chain;
+}
+
+static BROTLI_INLINE uint32_t PreparedDictionaryHash(
+    const uint8_t* data, uint32_t bucket_bits) {
+  uint32_t h = BROTLI_UNALIGNED_LOAD32LE(data) * 0x1E35A7BDu;
+  return h >> (32 - bucket_bits);
+}
+
+/* Chunks in the order of attachment; logically they are concatenated and
+   placed right before the first byte of the stream. */
+typedef struct CompoundDictionary {
+  size_t num_chunks;
+  size_t total_size;
+  const PreparedDictionary* chunks[BROTLI_MAX_COMPOUND_DICTS];
+  /* chunk_offsets[i] is the position of chunk i in the concatenation. */
+  size_t chunk_offsets[BROTLI_MAX_COMPOUND_DICTS + 1];
+} CompoundDictionary;
+
+BROTLI_INTERNAL PreparedDictionary* BrotliCreatePreparedDictionary(
+    MemoryManager* m, const uint8_t* source, size_t source_size, int quality);
+
+/* Serialized image layout, all fields are little-endian:
+     uint32_t magic = BROTLI_SERIALIZED_DICTIONARY_MAGIC
+     uint32_t version = BROTLI_SERIALIZED_DICTIONARY_VERSION
+     uint32_t source_size, bucket_bits, search_depth, reserved = 0
+     uint64_t source_hash  (BrotliPreparedDictionarySourceHash)
+     uint64_t header_hash  (of the 32 bytes above)
+     uint32_t heads[1 << bucket_bits]
+     uint32_t chain[source_size]
+   Header size is a multiple of 8, so a page-aligned image could be used in
+   place on little-endian platforms. */
+#define BROTLI_SERIALIZED_DICTIONARY_MAGIC 0x49505242u  /* "BRPI" */
+#define BROTLI_SERIALIZED_DICTIONARY_VERSION 1
+#define BROTLI_SERIALIZED_DICTIONARY_HEADER_SIZE 40
+
+BROTLI_INTERNAL uint64_t BrotliPreparedDictionarySourceHash(
+    const uint8_t* data, size_t size);
+
+/* Returns 0 if the dictionary is not a valid prepared one. */
+BROTLI_INTERNAL size_t BrotliPreparedDictionarySerializedSize(
+    const PreparedDictionary* dictionary);
+
+/* |output| has to be at least BrotliPreparedDictionarySerializedSize
+   bytes long. */
+BROTLI_INTERNAL void BrotliSerializePreparedDictionary(
+    const PreparedDictionary* dictionary, uint8_t* output);
+
+/* Returns NULL if image is malformed, does not match |source|, or allocation
+   failed. Index is referenced in place, if possible; otherwise it is copied.
+   Both |image| and |source| have to outlive the result. */
+BROTLI_INTERNAL PreparedDictionary* BrotliLoadPreparedDictionary(
+    MemoryManager* m, const uint8_t* image, size_t image_size,
+    const uint8_t* source, size_t source_size);
+
+BROTLI_INTERNAL void BrotliInitCompoundDictionary(CompoundDictionary* self);
+
+BROTLI_INTERNAL BROTLI_BOOL BrotliAttachPreparedDictionary(
+    CompoundDictionary* self, const PreparedDictionary* dictionary);
+
+#if defined(__cplusplus) || defined(c_plusplus)
+}  /* extern "C" */
+#endif
+
+#endif  /* BROTLI_ENC_COMPOUND_DICTIONARY_H_ */
@@ -11,6 +11,7 @@
 
 #include <stdlib.h>  /* free, malloc */
 #include <string.h>  /* memcpy, memset */
+#include <time.h>  /* clock, clock_gettime */
 
 #include "../common/constants.h"
 #include "../common/context.h"
@@ -22,6 +23,7 @@
 #include "./brotli_bit_stream.h"
 #include "./compress_fragment.h"
 #include "./compress_fragment_two_pass.h"
+#include "./compound_dictionary.h"
 #include "./encoder_dict.h"
 #include "./entropy_encode.h"
 #include "./fast_log.h"
@@ -63,6 +65,26 @@ typedef enum BrotliEncoderFlintState {
   BROTLI_FLINT_DONE = -2
 } BrotliEncoderFlintState;
 
+/* Queued output chunk in BROTLI_PARAM_SEGMENTED_OUTPUT mode. */
+typedef struct OutputSegment {
+  /* Owned allocation that holds the chunk. */
+  uint8_t* buffer;
+  size_t buffer_size;
+  /* Not yet acknowledged part of the chunk. */
+  const uint8_t* data;
+  size_t size;
+} OutputSegment;
+
+/* Entry of the BROTLI_PARAM_CHUNK_SIZE index: where the chunk starts and the
+   decoder state it depends on. */
+typedef struct ChunkEntry {
+  uint64_t compressed_offset;
+  uint64_t uncompressed_offset;
+  int dist_cache[4];
+  uint8_t prev_byte;
+  uint8_t prev_byte2;
+} ChunkEntry;
+
 typedef struct BrotliEncoderStateStruct {
   BrotliEncoderParams params;
 
@@ -95,6 +117,9 @@ typedef struct BrotliEncoderStateStruct {
   uint8_t* storage_;
 
   Hasher hasher_;
+  /* Zopfli scratch memory of quality 10 / 11; reused across input blocks of
+     one metablock, and freed before the metablock is built. */
+  ZopfliWorkspace zopfli_workspace_;
 
   /* Hash table for FAST_ONE_PASS_COMPRESSION_QUALITY mode. */
   int small_table_[1 << 10];  /* 4KiB */
@@ -135,6 +160,47 @@ typedef struct BrotliEncoderStateStruct {
   const BackwardReferenceFromDecoder* backward_references_;
   size_t back_refs_position_;
   size_t back_refs_size_;
+
+  /* BROTLI_PARAM_TARGET_SPEED support: |params.quality| is the current level,
+     |max_quality_| is the one requested by client. */
+  int max_quality_;
+  /* Encoder time spent on not yet emitted metablock, in microseconds. */
+  uint64_t pending_time_;
+  /* Last measured speed of each quality level, in KB/s; 0 if unknown. */
+  uint32_t quality_speed_[BROTLI_MAX_QUALITY + 1];
+
+  /* Number of input bytes emitted in uncompressed metablocks. */
+  size_t stored_bytes_;
+  /* Allocated when the first high-entropy block is met. Entries are wrapped
+     positions in |anchor_data_|, all below |anchor_end_|. */
+  uint32_t* anchor_table_;
+  const uint8_t* anchor_data_;
+  uint32_t anchor_end_;
+
+  /* BROTLI_PARAM_STABLE_INPUT mode: input is read from caller memory that
+     starts at |stable_input_|; ring buffer is not used. */
+  BROTLI_BOOL is_input_stable_;
+  const uint8_t* stable_input_;
+  /* Number of bytes offered at |stable_input_| so far; could be more than
+     consumed ones. */
+  uint64_t stable_input_size_;
+
+  /* BROTLI_PARAM_SEGMENTED_OUTPUT mode: produced output is moved to this
+     queue instead of being copied to the caller buffer. */
+  BROTLI_BOOL is_output_segmented_;
+  OutputSegment* segments_;
+  size_t num_segments_;
+  size_t segments_alloc_size_;
+
+  /* Number of compressed bytes produced so far, queued or not. */
+  uint64_t output_pos_;
+  /* BROTLI_PARAM_CHUNK_SIZE support: input position of the current chunk,
+     flag of the flush that ends it, and the index written at the end. */
+  uint64_t chunk_start_;
+  BROTLI_BOOL is_chunk_flush_pending_;
+  ChunkEntry* chunks_;
+  size_t num_chunks_;
+  size_t chunks_alloc_size_;
 } BrotliEncoderStateStruct;
 
 static size_t InputBlockSize(BrotliEncoderState* s) {
@@ -145,13 +211,40 @@ static uint64_t UnprocessedInputSize(BrotliEncoderState* s) {
   return s->input_pos_ - s->last_processed_pos_;
 }
 
+/* Returns the first position after |position| where WrapPosition is not
+   contiguous. */
+static uint64_t NextWrapJump(uint64_t position) {
+  const uint64_t gb = (uint64_t)1 << 30;
+  if (position < 3 * gb) return 3 * gb;
+  return 3 * gb + ((((position - 3 * gb) >> 31) + 1) << 31);
+}
+
+/* Returns the number of input bytes that still fit the current chunk. */
+static uint64_t RemainingChunkSize(BrotliEncoderState* s) {
+  const uint64_t used = s->input_pos_ - s->chunk_start_;
+  if (s->num_chunks_ == BROTLI_CHUNK_INDEX_MAX_CHUNKS) return ~(uint64_t)0;
+  if (used >= s->params.chunk_size) return 0;
+  return s->params.chunk_size - used;
+}
+
 static size_t RemainingInputBlockSize(BrotliEncoderState* s) {
   const uint64_t delta = UnprocessedInputSize(s);
   size_t block_size = InputBlockSize(s);
   if (delta >= block_size) return 0;
+  if (s->is_input_stable_) {
+    /* Blocks must not straddle WrapPosition jumps, see GetInputData. */
+    const uint64_t gap = NextWrapJump(s->last_processed_pos_) - s->input_pos_;
+    if (gap < block_size - delta) return (size_t)gap;
+  }
   return block_size - (size_t)delta;
 }
 
+/* Converts parameter value in KiB to bytes; saturates if size_t is 32-bit. */
+static size_t KiBToBytes(uint32_t value) {
+  size_t bytes = (size_t)value << 10;
+  return ((bytes >> 10) == value) ? bytes : BROTLI_SIZE_MAX;
+}
+
 BROTLI_BOOL BrotliEncoderSetParameter(
     BrotliEncoderState* state, BrotliEncoderParameter p, uint32_t value) {
   /* Changing parameters on the fly is not implemented yet. */
@@ -200,6 +293,26 @@ BROTLI_BOOL BrotliEncoderSetParameter(
       state->params.stream_offset = value;
       return BROTLI_TRUE;
 
+    case BROTLI_PARAM_TARGET_SPEED:
+      state->params.target_speed = value;
+      return BROTLI_TRUE;
+
+    case BROTLI_PARAM_STABLE_INPUT:
+      state->is_input_stable_ = TO_BROTLI_BOOL(!!value);
+      return BROTLI_TRUE;
+
+    case BROTLI_PARAM_SEGMENTED_OUTPUT:
+      state->is_output_segmented_ = TO_BROTLI_BOOL(!!value);
+      return BROTLI_TRUE;
+
+    case BROTLI_PARAM_MEMORY_LIMIT:
+      state->params.memory_limit = KiBToBytes(value);
+      return BROTLI_TRUE;
+
+    case BROTLI_PARAM_CHUNK_SIZE:
+      state->params.chunk_size = KiBToBytes(value);
+      return BROTLI_TRUE;
+
     default: return BROTLI_FALSE;
   }
 }
@@ -519,6 +632,21 @@ static void DecideOverLiteralContextModeling(const uint8_t* input,
   }
 }
 
+/* Returns the entropy of every |sample_rate|-th byte, in bits per byte. */
+static double SampledEntropy(const uint8_t* data, const size_t mask,
+                             const uint64_t start_pos, const size_t bytes,
+                             const uint32_t sample_rate) {
+  uint32_t literal_histo[256] = { 0 };
+  size_t t = (bytes + sample_rate - 1) / sample_rate;
+  uint32_t pos = (uint32_t)start_pos;
+  size_t i;
+  for (i = 0; i < t; i++) {
+    ++literal_histo[data[pos & mask]];
+    pos += sample_rate;
+  }
+  return BitsEntropy(literal_histo, 256) * sample_rate / (double)bytes;
+}
+
 static BROTLI_BOOL ShouldCompress(
     const uint8_t* data, const size_t mask, const uint64_t last_flush_pos,
     const size_t bytes, const size_t num_literals, const size_t num_commands) {
@@ -526,19 +654,9 @@ static BROTLI_BOOL ShouldCompress(
   if (bytes <= 2) return BROTLI_FALSE;
   if (num_commands < (bytes >> 8) + 2) {
     if ((double)num_literals > 0.99 * (double)bytes) {
-      uint32_t literal_histo[256] = { 0 };
-      static const uint32_t kSampleRate = 13;
       static const double kMinEntropy = 7.92;
-      const double bit_cost_threshold =
-          (double)bytes * kMinEntropy / kSampleRate;
-      size_t t = (bytes + kSampleRate - 1) / kSampleRate;
-      uint32_t pos = (uint32_t)last_flush_pos;
-      size_t i;
-      for (i = 0; i < t; i++) {
-        ++literal_histo[data[pos & mask]];
-        pos += kSampleRate;
-      }
-      if (BitsEntropy(literal_histo, 256) > bit_cost_threshold) {
+      if (SampledEntropy(data, mask, last_flush_pos, bytes, 13) >
+          kMinEntropy) {
         return BROTLI_FALSE;
       }
     }
@@ -546,6 +664,70 @@ static BROTLI_BOOL ShouldCompress(
   return BROTLI_TRUE;
 }
 
+/* Blocks shorter than this are not pre-scanned; entropy of fewer samples is
+   biased too low to be compared with 8 bits. */
+#define MIN_INCOMPRESSIBLE_SCAN_LENGTH 8192
+/* Number of remembered anchors, see LooksIncompressible. */
+#define ANCHOR_TABLE_SIZE (1u << 14)
+
+/* Predicts, before any backward reference search, that ShouldCompress would
+   reject the block. Besides sampled entropy, probes for repeats: positions
+   where 4-byte hash has the top 6 bits clear are "anchors"; as they are
+   chosen by content, a repeated string produces repeated anchors. Anchors
+   are remembered across blocks, so repeats of earlier data are found too;
+   only blocks with entropy too high for text are scanned. Block is considered
+   incompressible if its entropy is close to 8 bits and less than 1/32 of its
+   anchors start an 8-byte repeat of a previous anchor.
+   REQUIRED: block is contiguous in |data| (see RingBuffer tail). */
+static BROTLI_BOOL LooksIncompressible(BrotliEncoderState* s,
+    const uint8_t* data, const size_t mask, const uint32_t pos,
+    const size_t bytes) {
+  static const double kMinEntropy = 7.92;
+  static const double kMinScanEntropy = 7.5;
+  MemoryManager* m = &s->memory_manager_;
+  const uint8_t* block = &data[pos & mask];
+  uint32_t* anchors = s->anchor_table_;
+  size_t num_anchors = 0;
+  size_t num_repeats = 0;
+  double entropy;
+  size_t i;
+  if (bytes < MIN_INCOMPRESSIBLE_SCAN_LENGTH) return BROTLI_FALSE;
+  /* Keep at least MIN_INCOMPRESSIBLE_SCAN_LENGTH samples. */
+  entropy = SampledEntropy(data, mask, pos, bytes, (uint32_t)BROTLI_MIN(
+      size_t, 13, bytes / MIN_INCOMPRESSIBLE_SCAN_LENGTH));
+  if (entropy < kMinScanEntropy) return BROTLI_FALSE;
+  if (!anchors) {
+    anchors = BROTLI_ALLOC(m, uint32_t, ANCHOR_TABLE_SIZE);
+    if (BROTLI_IS_OOM(m) || BROTLI_IS_NULL(anchors)) return BROTLI_FALSE;
+    s->anchor_table_ = anchors;
+    s->anchor_data_ = NULL;
+  }
+  /* Positions wrapped, or BROTLI_PARAM_STABLE_INPUT moved the base of
+     |data|: old anchors do not address the same bytes anymore. */
+  if (data != s->anchor_data_ || pos < s->anchor_end_) {
+    memset(anchors, 0, ANCHOR_TABLE_SIZE * sizeof(anchors[0]));
+    s->anchor_data_ = data;
+  }
+  for (i = 0; i + 8 <= bytes; ++i) {
+    const uint32_t h = BROTLI_UNALIGNED_LOAD32LE(&block[i]) * kHashMul32;
+    if ((h >> 26) == 0) {
+      const size_t key = (h >> 12) & (ANCHOR_TABLE_SIZE - 1);
+      const uint32_t prev = anchors[key];
+      /* Only earlier positions are known to be readable. */
+      if (prev < pos + (uint32_t)i &&
+          BROTLI_UNALIGNED_LOAD64LE(&data[prev & mask]) ==
+          BROTLI_UNALIGNED_LOAD64LE(&block[i])) {
+        ++num_repeats;
+      }
+      anchors[key] = pos + (uint32_t)i;
+      ++num_anchors;
+    }
+  }
+  s->anchor_end_ = pos + (uint32_t)bytes;
+  return TO_BROTLI_BOOL(entropy > kMinEntropy &&
+                        num_repeats * 32 < num_anchors);
+}
+
 /* Chooses the literal context mode for a metablock */
 static ContextType ChooseContextMode(const BrotliEncoderParams* params,
     const uint8_t* data, const size_t pos, const size_t mask,
@@ -579,7 +761,8 @@ static void WriteMetaBlockInternal(MemoryManager* m,
                              const BlockSplitFromDecoder* literals_block_splits,
                              size_t* current_block_literals,
                              const BlockSplitFromDecoder* cmds_block_splits,
-                             size_t* current_block_cmds) {
+                             size_t* current_block_cmds,
+                             size_t* stored_bytes) {
   const uint32_t wrapped_last_flush_pos = WrapPosition(last_flush_pos);
   uint16_t last_bytes;
   uint8_t last_bytes_bits;
@@ -601,6 +784,7 @@ static void WriteMetaBlockInternal(MemoryManager* m,
     BrotliStoreUncompressedMetaBlock(is_last, data,
                                      wrapped_last_flush_pos, mask, bytes,
                                      storage_ix, storage);
+    *stored_bytes += bytes;
     return;
   }
 
@@ -672,6 +856,7 @@ static void WriteMetaBlockInternal(MemoryManager* m,
     BrotliStoreUncompressedMetaBlock(is_last, data,
                                      wrapped_last_flush_pos, mask,
                                      bytes, storage_ix, storage);
+    *stored_bytes += bytes;
   }
 }
 
@@ -701,6 +886,141 @@ static void ChooseDistanceParams(BrotliEncoderParams* params) {
       params, distance_postfix_bits, num_direct_distance_codes);
 }
 
+/* Returns the memory used by hasher tables; unknown input size is treated
+   as unbounded. */
+static size_t EstimateHasherMemory(const BrotliEncoderParams* params) {
+  BrotliEncoderParams hasher_params = *params;
+  ChooseHasher(&hasher_params, &hasher_params.hasher);
+  return HasherSize(&hasher_params, BROTLI_FALSE,
+      params->size_hint ? params->size_hint : BROTLI_SIZE_MAX);
+}
+
+/* Returns approximate peak memory used by encoder, excluding the hasher. It
+   is the sum of long-lived buffers and the largest of per-metablock ones:
+   backward reference search or metablock building (Zopfli workspace is freed
+   before metablock is built, so those do not overlap). */
+static size_t EstimateMemoryWithoutHasher(const BrotliEncoderParams* params,
+                                          BROTLI_BOOL has_ring_buffer) {
+  const size_t input_size =
+      params->size_hint ? params->size_hint : BROTLI_SIZE_MAX;
+  size_t result = sizeof(BrotliEncoderState);
+  if (params->quality == FAST_ONE_PASS_COMPRESSION_QUALITY ||
+      params->quality == FAST_TWO_PASS_COMPRESSION_QUALITY) {
+    const size_t block_size =
+        BROTLI_MIN(size_t, input_size, (size_t)1 << params->lgwin);
+    const size_t table_size =
+        HashTableSize(MaxHashTableSize(params->quality), block_size);
+    /* Small tables live in the state itself. */
+    if (table_size > (1u << 10)) result += table_size * sizeof(int);
+    if (params->quality == FAST_TWO_PASS_COMPRESSION_QUALITY) {
+      result += BROTLI_MIN(size_t, block_size,
+          kCompressFragmentTwoPassBlockSize) * (sizeof(uint32_t) + 1);
+    }
+    /* Output of a block that does not fit the client buffer. */
+    return result + 2 * block_size + 503;
+  } else {
+    const size_t block_size =
+        BROTLI_MIN(size_t, input_size, (size_t)1 << params->lgblock);
+    const size_t metablock_size =
+        BROTLI_MIN(size_t, input_size, MaxMetablockSize(params));
+    /* Metablock is emitted once it has more than 1/8 literals or commands
+       (see EncodeData). */
+    const size_t max_symbols =
+        BROTLI_MIN(size_t, metablock_size, metablock_size / 8 + block_size);
+    size_t search = 0;
+    size_t build = 0;
+    if (has_ring_buffer) {
+      result += (input_size <= block_size) ? input_size :
+          ((size_t)1 << ComputeRbBits(params)) + block_size;
+    }
+    if (params->quality < MIN_QUALITY_FOR_BLOCK_SPLIT) {
+      result += sizeof(Command) * (MAX_NUM_DELAYED_SYMBOLS + block_size);
+    } else {
+      result += sizeof(Command) * (max_symbols + block_size / 2);
+    }
+    result += 2 * metablock_size + 503;
+    if (params->quality >= ZOPFLIFICATION_QUALITY) {
+      /* Node array and cost model. */
+      search = (sizeof(ZopfliNode) + sizeof(float)) * (block_size + 2) +
+          sizeof(float) * params->dist.alphabet_size_limit;
+      if (params->quality >= HQ_ZOPFLIFICATION_QUALITY) {
+        /* Match lists; initial capacity, they grow on demand. */
+        search += (sizeof(uint32_t) + 4 * sizeof(BackwardMatch)) * block_size;
+      }
+    }
+    if (params->quality >= MIN_QUALITY_FOR_HQ_BLOCK_SPLITTING) {
+      /* Literal copy, block ids and cost bitmaps of block splitter take ~16
+         bytes per literal; there is a literal type per 544 literals, up to
+         100, and each has 64 context histograms before clustering. */
+      const size_t num_literal_types =
+          BROTLI_MIN(size_t, max_symbols / 544 + 1, 100);
+      build = 16 * max_symbols + ((2 * num_literal_types *
+          sizeof(HistogramLiteral)) << BROTLI_LITERAL_CONTEXT_BITS);
+    } else if (params->quality >= MIN_QUALITY_FOR_BLOCK_SPLIT) {
+      /* Greedy block splitter: up to 256 types in 13 contexts. */
+      build = BROTLI_MIN(size_t, metablock_size / 512 + 1,
+          BROTLI_MAX_NUMBER_OF_BLOCK_TYPES + 1) * 13 * sizeof(HistogramLiteral);
+    }
+    return result + BROTLI_MAX(size_t, search, build);
+  }
+}
+
+/* Returns peak memory estimate; the part of budget left after non-hasher
+   structures is handed to ChooseHasher. */
+static size_t EstimateMemoryWithinLimit(BrotliEncoderParams* params,
+                                        BROTLI_BOOL has_ring_buffer) {
+  const size_t limit = params->memory_limit;
+  const size_t other = EstimateMemoryWithoutHasher(params, has_ring_buffer);
+  params->hasher_memory_limit = (other < limit) ? limit - other : 1;
+  return other + EstimateHasherMemory(params);
+}
+
+/* Shrinks encoder structures until the peak memory estimate fits
+   |params->memory_limit|: hasher tables first (see ChooseHasher), then
+   metablock size, input block size and finally window size. Limits below
+   the smallest configuration are not enforced. */
+static void ApplyMemoryLimit(BrotliEncoderParams* params,
+                             BROTLI_BOOL has_ring_buffer) {
+  const size_t limit = params->memory_limit;
+  if (limit == 0) return;
+  if (params->quality == FAST_ONE_PASS_COMPRESSION_QUALITY ||
+      params->quality == FAST_TWO_PASS_COMPRESSION_QUALITY) {
+    return;
+  }
+  while (EstimateMemoryWithinLimit(params, has_ring_buffer) > limit) {
+    const int lgmetablock = ComputeLgMetablock(params);
+    if (lgmetablock > params->lgblock) {
+      params->lgmetablock = lgmetablock - 1;
+    } else if (params->lgblock > BROTLI_MIN_INPUT_BLOCK_BITS) {
+      params->lgblock--;
+      params->lgmetablock = params->lgblock;
+    } else if (params->lgwin > BROTLI_MIN_WINDOW_BITS) {
+      params->lgwin--;
+      ChooseDistanceParams(params);
+    } else {
+      break;
+    }
+  }
+}
+
+/* Starts a new chunk at the current input position. Encoder state the chunk
+   depends on, i.e. last distances and last 2 bytes, is saved to the index. */
+static BROTLI_BOOL AddChunk(BrotliEncoderState* s) {
+  MemoryManager* m = &s->memory_manager_;
+  ChunkEntry* chunk;
+  BROTLI_ENSURE_CAPACITY(m, ChunkEntry, s->chunks_, s->chunks_alloc_size_,
+      s->num_chunks_ + 1);
+  if (BROTLI_IS_OOM(m)) return BROTLI_FALSE;
+  chunk = &s->chunks_[s->num_chunks_++];
+  chunk->compressed_offset = s->output_pos_;
+  chunk->uncompressed_offset = s->input_pos_;
+  memcpy(chunk->dist_cache, s->dist_cache_, sizeof(chunk->dist_cache));
+  chunk->prev_byte = s->prev_byte_;
+  chunk->prev_byte2 = s->prev_byte2_;
+  s->chunk_start_ = s->input_pos_;
+  return BROTLI_TRUE;
+}
+
 static BROTLI_BOOL EnsureInitialized(BrotliEncoderState* s) {
   if (BROTLI_IS_OOM(&s->memory_manager_)) return BROTLI_FALSE;
   if (s->is_initialized_) return BROTLI_TRUE;
@@ -711,8 +1031,25 @@ static BROTLI_BOOL EnsureInitialized(BrotliEncoderState* s) {
   s->remaining_metadata_bytes_ = BROTLI_UINT32_MAX;
 
   SanitizeParams(&s->params);
+  if (s->params.dictionary.compound.num_chunks != 0) {
+    /* Fast one / two pass modes do not support custom dictionaries. */
+    s->params.quality = BROTLI_MAX(int, s->params.quality,
+        MAX_QUALITY_FOR_STATIC_ENTROPY_CODES);
+  }
+  if (s->params.chunk_size != 0) {
+    if (s->params.stream_offset != 0) {
+      /* Continuation of a stream could not start its own chunk index. */
+      s->params.chunk_size = 0;
+    } else {
+      /* Fast one / two pass modes compress blocks without chunk limits. */
+      s->params.quality = BROTLI_MAX(int, s->params.quality,
+          MAX_QUALITY_FOR_STATIC_ENTROPY_CODES);
+    }
+  }
   s->params.lgblock = ComputeLgBlock(&s->params);
   ChooseDistanceParams(&s->params);
+  ApplyMemoryLimit(&s->params, !s->is_input_stable_);
+  s->max_quality_ = s->params.quality;
 
   if (s->params.stream_offset != 0) {
     s->flint_ = BROTLI_FLINT_NEEDS_2_BYTES;
@@ -748,6 +1085,8 @@ static BROTLI_BOOL EnsureInitialized(BrotliEncoderState* s) {
                            s->cmd_code_, &s->cmd_code_numbits_);
   }
 
+  if (s->params.chunk_size != 0 && !AddChunk(s)) return BROTLI_FALSE;
+
   s->is_initialized_ = BROTLI_TRUE;
   return BROTLI_TRUE;
 }
@@ -760,6 +1099,12 @@ static void BrotliEncoderInitParams(BrotliEncoderParams* params) {
   params->lgblock = 0;
   params->stream_offset = 0;
   params->size_hint = 0;
+  params->target_speed = 0;
+  params->memory_limit = 0;
+  params->hasher_memory_limit = 0;
+  params->lgmetablock = 0;
+  params->chunk_size = 0;
+  params->chunk_prefix = 0;
   params->disable_literal_context_modeling = BROTLI_FALSE;
   BrotliInitEncoderDictionary(&params->dictionary);
   params->dist.distance_postfix_bits = 0;
@@ -783,6 +1128,7 @@ static void BrotliEncoderInitState(BrotliEncoderState* s) {
   s->storage_size_ = 0;
   s->storage_ = 0;
   HasherInit(&s->hasher_);
+  BrotliInitZopfliWorkspace(&s->zopfli_workspace_);
   s->large_table_ = NULL;
   s->large_table_size_ = 0;
   s->cmd_code_numbits_ = 0;
@@ -794,6 +1140,26 @@ static void BrotliEncoderInitState(BrotliEncoderState* s) {
   s->stream_state_ = BROTLI_STREAM_PROCESSING;
   s->is_last_block_emitted_ = BROTLI_FALSE;
   s->is_initialized_ = BROTLI_FALSE;
+  s->max_quality_ = 0;
+  s->pending_time_ = 0;
+  memset(s->quality_speed_, 0, sizeof(s->quality_speed_));
+  s->stored_bytes_ = 0;
+  s->anchor_table_ = NULL;
+  s->anchor_data_ = NULL;
+  s->anchor_end_ = 0;
+  s->is_input_stable_ = BROTLI_FALSE;
+  s->stable_input_ = NULL;
+  s->stable_input_size_ = 0;
+  s->is_output_segmented_ = BROTLI_FALSE;
+  s->segments_ = NULL;
+  s->num_segments_ = 0;
+  s->segments_alloc_size_ = 0;
+  s->output_pos_ = 0;
+  s->chunk_start_ = 0;
+  s->is_chunk_flush_pending_ = BROTLI_FALSE;
+  s->chunks_ = NULL;
+  s->num_chunks_ = 0;
+  s->chunks_alloc_size_ = 0;
 
   RingBufferInit(&s->ringbuffer_);
 
@@ -825,7 +1191,11 @@ BrotliEncoderState* BrotliEncoderCreateInstance(
   BrotliInitMemoryManager(
       &state->memory_manager_, alloc_func, free_func, opaque);
   BrotliEncoderInitState(state);
+  state->backward_references_ = NULL;
   state->back_refs_position_ = 0;
+  state->back_refs_size_ = 0;
+  state->literals_block_splits_decoder_ = NULL;
+  state->cmds_block_splits_decoder_ = NULL;
   state->current_block_literals_ = 0;
   state->current_block_cmds_ = 0;
   return state;
@@ -833,6 +1203,7 @@ BrotliEncoderState* BrotliEncoderCreateInstance(
 
 static void BrotliEncoderCleanupState(BrotliEncoderState* s) {
   MemoryManager* m = &s->memory_manager_;
+  size_t i;
   if (BROTLI_IS_OOM(m)) {
     BrotliWipeOutMemoryManager(m);
     return;
@@ -841,9 +1212,16 @@ static void BrotliEncoderCleanupState(BrotliEncoderState* s) {
   BROTLI_FREE(m, s->commands_);
   RingBufferFree(m, &s->ringbuffer_);
   DestroyHasher(m, &s->hasher_);
+  BrotliDestroyZopfliWorkspace(m, &s->zopfli_workspace_);
   BROTLI_FREE(m, s->large_table_);
   BROTLI_FREE(m, s->command_buf_);
   BROTLI_FREE(m, s->literal_buf_);
+  BROTLI_FREE(m, s->anchor_table_);
+  for (i = 0; i < s->num_segments_; ++i) {
+    BROTLI_FREE(m, s->segments_[i].buffer);
+  }
+  BROTLI_FREE(m, s->segments_);
+  BROTLI_FREE(m, s->chunks_);
 }
 
 /* Deinitializes and frees BrotliEncoderState instance. */
@@ -859,6 +1237,72 @@ void BrotliEncoderDestroyInstance(BrotliEncoderState* state) {
   }
 }
 
+BrotliEncoderPreparedDictionary* BrotliEncoderPrepareDictionary(
+    size_t data_size, const uint8_t* data, int quality,
+    brotli_alloc_func alloc_func, brotli_free_func free_func, void* opaque) {
+  MemoryManager m;
+  PreparedDictionary* dictionary;
+  if (!alloc_func != !free_func) return NULL;
+  BrotliInitMemoryManager(&m, alloc_func, free_func, opaque);
+  dictionary = BrotliCreatePreparedDictionary(&m, data, data_size,
+      BROTLI_MIN(int, BROTLI_MAX(int, quality, BROTLI_MIN_QUALITY),
+                 BROTLI_MAX_QUALITY));
+  if (BROTLI_IS_OOM(&m)) {
+    BrotliWipeOutMemoryManager(&m);
+    return NULL;
+  }
+  return (BrotliEncoderPreparedDictionary*)dictionary;
+}
+
+size_t BrotliEncoderGetPreparedDictionarySerializedSize(
+    const BrotliEncoderPreparedDictionary* dictionary) {
+  return BrotliPreparedDictionarySerializedSize(
+      (const PreparedDictionary*)dictionary);
+}
+
+BROTLI_BOOL BrotliEncoderSerializePreparedDictionary(
+    const BrotliEncoderPreparedDictionary* dictionary, size_t* encoded_size,
+    uint8_t* encoded) {
+  const PreparedDictionary* self = (const PreparedDictionary*)dictionary;
+  size_t size = BrotliPreparedDictionarySerializedSize(self);
+  if (size == 0 || *encoded_size < size) return BROTLI_FALSE;
+  BrotliSerializePreparedDictionary(self, encoded);
+  *encoded_size = size;
+  return BROTLI_TRUE;
+}
+
+BrotliEncoderPreparedDictionary* BrotliEncoderLoadPreparedDictionary(
+    size_t image_size, const uint8_t* image, size_t data_size,
+    const uint8_t* data, brotli_alloc_func alloc_func,
+    brotli_free_func free_func, void* opaque) {
+  MemoryManager m;
+  PreparedDictionary* dictionary;
+  if (!alloc_func != !free_func) return NULL;
+  BrotliInitMemoryManager(&m, alloc_func, free_func, opaque);
+  dictionary =
+      BrotliLoadPreparedDictionary(&m, image, image_size, data, data_size);
+  if (BROTLI_IS_OOM(&m)) {
+    BrotliWipeOutMemoryManager(&m);
+    return NULL;
+  }
+  return (BrotliEncoderPreparedDictionary*)dictionary;
+}
+
+void BrotliEncoderDestroyPreparedDictionary(
+    BrotliEncoderPreparedDictionary* dictionary) {
+  PreparedDictionary* self = (PreparedDictionary*)dictionary;
+  if (!self) return;
+  self->free_func(self->opaque, self);
+}
+
+BROTLI_BOOL BrotliEncoderAttachPreparedDictionary(BrotliEncoderState* state,
+    const BrotliEncoderPreparedDictionary* dictionary) {
+  /* Dictionary changes distance meaning, so it is fixed for the stream. */
+  if (state->is_initialized_) return BROTLI_FALSE;
+  return BrotliAttachPreparedDictionary(&state->params.dictionary.compound,
+      (const PreparedDictionary*)dictionary);
+}
+
 /*
    Copies the given input data to the internal ring buffer of the compressor.
    No processing of the data occurs at this time and this function can be
@@ -921,6 +1365,41 @@ static void CopyInputToRingBuffer(BrotliEncoderState* s,
   }
 }
 
+/* BROTLI_PARAM_STABLE_INPUT counterpart of CopyInputToRingBuffer: input is
+   only accounted, as it stays in caller memory. |available_size| is the
+   total size of the offered input, |input_size| of it is consumed.
+   Returns false if input does not continue the previously passed data. */
+static BROTLI_BOOL AppendStableInput(BrotliEncoderState* s,
+    const size_t input_size, const uint8_t* input_buffer,
+    const size_t available_size) {
+  if (!s->stable_input_) {
+    BROTLI_DCHECK(s->input_pos_ == 0);
+    s->stable_input_ = input_buffer;
+  } else if (input_buffer != s->stable_input_ + (size_t)s->input_pos_) {
+    return BROTLI_FALSE;
+  }
+  if (s->input_pos_ + available_size > s->stable_input_size_) {
+    s->stable_input_size_ = s->input_pos_ + available_size;
+  }
+  s->input_pos_ += input_size;
+  return BROTLI_TRUE;
+}
+
+/* Returns the buffer that holds input data at wrapped positions, and sets
+   |*mask| accordingly. In BROTLI_PARAM_STABLE_INPUT mode that is caller
+   memory, shifted so that wrapped positions of the current block map to their
+   input positions; metablocks never straddle the points where the shift
+   changes. */
+static const uint8_t* GetInputData(BrotliEncoderState* s, uint32_t* mask) {
+  if (s->stable_input_) {
+    *mask = (uint32_t)(BROTLI_SIZE_MAX >> 1);
+    return s->stable_input_ +
+        (size_t)(s->last_processed_pos_ - WrapPosition(s->last_processed_pos_));
+  }
+  *mask = s->ringbuffer_.mask_;
+  return s->ringbuffer_.buffer_;
+}
+
 /* Marks all input as processed.
    Returns true if position wrapping occurs. */
 static BROTLI_BOOL UpdateLastProcessedPos(BrotliEncoderState* s) {
@@ -933,8 +1412,8 @@ static BROTLI_BOOL UpdateLastProcessedPos(BrotliEncoderState* s) {
 static void ExtendLastCommand(BrotliEncoderState* s, uint32_t* bytes,
                               uint32_t* wrapped_last_processed_pos) {
   Command* last_command = &s->commands_[s->num_commands_ - 1];
-  const uint8_t* data = s->ringbuffer_.buffer_;
-  const uint32_t mask = s->ringbuffer_.mask_;
+  uint32_t mask;
+  const uint8_t* data = GetInputData(s, &mask);
   uint64_t max_backward_distance =
       (((uint64_t)1) << s->params.lgwin) - BROTLI_WINDOW_GAP;
   uint64_t last_copy_len = last_command->copy_len_ & 0x1FFFFFF;
@@ -964,6 +1443,88 @@ static void ExtendLastCommand(BrotliEncoderState* s, uint32_t* bytes,
   }
 }
 
+/* Returns CPU time consumed by the calling thread, in microseconds. */
+static uint64_t EncoderTime(void) {
+#if defined(CLOCK_THREAD_CPUTIME_ID)
+  struct timespec ts;
+  if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0) {
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+  }
+#endif
+  return (uint64_t)clock() * 1000000u / CLOCKS_PER_SEC;
+}
+
+/* Decoder-provided references and splits are consumed in stream order, at
+   the quality they were produced for; shortcuts must not skip over them. */
+static BROTLI_BOOL HasDecoderHints(const BrotliEncoderState* s) {
+  return TO_BROTLI_BOOL(s->back_refs_size_ != 0 ||
+      s->literals_block_splits_decoder_ || s->cmds_block_splits_decoder_);
+}
+
+static BROTLI_BOOL IsSpeedTargeted(const BrotliEncoderState* s) {
+  return TO_BROTLI_BOOL(s->params.target_speed != 0 &&
+      s->max_quality_ > FAST_TWO_PASS_COMPRESSION_QUALITY &&
+      !HasDecoderHints(s));
+}
+
+/* Returns the lowest quality compatible with the parameters chosen for the
+   requested quality at stream start. */
+static int MinAdaptiveQuality(const BrotliEncoderParams* params) {
+  if (params->dist.distance_postfix_bits != 0 ||
+      params->dist.num_direct_distance_codes != 0) {
+    /* Metablocks without block splitting always use NPOSTFIX = NDIRECT = 0. */
+    return MIN_QUALITY_FOR_BLOCK_SPLIT;
+  }
+  if (params->large_window) {
+    /* See SanitizeParams. */
+    return MAX_QUALITY_FOR_STATIC_ENTROPY_CODES + 1;
+  }
+  return MAX_QUALITY_FOR_STATIC_ENTROPY_CODES;
+}
+
+/* Updates quality after a metablock of |bytes| has been emitted. Quality is
+   lowered by one level when the metablock was encoded slower than
+   BROTLI_PARAM_TARGET_SPEED, and raised by one level when the next level is
+   known to be fast enough, or when there is twice the headroom to probe it.
+   If the new level needs a different hasher, the current one is dropped and
+   the next block starts with an empty one. Everything else that depends on
+   quality (ring buffer size, input block size, distance parameters) is fixed
+   at stream start and stays compatible with any level in range. */
+static void AdaptQuality(BrotliEncoderState* s, size_t bytes) {
+  MemoryManager* m = &s->memory_manager_;
+  const uint64_t target = s->params.target_speed;
+  const int quality = s->params.quality;
+  int new_quality = quality;
+  uint64_t speed;
+  if (s->pending_time_ == 0) return;  /* Too short to be measured. */
+  speed = (uint64_t)bytes * 1000u / s->pending_time_;
+  s->pending_time_ = 0;
+  s->quality_speed_[quality] =
+      speed < BROTLI_UINT32_MAX ? (uint32_t)speed : BROTLI_UINT32_MAX;
+  if (speed < target) {
+    if (quality > MinAdaptiveQuality(&s->params)) new_quality = quality - 1;
+  } else if (quality < s->max_quality_) {
+    const uint64_t next_speed = s->quality_speed_[quality + 1];
+    if (next_speed != 0 ? next_speed >= target : speed >= 2 * target) {
+      new_quality = quality + 1;
+    }
+  }
+  if (new_quality == quality) return;
+  s->params.quality = new_quality;
+  {
+    BrotliHasherParams hasher = s->params.hasher;
+    ChooseHasher(&s->params, &hasher);
+    if (hasher.type != s->params.hasher.type ||
+        hasher.bucket_bits != s->params.hasher.bucket_bits ||
+        hasher.block_bits != s->params.hasher.block_bits ||
+        hasher.hash_len != s->params.hasher.hash_len ||
+        hasher.num_last_distances_to_check !=
+            s->params.hasher.num_last_distances_to_check) {
+      /* HasherSetup allocates the new one with the next block. */
+      DestroyHasher(m, &s->hasher_);
+    }
+  }
+}
 
 /*
    Processes the accumulated input data and sets |*out_size| to the length of
@@ -983,14 +1544,16 @@ static BROTLI_BOOL EncodeData(
   const uint64_t delta = UnprocessedInputSize(s);
   uint32_t bytes = (uint32_t)delta;
   uint32_t wrapped_last_processed_pos = WrapPosition(s->last_processed_pos_);
-  uint8_t* data;
+  const uint8_t* data;
   uint32_t mask;
+  uint32_t held_back_bytes = 0;
   MemoryManager* m = &s->memory_manager_;
   ContextType literal_context_mode;
   ContextLut literal_context_lut;
+  const BROTLI_BOOL speed_targeted = IsSpeedTargeted(s);
+  const uint64_t start_time = speed_targeted ? EncoderTime() : 0;
 
-  data = s->ringbuffer_.buffer_;
-  mask = s->ringbuffer_.mask_;
+  data = GetInputData(s, &mask);
 
   /* Adding more blocks after "last" block is forbidden. */
   if (s->is_last_block_emitted_) return BROTLI_FALSE;
@@ -1055,6 +1618,65 @@ static BROTLI_BOOL EncodeData(
     *out_size = storage_ix >> 3;
     return BROTLI_TRUE;
   }
+
+  /* Incompressible block is stored right away, without hashing; data
+     processed before it is emitted as a separate metablock. Entropy of the
+     block says nothing about matches in attached dictionaries, so those
+     disable the shortcut. */
+  if (!HasDecoderHints(s) && s->params.dictionary.compound.num_chunks == 0 &&
+      LooksIncompressible(s, data, mask, wrapped_last_processed_pos, bytes)) {
+    const uint32_t pending_size =
+        (uint32_t)(s->last_processed_pos_ - s->last_flush_pos_);
+    uint8_t* storage =
+        GetBrotliStorage(s, 2 * (size_t)pending_size + 503 + bytes + 16);
+    size_t storage_ix = s->last_bytes_bits_;
+    if (BROTLI_IS_OOM(m)) return BROTLI_FALSE;
+    storage[0] = (uint8_t)s->last_bytes_;
+    storage[1] = (uint8_t)(s->last_bytes_ >> 8);
+    if (pending_size != 0) {
+      if (s->last_insert_len_ > 0) {
+        InitInsertCommand(&s->commands_[s->num_commands_++],
+                          s->last_insert_len_);
+        s->num_literals_ += s->last_insert_len_;
+        s->last_insert_len_ = 0;
+      }
+      literal_context_mode = ChooseContextMode(&s->params, data,
+          WrapPosition(s->last_flush_pos_), mask, pending_size);
+      WriteMetaBlockInternal(
+          m, data, mask, s->last_flush_pos_, pending_size, BROTLI_FALSE,
+          literal_context_mode, &s->params, s->prev_byte_, s->prev_byte2_,
+          s->num_literals_, s->num_commands_, s->commands_,
+          s->saved_dist_cache_, s->dist_cache_, &storage_ix, storage,
+          s->literals_block_splits_decoder_, &s->current_block_literals_,
+          s->cmds_block_splits_decoder_, &s->current_block_cmds_,
+          &s->stored_bytes_);
+      if (BROTLI_IS_OOM(m)) return BROTLI_FALSE;
+      s->num_commands_ = 0;
+      s->num_literals_ = 0;
+      memcpy(s->saved_dist_cache_, s->dist_cache_,
+             sizeof(s->saved_dist_cache_));
+    }
+    BrotliStoreUncompressedMetaBlock(is_last, data, wrapped_last_processed_pos,
+                                     mask, bytes, &storage_ix, storage);
+    s->stored_bytes_ += bytes;
+    s->last_bytes_ = (uint16_t)(storage[storage_ix >> 3]);
+    s->last_bytes_bits_ = storage_ix & 7u;
+    s->last_flush_pos_ = s->input_pos_;
+    if (UpdateLastProcessedPos(s)) {
+      HasherReset(&s->hasher_);
+    }
+    s->prev_byte_ = data[((uint32_t)s->last_flush_pos_ - 1) & mask];
+    s->prev_byte2_ = data[((uint32_t)s->last_flush_pos_ - 2) & mask];
+    if (speed_targeted && !is_last) {
+      s->pending_time_ += EncoderTime() - start_time;
+      AdaptQuality(s, pending_size + bytes);
+    }
+    *output = &storage[0];
+    *out_size = storage_ix >> 3;
+    return BROTLI_TRUE;
+  }
+  if (BROTLI_IS_OOM(m)) return BROTLI_FALSE;
+
   {
     /* Theoretical max number of commands is 1 per 2 bytes. */
     size_t newsize = s->num_commands_ + bytes / 2 + 1;
@@ -1074,6 +1696,17 @@ static BROTLI_BOOL EncodeData(
     }
   }
 
+  if (s->stable_input_) {
+    /* Hashers may read up to 7 bytes past the searched range; ring buffer is
+       padded for that, caller memory is not. Unless more input is offered,
+       the last bytes are emitted as literals instead. */
+    const uint64_t tail = s->stable_input_size_ - s->input_pos_;
+    if (tail < 7) {
+      held_back_bytes = BROTLI_MIN(uint32_t, bytes, 7 - (uint32_t)tail);
+      bytes -= held_back_bytes;
+    }
+  }
+
   InitOrStitchToPreviousBlock(m, &s->hasher_, data, mask, &s->params,
       wrapped_last_processed_pos, bytes, is_last);
 
@@ -1087,13 +1720,19 @@ static BROTLI_BOOL EncodeData(
   if (s->num_commands_ && s->last_insert_len_ == 0) {
     ExtendLastCommand(s, &bytes, &wrapped_last_processed_pos);
   }
+  if (s->params.chunk_size != 0) {
+    /* Block start might have been moved by ExtendLastCommand. */
+    s->params.chunk_prefix = (size_t)(s->last_processed_pos_ - s->chunk_start_ +
+        (uint32_t)(wrapped_last_processed_pos -
+            WrapPosition(s->last_processed_pos_)));
+  }
   if (s->params.quality == ZOPFLIFICATION_QUALITY) {
     BROTLI_DCHECK(s->params.hasher.type == 10);
     BrotliCreateZopfliBackwardReferences(m, bytes, wrapped_last_processed_pos,
         data, mask, literal_context_lut, &s->params,
         &s->hasher_, s->dist_cache_,
         &s->last_insert_len_, &s->commands_[s->num_commands_],
-        &s->num_commands_, &s->num_literals_);
+        &s->num_commands_, &s->num_literals_, &s->zopfli_workspace_);
     if (BROTLI_IS_OOM(m)) return BROTLI_FALSE;
   } else if (s->params.quality == HQ_ZOPFLIFICATION_QUALITY) {
     BROTLI_DCHECK(s->params.hasher.type == 10);
@@ -1101,7 +1740,7 @@ static BROTLI_BOOL EncodeData(
         data, mask, literal_context_lut, &s->params,
         &s->hasher_, s->dist_cache_,
         &s->last_insert_len_, &s->commands_[s->num_commands_],
-        &s->num_commands_, &s->num_literals_);
+        &s->num_commands_, &s->num_literals_, &s->zopfli_workspace_);
     if (BROTLI_IS_OOM(m)) return BROTLI_FALSE;
   } else {
     BrotliCreateBackwardReferences(bytes, wrapped_last_processed_pos,
@@ -1111,6 +1750,7 @@ static BROTLI_BOOL EncodeData(
         &s->num_commands_, &s->num_literals_, s->backward_references_,
         &s->back_refs_position_, s->back_refs_size_);
   }
+  s->last_insert_len_ += held_back_bytes;
   {
     const size_t max_length = MaxMetablockSize(&s->params);
     const size_t max_literals = max_length / 8;
@@ -1119,7 +1759,9 @@ static BROTLI_BOOL EncodeData(
     /* If maximal possible additional block doesn't fit metablock, flush now. */
     /* TODO: Postpone decision until next block arrives? */
     const BROTLI_BOOL next_input_fits_metablock = TO_BROTLI_BOOL(
-        processed_bytes + InputBlockSize(s) <= max_length);
+        processed_bytes + InputBlockSize(s) <= max_length &&
+        (!s->stable_input_ ||
+         s->input_pos_ != NextWrapJump(s->last_processed_pos_)));
     /* If block splitting is not used, then flush as soon as there is some
        amount of commands / literals produced. */
     const BROTLI_BOOL should_flush = TO_BROTLI_BOOL(
@@ -1133,6 +1775,7 @@ static BROTLI_BOOL EncodeData(
       if (UpdateLastProcessedPos(s)) {
         HasherReset(&s->hasher_);
       }
+      if (speed_targeted) s->pending_time_ += EncoderTime() - start_time;
       *out_size = 0;
       return BROTLI_TRUE;
     }
@@ -1157,8 +1800,11 @@ static BROTLI_BOOL EncodeData(
   {
     const uint32_t metablock_size =
         (uint32_t)(s->input_pos_ - s->last_flush_pos_);
-    uint8_t* storage = GetBrotliStorage(s, 2 * metablock_size + 503);
+    uint8_t* storage;
     size_t storage_ix = s->last_bytes_bits_;
+    /* Search is over; do not keep its memory while building metablock. */
+    BrotliDestroyZopfliWorkspace(m, &s->zopfli_workspace_);
+    storage = GetBrotliStorage(s, 2 * metablock_size + 503);
     if (BROTLI_IS_OOM(m)) return BROTLI_FALSE;
     storage[0] = (uint8_t)s->last_bytes_;
     storage[1] = (uint8_t)(s->last_bytes_ >> 8);
@@ -1168,7 +1814,7 @@ static BROTLI_BOOL EncodeData(
         s->num_literals_, s->num_commands_, s->commands_, s->saved_dist_cache_,
         s->dist_cache_, &storage_ix, storage, s->literals_block_splits_decoder_,
         &s->current_block_literals_, s->cmds_block_splits_decoder_,
-        &s->current_block_cmds_);
+        &s->current_block_cmds_, &s->stored_bytes_);
     if (BROTLI_IS_OOM(m)) return BROTLI_FALSE;
     s->last_bytes_ = (uint16_t)(storage[storage_ix >> 3]);
     s->last_bytes_bits_ = storage_ix & 7u;
@@ -1187,6 +1833,10 @@ static BROTLI_BOOL EncodeData(
     /* Save the state of the distance cache in case we need to restore it for
        emitting an uncompressed block. */
     memcpy(s->saved_dist_cache_, s->dist_cache_, sizeof(s->saved_dist_cache_));
+    if (speed_targeted && !is_last) {
+      s->pending_time_ += EncoderTime() - start_time;
+      AdaptQuality(s, metablock_size);
+    }
     *output = &storage[0];
     *out_size = storage_ix >> 3;
     return BROTLI_TRUE;
@@ -1257,7 +1907,9 @@ static BROTLI_BOOL BrotliCompressBufferQuality10(
   uint8_t prev_byte2 = 0;
 
   Hasher hasher;
+  ZopfliWorkspace workspace;
   HasherInit(&hasher);
+  BrotliInitZopfliWorkspace(&workspace);
 
   BrotliEncoderInitParams(&params);
   params.quality = 10;
@@ -1301,23 +1953,19 @@ static BROTLI_BOOL BrotliCompressBufferQuality10(
     for (block_start = metablock_start; block_start < metablock_end; ) {
       size_t block_size =
           BROTLI_MIN(size_t, metablock_end - block_start, max_block_size);
-      ZopfliNode* nodes = BROTLI_ALLOC(m, ZopfliNode, block_size + 1);
       size_t path_size;
       size_t new_cmd_alloc_size;
-      if (BROTLI_IS_OOM(m) || BROTLI_IS_NULL(nodes)) goto oom;
-      BrotliInitZopfliNodes(nodes, block_size + 1);
       StitchToPreviousBlockH10(&hasher.privat._H10, block_size, block_start,
                                input_buffer, mask);
       path_size = BrotliZopfliComputeShortestPath(m, block_size, block_start,
           input_buffer, mask, literal_context_lut, &params, dist_cache, &hasher,
-          nodes);
+          &workspace);
       if (BROTLI_IS_OOM(m)) goto oom;
       /* We allocate a command buffer in the first iteration of this loop that
          will be likely big enough for the whole metablock, so that for most
          inputs we will not have to reallocate in later iterations. We do the
-         allocation here and not before the loop, because if the input is small,
-         this will be allocated after the Zopfli cost model is freed, so this
-         will not increase peak memory usage.
+         allocation here and not before the loop, because then the size of the
+         first block is already known.
          TODO: If the first allocation is too small, increase command
          buffer size exponentially. */
       new_cmd_alloc_size = BROTLI_MAX(size_t, expected_num_commands,
@@ -1332,12 +1980,12 @@ static BROTLI_BOOL BrotliCompressBufferQuality10(
         }
         commands = new_commands;
       }
-      BrotliZopfliCreateCommands(block_size, block_start, &nodes[0], dist_cache,
-          &last_insert_len, &params, &commands[num_commands], &num_literals);
+      BrotliZopfliCreateCommands(block_size, block_start, workspace.nodes,
+          dist_cache, &last_insert_len, &params, &commands[num_commands],
+          &num_literals);
       num_commands += path_size;
       block_start += block_size;
       metablock_size += block_size;
-      BROTLI_FREE(m, nodes);
       if (num_literals > max_literals_per_metablock ||
           num_commands > max_commands_per_metablock) {
         break;
@@ -1348,6 +1996,7 @@ static BROTLI_BOOL BrotliCompressBufferQuality10(
       InitInsertCommand(&commands[num_commands++], last_insert_len);
       num_literals += last_insert_len;
     }
+    BrotliDestroyZopfliWorkspace(m, &workspace);
 
     is_last = TO_BROTLI_BOOL(metablock_start + metablock_size == input_size);
     storage = NULL;
@@ -1444,6 +2093,7 @@ static BROTLI_BOOL BrotliCompressBufferQuality10(
 
   *encoded_size = total_out_size;
   DestroyHasher(m, &hasher);
+  BrotliDestroyZopfliWorkspace(m, &workspace);
   return ok;
 
 oom:
@@ -1597,6 +2247,50 @@ static void InjectBytePaddingBlock(BrotliEncoderState* s) {
   if (seal_bits > 8) destination[1] = (uint8_t)(seal >> 8);
   if (seal_bits > 16) destination[2] = (uint8_t)(seal >> 16);
   s->available_out_ += (seal_bits + 7) >> 3;
+  s->output_pos_ += (seal_bits + 7) >> 3;
+}
+
+/* Moves pending internal output to the segment queue. Output that lives in
+   |storage_| is handed over together with the buffer, so the next block gets
+   a fresh one; small pieces in |tiny_buf_| are copied. */
+static BROTLI_BOOL PushOutputSegment(BrotliEncoderState* s) {
+  MemoryManager* m = &s->memory_manager_;
+  OutputSegment* segment;
+  if (s->num_segments_ == s->segments_alloc_size_) {
+    size_t new_size = s->segments_alloc_size_ ? 2 * s->segments_alloc_size_ : 8;
+    OutputSegment* new_segments = BROTLI_ALLOC(m, OutputSegment, new_size);
+    if (BROTLI_IS_OOM(m) || BROTLI_IS_NULL(new_segments)) return BROTLI_FALSE;
+    if (s->num_segments_ != 0) {
+      memcpy(new_segments, s->segments_,
+          s->num_segments_ * sizeof(OutputSegment));
+    }
+    BROTLI_FREE(m, s->segments_);
+    s->segments_ = new_segments;
+    s->segments_alloc_size_ = new_size;
+  }
+  segment = &s->segments_[s->num_segments_];
+  if (s->storage_ != NULL && s->next_out_ >= s->storage_ &&
+      s->next_out_ < s->storage_ + s->storage_size_) {
+    segment->buffer = s->storage_;
+    segment->buffer_size = s->storage_size_;
+    segment->data = s->next_out_;
+    s->storage_ = NULL;
+    s->storage_size_ = 0;
+  } else {
+    segment->buffer = BROTLI_ALLOC(m, uint8_t, s->available_out_);
+    if (BROTLI_IS_OOM(m) || BROTLI_IS_NULL(segment->buffer)) {
+      return BROTLI_FALSE;
+    }
+    memcpy(segment->buffer, s->next_out_, s->available_out_);
+    segment->buffer_size = s->available_out_;
+    segment->data = segment->buffer;
+  }
+  segment->size = s->available_out_;
+  s->num_segments_++;
+  /* Detached buffer must not be appended to by InjectBytePaddingBlock. */
+  s->next_out_ = NULL;
+  s->available_out_ = 0;
+  return BROTLI_TRUE;
 }
 
 /* Injects padding bits or pushes compressed data to output.
@@ -1609,6 +2303,10 @@ static BROTLI_BOOL InjectFlushOrPushOutput(BrotliEncoderState* s,
     return BROTLI_TRUE;
   }
 
+  if (s->available_out_ != 0 && s->is_output_segmented_) {
+    return PushOutputSegment(s);
+  }
+
   if (s->available_out_ != 0 && *available_out != 0) {
     size_t copy_output_size =
         BROTLI_MIN(size_t, s->available_out_, *available_out);
@@ -1757,6 +2455,57 @@ static BROTLI_BOOL BrotliEncoderCompressStreamFast(
   return BROTLI_TRUE;
 }
 
+static void StoreChunkIndexNumber(uint8_t* p, uint64_t value, size_t size) {
+  size_t i;
+  for (i = 0; i < size; ++i) p[i] = (uint8_t)(value >> (8 * i));
+}
+
+/* Finishes chunked stream: emits the chunk index as a metadata block followed
+   by an empty last meta-block. Output must be flushed and byte aligned. */
+static BROTLI_BOOL WriteChunkIndex(BrotliEncoderState* s) {
+  const size_t payload_size = BROTLI_CHUNK_INDEX_HEADER_SIZE +
+      s->num_chunks_ * BROTLI_CHUNK_INDEX_ENTRY_SIZE +
+      BROTLI_CHUNK_INDEX_FOOTER_SIZE;
+  uint8_t* storage = GetBrotliStorage(s, 16 + payload_size + 1);
+  uint8_t* p;
+  size_t header_size;
+  size_t i;
+  int j;
+  if (BROTLI_IS_OOM(&s->memory_manager_)) return BROTLI_FALSE;
+  header_size = WriteMetadataHeader(s, payload_size, storage);
+  p = storage + header_size;
+  StoreChunkIndexNumber(p, BROTLI_CHUNK_INDEX_MAGIC, 4);
+  p[4] = BROTLI_CHUNK_INDEX_VERSION;
+  p[5] = (uint8_t)(s->params.lgwin | (s->params.large_window ? 0x80 : 0));
+  p[6] = 0;
+  p[7] = 0;
+  StoreChunkIndexNumber(p + 8, s->num_chunks_, 4);
+  StoreChunkIndexNumber(p + 12, s->input_pos_, 8);
+  StoreChunkIndexNumber(p + 20, s->output_pos_, 8);
+  p += BROTLI_CHUNK_INDEX_HEADER_SIZE;
+  for (i = 0; i < s->num_chunks_; ++i) {
+    const ChunkEntry* chunk = &s->chunks_[i];
+    StoreChunkIndexNumber(p, chunk->compressed_offset, 8);
+    StoreChunkIndexNumber(p + 8, chunk->uncompressed_offset, 8);
+    for (j = 0; j < 4; ++j) {
+      StoreChunkIndexNumber(p + 16 + 4 * j, (uint32_t)chunk->dist_cache[j], 4);
+    }
+    p[32] = chunk->prev_byte;
+    p[33] = chunk->prev_byte2;
+    p += BROTLI_CHUNK_INDEX_ENTRY_SIZE;
+  }
+  StoreChunkIndexNumber(p, payload_size, 4);
+  StoreChunkIndexNumber(p + 4, BROTLI_CHUNK_INDEX_MAGIC, 4);
+  /* ISLAST, ISLASTEMPTY */
+  p[BROTLI_CHUNK_INDEX_FOOTER_SIZE] = 3;
+  s->next_out_ = storage;
+  s->available_out_ = header_size + payload_size + 1;
+  s->output_pos_ += s->available_out_;
+  s->is_last_block_emitted_ = BROTLI_TRUE;
+  s->stream_state_ = BROTLI_STREAM_FINISHED;
+  return BROTLI_TRUE;
+}
+
 static BROTLI_BOOL ProcessMetadata(
     BrotliEncoderState* s, size_t* available_in, const uint8_t** next_in,
     size_t* available_out, uint8_t** next_out, size_t* total_out) {
@@ -1781,6 +2530,7 @@ static BROTLI_BOOL ProcessMetadata(
       BROTLI_BOOL result = EncodeData(s, BROTLI_FALSE, BROTLI_TRUE,
           &s->available_out_, &s->next_out_);
       if (!result) return BROTLI_FALSE;
+      s->output_pos_ += s->available_out_;
       continue;
     }
 
@@ -1788,6 +2538,7 @@ static BROTLI_BOOL ProcessMetadata(
       s->next_out_ = s->tiny_buf_.u8;
       s->available_out_ =
           WriteMetadataHeader(s, s->remaining_metadata_bytes_, s->next_out_);
+      s->output_pos_ += s->available_out_;
       s->stream_state_ = BROTLI_STREAM_METADATA_BODY;
       continue;
     } else {
@@ -1806,8 +2557,20 @@ static BROTLI_BOOL ProcessMetadata(
         *next_in += copy;
         *available_in -= copy;
         s->remaining_metadata_bytes_ -= copy;
+        s->output_pos_ += copy;
         *next_out += copy;
         *available_out -= copy;
+      } else if (s->is_output_segmented_) {
+        /* Whole metadata body becomes a single segment. */
+        uint32_t copy = s->remaining_metadata_bytes_;
+        s->next_out_ = GetBrotliStorage(s, copy);
+        if (BROTLI_IS_OOM(&s->memory_manager_)) return BROTLI_FALSE;
+        memcpy(s->next_out_, *next_in, copy);
+        *next_in += copy;
+        *available_in -= copy;
+        s->remaining_metadata_bytes_ = 0;
+        s->available_out_ = copy;
+        s->output_pos_ += copy;
       } else {
         /* This guarantees progress in "TakeOutput" workflow. */
         uint32_t copy = BROTLI_MIN(uint32_t, s->remaining_metadata_bytes_, 16);
@@ -1817,6 +2580,7 @@ static BROTLI_BOOL ProcessMetadata(
         *available_in -= copy;
         s->remaining_metadata_bytes_ -= copy;
         s->available_out_ = copy;
+        s->output_pos_ += copy;
       }
       continue;
     }
@@ -1844,7 +2608,12 @@ BROTLI_BOOL BrotliEncoderCompressStream(
     BrotliEncoderState* s, BrotliEncoderOperation op, size_t* available_in,
     const uint8_t** next_in, size_t* available_out,uint8_t** next_out,
     size_t* total_out) {
+  size_t no_output = 0;
   if (!EnsureInitialized(s)) return BROTLI_FALSE;
+  if (s->is_output_segmented_) {
+    /* Caller buffer is not used; output is queued by PushOutputSegment. */
+    available_out = &no_output;
+  }
 
   /* Unfinished metadata block; check requirements. */
   if (s->remaining_metadata_bytes_ != BROTLI_UINT32_MAX) {
@@ -1863,7 +2632,9 @@ BROTLI_BOOL BrotliEncoderCompressStream(
     return BROTLI_FALSE;
   }
 
-  if (s->stream_state_ != BROTLI_STREAM_PROCESSING && *available_in != 0) {
+  /* Chunk flush is internal; input is accepted while it is pending. */
+  if (s->stream_state_ != BROTLI_STREAM_PROCESSING && *available_in != 0 &&
+      !s->is_chunk_flush_pending_) {
     return BROTLI_FALSE;
   }
   if (s->params.quality == FAST_ONE_PASS_COMPRESSION_QUALITY ||
@@ -1877,11 +2648,22 @@ BROTLI_BOOL BrotliEncoderCompressStream(
     if (s->flint_ >= 0 && remaining_block_size > (size_t)s->flint_) {
       remaining_block_size = (size_t)s->flint_;
     }
+    /* Blocks must not cross chunk boundaries. */
+    if (s->params.chunk_size != 0 &&
+        remaining_block_size > RemainingChunkSize(s)) {
+      remaining_block_size = (size_t)RemainingChunkSize(s);
+    }
 
     if (remaining_block_size != 0 && *available_in != 0) {
       size_t copy_input_size =
           BROTLI_MIN(size_t, remaining_block_size, *available_in);
-      CopyInputToRingBuffer(s, copy_input_size, *next_in);
+      if (s->is_input_stable_) {
+        if (!AppendStableInput(s, copy_input_size, *next_in, *available_in)) {
+          return BROTLI_FALSE;
+        }
+      } else {
+        CopyInputToRingBuffer(s, copy_input_size, *next_in);
+      }
       *next_in += copy_input_size;
       *available_in -= copy_input_size;
       if (s->flint_ > 0) s->flint_ = (int8_t)(s->flint_ - (int)copy_input_size);
@@ -1899,10 +2681,35 @@ BROTLI_BOOL BrotliEncoderCompressStream(
       continue;
     }
 
+    if (s->is_chunk_flush_pending_ && s->available_out_ == 0) {
+      /* Chunk is flushed and byte aligned; start the next one, or finish
+         the stream with the chunk index. */
+      s->is_chunk_flush_pending_ = BROTLI_FALSE;
+      CheckFlushComplete(s);
+      if (*available_in == 0 && op == BROTLI_OPERATION_FINISH) {
+        if (!WriteChunkIndex(s)) return BROTLI_FALSE;
+      } else {
+        if (!AddChunk(s)) return BROTLI_FALSE;
+      }
+      continue;
+    }
+
     /* Compress data only when internal output buffer is empty, stream is not
        finished and there is no pending flush request. */
     if (s->available_out_ == 0 &&
         s->stream_state_ == BROTLI_STREAM_PROCESSING) {
+      if (s->params.chunk_size != 0 && (RemainingChunkSize(s) == 0 ||
+          (*available_in == 0 && op == BROTLI_OPERATION_FINISH))) {
+        /* Chunked stream ends with a non-last meta-block. */
+        if (!EncodeData(s, BROTLI_FALSE, BROTLI_TRUE,
+            &s->available_out_, &s->next_out_)) {
+          return BROTLI_FALSE;
+        }
+        s->output_pos_ += s->available_out_;
+        s->stream_state_ = BROTLI_STREAM_FLUSH_REQUESTED;
+        s->is_chunk_flush_pending_ = BROTLI_TRUE;
+        continue;
+      }
       if (remaining_block_size == 0 || op != BROTLI_OPERATION_PROCESS) {
         BROTLI_BOOL is_last = TO_BROTLI_BOOL(
             (*available_in == 0) && op == BROTLI_OPERATION_FINISH);
@@ -1918,6 +2725,7 @@ BROTLI_BOOL BrotliEncoderCompressStream(
         result = EncodeData(s, is_last, force_flush,
             &s->available_out_, &s->next_out_);
         if (!result) return BROTLI_FALSE;
+        s->output_pos_ += s->available_out_;
         if (force_flush) s->stream_state_ = BROTLI_STREAM_FLUSH_REQUESTED;
         if (is_last) s->stream_state_ = BROTLI_STREAM_FINISHED;
         continue;
@@ -1935,7 +2743,7 @@ BROTLI_BOOL BrotliEncoderIsFinished(BrotliEncoderState* s) {
 }
 
 BROTLI_BOOL BrotliEncoderHasMoreOutput(BrotliEncoderState* s) {
-  return TO_BROTLI_BOOL(s->available_out_ != 0);
+  return TO_BROTLI_BOOL(s->available_out_ != 0 || s->num_segments_ != 0);
 }
 
 const uint8_t* BrotliEncoderTakeOutput(BrotliEncoderState* s, size_t* size) {
@@ -1957,6 +2765,63 @@ const uint8_t* BrotliEncoderTakeOutput(BrotliEncoderState* s, size_t* size) {
   return result;
 }
 
+size_t BrotliEncoderEstimatePeakMemory(int quality, int lgwin,
+                                       size_t size_hint) {
+  BrotliEncoderParams params;
+  BrotliEncoderInitParams(&params);
+  params.quality = quality;
+  params.lgwin = lgwin;
+  params.size_hint = size_hint;
+  params.large_window = TO_BROTLI_BOOL(lgwin > BROTLI_MAX_WINDOW_BITS);
+  SanitizeParams(&params);
+  params.lgblock = ComputeLgBlock(&params);
+  ChooseDistanceParams(&params);
+  return EstimateMemoryWithoutHasher(&params, BROTLI_TRUE) +
+      EstimateHasherMemory(&params);
+}
+
+size_t BrotliEncoderGetStoredBytes(BrotliEncoderState* s) {
+  return s->stored_bytes_;
+}
+
+size_t BrotliEncoderGetOutputSegments(BrotliEncoderState* s,
+    BrotliEncoderOutputSegment* segments, size_t max_segments) {
+  size_t n = BROTLI_MIN(size_t, max_segments, s->num_segments_);
+  size_t i;
+  for (i = 0; i < n; ++i) {
+    segments[i].data = s->segments_[i].data;
+    segments[i].size = s->segments_[i].size;
+  }
+  return n;
+}
+
+void BrotliEncoderReleaseOutput(BrotliEncoderState* s, size_t size) {
+  MemoryManager* m = &s->memory_manager_;
+  size_t released = 0;
+  while (size != 0 && released < s->num_segments_) {
+    OutputSegment* segment = &s->segments_[released];
+    size_t consumed = BROTLI_MIN(size_t, size, segment->size);
+    segment->data += consumed;
+    segment->size -= consumed;
+    s->total_out_ += consumed;
+    size -= consumed;
+    if (segment->size != 0) break;
+    /* Recycle buffer for the next block, if encoder has none. */
+    if (s->storage_ == NULL) {
+      s->storage_ = segment->buffer;
+      s->storage_size_ = segment->buffer_size;
+    } else {
+      BROTLI_FREE(m, segment->buffer);
+    }
+    released++;
+  }
+  if (released != 0) {
+    s->num_segments_ -= released;
+    memmove(s->segments_, s->segments_ + released,
+        s->num_segments_ * sizeof(OutputSegment));
+  }
+}
+
 uint32_t BrotliEncoderVersion(void) {
   return BROTLI_VERSION;
 }
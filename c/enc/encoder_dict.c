@@ -23,9 +23,12 @@ void BrotliInitEncoderDictionary(BrotliEncoderDictionary* dict) {
   dict->hash_table_lengths = kStaticDictionaryHashLengths;
   dict->buckets = kStaticDictionaryBuckets;
   dict->dict_words = kStaticDictionaryWords;
+  dict->prefix_filter = kStaticDictionaryPrefixFilter;
 
   dict->cutoffTransformsCount = kCutoffTransformsCount;
   dict->cutoffTransforms = kCutoffTransforms;
+
+  BrotliInitCompoundDictionary(&dict->compound);
 }
 
 #if defined(__cplusplus) || defined(c_plusplus)
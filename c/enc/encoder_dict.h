@@ -10,6 +10,7 @@
 #include "../common/dictionary.h"
 #include "../common/platform.h"
 #include <brotli/types.h>
+#include "./compound_dictionary.h"
 #include "./static_dict_lut.h"
 
 #if defined(__cplusplus) || defined(c_plusplus)
@@ -32,6 +33,11 @@ typedef struct BrotliEncoderDictionary {
   /* from static_dict_lut.h, for slow encoder */
   const uint16_t* buckets;
   const DictWord* dict_words;
+  const uint32_t* prefix_filter;
+
+  /* Custom dictionaries attached with BrotliEncoderAttachPreparedDictionary;
+     not owned. */
+  CompoundDictionary compound;
 } BrotliEncoderDictionary;
 
 BROTLI_INTERNAL void BrotliInitEncoderDictionary(BrotliEncoderDictionary* dict);
@@ -544,6 +544,92 @@ static BROTLI_INLINE void HasherSetup(MemoryManager* m, Hasher* hasher,
   }
 }
 
+/* Searches custom dictionaries for a match better than |out|. Chunks are
+   logically placed right before the stream: byte |g| of their concatenation
+   is addressed with distance |distance_offset| + |total_size| - |g|, where
+   |distance_offset| is the furthest distance that refers to the stream
+   itself. */
+static BROTLI_INLINE void LookupCompoundDictionaryMatch(
+    const CompoundDictionary* addon, const uint8_t* data,
+    size_t ring_buffer_mask, const int* distance_cache, size_t cur_ix,
+    size_t max_length, size_t distance_offset, size_t max_distance,
+    HasherSearchResult* out) {
+  const uint8_t* s = &data[cur_ix & ring_buffer_mask];
+  size_t c = addon->num_chunks;
+  if (max_length < BROTLI_PREPARED_DICTIONARY_HASH_LENGTH) return;
+  /* Later chunks are closer, so they are visited first. */
+  while (c-- > 0) {
+    const PreparedDictionary* chunk = addon->chunks[c];
+    const uint32_t* chain = PreparedDictionaryChain(chunk);
+    const size_t base =
+        distance_offset + addon->total_size - addon->chunk_offsets[c];
+    uint32_t item = PreparedDictionaryHeads(chunk)[
+        PreparedDictionaryHash(s, chunk->bucket_bits)];
+    uint32_t depth = chunk->search_depth;
+    for (; item != 0 && depth != 0; item = chain[item - 1], --depth) {
+      const size_t pos = item - 1;
+      const size_t distance = base - pos;
+      size_t len;
+      score_t score;
+      /* Index could come from a (damaged) serialized image. */
+      if (pos >= chunk->source_size) break;
+      /* Chains go from shorter to longer distances. */
+      if (distance > max_distance) break;
+      len = FindMatchLengthWithLimit(&chunk->source[pos], s,
+          BROTLI_MIN(size_t, max_length, chunk->source_size - pos));
+      if (len < BROTLI_PREPARED_DICTIONARY_HASH_LENGTH) continue;
+      score = (distance == (size_t)distance_cache[0]) ?
+          BackwardReferenceScoreUsingLastDistance(len) :
+          BackwardReferenceScore(len, distance);
+      if (score > out->score) {
+        out->len = len;
+        out->len_code_delta = 0;
+        out->distance = distance;
+        out->score = score;
+      }
+    }
+  }
+}
+
+/* Same as LookupCompoundDictionaryMatch, but stores each match that is longer
+   than |min_length| and than the matches stored before it, so |matches| are
+   sorted by length and by distance. Returns the number of stored matches. */
+static BROTLI_INLINE size_t LookupAllCompoundDictionaryMatches(
+    const CompoundDictionary* addon, const uint8_t* data,
+    size_t ring_buffer_mask, size_t cur_ix, size_t min_length,
+    size_t max_length, size_t distance_offset, size_t max_distance,
+    BackwardMatch* matches, size_t match_limit) {
+  const uint8_t* s = &data[cur_ix & ring_buffer_mask];
+  size_t best_len = min_length;
+  size_t num_matches = 0;
+  size_t c = addon->num_chunks;
+  if (max_length < BROTLI_PREPARED_DICTIONARY_HASH_LENGTH) return 0;
+  while (c-- > 0) {
+    const PreparedDictionary* chunk = addon->chunks[c];
+    const uint32_t* chain = PreparedDictionaryChain(chunk);
+    const size_t base =
+        distance_offset + addon->total_size - addon->chunk_offsets[c];
+    uint32_t item = PreparedDictionaryHeads(chunk)[
+        PreparedDictionaryHash(s, chunk->bucket_bits)];
+    uint32_t depth = chunk->search_depth;
+    for (; item != 0 && depth != 0; item = chain[item - 1], --depth) {
+      const size_t pos = item - 1;
+      const size_t distance = base - pos;
+      size_t len;
+      if (pos >= chunk->source_size) break;
+      if (distance > max_distance) break;
+      len = FindMatchLengthWithLimit(&chunk->source[pos], s,
+          BROTLI_MIN(size_t, max_length, chunk->source_size - pos));
+      if (len > best_len && len >= BROTLI_PREPARED_DICTIONARY_HASH_LENGTH) {
+        best_len = len;
+        InitBackwardMatch(&matches[num_matches++], distance, len);
+        if (num_matches == match_limit) return num_matches;
+      }
+    }
+  }
+  return num_matches;
+}
+
 static BROTLI_INLINE void InitOrStitchToPreviousBlock(
     MemoryManager* m, Hasher* hasher, const uint8_t* data, size_t mask,
     BrotliEncoderParams* params, size_t position, size_t input_size,
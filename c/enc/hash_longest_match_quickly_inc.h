@@ -169,7 +169,8 @@ static BROTLI_INLINE void FN(FindLongestMatch)(
 
   size_t cached_backward = (size_t)distance_cache[0];
   size_t prev_ix = cur_ix - cached_backward;
-  if (prev_ix < cur_ix) {
+  /* Cache could hold a custom dictionary distance that exceeds the window. */
+  if (prev_ix < cur_ix && cached_backward <= max_backward) {
     prev_ix &= (uint32_t)ring_buffer_mask;
     if (compare_char == data[prev_ix + best_len]) {
       const size_t len = FindMatchLengthWithLimit(
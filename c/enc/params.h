@@ -36,6 +36,18 @@ typedef struct BrotliEncoderParams {
   int lgblock;
   size_t stream_offset;
   size_t size_hint;
+  uint32_t target_speed;
+  /* Peak memory budget in bytes; 0 if unlimited. */
+  size_t memory_limit;
+  /* Part of |memory_limit| left for hasher tables; 0 if unlimited. */
+  size_t hasher_memory_limit;
+  /* Upper limit for log2 of metablock size; 0 if derived from window. */
+  int lgmetablock;
+  /* Size of independently decodable chunks in bytes; 0 if not chunked. */
+  size_t chunk_size;
+  /* Number of bytes of the current chunk preceding the processed block;
+     backward references must not reach past the chunk start. */
+  size_t chunk_prefix;
   BROTLI_BOOL disable_literal_context_modeling;
   BROTLI_BOOL large_window;
   BrotliHasherParams hasher;
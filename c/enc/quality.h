@@ -100,11 +100,19 @@ static BROTLI_INLINE int ComputeRbBits(const BrotliEncoderParams* params) {
   return 1 + BROTLI_MAX(int, params->lgwin, params->lgblock);
 }
 
-static BROTLI_INLINE size_t MaxMetablockSize(
+static BROTLI_INLINE int ComputeLgMetablock(
     const BrotliEncoderParams* params) {
   int bits =
       BROTLI_MIN(int, ComputeRbBits(params), BROTLI_MAX_INPUT_BLOCK_BITS);
-  return (size_t)1 << bits;
+  if (params->lgmetablock != 0) {
+    bits = BROTLI_MIN(int, bits, params->lgmetablock);
+  }
+  return bits;
+}
+
+static BROTLI_INLINE size_t MaxMetablockSize(
+    const BrotliEncoderParams* params) {
+  return (size_t)1 << ComputeLgMetablock(params);
 }
 
 /* When searching for backward references and have not seen matches for a long
@@ -118,6 +126,41 @@ static BROTLI_INLINE size_t LiteralSpreeLengthForSparseSearch(
   return params->quality < 9 ? 64 : 512;
 }
 
+/* Table sizes of hashers that could be shrunk to fit memory limit; should be
+   kept in sync with HashMemAllocInBytes of corresponding hashers. */
+#define ROLLING_HASHER_MEMORY ((size_t)1 << 26)
+#define H54_HASHER_MEMORY ((size_t)1 << 22)
+
+static BROTLI_INLINE size_t BucketedHasherMemory(
+    const BrotliHasherParams* hparams) {
+  return ((size_t)1 << hparams->bucket_bits) *
+      (sizeof(uint16_t) + (sizeof(uint32_t) << hparams->block_bits));
+}
+
+/* Trades compression ratio for smaller hasher tables, until they fit into
+   |limit| bytes or could not be reduced anymore. H10 is sized by window and
+   is left as is. */
+static BROTLI_INLINE void LimitHasherMemory(size_t limit,
+                                            BrotliHasherParams* hparams) {
+  /* Large window companions are dropped first. */
+  if (limit < 2 * ROLLING_HASHER_MEMORY) {
+    if (hparams->type == 35) hparams->type = 3;
+    if (hparams->type == 55) hparams->type = 54;
+    if (hparams->type == 65) hparams->type = 6;
+  }
+  if (hparams->type == 54 && limit < H54_HASHER_MEMORY) {
+    hparams->type = 4;
+  }
+  if (hparams->type == 5 || hparams->type == 6) {
+    while (hparams->block_bits > 4 && BucketedHasherMemory(hparams) > limit) {
+      hparams->block_bits--;
+    }
+    while (hparams->bucket_bits > 12 && BucketedHasherMemory(hparams) > limit) {
+      hparams->bucket_bits--;
+    }
+  }
+}
+
 static BROTLI_INLINE void ChooseHasher(const BrotliEncoderParams* params,
                                        BrotliHasherParams* hparams) {
   if (params->quality > 9) {
@@ -160,6 +203,10 @@ static BROTLI_INLINE void ChooseHasher(const BrotliEncoderParams* params,
       hparams->type = 65;
     }
   }
+
+  if (params->hasher_memory_limit != 0) {
+    LimitHasherMemory(params->hasher_memory_limit, hparams);
+  }
 }
 
 #endif  /* BROTLI_ENC_QUALITY_H_ */
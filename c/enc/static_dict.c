@@ -23,6 +23,17 @@ static BROTLI_INLINE uint32_t Hash(const uint8_t* data) {
   return h >> (32 - kDictNumBits);
 }
 
+/* Returns false if no word (after uppercase transforms) in the bucket of
+   |data| can start with the first 4 bytes of |data|. Probing the filter is
+   cheaper than scanning the bucket, which is mostly filled by words whose
+   prefix differs. */
+static BROTLI_INLINE BROTLI_BOOL MayMatch(
+    const BrotliEncoderDictionary* dictionary, const uint8_t* data) {
+  uint32_t h = BROTLI_UNALIGNED_LOAD32LE(data) * kDictHashMul32;
+  h >>= 32 - kDictFilterBits;
+  return TO_BROTLI_BOOL((dictionary->prefix_filter[h >> 5] >> (h & 31)) & 1);
+}
+
 static BROTLI_INLINE void AddMatch(size_t distance, size_t len, size_t len_code,
                                    uint32_t* matches) {
   uint32_t match = (uint32_t)((distance << 5) + len_code);
@@ -78,7 +89,7 @@ BROTLI_BOOL BrotliFindAllStaticDictionaryMatches(
     const BrotliEncoderDictionary* dictionary, const uint8_t* data,
     size_t min_length, size_t max_length, uint32_t* matches) {
   BROTLI_BOOL has_found_match = BROTLI_FALSE;
-  {
+  if (MayMatch(dictionary, data)) {
     size_t offset = dictionary->buckets[Hash(data)];
     BROTLI_BOOL end = !offset;
     while (!end) {
@@ -322,7 +333,8 @@ BROTLI_BOOL BrotliFindAllStaticDictionaryMatches(
     }
   }
   /* Transforms with prefixes " " and "." */
-  if (max_length >= 5 && (data[0] == ' ' || data[0] == '.')) {
+  if (max_length >= 5 && (data[0] == ' ' || data[0] == '.') &&
+      MayMatch(dictionary, &data[1])) {
     BROTLI_BOOL is_space = TO_BROTLI_BOOL(data[0] == ' ');
     size_t offset = dictionary->buckets[Hash(&data[1])];
     BROTLI_BOOL end = !offset;
@@ -416,9 +428,10 @@ BROTLI_BOOL BrotliFindAllStaticDictionaryMatches(
   }
   if (max_length >= 6) {
     /* Transforms with prefixes "e ", "s ", ", " and "\xC2\xA0" */
-    if ((data[1] == ' ' &&
-         (data[0] == 'e' || data[0] == 's' || data[0] == ',')) ||
-        (data[0] == 0xC2 && data[1] == 0xA0)) {
+    if (((data[1] == ' ' &&
+          (data[0] == 'e' || data[0] == 's' || data[0] == ',')) ||
+         (data[0] == 0xC2 && data[1] == 0xA0)) &&
+        MayMatch(dictionary, &data[2])) {
       size_t offset = dictionary->buckets[Hash(&data[2])];
       BROTLI_BOOL end = !offset;
       while (!end) {
@@ -444,10 +457,11 @@ BROTLI_BOOL BrotliFindAllStaticDictionaryMatches(
   }
   if (max_length >= 9) {
     /* Transforms with prefixes " the " and ".com/" */
-    if ((data[0] == ' ' && data[1] == 't' && data[2] == 'h' &&
-         data[3] == 'e' && data[4] == ' ') ||
-        (data[0] == '.' && data[1] == 'c' && data[2] == 'o' &&
-         data[3] == 'm' && data[4] == '/')) {
+    if (((data[0] == ' ' && data[1] == 't' && data[2] == 'h' &&
+          data[3] == 'e' && data[4] == ' ') ||
+         (data[0] == '.' && data[1] == 'c' && data[2] == 'o' &&
+          data[3] == 'm' && data[4] == '/')) &&
+        MayMatch(dictionary, &data[5])) {
       size_t offset = dictionary->buckets[Hash(&data[5])];
       BROTLI_BOOL end = !offset;
       while (!end) {
@@ -25,6 +25,7 @@ static const uint32_t kInvalidMatch = 0xFFFFFFF;
    for which a match is found, updates matches[l] to be the minimum possible
      (distance << 5) + len_code.
    Returns 1 if matches have been found, otherwise 0.
+   Only matches of length 4 or more are guaranteed to be reported.
    Prerequisites:
      matches array is at least BROTLI_MAX_STATIC_DICTIONARY_MATCH_LEN + 1 long
      all elements are initialized to kInvalidMatch */
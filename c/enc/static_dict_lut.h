@@ -24,6 +24,8 @@ typedef struct DictWord {
 
 static const int kDictNumBits = 15;
 static const uint32_t kDictHashMul32 = 0x1E35A7BD;
+/* Prefix filter is indexed with the same hash, but keeps more bits of it. */
+static const int kDictFilterBits = 18;
 
 static const uint16_t kStaticDictionaryBuckets[32768] = {
 1,0,0,0,0,0,0,0,0,3,6,0,0,0,0,0,20,0,0,0,21,0,22,0,0,0,0,0,0,0,0,23,0,0,25,0,29,
@@ -5857,6 +5859,648 @@ static const DictWord kStaticDictionaryWords[31705] = {
 11,410},{9,11,660},{138,11,347}
 };
 
+/* Bit set over kDictFilterBits-bit hashes of the first 4 bytes of every
+   (transformed) word in kStaticDictionaryWords. A clear bit means no entry
+   of the corresponding bucket can match. Generated and checked by
+   tests/static_dict_filter_test.c. */
+static const uint32_t kStaticDictionaryPrefixFilter[8192] = {
+1,0,4203520,0,4,262272,0,1073741824,5505024,524418,0,256,0,16392,8192,0,2097216,
+4,0,1073807888,0,67141632,1210908676,8,67633152,0,134217736,0,4718592,256,4096,
+2147483648,128,0,139266,0,64,270540832,2097152,0,0,0,262144,0,1024,33685504,0,
+2097152,33619968,1048576,0,4608,0,2684485632,33554560,8192,512,0,0,8,524480,
+2048,0,0,256,256,8389760,0,1073741968,32,536870913,32768,0,268435456,0,65536,
+2097160,8194,524288,1122368,1048576,557056,0,0,32768,2304,524448,0,272629761,0,
+134217888,1074020352,327680,1,268435456,33554448,335544576,2097664,2,0,16,0,0,
+131136,16777216,134217800,1282,16,4096,72,256,0,2147483712,1073741832,8421952,
+33554688,2100226,1,262144,65536,4259840,172033,0,73728,0,256,268451840,0,65568,
+131072,1074008576,536936448,786464,4194304,4096,16384,8448,2147549184,128,
+16777216,128,5,32768,0,2231369728,0,16386,0,8388624,0,135168,4194320,33554560,1,
+134217736,553648256,0,65538,0,0,6,536944640,33554432,536870912,0,0,1114144,
+17301536,8,1073741824,16,294912,2,512,16,33288,1342177280,33554432,8192,128,
+8320,1,0,67108864,2147483648,8,8320,1572864,2097152,16777216,671154176,8388640,
+8388608,8192,67109376,536936704,2048,0,16781312,4784384,0,2147483648,16416,0,0,
+0,2048,537461248,33554432,73728,64,16384,1073741824,419430400,1179652,128,
+1048576,16777472,4,2181038080,524544,8192,17833985,16384,8388608,32768,1052680,
+0,0,128,2,100663296,2147483648,0,20480,138412032,536870912,268435456,0,524288,
+128,65792,1048576,8,256,256,0,536870928,2,262144,8,4096,593920,2155872256,65536,
+134217729,33554432,65536,0,2097152,1024,65536,536870912,0,32768,2281766912,
+268435456,576,0,5767296,0,1065216,67108864,0,65536,8388616,545259520,50339840,
+4194304,6291457,0,1,134217728,67633152,98304,1081344,134217728,16384,2147483648,
+512,2048,536870912,536871168,0,1064960,0,67108864,1258294336,0,0,1114112,34048,
+536871040,0,147456,4096,0,16777216,1107296256,37748736,2056,2155872256,516,2048,
+32,16400,8,0,0,184549632,0,270533634,16908288,33554433,17412,65536,4,0,41943040,
+268435712,32784,0,269485056,2147516416,0,536875010,256,573440,0,4096,2097664,32,
+0,1,0,0,134219776,0,0,0,1048576,134217728,8192,8,16908288,4096,142639104,
+545325056,65536,0,262144,0,65536,268435456,557072,0,268451840,2048,134217744,
+16777216,272629760,2363424,4194304,16777216,537919504,536870912,33587208,
+2099201,8,0,65536,0,10485762,65552,1,2147614720,0,4194306,33554960,65536,
+536870912,536870912,1073741824,0,0,16640,4096,8,131072,2097152,268435456,256,
+520,536870976,272629888,0,8192,135268352,8448,8,8388608,1280,64,2097408,
+603979776,0,268435520,0,0,69337088,0,160,1,65,268435456,0,9,2097152,32784,
+41943040,0,262664,1028,131072,2064,66048,33571336,0,1048832,0,40960,0,16,2,
+32768,0,67142656,96,257,0,67108864,0,8,49,0,32768,1,67121152,256,16777216,2,
+536879104,528384,0,0,0,8388608,268435456,0,16785680,0,32800,1099038720,26,32784,
+0,0,402718721,0,335544326,0,2176860160,512,0,0,0,1,1048576,0,142606336,2129920,
+2147483664,262656,8192,0,2,536875008,16384,17039360,32,131072,38011152,0,
+268435472,4194320,32768,83886080,25690112,8,64,269486082,0,0,1050624,537088,
+1073741824,67371008,1073742080,0,134742016,67633152,0,17825792,16778240,73728,
+1073741824,0,67109376,33554448,0,20480,0,1073741840,536870912,8,8,0,65552,0,
+1025,0,268435456,33792,8388608,2147483648,0,131200,2,0,0,0,16777216,0,16777216,
+16,268468224,671088640,10256,0,32768,301989888,4096,8388640,0,0,16777216,266368,
+67109376,8192,12583040,128,0,2149580801,65544,589824,42008608,32768,2,67109888,
+0,4096,0,276828672,1028,256,0,0,0,67108868,16785472,0,2048,1024,0,0,33816576,
+16384,1073774600,0,404750336,16384,33572867,10485760,524416,16642,32768,
+16777248,134266880,2,32768,0,2097440,268437504,1075838976,2097408,33816592,
+2147483648,32,0,134217730,2359552,0,8388612,0,0,1638400,8,0,537919488,33554432,
+0,134217728,0,64,33554688,69632,4194304,2147483648,131074,8208,2097168,
+270532608,131106,2097152,0,0,0,1073741856,134217728,33554688,2961178624,
+16908288,2214592592,33554432,0,1048640,1,33554432,268435458,0,4096,536870912,0,
+134221832,1024,67108992,2048,20971600,402653184,269484288,134217728,16392,
+2155872256,0,4,134217728,2097152,0,536870944,2,6291456,33554432,0,128,0,258,
+131072,256,0,4096,0,2147483648,0,12847104,8192,2097176,32,8,0,2164260864,8,
+268435456,0,75497472,0,2,134250496,8421506,0,1,139264,0,8388608,268439808,0,
+524288,268435520,0,0,0,0,2048,1024,536870912,128,2048,4194308,1,8388608,
+67108864,1024,167837730,0,131200,41959424,1040,1073741856,268435456,262148,0,
+268435456,32768,134217728,0,262148,0,4259840,8388608,2147483656,1025,139264,
+1073742336,0,16908288,16385,0,4096,570425344,68157456,16,1048576,1024,0,512,0,
+4194304,8194,32,536870920,393216,2048,2064,16384,1073807360,524288,4194312,
+16384,0,524304,268435456,5120,0,4194304,25166080,67239940,0,0,8519762,8388752,
+524288,268445200,1073741824,16384,0,32896,32,0,536870914,0,536952832,0,67108872,
+4194304,83886592,1025,1056,1,0,8388614,512,40,285212672,0,8,0,0,4104,0,2048,
+536871488,0,545259552,1048832,66049,2148040704,8,0,1024,81,1,0,16384,33558528,
+268435456,134217728,4,0,8322,2147614720,134479872,262145,0,17440,0,66,0,4194304,
+0,16777216,1073776642,0,0,8,524288,0,0,16777226,33554464,67174400,33554464,
+262144,1,81920,589824,256,0,4,0,1124073472,1075838976,32,134217728,262148,40960,
+2147483680,524544,0,64,0,17825824,4116,8,16777284,2147483648,0,16777216,262144,
+268435728,65536,1,0,65536,1050624,512,69239296,2048,134219811,524288,262144,2,
+16386,4096,67371008,134217808,1,2304,1048576,0,37748736,67633152,557056,
+33595392,0,134217728,536872960,17408,0,1048576,8,2,8388609,2176,1073766529,1,0,
+268959744,41,0,0,538050560,545275904,0,524288,268435584,8,134217728,80,1048832,
+0,1,2147486720,2684362768,256,1049600,0,0,67108864,0,0,0,536870912,1310720,
+67633152,16777216,128,131072,4097,1,2147483648,41943072,4,131074,4096,536872962,
+142614528,4096,4194304,2147517440,0,1048576,0,671090688,2147549196,0,0,
+268435968,0,16941056,32,0,822083656,0,16777220,128,541081600,0,136314944,0,2048,
+0,262144,67633154,16384,36831232,2560,229632,268435456,4104,65536,8388608,0,
+524312,536936448,0,0,268435968,8,512,256,8421376,0,528386,67108864,4096,0,
+537067520,8388608,0,0,131072,16777216,51200,147456,0,134217728,67108868,4325890,
+0,538968128,2185265152,1048576,0,0,0,128,2097152,134217728,33554434,0,524800,
+524288,32,67125250,537395200,16384,8,0,524808,8,1342177312,0,81928,402653184,
+1048576,2148532224,4194560,1048640,2097152,64,32,75513864,4276224,8256,40,4096,
+33558528,0,4,20480,4096,4194560,0,8388608,2147483648,1073741824,134217728,32,
+263168,268435456,65536,1057344,1081408,65616,0,8,536903681,4194336,0,8388608,34,
+524288,4194306,0,0,0,268451844,1048576,268435456,8,167772417,256,0,512,16777226,
+8192,1073774656,2097216,524304,32768,524288,536870928,2684354560,0,512,34816,
+67108864,25166864,8192,75497472,512,8388608,2048,256,1073742336,43008,256,
+33554432,524288,524288,33570816,0,2147500160,0,131073,67109120,0,768,131072,
+1048608,136314880,512,2164260864,8,20480,1048576,1073741824,4096,65536,32768,8,
+8396802,0,0,2415919104,262144,133252,131072,1048576,65536,4194304,0,67371072,2,
+0,32768,512,0,0,0,0,1073741824,8388672,8336,1107304449,16897,67239936,0,8388608,
+0,4194320,2147484160,2,32768,0,0,8,32768,83886592,33554432,131072,2101376,0,
+8519712,512,524288,33554432,4096,0,67108864,0,16,134283264,264216,1073741888,
+524288,0,34603008,1152,2147483648,0,32,0,268451840,524290,18874370,49184,0,
+268501248,0,4096,512,8192,524288,33554432,134221952,0,0,4194816,1073741832,0,
+33554436,134217728,66,1074268160,100696576,1073741824,0,33562624,8388609,
+3407872,0,0,0,0,67108864,0,268435456,134283264,8388608,0,33554432,0,1074790400,
+2138114,131200,0,1048576,0,33555714,256,24,64,3,0,1028,512,73792,2147483648,0,
+2147516432,0,0,1048576,262144,0,1116160,32768,1081408,8388864,0,335806467,0,
+1048576,8194,268435456,0,0,134235152,67371008,33587200,1048576,0,33620160,256,0,
+537427984,0,536872960,0,2105344,0,0,528640,2048,128,0,1073741828,1073774593,
+1048576,268435456,1441800,0,16,3,0,524288,0,2147484672,1179654,134217728,0,0,
+268435472,268435456,1056768,16384,0,32776,0,134217728,67117312,0,83886096,
+524288,805310464,6144,4096,5120,268468224,0,2097152,67108864,0,34603008,5,0,0,2,
+8392704,0,8,4104,0,0,65536,16777216,131072,64,1589248,0,0,131072,32,268435456,8,
+8421384,1612779520,67108864,1,4,17,0,0,33554432,256,131088,32768,33554434,0,0,
+134217728,0,134217728,1077936128,0,32768,0,4096,536870912,67108864,512,32,
+131136,4194816,1073741834,0,67584,33589248,65536,16777232,67109376,4194304,265,
+2097152,16908288,268468224,0,536870928,0,0,524800,67108864,10485760,4194432,
+1048576,134283265,0,8388608,807403520,16912384,4096,37748736,0,540672,8,524288,
+2147483648,0,2097152,268436480,2147483648,67109120,33554496,16,0,0,301993984,0,
+142606336,65792,134217728,268437568,132096,32,1081344,67108864,0,67108872,0,0,
+33554432,0,0,0,2147483648,1048576,8519680,0,12800,1,0,526336,4096,17563650,
+1048580,0,48,65536,16400,2097160,16785408,134217728,8,2621472,4194304,66560,4,
+67108864,2048,0,8388609,402655232,1073742920,16,4196352,64,4096,128,0,8192,
+2155872272,1114192,671219712,2080,16777216,4096,2101248,2048,1056,65536,0,
+67108896,16384,2166784,12582944,66,0,128,0,2684354560,2048,1,1048836,17825792,
+1048576,512,524352,0,536879104,33554432,34079232,0,536936448,1048576,0,0,4100,0,
+1310720,4,8388608,536875008,541065216,1048576,32,147585,8388608,536870912,
+536870912,16,536870912,0,16384,8683584,1048640,320,2147483648,0,32838,2097160,
+17302528,32768,16384,8192,0,536875200,67117184,1,1048576,67371008,2048,512,0,
+8388608,1048576,1048832,0,33554432,0,1073741824,524288,83951648,102760448,16,
+8392768,2,8519680,0,526344,1107296256,806355968,131104,0,2147549184,0,1048576,
+33554432,0,268435456,19169280,1052672,1025,0,0,16448,33554516,0,2,8683520,49152,
+1024,2097160,0,4096,1048577,8208,536875008,16,0,2147483680,33,16777216,0,0,
+2622528,0,1,32769,0,0,32769,131072,8454144,0,134217732,64,2097668,1,557056,
+301989920,4096,603980288,1073741824,536870912,8192,2147483648,0,40968,268435456,
+16777217,8721,0,0,0,8,0,590080,17825794,4325444,536870912,0,8912904,2097152,
+2164261504,786944,528400,0,0,16,1245200,0,196608,0,0,4458497,2097664,0,2,
+269484160,0,0,9232,67108864,50335752,16777344,524320,81920,0,4096,2147483648,0,
+8388608,163840,524288,27262976,512,1073745920,0,0,0,0,134217728,33554432,
+33554432,2097152,0,128,6,1073741889,4227072,536870912,65536,272,0,33554432,
+76546304,268435456,1,1048576,8192,0,512,2281734144,0,0,2097152,527378,128,0,
+4096,1572864,134217728,2048,33554560,128,64,18434,0,65538,268566528,8388640,
+536870914,2097156,536870912,544,0,0,0,537135104,0,805306368,33689608,68157440,0,
+0,2048,544,33554465,0,32768,0,302530560,0,134217728,33554432,0,0,8192,0,8388608,
+2147550208,81920,0,4096,0,0,2,8388608,1,0,0,16386,536870912,16384,65536,128,
+131328,131588,268468224,1048592,2147549184,536870916,2048,0,0,0,256,2,0,
+536879104,0,33554432,512,16777216,8650752,16778240,2097152,536870912,0,
+134221824,526336,8192,287309864,0,2,4194690,0,8,0,268435456,2147502104,0,0,
+268437504,32,2155872256,0,2164326416,0,2105344,33554432,131080,67108864,
+67256384,257,16842752,1024,32,12,0,2147483649,570425352,1024,0,0,4194312,0,0,
+2147483648,0,2,1073743872,2147492352,0,2281701376,2099712,0,35651600,516,262144,
+268468258,2147483680,268435456,0,134217728,2147483648,0,2147485696,10,65536,
+2048,65536,33816576,4096,0,8192,268435456,0,4096,0,2417229824,2,33554436,
+67108864,0,2424307712,134252544,0,0,65536,0,67108868,0,8192,0,0,0,2621968,
+33554464,2048,64,32770,16,524288,302055424,128,32768,1049668,1048576,512,524296,
+524289,537034752,0,268436480,0,4608,258,0,0,33574920,0,46137344,268567552,
+67108864,32768,2164260864,268435456,8388608,134365184,0,2147487744,134217732,
+2621440,1074004096,1024,524288,536870912,272,64,4194304,4098,8,8192,0,2048,
+268435456,4202512,4456456,4196552,64,16777216,262144,1048704,2097184,2621440,
+128,167772160,1048584,33800,0,256,536903688,1073741824,2147483648,0,33554432,
+1048576,65664,32,262400,4096,33554433,2097152,1024,2147483648,32,2818637824,
+2048,1441792,1,655360,268435464,536887296,34619392,136314881,67108864,536871936,
+0,16,0,32,18874368,2147500578,65536,8192,262144,134320128,524416,0,0,0,
+2155872256,16384,536870914,524800,8192,0,1048640,0,9,32768,1048576,0,134217728,
+8192,0,32768,673185792,65540,0,0,393216,33554432,2,0,0,2048,2048,0,131072,8193,
+536870920,150994946,128,0,33554432,134217728,1056832,512,1073742080,16793600,64,
+33562628,0,4096,0,1040,0,256,67108864,2097154,0,0,0,536870912,268960770,16512,
+536870913,0,4196354,0,268435456,206602240,1052672,67108864,67108880,33554432,
+134217728,262144,65536,0,132,8192,33554432,8192,16,16777216,0,0,33559040,
+8454144,0,0,0,2415919104,33554432,196608,0,0,65536,2147491842,1207959680,
+12615680,2147483648,2147483648,0,0,1024,268451840,536870944,131841,268435456,
+2151678986,0,1076101120,0,134217728,16777216,289411073,17629184,4194304,0,
+2147483649,12599296,0,0,0,4227072,0,33554432,0,4,196610,1140850688,16777250,0,
+134217728,8388640,8,1048576,2097472,2099202,536870912,0,2147483649,0,67108864,
+64,16777216,4718592,160,402657280,32768,1048577,524288,98305,1073741824,32,0,
+65536,1024,0,8470596,1,0,1,0,67207680,65536,2147483904,2155872256,1075052544,
+536904002,0,2,0,67125248,0,0,32768,4,8,134217792,384,4194320,513,0,67108864,
+1573392,2281701376,1026,0,0,2,4194304,0,0,268435458,0,0,0,0,0,8,33554432,32832,
+65536,96,0,268443652,512,1024,268437504,0,0,16777216,2684422144,808484992,
+142606344,0,33621000,0,8,33554432,2,138412032,68288516,134218241,32768,1048576,
+32768,2,0,0,0,0,268435456,0,0,8,1024,2420113408,1073741824,73728,0,544,131072,
+67108864,16779280,0,8,64,262145,524288,0,278528,0,0,65536,8388608,1,8,0,9437192,
+32768,33554434,67108928,32,16777216,1024,2148007936,0,66,2359296,2,538984448,
+268435456,4096,0,0,8650752,262144,0,0,67143680,256,66048,268435456,67109376,
+268435584,0,8388641,268435456,8,98304,599088,0,0,134217728,2147483776,128,
+268435456,16777216,2621440,16777217,139392,0,268435456,0,2097152,33556480,16,
+320,33554440,512,520,1024,262148,1024,0,807927840,131072,0,0,0,65552,0,8388608,
+33554432,34082816,4096,0,2097152,2,4100,4,8192,40960,68157440,268435456,144,
+264192,128,268967936,3149824,2147516416,67108865,134234112,0,524800,1024,0,
+537395200,196608,33554432,0,8,0,536870912,2147483648,0,4096,4194304,262400,
+524288,0,2097152,16384,0,128,604045312,3221749760,0,0,16386,0,2684354560,
+2147483648,2113,0,2304,128,33619968,0,0,16777216,134332418,12587008,33558528,0,
+128,4194320,0,0,134217736,2147483648,0,288,4194304,8196,0,1048576,16,1074266112,
+67109632,9437184,0,134217728,0,33619968,0,134217856,65536,288,131072,4194304,0,
+67108864,524352,0,4195328,131072,1048584,17432577,272646144,268435456,268435464,
+1073741824,134219776,0,8454144,528,0,256,18907200,67108864,0,2147483648,32,0,
+32768,67108864,256,8388608,256,134217730,2129920,0,0,268435456,8404992,
+134217728,528,272629760,16908288,2148532228,0,1048578,2147483648,67108864,
+50339840,134217728,526336,0,2149580802,256,73728,131076,32,156288,524288,16,
+1050624,131072,0,32,0,0,402670592,33554688,0,150994948,16,128,134217732,40960,
+8462336,16384,0,98436,0,33554432,268517378,0,4980736,64,2684354570,0,16777216,
+2080,2048,0,64,2048,4259840,0,32,542720,0,4096,8192,0,0,0,33555968,1073807360,
+268566537,524288,8404994,262144,0,256,0,4227072,256,536872960,0,2148040704,3,2,
+131072,33554944,0,18874369,544,268435456,0,1049600,536870912,18874368,0,4194304,
+0,65536,0,8388608,4,65537,197632,536905728,4098,139264,0,33792,0,262272,74,0,
+4096,2048,8,4198400,16777472,131136,268468224,16777226,536940544,2147483792,
+33792,8192,131072,536870912,0,8388672,4194560,536871170,0,2,0,4,16777216,
+268451840,67108880,268566528,128,2097152,2,67108864,131072,0,1073758208,0,0,8,0,
+8389760,131072,16,524288,0,4096,269484032,0,2048,536872960,0,16,0,8224,4227072,
+65570,1,256,2097153,0,32768,2049,16777216,8,134217728,32768,0,8388612,16,8193,
+268435456,2147483648,32768,264193,0,4194304,163840,16777472,256,0,1048576,32776,
+65552,0,537133056,8,0,589824,256,10,1048576,16392,538968064,151003136,4198400,0,
+128,1048576,0,1048576,4,4160,8650768,0,32800,268435456,2097170,0,0,256,32768,
+272695328,75497472,1,0,2048,524288,32,0,33554432,268435457,65792,8256,
+1073741824,67112976,33554432,4608,1048576,67109120,0,0,16908288,100679808,
+131072,0,1073741828,1073741824,268437504,4096,4194312,16,34078720,8,64,4194305,
+2,8925312,134217729,1024,2097152,0,0,128,4,147456,32,64,268435456,4096,65560,
+268435456,268435456,0,67125248,0,2147483648,268567552,131072,0,1073741824,0,1,
+84410368,8,536870912,262144,0,4096,131072,139264,262144,0,32768,570425600,
+1048576,0,4608,32768,4,0,2097664,4194304,8519680,0,0,1073741832,16781312,
+402653184,16777216,8388608,0,0,128,1048832,268435456,32768,134742016,270532672,
+0,33554436,512,33554560,4210690,0,16785408,163842,1056768,0,5,4128,1040,
+402653184,0,0,0,524290,536870912,524290,512,2147483648,32768,2048,1073741824,
+67371008,8388608,589824,100663296,12582912,65536,33280,0,0,2097152,33793,64,16,
+0,268435456,1073741824,2147483648,0,8192,664576,21053440,131072,16777217,0,8,
+131136,268500992,2147483648,2181038592,0,136577024,272631808,268959744,32,0,0,
+32768,2080,2097152,2097152,268435456,0,163840,0,32768,167773188,16793856,0,512,
+1024,8192,2097664,0,67584,0,12800,8264,33562624,10485766,1048576,1073758208,256,
+0,0,0,2147516416,525376,1048640,4194304,2441216,0,0,2147483648,134545408,
+268435456,64,144,20971520,16777216,536870916,34,553648128,0,536870912,64,
+134217728,1024,268435456,268435456,256,4456512,67108868,536870912,268435457,
+2050,2048,276824064,512,268436480,0,2097184,65536,0,2149580808,2147487744,
+134217728,67108866,2147483648,0,65536,545,1075904546,67108864,1107427328,532736,
+32832,256,290,8388608,1310720,67305544,0,268484608,512,268435456,4,134217728,0,
+16777344,147472,65568,2147483648,16777216,68157696,0,33554437,131072,0,0,2048,
+4194432,276824320,0,0,262144,536870912,2129920,0,0,134479872,33088,12,1048576,
+16,2147549184,2048,65544,0,2048,67125312,0,1,1048592,144,1048704,537001984,
+2147483648,32,0,42336264,8192,0,4194304,2,73728,262144,0,0,0,0,133120,33554440,
+0,16777224,0,2097160,1048576,536870912,41943040,32772,0,2147483680,131584,16,0,
+524288,545261568,537919488,0,100663360,2048,0,262144,524288,1,1048576,116736,0,
+1879048192,257,16777216,16777216,65538,0,8388608,0,512,768,0,67125249,8388610,
+16778240,0,0,0,0,150994944,16,0,524320,262144,4194304,134217728,67239936,5,
+2147764224,33554440,16777216,68157440,805310976,16777216,570425344,8,16777216,
+2129920,0,0,4096,0,268436480,512,2149580808,263240,2064,17825793,4100,262144,16,
+2151677952,2097184,16777216,32,268451840,134218752,0,256,1,0,33024,67108864,
+33554432,4196385,1,262144,65536,268517392,0,256,8240,83886082,33554434,
+1074790400,0,1073807488,6291456,0,524288,0,134348800,4096,526336,0,1056833,0,
+134217728,536870912,136,25165952,268435457,0,10485792,33554432,0,0,18,0,0,
+537001984,16385,4136,32768,277087232,0,1,2147483648,2281701376,8,268436480,512,
+2,32,262144,1048577,16777216,32776,256,262144,0,2097152,0,33554432,2147483648,0,
+81920,33554688,512,65537,1073741824,32768,142606336,134242305,32,0,262144,0,
+655360,32768,1048576,134217728,143654912,1073741824,67108864,16908352,4096,32,
+65536,0,524292,268436480,536870944,512,2097216,128,16384,0,0,2818572288,8390656,
+2147483648,0,0,33555458,0,0,8192,0,1114112,301989888,0,0,0,4,0,0,0,1073807376,
+268435458,272,1107296256,1,0,134218240,2048,8,32768,64,1081344,16384,0,0,
+16777216,16777216,33554432,0,4194432,0,537395265,134217728,1,0,0,8192,268435456,
+4,0,32768,33554432,0,0,128,528,0,136314880,17039360,268435456,0,147976,
+1207959552,163840,134217728,3221225472,512,12288,0,0,0,4194304,1048576,524288,0,
+524296,536879104,0,0,0,524420,0,128,5152,512,0,3145728,33556480,512,0,0,262144,
+136839168,0,536870912,0,134217728,33555472,65536,2097154,64,4297728,536870916,0,
+0,0,524288,872415744,64,0,0,131136,3221258248,2147485696,268435456,32,98304,
+16384,16777218,64,0,65536,2147485704,2222981120,0,34078721,0,67108864,0,557056,
+8388610,68,33563136,0,0,0,16777504,0,268435465,8256,256,536887296,32768,131200,
+2147483776,135266560,0,0,2147500032,262144,0,0,1052676,16,2048,1082196992,0,
+536870912,4292608,524304,8388608,1,16785408,128,0,0,0,268443648,0,2,0,32768,
+2147483650,0,2,268468224,16384,536969216,0,4198400,0,136,0,16785408,0,262144,
+32768,4194816,35668096,16,2048,1073741834,131200,8388608,16,0,2147483648,0,0,
+2064,134217728,131072,0,8585216,8,268435456,1048576,201457664,16,768,0,1064960,
+16777240,17,262144,2684370944,0,540672,0,8421408,32,128,0,536936512,0,16793600,
+8192,33554688,278529,134221824,0,65536,0,0,524288,8,0,524288,8704,8388608,
+524288,0,1208221704,16,67108868,131072,256,8192,0,0,134217786,192,302120996,0,
+294912,33555488,4096,131072,1073741824,2147483712,536870914,9437184,16,3,
+1073745920,134217728,0,8388608,2181039104,65536,0,262208,16842769,16777217,
+67239944,536871424,16779280,2173173792,40,17039360,512,131072,0,128,16384,
+9437184,0,32,419430528,8388610,2151677953,0,3670016,8,81920,32,201408512,
+671219728,67111040,37748736,32768,4194304,1048704,4096,1,0,0,2147483648,2228228,
+270336,9439232,34603008,266496,4194368,2,33554432,0,524288,537133056,268435456,
+64,0,65748,2415919104,0,0,22,2147483648,131072,16777216,0,9437184,0,0,
+2281702400,2147508224,0,0,268439616,4198528,8404992,0,6291456,32800,0,1638400,
+8388608,262144,0,134217728,0,0,1048576,2181038208,262144,131072,128,262144,8194,
+1,268435456,4194308,131072,537395200,4,2,327680,167772160,67108864,0,0,33555456,
+16777248,528420,0,134217728,0,33554432,4096,8390660,33554496,2147483648,16384,
+33555457,131074,4096,1024,0,2048,65666,0,0,0,0,2148630528,134217728,67125248,
+1576960,134217728,24,0,0,131072,67108880,8388608,1,256,0,1,0,8388608,0,
+134217792,65536,4198400,2147549186,0,0,65536,16777216,1,0,16777216,2148012032,
+269746176,2148016128,2147483650,268435456,536870912,134217728,0,147968,
+536870912,512,4,33554440,0,2147483648,512,16777216,536871168,8388608,68,
+2147483680,0,2359304,4104,0,0,1073807360,8389888,1,2048,128,65540,32,33554432,0,
+0,8,2048,540672,0,0,2048,134225928,8389632,4096,0,134217728,67108864,67584,
+17826336,2064,262144,0,2129920,0,1310720,1,65536,8388608,256,135168,8192,0,
+1048576,134217728,0,2147483712,65536,419446848,1073741826,2048,4263936,
+536870912,2097152,2,33554464,0,0,268451840,536870914,2048,4194304,0,43008,128,
+67108864,65536,256,288,8522112,33554433,0,0,0,16,33554432,2,671088673,0,0,
+553648128,0,0,8192,4,32772,4096,67117056,4194304,8704,64,65540,33554432,16392,
+268435464,264192,262144,41943040,0,2,32,8519808,536953027,65537,8450,0,0,147456,
+2048,0,768,1048576,134217728,16,2155872256,0,0,0,25165824,0,2,33554464,262152,
+67117056,16777232,24576,67108864,134236225,8388608,524416,0,134217760,16777472,
+128,33554472,0,0,512,33024,2097216,0,4096,16,393216,0,524288,524296,8192,
+134217728,0,8716288,32,33554432,16,1,4112,2148024320,269488256,2281725953,8192,
+0,0,16908440,8194,0,0,16891904,2684366848,32768,73740,4096,268435968,0,2050,
+4112,0,536870914,536870912,16777280,8208,2,2048,0,0,720896,0,131080,2048,0,0,0,
+0,524288,41959424,8192,786432,0,16779264,0,34603072,0,2,0,4096,32930,262144,
+16777216,4194305,134250496,1536,33792,2048,0,268435456,1179648,524288,32768,
+16777216,32,512,2214854656,0,1054752,0,0,4096,2048,262144,1081664,406847488,0,
+33,0,4458592,98304,276889600,0,98312,0,69345282,33556480,33554496,524288,
+2147483648,33536,16777217,545,285212672,0,2097152,548896,8388608,0,4096,65536,
+160,262144,0,402653184,2048,0,1048640,32,67108992,2,0,0,16384,536870912,32768,
+16777216,562036736,268439552,545261568,0,268443648,8,67141632,33280,0,32768,
+8388608,16781312,2064,4456576,0,1048576,33636352,262144,75628544,131072,
+16777216,134283264,142671872,0,1048576,8,8192,139274,8388608,524288,0,4100,
+67371520,524300,268435456,25165824,2147483652,1,0,512,768,262144,4194368,
+536870945,0,0,33554436,540672,262144,128,33554432,65536,0,272,2147491840,
+1048576,64,2050,0,4,2097152,67840,3221225730,0,0,0,33554432,524544,0,8,0,0,
+131328,4227076,0,3145728,536870912,0,33280,0,33554432,1024,0,256,65536,
+2415935764,0,1025,0,2048,268567040,67108864,16777216,128,1048836,0,2,8704,64,0,
+1028,16,32768,0,2147500040,1048576,1064960,0,0,134217728,64,8200,262144,0,0,0,
+134217728,0,67109120,65538,33554432,268439552,8388608,131584,1073741824,0,
+536870914,67141636,0,0,0,0,2097168,0,268500992,1048584,0,1073741840,8192,0,
+8388608,2099200,0,0,1310721,2359296,32784,1048576,262144,16,0,65553,2048,
+2097152,8388608,2157969408,16,0,268435458,2147483648,524288,264,268435456,
+1048577,256,64,262144,2147483648,1048576,544,4096,268435456,133120,262144,
+524288,33554480,256,16779264,134217744,25165824,8390656,32,8388609,138936864,
+65537,65,0,0,786432,0,0,0,2048,33554432,0,16777216,128,8192,0,2,32,32768,4,
+262400,0,570425600,65536,16384,4196356,268440576,33554436,0,2147483648,2097152,
+8388608,132,16777232,262144,0,2147483664,131072,67108864,0,0,268435456,0,4,
+262144,134251008,0,4194320,10240,268468480,2,0,2097152,33562688,134223872,
+2147500032,262160,16386,67108864,33554432,4352,134218240,134217760,32768,
+33554432,536870912,40960,0,48,65,0,2097152,524288,256,16908288,2147483656,
+33554432,10240,0,0,65536,2228224,1073741824,0,66560,256,2147500040,1048576,
+34095105,0,0,134217728,0,8456194,0,17563648,49152,4096,2097152,0,1073755136,
+4194304,33554432,163842,4096,2147483648,32,0,16384,0,256,64,18874384,17305600,
+262400,135528456,40960,33554432,0,33554432,150994944,65536,16777280,8388608,
+142610432,0,2717908992,16777216,537952256,16781312,0,128,0,0,0,0,2147516417,0,0,
+268435464,131336,16781312,134218240,0,17039360,64,524288,2415919104,0,8914944,
+16384,1024,557088,0,128,0,2048,0,134316032,65536,256,8390656,524800,65536,
+131072,36,128,0,0,67117060,268439552,150994952,524288,0,35651584,65536,67109376,
+0,134217728,69206016,512,16842752,8257,69632,8454144,1,0,2097152,16777216,0,
+268435456,0,0,8396928,524290,2097156,0,0,16777216,8260,0,268439810,268435456,0,
+2147483648,2064,2147614720,0,8192,2,0,8388608,1024,65536,6356992,4,1081344,
+134217728,8392708,4096,33685504,5246976,0,1179648,2147483648,1048704,2424307712,
+0,4096,134230016,590082,75497472,0,68157448,8,4194304,17956864,536871172,1,8,0,
+0,0,33554448,268435488,8912896,2147483648,1024,18,1048576,3221226496,64,0,
+33554432,0,8519680,0,134217729,65536,128,0,4608,524544,0,1610612736,136,524290,
+8388610,256,0,67108872,64,0,134348800,12,8388736,8912896,8192,2565,32768,131584,
+101711872,8519712,10,128,0,0,6291456,2147483648,0,2214592512,64,83887104,
+33554432,8388608,0,16384,8388608,0,33024,270532608,16777216,16908288,0,131080,
+8388608,0,1048596,134217728,16777728,2147484160,8192,8192,0,32,32,2147500032,18,
+32,256,0,33554432,1073741825,32,0,2097156,8192,536870912,67108864,0,12292,0,
+8388608,4608,33554432,1024,4194304,1073742336,0,8192,0,16810496,1073744896,
+2181038080,16,134217728,262144,134217760,8228,1,536870928,142606336,8388610,0,0,
+1024,1056,1057289,2129920,1024,0,65536,8,0,16,0,1073807424,2101248,2,8196,
+1073741824,64,0,0,1310721,0,268435600,16385,137,8456,66048,2155872256,671154432,
+83886080,32,8388609,2048,8,512,67698720,0,167772168,134217728,268968192,0,
+1052672,16777344,0,132109,0,0,8388624,0,67109512,262144,33554448,64,33558528,
+34078722,301990912,0,32768,8,0,1342177312,0,512,0,4,0,0,0,268435456,32768,0,0,0,
+0,268435456,32769,32768,4194304,0,0,138412048,0,8388608,335579136,0,1,67174400,
+134217736,134217728,131200,0,2097696,0,67108864,33554688,0,537001984,4263936,32,
+8392704,16,2048,8196,67108864,4194304,0,33816576,16384,0,33554432,69664,1050880,
+0,32,134218752,16384,8,524288,1025,278528,134220032,524288,16777224,256,32768,
+16908288,553697280,33558528,33554432,0,16777216,0,0,0,0,2147614721,0,67125264,0,
+6,0,128,16777216,229376,67174400,1048576,256,0,33554432,0,538968064,6356992,
+8388608,12,1,4096,2281701376,1114112,269484032,1073742336,0,133120,0,1,
+3263168512,4,134217729,1310720,1024,0,134348800,2164260880,65536,2048,2228224,
+80,524288,2149580800,16777728,8421376,16777728,16,1,8,8,262144,7864400,
+135266304,268435457,335544320,2147483648,131072,0,0,32,132,32,24576,67109120,
+40964,0,0,0,131072,2147483904,2228224,1048576,0,8192,2147491872,0,3229614080,
+2048,0,0,2048,4196352,1073741888,0,268435456,0,1028,272,0,2,134217856,4194304,0,
+0,0,0,12582912,268435712,1,2048,16777320,2147614720,1,0,536870944,8388608,
+1048608,0,0,4352,0,0,72,512,0,2147614720,0,0,1081344,1025,1082196480,2048,0,256,
+402665472,537395200,2147483680,9437184,1048576,1048584,4194304,805306368,0,33,
+2050,142606336,66,35651616,34086914,33587712,24576,16777216,0,268435456,2097152,
+8389632,1088,0,0,128,0,4,2,514,2952790016,2099202,4096,256,268533760,256,4,
+33554432,2,0,0,0,0,257,0,8,16,536875072,8192,134217732,16448,8388608,570451712,
+8388608,0,9,4292608,256,131072,0,128,1048576,0,1114112,0,2048,16,1,2228228,
+131072,0,2097152,41944064,16908288,557056,2,0,32768,65536,0,134217728,
+2684354560,1048576,1073891584,0,0,16,671350784,268435456,2048,2097168,1327104,1,
+4096,262144,0,0,2,132096,67108872,128,0,262144,0,514,1073774594,4,0,135528448,
+32768,1048576,8,8388608,0,67108864,2097152,8421376,1074004224,335544320,
+268451840,0,3,4097,1,12416,4096,4,524288,33555000,40960,4194304,8421376,0,
+1073742146,1024,256,0,537004096,128,0,0,1073774592,2048,0,136314898,262144,
+33554432,268435456,0,0,0,268501120,32768,1073742144,33554944,0,8388609,0,0,
+537001994,256,2147483648,4608,64,335544320,0,2048,16777728,69632,1084227584,0,0,
+0,69468160,0,2097216,8388608,0,64,4456456,268435460,0,0,16777217,0,144,65540,
+134283264,132,4,4,536870912,64,67108864,0,32768,16,16777216,268437504,1,32896,
+33554432,0,2147484673,0,17825792,32768,0,69206280,32768,1074003968,8716288,
+1056768,1048576,128,512,2147483648,131072,0,33554688,0,1,2147483776,2147483650,
+0,16,134218272,0,2147483788,0,0,67141632,2148532224,2147483648,67108864,524288,
+0,131072,16777346,32,335544320,134250768,524288,32770,256,257,538968064,
+16777344,8388608,0,17039360,0,0,65536,32768,0,4194320,134217984,131072,33554440,
+0,65536,536879104,0,0,0,4608,16777216,536870928,71598080,545259528,269484032,
+2048,2048,34816,16777216,8388880,172032,2097164,0,4096,32,537985024,0,
+1073741824,16777216,2624,2621440,1049600,256,1048576,4096,1048576,2097280,128,
+33558528,0,2148532224,0,0,0,0,335544320,2818572288,134217732,2147483776,
+570425376,4104,0,0,2,0,134221824,268435456,16777216,3221372928,0,0,1,2097152,
+2156920832,0,16,268435456,0,520,67584,16777216,0,8196,2147483649,0,264,16785408,
+0,0,16777472,33818624,0,65536,1048576,262144,16,16842752,1048576,589824,0,
+132096,4096,2228226,134226048,8421376,1074790400,134479876,134217737,268435456,
+32,268435968,1073741824,262144,8200,32,0,2,2147483648,16777216,18874505,0,0,0,0,
+0,16842752,0,67108864,65538,0,0,67373056,134217776,41943040,2,0,2101504,32768,
+256,134217728,32768,131072,0,0,1024,0,0,0,0,0,655360,8240,1207975936,2550136832,
+2147483652,537919488,16400,33554432,2097664,33554432,134299648,65536,16,
+2155872258,32,0,0,2048,2147483664,128,0,0,536870912,4194432,134217728,2048,
+268959744,0,16392,8388608,32768,64,0,1048594,2147484176,16,0,0,134217732,
+8391424,2064,8388610,2105648,0,514,327680,0,128,0,512,67117064,2147483648,
+16777216,0,2,8388608,0,16392,169869316,411049984,0,32,4096,0,0,4104,0,32768,
+134283264,872415232,524288,16779264,603980032,0,0,0,0,2162688,16793604,33619969,
+0,138412032,0,0,0,2147483650,0,0,0,4128,64,33554432,131200,35651584,256,1048576,
+268435456,2,0,8194,532480,32,67108864,134218242,65536,268451840,268451848,1,
+134217728,33554448,8388608,1074266112,134217856,536871172,538968064,0,0,0,0,0,
+64,0,0,2056,262144,65568,0,1024,0,805371904,128,0,272,33554432,301989892,512,8,
+16777216,65537,2,64,512,0,2214592768,2097152,0,0,0,128,2359296,540688,67112960,
+67108864,1048576,32,0,2097408,0,32768,67108864,27262976,32768,64,2147483776,1,
+16,8,67141632,34816,128,1,33554432,0,0,0,0,1073750016,2684880896,553648128,0,0,
+131072,16777216,8388608,268435456,0,16777217,8192,0,8192,32768,0,2147483648,
+67109120,0,268435456,4194304,2048,594496,270352,2160099328,0,0,0,98320,16384,
+33554688,536870976,131072,786432,67174402,268435456,2148007961,32,0,262152,8,
+537069572,402655232,0,2147487744,16384,8388640,192,8914945,16779392,32,
+335544320,32768,1048576,0,16416,16777216,10485760,16384,3,8389632,32769,196612,
+8392704,0,0,268435488,268437504,262144,33280,262144,0,81920,0,0,131072,81920,0,
+524312,268435456,256,0,1048594,0,4194304,0,134217728,134217728,1,2097412,
+71303168,1,32768,147458,1,2415919112,536870912,2048,1,0,4194432,9437252,32768,
+524288,33554432,256,131104,1073741824,574619648,536871936,0,524288,4194304,
+2147483648,536887296,0,16777352,0,40,2164260928,8,4194304,131104,16392,1048576,
+2281701376,128,1073741824,139264,0,32768,4194336,32,2684354560,536870912,0,
+16777744,0,8388608,65536,1073741824,0,0,131072,134230016,16,0,0,536872964,
+524288,131200,8,0,0,16777216,4104,64,4194304,0,67108864,34,134217730,1342439424,
+16384,67174401,4,1024,268435456,268435712,0,262160,0,0,513,130,2147483648,2048,
+5120,268435456,134217728,2048,0,65536,512,67108865,134218240,65536,0,0,1050624,
+160,1610678272,18432,131072,32768,33792,16384,167772160,524288,268441600,0,4096,
+8388608,2105344,134217728,131328,1082130432,0,32,4096,134217728,67108864,8192,
+12,8388608,32768,8455168,0,4097,37748736,524416,41943044,256,8912897,536870928,
+0,0,1,2048,16384,8,0,8,0,0,33554432,0,20971522,0,262144,20971520,262208,
+268435584,8388608,16809984,0,2048,278530,2097152,2,16,0,2097416,8193,33554560,
+2097156,2097216,1048576,67108864,134217728,1310720,0,524288,0,16,524288,32768,
+269484032,131072,0,0,128,2097152,8200,528,268435456,536875008,268451968,
+134365184,8388608,256,64,17,34817,805306368,32768,49186,8,134348800,134217728,
+69632,0,16,131074,16,528384,1073741824,67109120,16777216,2,1082130432,514,2,
+1048576,0,0,0,32776,33554432,8388608,0,0,4259912,10272,147456,1073848320,
+33619968,536870912,67108864,268435584,2048,128,256,4112,2147516418,0,268435456,
+16777728,0,0,8,1310720,64,0,16777280,1088,1073741824,2048,2147483648,32800,4353,
+0,135328,0,8,0,1122304,32768,1049088,16777217,8914944,335808513,33554432,0,
+524288,1114144,1073741824,0,2147483664,67110912,0,136317440,268435456,131072,
+4194304,1024,33595392,1179648,0,4194816,1049088,4,69632,4096,2156462080,0,0,0,
+1024,4100,8388608,0,4,0,4,4194432,4194320,0,2415919104,0,0,33554448,0,32,
+2214854672,134225920,2147500048,8192,2621952,2359296,8392704,0,0,0,32,1,0,
+8388608,2151679488,402653184,262148,2097152,0,0,2048,0,131073,1024,3,8396800,0,
+0,0,257,0,0,8519688,2147483648,134217728,67371010,268435456,0,0,0,32,134234112,
+8192,1052672,33554432,0,8192,0,0,131107,33562626,1187840,131072,4608,1183744,
+2048,65792,4096,258,0,262144,133120,4096,0,536870928,0,67108864,0,134742016,
+131072,34816,553650696,0,0,64,33280,134217728,524288,0,0,4259848,20979712,48,0,
+0,65536,2432696320,512,539492352,8218,268468352,1048576,69633,2180,33554432,
+32768,151126016,570429440,131072,131072,0,16777216,301989888,2147500032,
+2147483648,1,2189475840,17408,32768,0,0,2147483648,0,4096,65536,0,147456,32,
+1073741824,524288,0,0,1073741826,65536,0,0,2097154,2048,524288,17920,0,
+268435456,1073280,8519680,0,32,268437504,2702180384,18876416,33556480,2097152,
+4194816,0,98352,17842176,1,1,0,8454144,128,134742017,0,2684354564,3162128,
+262145,2048,272646144,8388608,287310336,1024,0,256,2670656,0,0,8388608,0,
+2621448,0,0,512,16384,0,0,67108864,256,0,33554432,32,16793600,0,33619968,0,0,
+33794,2052,2048,33554689,0,268443648,134217984,0,524288,8,33554432,0,2560,
+268451840,268435488,536870912,4,0,65536,0,0,4358144,4,4,1152,37781634,35651584,
+8519680,134217728,0,33554432,536870912,2,0,1,33624064,0,268435456,8388608,
+2097154,2,0,201327114,4,8192,131328,0,32768,16384,536871296,1056777,262144,
+1073741824,32,268437504,16777344,1,0,1090519296,536870929,33555200,131072,4104,
+1048608,66048,2097280,0,8,135184,67239936,4096,0,32768,8388608,131144,0,
+142676002,1073872896,9437184,48,0,1073741824,1589248,1048576,1,0,33554432,
+1207959552,16384,2048,570425344,1089536,134234144,0,33554432,0,4096,0,0,2050,0,
+2148270080,65536,544,16777216,8192,1610612736,0,16,1073758208,0,0,16384,
+1175486528,0,0,0,16384,134217760,69206016,0,4194304,33554432,16777216,67141632,
+1073811712,0,2,2097152,1048608,2097152,131088,134217728,262145,8388608,33554432,
+131072,0,4096,1,0,64,4100,2048,134217744,10486272,48,1024,128,0,0,2,2170880,
+268437504,134316032,0,256,67108865,0,536872960,0,268435712,8388608,18944,16,
+67108864,2101248,16384,536870912,4194304,0,131072,8208,16908288,134217728,512,
+2048,0,0,135232,66560,9,0,1073741840,1077968896,0,0,131076,2147483648,33554432,
+64,0,0,2164260864,4,0,33280,16,269500416,0,524289,12288,0,0,4352,402653184,0,
+67403776,32768,536870912,32,536870912,38273024,1145061376,134479872,1073742336,
+1,2097152,0,67110912,16,0,2147483648,67371008,134225922,25165891,0,0,268435712,
+1048704,0,4194308,0,536903688,268435458,524288,67108864,0,0,2147483648,2097408,
+268435456,2147516416,2148536320,8194,0,2101248,8388672,131072,2,8192,2181300224,
+67108864,33554433,134217728,536870912,20,2052,2048,256,0,134221824,9437184,
+16777224,0,33554432,65536,0,786432,2,4,262144,16,65536,67110912,2097152,0,
+33556992,0,134217728,1281,4206720,268435456,0,49152,134217728,0,64,17301512,
+8389634,128,2101248,2148007936,67108864,256,33554432,2099200,268435520,33554432,
+0,0,72,2416082944,0,0,0,2,36864,65544,0,0,536870912,3223322624,0,0,67141632,
+16812032,64,16777216,201326593,34848,1074282496,0,8226,32768,0,2147487744,0,
+4194308,64,16779520,2152267776,1048576,8,134250496,2181079296,134217728,0,
+526344,4,0,512,262144,32912,528384,4194313,33554440,2097664,1040,0,0,0,4,
+536870912,134217729,2,4,4,2304,1024,0,6291456,1610743872,0,262154,0,16384,1048,
+0,128,257,16,32784,0,1179648,134217736,65536,2048,40,16,268963840,1115684896,32,
+131072,33280,2147483664,0,0,0,16779264,65536,4096,16777216,4224,8912896,2,0,0,
+131168,49152,0,128,0,16648,2151677952,4194304,4,1160,16777216,1048576,268435456,
+8388624,0,65536,4,33570816,0,393216,2181038080,65568,8388608,0,1048576,2,262144,
+671219712,102764544,16809984,0,268435456,0,2048,68,8192,32,16384,4588544,
+268451874,0,32,2097152,536870912,32768,134283264,33554432,0,67108864,557568,512,
+2097152,32,268435592,256,131073,128,8388616,4194304,0,4194304,0,536969216,160,
+1050624,0,1,268435456,0,1064960,169885696,2048,65536,0,32768,268435456,8388640,
+2164531202,2147500032,2147495936,4198400,257,134217728,32784,0,16908328,1024,
+2149580800,4194304,16384,4194304,4,0,0,524288,0,67108864,1048576,268435520,
+41943040,1,50331648,0,0,96,8,0,65536,1207960064,16384,4096,2,0,33554560,1048576,
+2098176,2149597184,8389120,1,1075838976,512,268435464,151127040,17039364,
+22544384,65537,8388608,67649600,8192,2048,41943040,2048,9744,0,2097160,262152,0,
+16777217,690176,8388608,68714496,17408,2147616768,0,0,2148007936,128,536871040,
+1048576,134275082,4,67108864,520,32768,0,65536,4,0,0,0,536875008,0,2147549440,
+1048576,33556480,0,8912896,4,545259522,0,2164260865,1048576,0,131072,1296,0,
+134217738,134217728,12632080,536870916,4,128,135267328,0,256,262144,17039369,
+512,163856,1082130432,34816,4096,1073758208,0,402654208,16809984,65664,524288,
+2172649472,1,268697920,0,32769,2101250,16,0,2,0,0,0,1073741824,268705792,65537,
+134217728,0,0,131072,0,0,557056,33554432,536870912,100663296,0,1073741840,
+67108864,16,268435464,25165824,0,536875008,671088896,1025,33554432,0,0,0,
+8781824,0,0,0,16777216,2097154,4194304,0,258,4194560,1048584,130,2097152,524288,
+0,8,0,0,131072,0,8,1572928,0,0,1342242816,16384,67108864,0,512,262152,0,0,
+2105344,536870912,0,16777216,0,67108864,66,2099200,134217728,8388608,67108865,0,
+3223323144,150994944,1049600,33554432,33554432,1544,0,131072,2064,2147483648,0,
+2,33554432,2155872264,33554432,8192,16,262208,134217728,8192,67108992,2,524544,
+0,1048576,42,0,2048,536870912,4096,0,2147491844,270336,4,2560,1090519043,525312,
+1048576,1048576,65536,0,2097184,0,65536,0,1064992,4,4096,131072,0,67371016,
+167772160,0,67117184,132,18874376,1024,1024,0,33587201,0,524288,0,134348802,0,0,
+262144,8192,0,75497504,33554432,4096,0,268435456,6144,16,8,406847632,0,32768,
+2147483648,512,0,134217760,640,5120,33554433,0,0,66048,2147483664,553648128,256,
+8192,67895298,322,16777216,553648128,4096,134217760,536870912,134217728,
+12582912,524288,4608,128,536870928,1048578,0,65536,0,1,0,150994945,3,33554432,
+131072,16385,64,4,1081344,132096,393536,33554432,33566720,17039360,16,16777216,
+268435458,269484032,0,2097152,33685504,0,134217728,134217728,8658944,4194305,
+524288,8,0,0,0,0,128,0,2097153,40,162,50364672,33588224,536870912,67108864,
+134217728,0,402653184,128,4203520,131072,2097152,16392,1073872896,20480,
+268443656,1024,0,262144,0,192,134217728,268435456,16777216,4612,2097162,0,
+8388608,2228416,130,16384,0,285212672,2147500032,262144,16384,256,256,0,0,
+1065216,49152,0,16384,20480,8192,8388608,0,0,1,134217728,67108864,9437184,0,256,
+8913026,4096,32768,4194304,1050656,2097152,1,4194320,16,0,8192,1073741824,0,512,
+0,2097152,2415919104,0,128,2097152,0,0,33554432,2048,1048592,65537,2375680,0,
+34111488,8192,0,1207961600,2147484033,34816,2049,327744,0,524289,557064,
+1074790400,0,65536,2147483648,268435456,67108864,0,0,256,65536,134217728,
+537395456,4096,33555456,64,524288,16777216,2147483652,655360,2148532224,65536,
+536870912,402653184,2181038081,1075838976,17041408,0,0,32,2097152,134218240,
+16785408,1032,4227073,1048576,0,0,134217746,536870912,4227072,2147614722,160,
+131072,268435456,545260544,335544320,0,17039360,2147483648,536870922,32769,2,0,
+32768,67174400,268435456,16777216,32,0,16842752,1048576,268440064,134217728,2,0,
+67109248,1048704,1025,75563008,0,16777216,32776,2105344,536870912,0,1073741824,
+32768,0,8388608,4096,285212672,2,2048,1,2147483712,32,0,8388616,1073741904,
+33554448,269500416,0,2048,1048576,41943040,0,67584,0,8388608,32,2,128,0,144,0,0,
+4259840,262144,537919488,17825792,2,268435456,2147487746,8,1073742850,8390784,0,
+2147483656,2097152,3145736,0,1,82176,0,536894464,0,0,0,1048610,32768,2147500032,
+128,16384,16778752,1048576,0,268435456,0,0,3221225472,268828676,4096,40,
+1493172224,1056,0,16777216,2,135266432,131072,4096,0,0,134217728,268435456,
+268566544,32768,32,0,262208,0,3072,32768,16384,66305,69888,67108864,0,32768,
+16777346,2164342784,0,0,0,0,8650756,0,8388624,2097152,16777216,0,537395328,
+540672,131072,65536,8448,1048704,0,134217728,32,0,1048576,2048,0,4096,0,
+67129344,2097152,2147483650,1026,51380232,2,2097152,0,16777217,0,0,0,33558528,
+64,128,134283313,33554432,67109888,2056,2048,2048,262160,24,268435456,1536,0,0,
+1,0,1077938208,335544320,1048640,0,8388672,6144,640,256,0,134217728,144,
+83886082,0,2101252,16908288,327808,1073741824,536903680,2148007968,4,1050624,
+413138944,16777216,0,268443648,2097160,2097152,0,0,0,134217729,0,33562624,64,
+134283267,2147483648,1048576,128,0,2097152,2048,9,0,8388624,0,524288,1074806784,
+0,16777218,32768,0,268435456,4202496,8650768,0,2621440,4227104,1073741824,8,
+66048,0,128,0,2151678465,32776,344064,256,16384,2049,67141632,0,256,0,268435584,
+4194304,131072,0,65536,33554434,0,671088640,538460160,0,67109888,16812032,0,
+65536,268439616,0,1028,2149582850,0,0,2097728,2,1048576,2097152,16777216,66562,
+8396800,2281832448,134217728,0,0,0,65536,0,65536,0,536936448,1024,1049088,16,0,
+0,0,0,8917000,524306,0,33554448,0,201326592,0,0,8,1048576,64,32,536870912,
+8421376,2147483648,0,1049088,2684354568,8396800,4718592,134217728,2147483648,0,
+262144,268435456,8,4096,1048592,66048,0,16384,34078720,0,671105040,512,9216,0,
+134219776,262144,262152,32,2097152,134217728,0,402653188,262144,1,512,2048,
+2151817232,131080,4128,128,134225920,4096,0,0,0,16908352,256,2147483904,0,0,0,0,
+0,2157969664,838860800,0,131072,8288,0,134217728,1028,0,129,16777216,60,8388608,
+131234,1207967872,0,66,4,134217728,19456,8388608,353402880,536870912,83889664,
+268435584,0,262144,32770,134217728,0,8,64,2,0,16,2164260896,1049088,2147484160,
+1140855808,6,1073741824,0,1114112,0,42008577,0,0,0,514,4227328,8388608,0,0,
+16384,536871940,0,335544320,1048576,537002244,2048,576,1073741824,352387072,0,
+134217744,0,0,67108864,0,0,100663296,134217728,4259840,131072,9453568,18496,
+536872960,5,0,0,36700160,1024,0,4096,262152,65536,16,12352,34816,67109120,
+4198528,553652224,0,0,512,1048640,144,8,4224,0,16416,25166336,128,8208,262656,
+258,4325504,33554464,272630016,131584,0,67108864,268443648,0,10489984,8388608,
+67239936,4096,134217728,32768,12288,16777216,67108872,67108864,2147483808,
+8388608,16,4354,0,0,1048580,270532736,0,2056,0,159383552,134217728,1051648,
+33587202,2416214016,0,256,0,1040,128,0,34,33554432,0,1073872896,65538,512,
+524288,0,9437184,134217728,0,6,67108864,0,0,35651712,128,0,1,65536,8388640,
+10240,1081344,65536,201326592,0,8388992,1073741824,256,0,0,8192,0,33554498,0,0,
+4195328,32,262144,1088,2147484032,16384,33817600,67109376,64,2182086784,8,0,
+4194304,268435488,0,1,64,536872978,1,1073741824,34078720,524288,256,2147483648,
+1048576,8192,2147549184,8388608,65536,167772432,67117376,8,545259524,1572992,
+65664,134217728,0,1024,0,32768,0,0,16777216,64,16384,2097224,16512,0,8,32769,1,
+268435970,131072,0,2147483648,0,0,132,131072,805322768,268435456,0,1024,8388608,
+8388608,512,134217728,2147483648,131080,0,0,4194304,536870912,4096,0,32,
+536871168,33280,8,263168,32768,131072,2097152,2097160,2147483648,33816576,
+1073741824,603979776,67174400,16828418,2105344,134217728,2097152,266240,393216,
+276824072,0,0,0,4097,128,1024,0,8390656,0,512,268455936,8,1024,37748736,
+67108992,33554432,8388672,2048,12,20987904,0,589824,2197815313,33558528,0,65536,
+272629760,0,0,0,0,0,33570816,4718592,65536,32776,0,2147483648,131332,0,8650752,
+1048576,65536,33556608,136413184,0,2147483648,2,2,8,0,131072,131073,4096,0,0,
+512,0,1086332992,12583040,536870912,2,67108864,16777216,0,8388608,4224,35651584,
+0,0,0,256,0,0,0,536871936,2048,0,2097216,32,48,8,134217728,1048576,201326592,
+2048,134217729,0,33554432,0,1277952,4460544,570433536,603979776,1073741825,
+2097664,131072,8388608,1052800,17039360,73732,0,655360,545259520,134217728,
+8388608,1,2048,0,16,524292,0,134283264,16777248,2560,0,262144,33554432,64,
+131074,10,4096,0,4,4,1024,0,268435456,2147516416,269484096,2416181248,2099202,0,
+256,33554432,16384,1024,536870976,0,1048704,0,48,8,8,134222336,8192,0,268435456,
+67108864,67112992,1,1,0,0,0,1024,16908288,0,16777216,64,32,0,32768,134217728,
+256,2048,33554496,32,0,10485760,2147484048,2097152,8,0,32768,1073741825,0,0,
+65536,524288,8388624,8405009,33,0,0,0,201326593,8193,524288,4,268697600,
+536879112,2147745792,4352,16384,67108865,1207963906,0,67108864,24,35782656,0,
+128,65536,134217728,0,0,0,0,524545,512,40,0,256,2097152,1,0,67108880,0,0,
+10485824,0,67108864,0,524288,1048576,1049600,142606912,16,0,32,0,24,128,
+1073741832,2048,3145728,2179073,0,32,2228224,262144,0,1610612736,32768,16384,
+1024,65792,16384,134221824,4196352,32,96,48,1,0,536871424,0,268960256,0,0,
+16777232,2097154,131072,266244,256,32768,512,128,8404992,8200,1073741888,0,0,
+71892992,8224,33619968,1048576,16777472,512,33619968,1048576,2097152,0,2097152,
+0,1081920,1078460418,0,131072,2097280,65536,1,0,0,67108864,16777280,16777216,0,
+512,4227072,0,8650752,2056,16,196608,262144,1048576,2114561,4,1310721,0,2097152,
+65568,402654224,8388736,0,167772176,67108864,0,0,0,128,131592,0,0,393216,
+2097152,128,2097152,0,16777216,69888,512,1025,0,0,0,0,2,132096,0,0,268435458,
+147457,0,536887360,272629760,4100,0,8389632,8388608,0,2147483668,8192,18,2048,
+4096,268435456,1074270208,524,4096,268500992,0,0,67108864,0,2360576,2048,0,0,
+524416,8454160,0,1056768,131072,32,16,8192,0,268435488,0,256,0,0,8390656,33280,
+268959744,67112960,4,0,0,272629760,1,134217728,0,0,268435456,536936448,
+1107296256,64,8388608,8421376,4194304,8320,0,306184192,8192,0,83968,1024,4,256,
+0,0,2,67108896,536870912,0,2097153,32896,2147483648,302120960,0,17825808,
+25165838,2147483648,37748736,268435456,33554496,16778752,0,264,134217728,
+2151694400,0,537001984,2147483648,2147483648,17827840,0,67109888,1026,128,0,
+33558528,8390656,67176448,0,1207959568,33558528,144,9,512,2147483648,524288,
+268437552,16384,8192,2147516418,8192,73401600,0,0,0,0,1342177280,0,67108864,
+9439232,257,256,17039360,2,1048584,0,2717917184,0,2048,16,131072,0,20988424,0,0,
+1048576,2,285214722,128,0,0,2097153,164,2048,4,262144,268533760,1056,262160,0,
+67108864,33554704,536871040,11010048,16777216,8389642,1083179520,65552,4195328,
+272629764,0,2550136832,0,0,2147483648,6291456,2147483648,0,2148532228,0,68,
+268435472,288,0,134217728,65536,131072,0,4112,8704,33556480,2099200,17842176,
+134217728,8454144,0,131072,33554434,268960256,2050,135169,134217728,150994944,0,
+4,0,4288,2147484673,1024,0,335544384,67108864,67125248,2097220,0,5184,8388616,0,
+516,131073,4096,536871040,536870912,128,8388608,1,16785408,268439552,33554432,
+2097168,0,4096,34607104,0,2147483656,0,1048576,4096,49184,33554440,4098,41088,
+16384,20971536,0,67108864,67119296,4194304,147456,263168,1073758208,0,134217856,
+4718864,0,0,0,33628160,0,131072,0,0,270532608,16,2101376,32,131200,537001984,
+134217896,0,536891392,64,2176,65536,256,8404992,48,0,268435456,16794112,
+2148532224,8,0,0,536870912,270336,0,1611137024,258,49152,0,6144,16384,569344,
+2048,0,131072,0,129,36,8404992,16777216,8192,0,0,264256,8,33554432,1048576,0,0,
+320,8388616,0,8208,262208,8,8388608,262160,34111488,131072,67633152,1073742080,
+0,256,131072,0,32768,134217728,296968,128,524288,16,134348800,2097152,0,3,
+1048576,32768,0,2,0,0,512,0,4096,8454144,0,1073741824,0,786432,1081344,67108870,
+0,2214592513,0,0,4325376,268435457,0,0,67117056,67110912,33560576,16785409,0,
+1073807360,33554432,132,33554432,16777232,8396800,0,0,16,0,4096,0,4,32768,0,0,0,
+0,1048584,134217732,0,270532674,131072,32768,4,402670608,0,3200,0,268509184,0,
+4981776,0,0,2,4096,268435496,0,0,536903680,132098,128,536870912,4105,20987904,
+2147745792,4096,32768,4194304,0,37847040,33554496,42008960,32768,327680,
+134283266,142606336,33619968,2147483648,2048,8388608,0,16384,671088640,0,
+4194304,0,0,16400,2097152,16777218,8388608,0,0,1048580,268435456,536870912,
+33554432,8912896,0,1074855936,4718604,8519680,524292};
+
 #if defined(__cplusplus) || defined(c_plusplus)
 }  /* extern "C" */
 #endif
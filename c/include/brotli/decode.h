@@ -104,7 +104,9 @@ typedef struct BackwardReferenceFromDecoder {
   BROTLI_ERROR_CODE(_ERROR_FORMAT_, PADDING_2, -15) SEPARATOR              \
   BROTLI_ERROR_CODE(_ERROR_FORMAT_, DISTANCE, -16) SEPARATOR               \
                                                                            \
-  /* -17..-18 codes are reserved */                                        \
+  /* -17 code is reserved */                                               \
+                                                                           \
+  BROTLI_ERROR_CODE(_ERROR_, COMPOUND_DICTIONARY, -18) SEPARATOR           \
                                                                            \
   BROTLI_ERROR_CODE(_ERROR_, DICTIONARY_NOT_SET, -19) SEPARATOR            \
   BROTLI_ERROR_CODE(_ERROR_, INVALID_ARGUMENTS, -20) SEPARATOR             \
@@ -121,7 +123,11 @@ typedef struct BackwardReferenceFromDecoder {
   BROTLI_ERROR_CODE(_ERROR_ALLOC_, BLOCK_TYPE_TREES, -30) SEPARATOR        \
                                                                            \
   /* "Impossible" states */                                                \
-  BROTLI_ERROR_CODE(_ERROR_, UNREACHABLE, -31)
+  BROTLI_ERROR_CODE(_ERROR_, UNREACHABLE, -31) SEPARATOR                   \
+                                                                           \
+  /* Limits set with ::BrotliDecoderSetParameter */                        \
+  BROTLI_ERROR_CODE(_ERROR_LIMIT_, MEMORY, -32) SEPARATOR                  \
+  BROTLI_ERROR_CODE(_ERROR_LIMIT_, OUTPUT_RATIO, -33)
 
 /**
  * Error code for detailed logging / production debugging.
@@ -144,7 +150,7 @@ typedef enum {
  * to @c -1. There are also 4 other possible non-error codes @c 0 .. @c 3 in
  * ::BrotliDecoderErrorCode enumeration.
  */
-#define BROTLI_LAST_ERROR_CODE BROTLI_DECODER_ERROR_UNREACHABLE
+#define BROTLI_LAST_ERROR_CODE BROTLI_DECODER_ERROR_LIMIT_OUTPUT_RATIO
 
 /** Options to be used with ::BrotliDecoderSetParameter. */
 typedef enum BrotliDecoderParameter {
@@ -164,9 +170,59 @@ typedef enum BrotliDecoderParameter {
    * Flag that determines if need to collect commands during decompression and
    * save then to file.
    */
-  BROTLI_DECODER_PARAM_SAVE_INFO = 2
+  BROTLI_DECODER_PARAM_SAVE_INFO = 2,
+  /**
+   * Number of Huffman tables kept for reuse in the following metablocks.
+   *
+   * Helps streams that repeat prefix codes, e.g. produced by encoders that
+   * flush often. The default value is @c 0, i.e. cache is disabled. Values
+   * above ::BROTLI_DECODER_MAX_HUFFMAN_CACHE_SIZE are rejected.
+   */
+  BROTLI_DECODER_PARAM_HUFFMAN_CACHE_SIZE = 3,
+  /**
+   * Upper bound of memory allocated for decoding, in bytes.
+   *
+   * Ring-buffer, Huffman tables and context maps are counted; decoder instance
+   * itself and attached dictionaries are not. Allocation that would exceed the
+   * limit is not made, and decoding fails with
+   * ::BROTLI_DECODER_ERROR_LIMIT_MEMORY. Optional caches just stop growing.
+   * Memory kept by ::BrotliDecoderReset remains counted.
+   *
+   * The default value is @c 0, i.e. no limit. Note that the ring-buffer alone
+   * takes up to 16 MiB (or 1 GiB, if ::BROTLI_DECODER_PARAM_LARGE_WINDOW is
+   * set) for valid streams.
+   */
+  BROTLI_DECODER_PARAM_MAX_MEMORY = 4,
+  /**
+   * Upper bound of output size to consumed input size ratio.
+   *
+   * Decoding fails with ::BROTLI_DECODER_ERROR_LIMIT_OUTPUT_RATIO, before any
+   * output that would exceed the ratio is produced. Ratio is checked from the
+   * start of the stream, so the value should leave room for tiny streams.
+   * After ::BrotliDecoderSeek it is checked from the start of the chunk;
+   * decoded bytes that precede the offset are not counted as output.
+   *
+   * The default value is @c 0, i.e. no limit.
+   */
+  BROTLI_DECODER_PARAM_MAX_OUTPUT_RATIO = 5,
+  /**
+   * Number of transformed static dictionary words kept for reuse.
+   *
+   * Helps text and markup, that refer to the same few hundred dictionary
+   * words with the same transforms over and over. Each entry takes 56 bytes;
+   * cache is kept by ::BrotliDecoderReset. The default value is @c 0, i.e.
+   * cache is disabled. Values above ::BROTLI_DECODER_MAX_WORD_CACHE_SIZE are
+   * rejected.
+   */
+  BROTLI_DECODER_PARAM_WORD_CACHE_SIZE = 6
 } BrotliDecoderParameter;
 
+/** Maximal value for ::BROTLI_DECODER_PARAM_HUFFMAN_CACHE_SIZE. */
+#define BROTLI_DECODER_MAX_HUFFMAN_CACHE_SIZE 64
+
+/** Maximal value for ::BROTLI_DECODER_PARAM_WORD_CACHE_SIZE. */
+#define BROTLI_DECODER_MAX_WORD_CACHE_SIZE 4096
+
 /**
  * Sets the specified parameter to the given decoder instance.
  *
@@ -179,12 +235,44 @@ typedef enum BrotliDecoderParameter {
 BROTLI_DEC_API BROTLI_BOOL BrotliDecoderSetParameter(
     BrotliDecoderState* state, BrotliDecoderParameter param, uint32_t value);
 
+/** Dictionary formats accepted by ::BrotliDecoderAttachDictionary. */
+typedef enum BrotliSharedDictionaryType {
+  /** Raw LZ77 prefix dictionary. */
+  BROTLI_SHARED_DICTIONARY_RAW = 0
+} BrotliSharedDictionaryType;
+
+/**
+ * Adds LZ77 prefix dictionary to the decoder instance.
+ *
+ * Up to 15 dictionaries could be attached; they are logically concatenated
+ * in the order of attachment and placed right before the stream data, i.e.
+ * backward references that reach beyond the beginning of the stream address
+ * the dictionary data. Encoder has to use the same dictionaries in the same
+ * order, see ::BrotliEncoderAttachPreparedDictionary.
+ *
+ * Dictionary data is not copied; it @b MUST remain valid and unchanged until
+ * the decoder instance is destroyed. The same dictionary memory (e.g. mapped
+ * file) could be used by any number of decoder instances simultaneously.
+ *
+ * @param state decoder instance
+ * @param type dictionary data format
+ * @param data_size size of @p data; up to 1 GiB in total
+ * @param data dictionary data
+ * @returns ::BROTLI_FALSE if decoding is already started, format is not
+ *          supported, too many dictionaries are attached, or allocation
+ *          failed
+ * @returns ::BROTLI_TRUE if dictionary is attached
+ */
+BROTLI_DEC_API BROTLI_BOOL BrotliDecoderAttachDictionary(
+    BrotliDecoderState* state, BrotliSharedDictionaryType type,
+    size_t data_size, const uint8_t data[BROTLI_ARRAY_PARAM(data_size)]);
+
 /**
  * Creates an instance of ::BrotliDecoderState and initializes it.
  *
  * The instance can be used once for decoding and should then be destroyed with
- * ::BrotliDecoderDestroyInstance, it cannot be reused for a new decoding
- * session.
+ * ::BrotliDecoderDestroyInstance, or prepared for a new decoding session with
+ * ::BrotliDecoderReset.
  *
  * @p alloc_func and @p free_func @b MUST be both zero or both non-zero. In the
  * case they are both zero, default memory allocators are used. @p opaque is
@@ -207,12 +295,29 @@ BROTLI_DEC_API BrotliDecoderState* BrotliDecoderCreateInstance(
  */
 BROTLI_DEC_API void BrotliDecoderDestroyInstance(BrotliDecoderState* state);
 
+/**
+ * Prepares ::BrotliDecoderState instance for decoding a new stream.
+ *
+ * Decoding state and error are discarded, as if the instance was just
+ * created. Parameters and attached dictionaries are kept. Ring-buffer, context
+ * maps and Huffman tables memory is kept too, and reused while it is large
+ * enough; this saves most of allocations when many small streams are decoded.
+ *
+ * @param state decoder instance
+ */
+BROTLI_DEC_API void BrotliDecoderReset(BrotliDecoderState* state);
+
 /**
  * Performs one-shot memory-to-memory decompression.
  *
  * Decompresses the data in @p encoded_buffer into @p decoded_buffer, and sets
  * @p *decoded_size to the decompressed length.
  *
+ * If @p decoded_buffer has some spare room (a few dozen bytes) after the
+ * decompressed data, it is used as sliding window directly, so no ring-buffer
+ * is allocated and output is not copied. Contents of the spare room are
+ * unspecified after the call.
+ *
  * @param encoded_size size of @p encoded_buffer
  * @param encoded_buffer compressed data buffer with at least @p encoded_size
  *        addressable bytes
@@ -360,6 +465,147 @@ BROTLI_DEC_API BrotliDecoderErrorCode BrotliDecoderGetErrorCode(
  */
 BROTLI_DEC_API const char* BrotliDecoderErrorString(BrotliDecoderErrorCode c);
 
+/**
+ * Gets Huffman table cache counters.
+ *
+ * See ::BROTLI_DECODER_PARAM_HUFFMAN_CACHE_SIZE. Only prefix codes defined by
+ * code lengths are looked up in cache; codes with 1..4 symbols are cheap to
+ * build.
+ *
+ * @param state decoder instance
+ * @param[out] hits number of prefix codes with table taken from cache
+ * @param[out] misses number of prefix codes with table built anew
+ */
+BROTLI_DEC_API void BrotliDecoderGetHuffmanCacheStats(
+    const BrotliDecoderState* state, uint64_t* hits, uint64_t* misses);
+
+/**
+ * Location of an independently decodable chunk of a stream produced with
+ * ::BROTLI_PARAM_CHUNK_SIZE, and the decoder state it starts with.
+ */
+typedef struct BrotliDecoderChunk {
+  /** Range of the chunk in the compressed stream. */
+  size_t compressed_offset;
+  size_t compressed_size;
+  /** Range of the chunk in the decompressed data. */
+  size_t uncompressed_offset;
+  size_t uncompressed_size;
+  /** Stream window; used by ::BrotliDecoderStartChunk. */
+  int window_bits;
+  BROTLI_BOOL large_window;
+  /** Last distances, from the last one; used by ::BrotliDecoderStartChunk. */
+  int distances[4];
+  /** Last byte and the one before it; used by ::BrotliDecoderStartChunk. */
+  uint8_t context[2];
+} BrotliDecoderChunk;
+
+/**
+ * Gets the number of chunks listed in the chunk index of the stream.
+ *
+ * Whole index is checked: chunks must be adjacent, in stream order, and end
+ * within the compressed and decompressed sizes recorded in the index.
+ *
+ * @param encoded_size size of @p encoded
+ * @param encoded complete compressed stream
+ * @returns @c 0 if stream has no valid chunk index, i.e. it was not produced
+ *          with ::BROTLI_PARAM_CHUNK_SIZE, or the index is inconsistent
+ */
+BROTLI_DEC_API size_t BrotliDecoderGetChunkCount(size_t encoded_size,
+    const uint8_t encoded[BROTLI_ARRAY_PARAM(encoded_size)]);
+
+/**
+ * Reads an entry of the chunk index of the stream.
+ *
+ * Chunks are listed in stream order, they are adjacent and cover all the
+ * decompressed data. Only the requested entry is checked, so chunks could be
+ * relied upon to be disjoint only after ::BrotliDecoderGetChunkCount accepts
+ * the index.
+ *
+ * @param encoded_size size of @p encoded
+ * @param encoded complete compressed stream
+ * @param index chunk number, less than ::BrotliDecoderGetChunkCount result
+ * @param[out] chunk chunk location
+ * @returns ::BROTLI_FALSE if index is missing or invalid
+ */
+BROTLI_DEC_API BROTLI_BOOL BrotliDecoderGetChunk(size_t encoded_size,
+    const uint8_t encoded[BROTLI_ARRAY_PARAM(encoded_size)], size_t index,
+    BrotliDecoderChunk* chunk);
+
+/**
+ * Prepares a fresh decoder instance for decoding a chunk in the middle of
+ * the stream.
+ *
+ * Instance must be just created or reset. Then ::BrotliDecoderDecompressStream
+ * is fed with @p chunk->compressed_size bytes of the stream starting at
+ * @p chunk->compressed_offset; chunk is decoded completely when all of them
+ * are consumed and @p chunk->uncompressed_size bytes are produced. Result is
+ * ::BROTLI_DECODER_RESULT_NEEDS_MORE_INPUT then, because the stream goes on.
+ * Instances that decode different chunks are independent, thus could work
+ * in parallel.
+ *
+ * @param state decoder instance
+ * @param chunk chunk location obtained with ::BrotliDecoderGetChunk
+ * @returns ::BROTLI_FALSE if instance is already used, or chunk is invalid,
+ *          or chunk has large window and ::BROTLI_DECODER_PARAM_LARGE_WINDOW
+ *          is not set
+ */
+BROTLI_DEC_API BROTLI_BOOL BrotliDecoderStartChunk(
+    BrotliDecoderState* state, const BrotliDecoderChunk* chunk);
+
+/**
+ * Prepares decoder instance for decoding the stream from the given offset of
+ * decompressed data.
+ *
+ * Stream @b MUST have a chunk index, see ::BROTLI_PARAM_CHUNK_SIZE. Instance
+ * is reset, as with ::BrotliDecoderReset, and set up to decode the chunk that
+ * contains @p offset. Then ::BrotliDecoderDecompressStream is fed with the
+ * stream starting at @p *input_offset; bytes of the chunk before @p offset
+ * are decoded, but not output. Decoding goes on through the following
+ * chunks up to the end of the stream. Thus the cost of seek is bounded by the
+ * chunk size, not by the offset.
+ *
+ * @c total_out reported by ::BrotliDecoderDecompressStream counts from the
+ * start of the chunk, skipped bytes included.
+ *
+ * @param state decoder instance
+ * @param encoded_size size of @p encoded
+ * @param encoded complete compressed stream
+ * @param offset position in decompressed data, up to its size
+ * @param[out] input_offset position in @p encoded to continue decoding from
+ * @returns ::BROTLI_FALSE if stream has no valid chunk index, @p offset is
+ *          beyond the end of decompressed data, or chunk has large window
+ *          and ::BROTLI_DECODER_PARAM_LARGE_WINDOW is not set
+ */
+BROTLI_DEC_API BROTLI_BOOL BrotliDecoderSeek(BrotliDecoderState* state,
+    size_t encoded_size,
+    const uint8_t encoded[BROTLI_ARRAY_PARAM(encoded_size)], size_t offset,
+    size_t* input_offset);
+
+/**
+ * Performs one-shot decompression of a range of decompressed data.
+ *
+ * Stream @b MUST have a chunk index, see ::BrotliDecoderSeek. Only chunks
+ * that overlap the range are decoded. Streams with large window are
+ * accepted.
+ *
+ * @param encoded_size size of @p encoded_buffer
+ * @param encoded_buffer complete compressed stream
+ * @param offset start of the range in decompressed data
+ * @param[in, out] decoded_size @b in: size of the range; \n
+ *                 @b out: number of bytes written to @p decoded_buffer; less
+ *                 than requested if range spans beyond the end of data
+ * @param decoded_buffer destination buffer for the range
+ * @returns ::BROTLI_DECODER_RESULT_ERROR if stream has no chunk index,
+ *          @p offset is beyond the end of data, input is corrupted, or memory
+ *          allocation failed
+ * @returns ::BROTLI_DECODER_RESULT_SUCCESS otherwise
+ */
+BROTLI_DEC_API BrotliDecoderResult BrotliDecoderDecompressRange(
+    size_t encoded_size,
+    const uint8_t encoded_buffer[BROTLI_ARRAY_PARAM(encoded_size)],
+    size_t offset, size_t* decoded_size,
+    uint8_t decoded_buffer[BROTLI_ARRAY_PARAM(*decoded_size)]);
+
 /**
  * Gets a decoder library version.
  *
@@ -219,7 +219,93 @@ typedef enum BrotliEncoderParameter {
    * maximal window size have the same effect. Values greater than 2**30 are not
    * allowed.
    */
-  BROTLI_PARAM_STREAM_OFFSET = 9
+  BROTLI_PARAM_STREAM_OFFSET = 9,
+  /**
+   * Target encoding speed, in kilobytes (1000 bytes) of input per second of
+   * encoder thread CPU time.
+   *
+   * When set, ::BROTLI_PARAM_QUALITY is treated as the upper bound: after each
+   * meta-block encoder measures its own throughput and moves to a lower
+   * quality (cheaper hasher, block splitting and context modeling) if it is
+   * too slow, or back to a higher one if there is enough headroom. Output is
+   * a valid stream either way.
+   *
+   * @note Switching the hasher drops the match history, so compression ratio
+   *       is somewhat worse than that of a fixed quality of the same speed.
+   *
+   * @note Has no effect for qualities 0 and 1, and when backward references
+   *       or block splits provided by decoder are used.
+   *
+   * The default value is 0, which means that quality is not adjusted.
+   */
+  BROTLI_PARAM_TARGET_SPEED = 10,
+  /**
+   * Flag that tells that input passed to ::BrotliEncoderCompressStream is
+   * stable.
+   *
+   * Stable input is one contiguous buffer: each call continues exactly where
+   * the previous one stopped consuming, and all the data passed stays valid
+   * and unchanged until the stream is finished. Encoder then reads input
+   * directly from that buffer instead of copying it to the internal ring
+   * buffer, which saves a copy and the ring buffer memory.
+   *
+   * ::BrotliEncoderCompressStream fails if input does not continue the data
+   * passed before. Metadata (::BROTLI_OPERATION_EMIT_METADATA) is not part of
+   * the stable buffer.
+   *
+   * @note Compressed output could differ by a few bytes from output without
+   *       the flag: encoder does not look past the end of passed input, so up
+   *       to 7 last bytes of it are not searched for backward references.
+   */
+  BROTLI_PARAM_STABLE_INPUT = 11,
+  /**
+   * Flag that enables segmented output.
+   *
+   * In this mode ::BrotliEncoderCompressStream does not copy compressed data
+   * to @p next_out; instead the encoder keeps each produced chunk in its own
+   * buffer and queues it. Queued chunks are exposed with
+   * ::BrotliEncoderGetOutputSegments and stay valid until they are
+   * acknowledged with ::BrotliEncoderReleaseOutput, so they could be passed
+   * to vectored I/O (e.g. @c writev) without intermediate copies.
+   *
+   * Encoder keeps producing output while there is input, thus the amount of
+   * queued data is bounded by the amount of input passed between releases.
+   *
+   * ::BrotliEncoderTakeOutput returns no data in this mode.
+   */
+  BROTLI_PARAM_SEGMENTED_OUTPUT = 12,
+  /**
+   * Peak memory budget of the encoder, in KiB.
+   *
+   * When set, encoder reduces hasher tables, metablock size, input block size
+   * and, as a last resort, window size, until the estimate of
+   * ::BrotliEncoderEstimatePeakMemory for the resulting configuration fits
+   * the budget. Budgets below the smallest configuration are not enforced.
+   *
+   * Estimate takes ::BROTLI_PARAM_SIZE_HINT into account, so it is better to
+   * set both. The default value is @c 0, which means no limit.
+   */
+  BROTLI_PARAM_MEMORY_LIMIT = 13,
+  /**
+   * Size of independently decodable chunks, in KiB.
+   *
+   * When set, encoder ends a meta-block after each chunk of input of this
+   * size, and backward references do not reach past the start of the chunk
+   * they are in. Stream is finished with a metadata block that holds the
+   * index of chunks: their offsets, and the last distances and the last 2
+   * bytes each chunk starts with. With it a decoder could split the stream
+   * into ranges and decode them in parallel, see
+   * ::BrotliDecoderGetChunkCount. Stream is still decoded by any decoder.
+   *
+   * @note Every chunk starts with an empty window, so smaller chunks cost more
+   *       compression ratio.
+   *
+   * @note Qualities 0 and 1 are raised to 2. Not applicable together with
+   *       ::BROTLI_PARAM_STREAM_OFFSET.
+   *
+   * The default value is @c 0, which means that stream is not chunked.
+   */
+  BROTLI_PARAM_CHUNK_SIZE = 14
 } BrotliEncoderParameter;
 
 /**
@@ -271,6 +357,137 @@ BROTLI_ENC_API BrotliEncoderState* BrotliEncoderCreateInstance(
  */
 BROTLI_ENC_API void BrotliEncoderDestroyInstance(BrotliEncoderState* state);
 
+/**
+ * Opaque structure that holds a custom dictionary prepared for encoders.
+ *
+ * Created with ::BrotliEncoderPrepareDictionary.
+ * Deallocated with ::BrotliEncoderDestroyPreparedDictionary.
+ */
+typedef struct BrotliEncoderPreparedDictionaryStruct
+    BrotliEncoderPreparedDictionary;
+
+/**
+ * Builds a search index over a custom ("prefix") dictionary.
+ *
+ * Prepared dictionary is immutable: it could be attached to any number of
+ * encoder instances, including ones used concurrently by different threads.
+ * Dictionary data is not copied; it @b MUST remain valid and unchanged until
+ * the prepared dictionary is destroyed.
+ *
+ * Streams produced with a dictionary could be decoded only with the same
+ * dictionary attached to the decoder, see ::BrotliDecoderAttachDictionary.
+ *
+ * @p alloc_func and @p free_func @b MUST be both zero or both non-zero; they
+ * are also used to deallocate the result.
+ *
+ * @param data_size size of @p data, up to 1 GiB
+ * @param data dictionary data
+ * @param quality quality the dictionary is mostly going to be used with; it
+ *        defines the size of index and search depth
+ * @param alloc_func custom memory allocation function
+ * @param free_func custom memory free function
+ * @param opaque custom memory manager handle
+ * @returns @c 0 if dictionary is too big or memory allocation failed
+ * @returns pointer to prepared dictionary otherwise
+ */
+BROTLI_ENC_API BrotliEncoderPreparedDictionary* BrotliEncoderPrepareDictionary(
+    size_t data_size, const uint8_t data[BROTLI_ARRAY_PARAM(data_size)],
+    int quality, brotli_alloc_func alloc_func, brotli_free_func free_func,
+    void* opaque);
+
+/**
+ * Calculates the size of serialized image of prepared dictionary.
+ *
+ * Serialized image holds only the search index, but not the dictionary data
+ * itself. It could be stored (e.g. created offline with @c brotli tool) and
+ * later turned back into prepared dictionary with
+ * ::BrotliEncoderLoadPreparedDictionary much faster than preparing it again.
+ *
+ * @param dictionary prepared dictionary
+ * @returns @c 0 if @p dictionary is not valid
+ * @returns size of serialized image otherwise
+ */
+BROTLI_ENC_API size_t BrotliEncoderGetPreparedDictionarySerializedSize(
+    const BrotliEncoderPreparedDictionary* dictionary);
+
+/**
+ * Serializes prepared dictionary search index.
+ *
+ * Format is versioned and platform-independent.
+ *
+ * @param dictionary prepared dictionary
+ * @param[in, out] encoded_size @b in: size of @p encoded buffer; \n
+ *                 @b out: length of serialized image; \n
+ *                 @b out value is only valid if function returns ::BROTLI_TRUE
+ * @param encoded output buffer
+ * @returns ::BROTLI_FALSE if @p dictionary is not valid, or the buffer is too
+ *          small (see ::BrotliEncoderGetPreparedDictionarySerializedSize)
+ * @returns ::BROTLI_TRUE otherwise
+ */
+BROTLI_ENC_API BROTLI_BOOL BrotliEncoderSerializePreparedDictionary(
+    const BrotliEncoderPreparedDictionary* dictionary, size_t* encoded_size,
+    uint8_t encoded[BROTLI_ARRAY_PARAM(*encoded_size)]);
+
+/**
+ * Creates prepared dictionary from serialized image and dictionary data.
+ *
+ * Image is validated against the hash of @p data, so stale images are
+ * rejected. On little-endian platforms, if @p image is 4-byte aligned (e.g.
+ * memory mapped file), search index is used in place: loading costs a pass
+ * over @p data and no allocations besides a small header, and memory pages
+ * of the image are shared by all processes that map it. Otherwise the index
+ * is copied.
+ *
+ * Neither @p image nor @p data is copied in the former case; both @b MUST
+ * remain valid and unchanged until the prepared dictionary is destroyed.
+ *
+ * @param image_size size of @p image
+ * @param image serialized image
+ * @param data_size size of @p data
+ * @param data dictionary data
+ * @param alloc_func custom memory allocation function
+ * @param free_func custom memory free function
+ * @param opaque custom memory manager handle
+ * @returns @c 0 if image is malformed, does not match @p data, or memory
+ *          allocation failed
+ * @returns pointer to prepared dictionary otherwise
+ */
+BROTLI_ENC_API BrotliEncoderPreparedDictionary*
+BrotliEncoderLoadPreparedDictionary(
+    size_t image_size, const uint8_t image[BROTLI_ARRAY_PARAM(image_size)],
+    size_t data_size, const uint8_t data[BROTLI_ARRAY_PARAM(data_size)],
+    brotli_alloc_func alloc_func, brotli_free_func free_func, void* opaque);
+
+/**
+ * Deallocates prepared dictionary.
+ *
+ * @warning Dictionary @b MUST NOT be attached to any live encoder instance.
+ *
+ * @param dictionary prepared dictionary to deallocate
+ */
+BROTLI_ENC_API void BrotliEncoderDestroyPreparedDictionary(
+    BrotliEncoderPreparedDictionary* dictionary);
+
+/**
+ * Attaches prepared dictionary to the encoder instance.
+ *
+ * Up to 15 dictionaries could be attached; they are logically concatenated
+ * in the order of attachment and placed right before the stream data.
+ * Dictionary is not copied; it has to outlive the encoder instance.
+ *
+ * @note Qualities @c 0 and @c 1 are raised to @c 2 when a dictionary is
+ *       attached.
+ *
+ * @param state encoder instance
+ * @param dictionary prepared dictionary
+ * @returns ::BROTLI_FALSE if encoding is already started, or too many
+ *          dictionaries are attached
+ * @returns ::BROTLI_TRUE if dictionary is attached
+ */
+BROTLI_ENC_API BROTLI_BOOL BrotliEncoderAttachPreparedDictionary(
+    BrotliEncoderState* state,
+    const BrotliEncoderPreparedDictionary* dictionary);
+
 /**
  * Calculates the output size bound for the given @p input_size.
  *
@@ -440,6 +657,75 @@ BROTLI_ENC_API BROTLI_BOOL BrotliEncoderHasMoreOutput(
 BROTLI_ENC_API const uint8_t* BrotliEncoderTakeOutput(
     BrotliEncoderState* state, size_t* size);
 
+/**
+ * Gets the number of input bytes that were emitted as uncompressed
+ * meta-blocks.
+ *
+ * Encoder stores data uncompressed when compression would not pay off, e.g.
+ * for already compressed or encrypted payloads; such data is detected with a
+ * quick scan and bypasses backward reference search.
+ *
+ * @note Qualities 0 and 1 do not account stored data.
+ *
+ * @param state encoder instance
+ * @returns number of input bytes stored uncompressed so far
+ */
+BROTLI_ENC_API size_t BrotliEncoderGetStoredBytes(BrotliEncoderState* state);
+
+/**
+ * Estimates peak memory usage of the encoder.
+ *
+ * Result is an approximation that covers the instance, internal buffers and
+ * the biggest temporary allocations; it does not include allocator overhead.
+ *
+ * @param quality quality parameter value, e.g. ::BROTLI_DEFAULT_QUALITY
+ * @param lgwin lgwin parameter value, e.g. ::BROTLI_DEFAULT_WINDOW
+ * @param size_hint expected input size, @c 0 if unknown
+ * @returns estimated number of bytes used by the encoder
+ */
+BROTLI_ENC_API size_t BrotliEncoderEstimatePeakMemory(
+    int quality, int lgwin, size_t size_hint);
+
+/** Piece of encoder output, see ::BrotliEncoderGetOutputSegments. */
+typedef struct BrotliEncoderOutputSegment {
+  /** Pointer to the first byte of the segment. */
+  const uint8_t* data;
+  /** Number of bytes in the segment. */
+  size_t size;
+} BrotliEncoderOutputSegment;
+
+/**
+ * Peeks queued output in ::BROTLI_PARAM_SEGMENTED_OUTPUT mode.
+ *
+ * Segments are filled in stream order, starting with the first
+ * unacknowledged byte. Returned memory is owned by the encoder and remains
+ * valid and unchanged until it is acknowledged with
+ * ::BrotliEncoderReleaseOutput or the instance is destroyed; calls to
+ * ::BrotliEncoderCompressStream do not invalidate it.
+ *
+ * @param state encoder instance
+ * @param[out] segments array to fill
+ * @param max_segments number of elements in @p segments
+ * @returns number of segments filled; @c 0 if there is no queued output
+ */
+BROTLI_ENC_API size_t BrotliEncoderGetOutputSegments(
+    BrotliEncoderState* state, BrotliEncoderOutputSegment* segments,
+    size_t max_segments);
+
+/**
+ * Acknowledges queued output in ::BROTLI_PARAM_SEGMENTED_OUTPUT mode.
+ *
+ * First @p size bytes of the queued output are considered consumed; fully
+ * consumed segments are released. Partially consumed segment stays in the
+ * queue, shortened from its beginning, which matches short writes.
+ *
+ * @param state encoder instance
+ * @param size number of bytes to acknowledge; values greater than the amount
+ *        of queued output are clamped
+ */
+BROTLI_ENC_API void BrotliEncoderReleaseOutput(
+    BrotliEncoderState* state, size_t size);
+
 
 /**
  * Gets an encoder library version.
@@ -0,0 +1,340 @@
+/* Copyright 2026 The Brotli Authors. All Rights Reserved.
+
+   Distributed under MIT license.
+   See file LICENSE for detail or copy at https://opensource.org/licenses/MIT
+*/
+
+/* Round trip of chunked streams through the parallel decoder.
+
+   Every file is compressed with BROTLI_PARAM_CHUNK_SIZE, then decoded by the
+   regular one-pass decoder (chunk index must be transparent to it) and by
+   BrotliParallelDecompress with one and with the requested number of
+   threads. Decoding throughput is reported for both. Then random ranges are
+   read with BrotliDecoderDecompressRange; average time of a range read is
+   reported. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <brotli/decode.h>
+#include <brotli/encode.h>
+#include "./parallel_decode.h"
+
+typedef struct Options {
+  int quality;
+  int lgwin;
+  BROTLI_BOOL large_window;
+  unsigned long chunk_size;
+  int num_threads;
+  int rounds;
+  int num_ranges;
+} Options;
+
+static double Now(void) {
+#if defined(_WIN32)
+  return (double)clock() / CLOCKS_PER_SEC;
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+#endif
+}
+
+static const char* FileName(const char* path) {
+  const char* name = path;
+  const char* p;
+  for (p = path; *p; ++p) {
+    if (*p == '/' || *p == '\\') name = p + 1;
+  }
+  return name;
+}
+
+static uint8_t* ReadFile(const char* path, size_t* size) {
+  FILE* file = fopen(path, "rb");
+  uint8_t* data;
+  long file_size;
+  if (!file) {
+    fprintf(stderr, "failed to open [%s]\n", path);
+    return NULL;
+  }
+  if (fseek(file, 0, SEEK_END) != 0 || (file_size = ftell(file)) < 0 ||
+      fseek(file, 0, SEEK_SET) != 0) {
+    fprintf(stderr, "failed to seek [%s]\n", path);
+    fclose(file);
+    return NULL;
+  }
+  *size = (size_t)file_size;
+  data = (uint8_t*)malloc(*size ? *size : 1);
+  if (!data || fread(data, 1, *size, file) != *size) {
+    fprintf(stderr, "failed to read [%s]\n", path);
+    free(data);
+    fclose(file);
+    return NULL;
+  }
+  fclose(file);
+  return data;
+}
+
+static uint8_t* Compress(const Options* options, const uint8_t* input,
+    size_t input_size, size_t* encoded_size) {
+  BrotliEncoderState* s = BrotliEncoderCreateInstance(NULL, NULL, NULL);
+  size_t capacity = BrotliEncoderMaxCompressedSize(input_size);
+  uint8_t* encoded;
+  const uint8_t* next_in = input;
+  size_t available_in = input_size;
+  uint8_t* next_out;
+  size_t available_out;
+  BROTLI_BOOL ok = BROTLI_TRUE;
+  if (!s) return NULL;
+  /* Chunk flushes and index are not accounted by the bound. */
+  capacity = (capacity ? capacity : input_size) + (input_size >> 4) + 65536;
+  encoded = (uint8_t*)malloc(capacity);
+  if (!encoded) {
+    BrotliEncoderDestroyInstance(s);
+    return NULL;
+  }
+  BrotliEncoderSetParameter(s, BROTLI_PARAM_QUALITY,
+      (uint32_t)options->quality);
+  BrotliEncoderSetParameter(s, BROTLI_PARAM_LGWIN, (uint32_t)options->lgwin);
+  BrotliEncoderSetParameter(s, BROTLI_PARAM_LARGE_WINDOW,
+      (uint32_t)options->large_window);
+  BrotliEncoderSetParameter(s, BROTLI_PARAM_SIZE_HINT, (uint32_t)input_size);
+  BrotliEncoderSetParameter(s, BROTLI_PARAM_CHUNK_SIZE,
+      (uint32_t)options->chunk_size);
+  next_out = encoded;
+  available_out = capacity;
+  while (ok && !BrotliEncoderIsFinished(s)) {
+    ok = BrotliEncoderCompressStream(s, BROTLI_OPERATION_FINISH,
+        &available_in, &next_in, &available_out, &next_out, NULL);
+    if (available_out == 0 && !BrotliEncoderIsFinished(s)) ok = BROTLI_FALSE;
+  }
+  BrotliEncoderDestroyInstance(s);
+  if (!ok) {
+    free(encoded);
+    return NULL;
+  }
+  *encoded_size = (size_t)(next_out - encoded);
+  return encoded;
+}
+
+/* Decodes the stream the way any other decoder would. */
+static BROTLI_BOOL DecompressPlain(const uint8_t* encoded,
+    size_t encoded_size, uint8_t* decoded, size_t decoded_size) {
+  BrotliDecoderState* s = BrotliDecoderCreateInstance(NULL, NULL, NULL);
+  const uint8_t* next_in = encoded;
+  size_t available_in = encoded_size;
+  uint8_t* next_out = decoded;
+  size_t available_out = decoded_size;
+  BrotliDecoderResult result;
+  if (!s) return BROTLI_FALSE;
+  BrotliDecoderSetParameter(s, BROTLI_DECODER_PARAM_LARGE_WINDOW, 1u);
+  result = BrotliDecoderDecompressStream(
+      s, &available_in, &next_in, &available_out, &next_out, NULL);
+  BrotliDecoderDestroyInstance(s);
+  return TO_BROTLI_BOOL(result == BROTLI_DECODER_RESULT_SUCCESS &&
+      available_in == 0 && available_out == 0);
+}
+
+/* Returns decoding speed in MB/s, or negative value on mismatch. */
+static double DecompressParallel(const Options* options, int num_threads,
+    const uint8_t* encoded, size_t encoded_size, const uint8_t* original,
+    uint8_t* decoded, size_t decoded_size) {
+  double start = Now();
+  double elapsed;
+  int round;
+  for (round = 0; round < options->rounds; ++round) {
+    size_t size = decoded_size;
+    memset(decoded, 0, decoded_size);
+    if (BrotliParallelDecompress(encoded_size, encoded, num_threads, &size,
+        decoded) != BROTLI_DECODER_RESULT_SUCCESS || size != decoded_size ||
+        (size != 0 && memcmp(decoded, original, size) != 0)) {
+      return -1.0;
+    }
+  }
+  elapsed = Now() - start;
+  if (elapsed <= 0.0) elapsed = 1e-9;
+  return (double)decoded_size * options->rounds / elapsed / 1e6;
+}
+
+/* Returns average range read time in microseconds, or negative value on
+   mismatch. */
+static double DecompressRanges(const Options* options, const uint8_t* encoded,
+    size_t encoded_size, const uint8_t* original, size_t size,
+    uint8_t* decoded) {
+  /* Ranges span up to 3 chunks. */
+  size_t max_length = (size_t)options->chunk_size * 3 * 1024;
+  uint32_t seed = 0x12345678u;
+  double start = Now();
+  int i;
+  for (i = 0; i < options->num_ranges; ++i) {
+    size_t offset;
+    size_t length;
+    size_t expected;
+    seed = seed * 1103515245u + 12345u;
+    offset = (size_t)(seed >> 8) % (size + 1);
+    seed = seed * 1103515245u + 12345u;
+    length = (size_t)(seed >> 8) % (max_length + 1);
+    /* Range that ends beyond the data is truncated. */
+    if (i == 0) offset = size;
+    expected = length < size - offset ? length : size - offset;
+    if (BrotliDecoderDecompressRange(encoded_size, encoded, offset, &length,
+        decoded) != BROTLI_DECODER_RESULT_SUCCESS || length != expected ||
+        (length != 0 && memcmp(decoded, original + offset, length) != 0)) {
+      return -1.0;
+    }
+  }
+  return options->num_ranges ?
+      (Now() - start) * 1e6 / options->num_ranges : 0.0;
+}
+
+static BROTLI_BOOL RunFile(const Options* options, const char* path) {
+  size_t size;
+  size_t encoded_size = 0;
+  size_t decoded_size = 0;
+  size_t num_chunks;
+  uint8_t* original = ReadFile(path, &size);
+  uint8_t* encoded = NULL;
+  uint8_t* decoded = NULL;
+  double single = -1.0;
+  double multi = -1.0;
+  double range = -1.0;
+  BROTLI_BOOL ok = TO_BROTLI_BOOL(original != NULL);
+  if (ok) {
+    encoded = Compress(options, original, size, &encoded_size);
+    decoded = (uint8_t*)malloc(size ? size : 1);
+    ok = TO_BROTLI_BOOL(encoded && decoded);
+    if (!ok) fprintf(stderr, "failed to compress [%s]\n", path);
+  }
+  if (ok) {
+    ok = TO_BROTLI_BOOL(
+        DecompressPlain(encoded, encoded_size, decoded, size) &&
+        (size == 0 || memcmp(decoded, original, size) == 0));
+    if (!ok) fprintf(stderr, "plain decoding failed [%s]\n", path);
+  }
+  if (ok) {
+    ok = TO_BROTLI_BOOL(
+        BrotliParallelDecodedSize(encoded_size, encoded, &decoded_size) &&
+        decoded_size == size);
+    if (!ok) fprintf(stderr, "chunk index is missing [%s]\n", path);
+  }
+  if (ok) {
+    single = DecompressParallel(options, 1, encoded, encoded_size, original,
+        decoded, size);
+    multi = DecompressParallel(options, options->num_threads, encoded,
+        encoded_size, original, decoded, size);
+    ok = TO_BROTLI_BOOL(single >= 0.0 && multi >= 0.0);
+    if (!ok) fprintf(stderr, "parallel decoding failed [%s]\n", path);
+  }
+  if (ok) {
+    /* Only bytes up to the end of data are written, so they fit. */
+    range = DecompressRanges(options, encoded, encoded_size, original, size,
+        decoded);
+    ok = TO_BROTLI_BOOL(range >= 0.0);
+    if (!ok) fprintf(stderr, "range decoding failed [%s]\n", path);
+  }
+  if (ok) {
+    num_chunks = BrotliDecoderGetChunkCount(encoded_size, encoded);
+    fprintf(stdout, "%s: %lu -> %lu bytes, %lu chunks, "
+        "1 thread: %.1f MB/s, %d threads: %.1f MB/s, range: %.0f us\n",
+        FileName(path), (unsigned long)size, (unsigned long)encoded_size,
+        (unsigned long)num_chunks, single, options->num_threads, multi,
+        range);
+  }
+  free(original);
+  free(encoded);
+  free(decoded);
+  return ok;
+}
+
+static BROTLI_BOOL ParseNumber(const char* arg, const char* name,
+    unsigned long* value) {
+  size_t name_length = strlen(name);
+  char* end;
+  if (strncmp(arg, name, name_length) != 0 || arg[name_length] != '=') {
+    return BROTLI_FALSE;
+  }
+  *value = strtoul(arg + name_length + 1, &end, 10);
+  if (*end != 0) {
+    fprintf(stderr, "invalid value in [%s]\n", arg);
+    exit(1);
+  }
+  return BROTLI_TRUE;
+}
+
+static void PrintHelp(const char* name) {
+  fprintf(stdout,
+"Usage: %s [OPTION]... FILE...\n"
+"Compresses files in chunks and decodes them in parallel.\n"
+"Options:\n"
+"  --chunk-size=NUM      chunk size in KiB, default: 64\n"
+"  --large-window        use large window\n"
+"  --lgwin=NUM           window size bits, default: 22\n"
+"  --quality=NUM         compression quality, default: 5\n"
+"  --ranges=NUM          random ranges to read, default: 16\n"
+"  --rounds=NUM          decoding repeats for timing, default: 1\n"
+"  --threads=NUM         decoding threads, default: 4\n",
+      name);
+}
+
+int main(int argc, char** argv) {
+  Options options;
+  unsigned long value;
+  size_t num_files = 0;
+  size_t num_failures = 0;
+  int i;
+
+  options.quality = 5;
+  options.lgwin = BROTLI_DEFAULT_WINDOW;
+  options.large_window = BROTLI_FALSE;
+  options.chunk_size = 64;
+  options.num_threads = 4;
+  options.rounds = 1;
+  options.num_ranges = 16;
+  for (i = 1; i < argc; ++i) {
+    const char* arg = argv[i];
+    if (ParseNumber(arg, "--chunk-size", &value)) {
+      if (value == 0) {
+        fprintf(stderr, "invalid chunk size\n");
+        return 1;
+      }
+      options.chunk_size = value;
+    } else if (strcmp(arg, "--large-window") == 0) {
+      options.large_window = BROTLI_TRUE;
+    } else if (ParseNumber(arg, "--lgwin", &value)) {
+      options.lgwin = (int)value;
+    } else if (ParseNumber(arg, "--quality", &value)) {
+      options.quality = (int)value;
+    } else if (ParseNumber(arg, "--ranges", &value)) {
+      options.num_ranges = (int)value;
+    } else if (ParseNumber(arg, "--rounds", &value)) {
+      options.rounds = value ? (int)value : 1;
+    } else if (ParseNumber(arg, "--threads", &value)) {
+      if (value < 1 || value > BROTLI_PARALLEL_MAX_THREADS) {
+        fprintf(stderr, "invalid number of threads\n");
+        return 1;
+      }
+      options.num_threads = (int)value;
+    } else if (strcmp(arg, "--help") == 0) {
+      PrintHelp(FileName(argv[0]));
+      return 0;
+    } else if (arg[0] == '-' && arg[1] == '-') {
+      fprintf(stderr, "unknown option [%s]\n", arg);
+      return 1;
+    } else {
+      num_files++;
+    }
+  }
+  if (num_files == 0) {
+    PrintHelp(FileName(argv[0]));
+    return 1;
+  }
+  for (i = 1; i < argc; ++i) {
+    if (argv[i][0] == '-' && argv[i][1] == '-') continue;
+    if (!RunFile(&options, argv[i])) num_failures++;
+  }
+  fprintf(stdout, "files: %lu, failures: %lu\n",
+      (unsigned long)num_files, (unsigned long)num_failures);
+  return num_failures ? 1 : 0;
+}
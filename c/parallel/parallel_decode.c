@@ -0,0 +1,204 @@
+/* Copyright 2026 The Brotli Authors. All Rights Reserved.
+
+   Distributed under MIT license.
+   See file LICENSE for detail or copy at https://opensource.org/licenses/MIT
+*/
+
+/* Multi-threaded decoding of chunked streams. */
+
+#include "./parallel_decode.h"
+
+#include <brotli/decode.h>
+#include <brotli/types.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+typedef CRITICAL_SECTION BrotliMutex;
+typedef HANDLE BrotliThread;
+#define BROTLI_MUTEX_INIT(M) (InitializeCriticalSection(M), 1)
+#define BROTLI_MUTEX_DESTROY(M) DeleteCriticalSection(M)
+#define BROTLI_MUTEX_LOCK(M) EnterCriticalSection(M)
+#define BROTLI_MUTEX_UNLOCK(M) LeaveCriticalSection(M)
+#else
+#include <pthread.h>
+typedef pthread_mutex_t BrotliMutex;
+typedef pthread_t BrotliThread;
+#define BROTLI_MUTEX_INIT(M) (pthread_mutex_init(M, NULL) == 0)
+#define BROTLI_MUTEX_DESTROY(M) pthread_mutex_destroy(M)
+#define BROTLI_MUTEX_LOCK(M) pthread_mutex_lock(M)
+#define BROTLI_MUTEX_UNLOCK(M) pthread_mutex_unlock(M)
+#endif
+
+#if defined(__cplusplus) || defined(c_plusplus)
+extern "C" {
+#endif
+
+/* State shared by workers; chunks are handed out in order. */
+typedef struct Job {
+  BrotliMutex mutex;
+  size_t encoded_size;
+  const uint8_t* encoded;
+  uint8_t* decoded;
+  size_t num_chunks;
+  /* Guarded by mutex. */
+  size_t next_chunk;
+  BROTLI_BOOL failed;
+} Job;
+
+/* Returns next chunk to decode, or num_chunks if there is nothing to do. */
+static size_t TakeChunk(Job* job, BROTLI_BOOL failed) {
+  size_t index;
+  BROTLI_MUTEX_LOCK(&job->mutex);
+  if (failed) job->failed = BROTLI_TRUE;
+  index = job->failed ? job->num_chunks : job->next_chunk;
+  if (index < job->num_chunks) job->next_chunk++;
+  BROTLI_MUTEX_UNLOCK(&job->mutex);
+  return index;
+}
+
+static BROTLI_BOOL DecodeChunk(Job* job, BrotliDecoderState* s,
+    size_t index) {
+  BrotliDecoderChunk chunk;
+  const uint8_t* next_in;
+  size_t available_in;
+  uint8_t* next_out;
+  size_t available_out;
+  BrotliDecoderResult result;
+  if (!BrotliDecoderGetChunk(job->encoded_size, job->encoded, index, &chunk)) {
+    return BROTLI_FALSE;
+  }
+  BrotliDecoderReset(s);
+  if (!BrotliDecoderStartChunk(s, &chunk)) return BROTLI_FALSE;
+  next_in = job->encoded + chunk.compressed_offset;
+  available_in = chunk.compressed_size;
+  next_out = job->decoded + chunk.uncompressed_offset;
+  available_out = chunk.uncompressed_size;
+  result = BrotliDecoderDecompressStream(
+      s, &available_in, &next_in, &available_out, &next_out, NULL);
+  /* Chunk ends with a flush, so decoder waits for the next one; the last
+     chunk is followed by the index, which is not part of it. */
+  return TO_BROTLI_BOOL(result == BROTLI_DECODER_RESULT_NEEDS_MORE_INPUT &&
+      available_in == 0 && available_out == 0);
+}
+
+static void RunWorker(Job* job) {
+  BrotliDecoderState* s = BrotliDecoderCreateInstance(NULL, NULL, NULL);
+  BROTLI_BOOL failed = TO_BROTLI_BOOL(!s);
+  size_t index;
+  if (s) BrotliDecoderSetParameter(s, BROTLI_DECODER_PARAM_LARGE_WINDOW, 1u);
+  while ((index = TakeChunk(job, failed)) < job->num_chunks) {
+    failed = TO_BROTLI_BOOL(!DecodeChunk(job, s, index));
+  }
+  if (s) BrotliDecoderDestroyInstance(s);
+}
+
+#if defined(_WIN32)
+static DWORD WINAPI WorkerThread(LPVOID arg) {
+  RunWorker((Job*)arg);
+  return 0;
+}
+
+static BROTLI_BOOL StartThread(BrotliThread* thread, Job* job) {
+  *thread = CreateThread(NULL, 0, WorkerThread, job, 0, NULL);
+  return TO_BROTLI_BOOL(*thread != NULL);
+}
+
+static void JoinThread(BrotliThread thread) {
+  WaitForSingleObject(thread, INFINITE);
+  CloseHandle(thread);
+}
+#else
+static void* WorkerThread(void* arg) {
+  RunWorker((Job*)arg);
+  return NULL;
+}
+
+static BROTLI_BOOL StartThread(BrotliThread* thread, Job* job) {
+  return TO_BROTLI_BOOL(pthread_create(thread, NULL, WorkerThread, job) == 0);
+}
+
+static void JoinThread(BrotliThread thread) {
+  pthread_join(thread, NULL);
+}
+#endif
+
+/* Fallback for streams without index. */
+static BrotliDecoderResult DecompressSequential(size_t encoded_size,
+    const uint8_t* encoded, size_t* decoded_size, uint8_t* decoded) {
+  BrotliDecoderState* s = BrotliDecoderCreateInstance(NULL, NULL, NULL);
+  const uint8_t* next_in = encoded;
+  size_t available_in = encoded_size;
+  uint8_t* next_out = decoded;
+  size_t available_out = *decoded_size;
+  BrotliDecoderResult result;
+  if (!s) return BROTLI_DECODER_RESULT_ERROR;
+  BrotliDecoderSetParameter(s, BROTLI_DECODER_PARAM_LARGE_WINDOW, 1u);
+  result = BrotliDecoderDecompressStream(
+      s, &available_in, &next_in, &available_out, &next_out, NULL);
+  *decoded_size = (size_t)(next_out - decoded);
+  BrotliDecoderDestroyInstance(s);
+  if (result == BROTLI_DECODER_RESULT_NEEDS_MORE_INPUT) {
+    result = BROTLI_DECODER_RESULT_ERROR;
+  }
+  return result;
+}
+
+BROTLI_BOOL BrotliParallelDecodedSize(size_t encoded_size,
+    const uint8_t* encoded, size_t* decoded_size) {
+  size_t num_chunks = BrotliDecoderGetChunkCount(encoded_size, encoded);
+  BrotliDecoderChunk last;
+  if (num_chunks == 0 ||
+      !BrotliDecoderGetChunk(encoded_size, encoded, num_chunks - 1, &last)) {
+    return BROTLI_FALSE;
+  }
+  *decoded_size = last.uncompressed_offset + last.uncompressed_size;
+  return BROTLI_TRUE;
+}
+
+BrotliDecoderResult BrotliParallelDecompress(size_t encoded_size,
+    const uint8_t* encoded, int num_threads, size_t* decoded_size,
+    uint8_t* decoded) {
+  BrotliThread threads[BROTLI_PARALLEL_MAX_THREADS];
+  Job job;
+  size_t total_size;
+  int num_started = 0;
+  int i;
+
+  if (!BrotliParallelDecodedSize(encoded_size, encoded, &total_size)) {
+    return DecompressSequential(encoded_size, encoded, decoded_size, decoded);
+  }
+  if (total_size > *decoded_size) {
+    return BROTLI_DECODER_RESULT_NEEDS_MORE_OUTPUT;
+  }
+
+  job.encoded_size = encoded_size;
+  job.encoded = encoded;
+  job.decoded = decoded;
+  job.num_chunks = BrotliDecoderGetChunkCount(encoded_size, encoded);
+  job.next_chunk = 0;
+  job.failed = BROTLI_FALSE;
+  if (num_threads < 1) num_threads = 1;
+  if (num_threads > BROTLI_PARALLEL_MAX_THREADS) {
+    num_threads = BROTLI_PARALLEL_MAX_THREADS;
+  }
+  if ((size_t)num_threads > job.num_chunks) num_threads = (int)job.num_chunks;
+  if (!BROTLI_MUTEX_INIT(&job.mutex)) return BROTLI_DECODER_RESULT_ERROR;
+
+  /* Calling thread is a worker too; if thread could not be started, the
+     rest of chunks is decoded by those already running. */
+  for (i = 1; i < num_threads; ++i) {
+    if (!StartThread(&threads[num_started], &job)) break;
+    num_started++;
+  }
+  RunWorker(&job);
+  for (i = 0; i < num_started; ++i) JoinThread(threads[i]);
+  BROTLI_MUTEX_DESTROY(&job.mutex);
+
+  if (job.failed) return BROTLI_DECODER_RESULT_ERROR;
+  *decoded_size = total_size;
+  return BROTLI_DECODER_RESULT_SUCCESS;
+}
+
+#if defined(__cplusplus) || defined(c_plusplus)
+}  /* extern "C" */
+#endif
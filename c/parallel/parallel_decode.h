@@ -0,0 +1,71 @@
+/* Copyright 2026 The Brotli Authors. All Rights Reserved.
+
+   Distributed under MIT license.
+   See file LICENSE for detail or copy at https://opensource.org/licenses/MIT
+*/
+
+/**
+ * @file
+ * Multi-threaded decoding of chunked streams.
+ *
+ * Streams produced with ::BROTLI_PARAM_CHUNK_SIZE end with an index of
+ * independently decodable chunks. Chunks are spread across worker threads;
+ * each thread writes its chunks into disjoint ranges of the output buffer.
+ * Streams without an index are decoded sequentially.
+ */
+
+#ifndef BROTLI_PARALLEL_PARALLEL_DECODE_H_
+#define BROTLI_PARALLEL_PARALLEL_DECODE_H_
+
+#include <brotli/decode.h>
+#include <brotli/types.h>
+
+#if defined(__cplusplus) || defined(c_plusplus)
+extern "C" {
+#endif
+
+/** Upper bound of worker threads used by ::BrotliParallelDecompress. */
+#define BROTLI_PARALLEL_MAX_THREADS 256
+
+/**
+ * Gets the decoded size of a chunked stream.
+ *
+ * @param encoded_size size of @p encoded
+ * @param encoded compressed stream
+ * @param[out] decoded_size decoded size
+ * @returns ::BROTLI_FALSE if stream has no valid chunk index
+ */
+BROTLI_BOOL BrotliParallelDecodedSize(size_t encoded_size,
+    const uint8_t encoded[BROTLI_ARRAY_PARAM(encoded_size)],
+    size_t* decoded_size);
+
+/**
+ * Decompresses the stream, decoding chunks concurrently.
+ *
+ * Semantics mirror ::BrotliDecoderDecompress. Streams with large window
+ * are accepted.
+ *
+ * @param encoded_size size of @p encoded
+ * @param encoded compressed stream
+ * @param num_threads number of worker threads, including the calling one;
+ *        clamped to [1, ::BROTLI_PARALLEL_MAX_THREADS] and to the number of
+ *        chunks
+ * @param[in, out] decoded_size @b in: size of @p decoded; \n
+ *                 @b out: length of decompressed data
+ * @param[out] decoded decompressed data destination buffer
+ * @returns ::BROTLI_DECODER_RESULT_ERROR if input is corrupted or memory
+ *          allocation failed
+ * @returns ::BROTLI_DECODER_RESULT_NEEDS_MORE_OUTPUT if @p decoded is too
+ *          small
+ * @returns ::BROTLI_DECODER_RESULT_SUCCESS otherwise
+ */
+BrotliDecoderResult BrotliParallelDecompress(size_t encoded_size,
+    const uint8_t encoded[BROTLI_ARRAY_PARAM(encoded_size)], int num_threads,
+    size_t* decoded_size,
+    uint8_t decoded[BROTLI_ARRAY_PARAM(*decoded_size)]);
+
+#if defined(__cplusplus) || defined(c_plusplus)
+}  /* extern "C" */
+#endif
+
+#endif  /* BROTLI_PARALLEL_PARALLEL_DECODE_H_ */
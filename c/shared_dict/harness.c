@@ -0,0 +1,528 @@
+/* Copyright 2026 The Brotli Authors. All Rights Reserved.
+
+   Distributed under MIT license.
+   See file LICENSE for detail or copy at https://opensource.org/licenses/MIT
+*/
+
+/* Local simulation of "Shared Brotli" dictionary negotiation.
+
+   Client and server exchange textual headers in-process:
+     request:  Available-Dict: <dictionary URL> sha256-<base64>
+     response: Content-Encoding: sbr
+               Sbr-Dict: <dictionary URL> sha256-<base64>
+   Server looks up the advertised dictionary in the shared cache and falls
+   back to plain "br" if it does not know it. Client verifies the dictionary
+   hash, decodes the response and compares it to the original resource. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <brotli/decode.h>
+#include <brotli/encode.h>
+#include "./shared_dict.h"
+
+#if !defined(_WIN32)
+#include <pthread.h>
+#define HARNESS_THREADS 1
+#else
+#define HARNESS_THREADS 0
+#endif
+
+#define MAX_DICTIONARIES 16
+#define MAX_RESOURCES 64
+#define MAX_THREADS 64
+#define MAX_HEADER_SIZE 512
+
+typedef struct Blob {
+  const char* path;
+  char url[256];
+  uint8_t* data;
+  size_t size;
+  uint8_t hash[BROTLI_SHARED_DICT_HASH_SIZE];
+} Blob;
+
+typedef struct Harness {
+  BrotliSharedDictCache* cache;
+  int quality;
+  int rounds;
+  int num_threads;
+  BROTLI_BOOL verbose;
+  Blob dictionaries[MAX_DICTIONARIES];
+  size_t num_dictionaries;
+  Blob resources[MAX_RESOURCES];
+  size_t num_resources;
+} Harness;
+
+typedef struct Worker {
+  Harness* harness;
+  int index;
+  size_t num_requests;
+  size_t num_sbr;
+  size_t num_failures;
+} Worker;
+
+typedef struct Buffer {
+  uint8_t* data;
+  size_t size;
+  size_t capacity;
+} Buffer;
+
+static const char* FileName(const char* path) {
+  const char* name = path;
+  const char* p;
+  for (p = path; *p; ++p) {
+    if (*p == '/' || *p == '\\') name = p + 1;
+  }
+  return name;
+}
+
+static BROTLI_BOOL ReadBlob(const char* path, Blob* blob) {
+  FILE* file = fopen(path, "rb");
+  long size;
+  if (!file) {
+    fprintf(stderr, "failed to open [%s]\n", path);
+    return BROTLI_FALSE;
+  }
+  if (fseek(file, 0, SEEK_END) != 0 || (size = ftell(file)) < 0 ||
+      fseek(file, 0, SEEK_SET) != 0) {
+    fprintf(stderr, "failed to seek [%s]\n", path);
+    fclose(file);
+    return BROTLI_FALSE;
+  }
+  blob->path = path;
+  blob->size = (size_t)size;
+  blob->data = (uint8_t*)malloc(blob->size ? blob->size : 1);
+  if (!blob->data ||
+      fread(blob->data, 1, blob->size, file) != blob->size) {
+    fprintf(stderr, "failed to read [%s]\n", path);
+    fclose(file);
+    return BROTLI_FALSE;
+  }
+  fclose(file);
+  BrotliSharedDictComputeHash(blob->size, blob->data, blob->hash);
+  return BROTLI_TRUE;
+}
+
+static BROTLI_BOOL BufferAppend(Buffer* buffer, const uint8_t* data,
+    size_t size) {
+  if (buffer->size + size > buffer->capacity) {
+    size_t capacity = buffer->capacity ? buffer->capacity : 65536;
+    uint8_t* grown;
+    while (capacity < buffer->size + size) capacity *= 2;
+    grown = (uint8_t*)realloc(buffer->data, capacity);
+    if (!grown) return BROTLI_FALSE;
+    buffer->data = grown;
+    buffer->capacity = capacity;
+  }
+  memcpy(buffer->data + buffer->size, data, size);
+  buffer->size += size;
+  return BROTLI_TRUE;
+}
+
+/* Finds the value of header |name| in |headers|; returns its length. */
+static size_t FindHeader(const char* headers, const char* name,
+    const char** value) {
+  size_t name_length = strlen(name);
+  const char* line = headers;
+  while (*line) {
+    const char* end = strstr(line, "\r\n");
+    if (!end) end = line + strlen(line);
+    if ((size_t)(end - line) > name_length + 1 &&
+        strncmp(line, name, name_length) == 0 && line[name_length] == ':') {
+      const char* p = line + name_length + 1;
+      while (*p == ' ') ++p;
+      *value = p;
+      return (size_t)(end - p);
+    }
+    line = *end ? end + 2 : end;
+  }
+  return 0;
+}
+
+/* Splits "<url> <hash id>" dictionary identifier. */
+static BROTLI_BOOL ParseDictionaryId(const char* value, size_t length,
+    char* url, size_t url_capacity, uint8_t* hash) {
+  const char* space = (const char*)memchr(value, ' ', length);
+  size_t url_length;
+  if (!space) return BROTLI_FALSE;
+  url_length = (size_t)(space - value);
+  if (url_length == 0 || url_length >= url_capacity) return BROTLI_FALSE;
+  memcpy(url, value, url_length);
+  url[url_length] = 0;
+  return BrotliSharedDictParseHashId(
+      length - url_length - 1, space + 1, hash);
+}
+
+static BROTLI_BOOL Compress(int quality,
+    const BrotliEncoderPreparedDictionary* dictionary,
+    const Blob* resource, Buffer* body) {
+  BrotliEncoderState* s = BrotliEncoderCreateInstance(NULL, NULL, NULL);
+  const uint8_t* next_in = resource->data;
+  size_t available_in = resource->size;
+  BROTLI_BOOL ok = BROTLI_TRUE;
+  if (!s) return BROTLI_FALSE;
+  BrotliEncoderSetParameter(s, BROTLI_PARAM_QUALITY, (uint32_t)quality);
+  if (dictionary && !BrotliEncoderAttachPreparedDictionary(s, dictionary)) {
+    BrotliEncoderDestroyInstance(s);
+    return BROTLI_FALSE;
+  }
+  while (ok) {
+    uint8_t chunk[65536];
+    uint8_t* next_out = chunk;
+    size_t available_out = sizeof(chunk);
+    if (!BrotliEncoderCompressStream(s, BROTLI_OPERATION_FINISH,
+        &available_in, &next_in, &available_out, &next_out, NULL)) {
+      ok = BROTLI_FALSE;
+      break;
+    }
+    ok = BufferAppend(body, chunk, sizeof(chunk) - available_out);
+    if (BrotliEncoderIsFinished(s)) break;
+  }
+  BrotliEncoderDestroyInstance(s);
+  return ok;
+}
+
+static BROTLI_BOOL Decompress(const Blob* dictionary, const Buffer* body,
+    Buffer* output) {
+  BrotliDecoderState* s = BrotliDecoderCreateInstance(NULL, NULL, NULL);
+  BrotliDecoderResult result = BROTLI_DECODER_RESULT_NEEDS_MORE_OUTPUT;
+  const uint8_t* next_in = body->data;
+  size_t available_in = body->size;
+  BROTLI_BOOL ok = BROTLI_TRUE;
+  if (!s) return BROTLI_FALSE;
+  if (dictionary && !BrotliDecoderAttachDictionary(s,
+      BROTLI_SHARED_DICTIONARY_RAW, dictionary->size, dictionary->data)) {
+    BrotliDecoderDestroyInstance(s);
+    return BROTLI_FALSE;
+  }
+  while (ok && result == BROTLI_DECODER_RESULT_NEEDS_MORE_OUTPUT) {
+    uint8_t chunk[65536];
+    uint8_t* next_out = chunk;
+    size_t available_out = sizeof(chunk);
+    result = BrotliDecoderDecompressStream(s, &available_in, &next_in,
+        &available_out, &next_out, NULL);
+    ok = BufferAppend(output, chunk, sizeof(chunk) - available_out);
+  }
+  if (result != BROTLI_DECODER_RESULT_SUCCESS || available_in != 0) {
+    ok = BROTLI_FALSE;
+  }
+  BrotliDecoderDestroyInstance(s);
+  return ok;
+}
+
+/* Serves resource; fills response headers and body. */
+static BROTLI_BOOL Serve(Harness* harness, const Blob* resource,
+    const char* request_headers, char* response_headers, Buffer* body) {
+  const char* value;
+  size_t length = FindHeader(request_headers, "Available-Dict", &value);
+  const BrotliSharedDict* dictionary = NULL;
+  char url[256];
+  uint8_t hash[BROTLI_SHARED_DICT_HASH_SIZE];
+  BROTLI_BOOL ok;
+
+  if (length && ParseDictionaryId(value, length, url, sizeof(url), hash)) {
+    /* Server may only use dictionaries it has; look up in the store. */
+    size_t i;
+    for (i = 0; i < harness->num_dictionaries; ++i) {
+      const Blob* candidate = &harness->dictionaries[i];
+      if (memcmp(candidate->hash, hash, sizeof(hash)) == 0) {
+        dictionary = BrotliSharedDictCacheLookupOrPrepare(harness->cache,
+            candidate->size, candidate->data, candidate->hash);
+        break;
+      }
+    }
+  }
+
+  if (dictionary) {
+    char id[BROTLI_SHARED_DICT_HASH_ID_SIZE];
+    BrotliSharedDictFormatHashId(BrotliSharedDictHash(dictionary), id);
+    sprintf(response_headers,
+        "Content-Encoding: sbr\r\nSbr-Dict: %s %s\r\n", url, id);
+    ok = Compress(harness->quality, BrotliSharedDictPrepared(dictionary),
+        resource, body);
+    BrotliSharedDictCacheRelease(harness->cache, dictionary);
+  } else {
+    sprintf(response_headers, "Content-Encoding: br\r\n");
+    ok = Compress(harness->quality, NULL, resource, body);
+  }
+  return ok;
+}
+
+/* Performs single request; returns BROTLI_FALSE on any mismatch. */
+static BROTLI_BOOL Fetch(Harness* harness, size_t resource_index,
+    size_t dictionary_index, BROTLI_BOOL* used_dictionary) {
+  const Blob* resource = &harness->resources[resource_index];
+  const Blob* dictionary = NULL;
+  char request_headers[MAX_HEADER_SIZE];
+  char response_headers[MAX_HEADER_SIZE];
+  char id[BROTLI_SHARED_DICT_HASH_ID_SIZE];
+  Buffer body = {NULL, 0, 0};
+  Buffer output = {NULL, 0, 0};
+  const char* value;
+  size_t length;
+  BROTLI_BOOL ok;
+
+  if (dictionary_index < harness->num_dictionaries) {
+    const Blob* advertised = &harness->dictionaries[dictionary_index];
+    BrotliSharedDictFormatHashId(advertised->hash, id);
+    sprintf(request_headers, "Accept-Encoding: sbr, br\r\n"
+        "Available-Dict: %s %s\r\n", advertised->url, id);
+  } else {
+    /* Advertise dictionary server does not have. */
+    uint8_t unknown[BROTLI_SHARED_DICT_HASH_SIZE];
+    BrotliSharedDictComputeHash(strlen(resource->url),
+        (const uint8_t*)resource->url, unknown);
+    BrotliSharedDictFormatHashId(unknown, id);
+    sprintf(request_headers, "Accept-Encoding: sbr, br\r\n"
+        "Available-Dict: /dict/unknown %s\r\n", id);
+  }
+
+  ok = Serve(harness, resource, request_headers, response_headers, &body);
+
+  *used_dictionary = BROTLI_FALSE;
+  if (ok) {
+    length = FindHeader(response_headers, "Content-Encoding", &value);
+    if (length == 3 && memcmp(value, "sbr", 3) == 0) {
+      char url[256];
+      uint8_t hash[BROTLI_SHARED_DICT_HASH_SIZE];
+      size_t i;
+      /* "sbr" without "Sbr-Dict" is a network error. */
+      length = FindHeader(response_headers, "Sbr-Dict", &value);
+      ok = TO_BROTLI_BOOL(length &&
+          ParseDictionaryId(value, length, url, sizeof(url), hash));
+      for (i = 0; ok && i < harness->num_dictionaries; ++i) {
+        if (strcmp(harness->dictionaries[i].url, url) == 0) {
+          dictionary = &harness->dictionaries[i];
+          break;
+        }
+      }
+      /* Client MUST verify the dictionary it has. */
+      if (ok && dictionary) {
+        uint8_t actual[BROTLI_SHARED_DICT_HASH_SIZE];
+        BrotliSharedDictComputeHash(dictionary->size, dictionary->data,
+            actual);
+        ok = TO_BROTLI_BOOL(memcmp(actual, hash, sizeof(hash)) == 0);
+      } else {
+        ok = BROTLI_FALSE;
+      }
+      *used_dictionary = BROTLI_TRUE;
+    } else if (length != 2 || memcmp(value, "br", 2) != 0) {
+      ok = BROTLI_FALSE;
+    }
+  }
+  if (ok) ok = Decompress(dictionary, &body, &output);
+  if (ok) {
+    ok = TO_BROTLI_BOOL(output.size == resource->size &&
+        (output.size == 0 ||
+         memcmp(output.data, resource->data, output.size) == 0));
+  }
+
+  if (harness->verbose || !ok) {
+    fprintf(stderr, "%s %s: %lu -> %lu bytes, dictionary %s\n",
+        ok ? "OK" : "FAIL", resource->url, (unsigned long)resource->size,
+        (unsigned long)body.size, dictionary ? dictionary->url : "none");
+  }
+  free(body.data);
+  free(output.data);
+  return ok;
+}
+
+static void RunWorker(Worker* worker) {
+  Harness* harness = worker->harness;
+  size_t num_choices = harness->num_dictionaries + 1;
+  size_t total = (size_t)harness->rounds * harness->num_resources;
+  size_t i;
+  for (i = (size_t)worker->index; i < total;
+      i += (size_t)harness->num_threads) {
+    size_t resource_index = i % harness->num_resources;
+    /* Rotate advertised dictionary, including the unknown one. */
+    size_t dictionary_index =
+        (resource_index + i / harness->num_resources) % num_choices;
+    BROTLI_BOOL used_dictionary;
+    worker->num_requests++;
+    if (!Fetch(harness, resource_index, dictionary_index, &used_dictionary)) {
+      worker->num_failures++;
+    }
+    if (used_dictionary) worker->num_sbr++;
+  }
+}
+
+#if HARNESS_THREADS
+static void* WorkerThread(void* arg) {
+  RunWorker((Worker*)arg);
+  return NULL;
+}
+#endif
+
+static BROTLI_BOOL ParseNumber(const char* arg, const char* name,
+    unsigned long* value) {
+  size_t name_length = strlen(name);
+  char* end;
+  if (strncmp(arg, name, name_length) != 0 || arg[name_length] != '=') {
+    return BROTLI_FALSE;
+  }
+  *value = strtoul(arg + name_length + 1, &end, 10);
+  if (*end != 0) {
+    fprintf(stderr, "invalid value in [%s]\n", arg);
+    exit(1);
+  }
+  return BROTLI_TRUE;
+}
+
+/* Checks that dictionary with a wrong hash is rejected and not cached. */
+static BROTLI_BOOL CheckWrongHash(Harness* harness) {
+  const Blob* blob = &harness->dictionaries[0];
+  uint8_t hash[BROTLI_SHARED_DICT_HASH_SIZE];
+  const BrotliSharedDict* dictionary;
+  memcpy(hash, blob->hash, sizeof(hash));
+  hash[0] ^= 1;
+  dictionary = BrotliSharedDictCacheLookupOrPrepare(harness->cache,
+      blob->size, blob->data, hash);
+  if (dictionary) {
+    BrotliSharedDictCacheRelease(harness->cache, dictionary);
+    return BROTLI_FALSE;
+  }
+  dictionary = BrotliSharedDictCacheLookup(harness->cache, hash);
+  if (dictionary) {
+    BrotliSharedDictCacheRelease(harness->cache, dictionary);
+    return BROTLI_FALSE;
+  }
+  return BROTLI_TRUE;
+}
+
+static void PrintHelp(const char* name) {
+  fprintf(stdout,
+"Usage: %s [OPTION]... --dict=FILE... RESOURCE...\n"
+"Simulates Shared Brotli negotiation between client and server.\n"
+"Options:\n"
+"  --dict=FILE           dictionary both client and server have\n"
+"  --memory-limit=NUM    dictionary cache memory limit, default: 67108864\n"
+"  --quality=NUM         compression quality, default: 5\n"
+"  --rounds=NUM          requests per resource, default: 4\n"
+"  --threads=NUM         concurrent clients, default: 1\n"
+"  --verbose             report every request\n",
+      name);
+}
+
+int main(int argc, char** argv) {
+  Harness harness;
+  Worker workers[MAX_THREADS];
+  BrotliSharedDictCacheStats stats;
+  unsigned long memory_limit = 64ul << 20;
+  unsigned long value;
+  size_t num_requests = 0;
+  size_t num_sbr = 0;
+  size_t num_failures = 0;
+  size_t i;
+  int t;
+
+  memset(&harness, 0, sizeof(harness));
+  harness.quality = 5;
+  harness.rounds = 4;
+  harness.num_threads = 1;
+  for (i = 1; i < (size_t)argc; ++i) {
+    const char* arg = argv[i];
+    if (strncmp(arg, "--dict=", 7) == 0) {
+      Blob* blob;
+      if (harness.num_dictionaries == MAX_DICTIONARIES) {
+        fprintf(stderr, "too many dictionaries\n");
+        return 1;
+      }
+      blob = &harness.dictionaries[harness.num_dictionaries++];
+      if (!ReadBlob(arg + 7, blob)) return 1;
+      sprintf(blob->url, "/dict/%.240s", FileName(blob->path));
+    } else if (ParseNumber(arg, "--memory-limit", &value)) {
+      memory_limit = value;
+    } else if (ParseNumber(arg, "--quality", &value)) {
+      harness.quality = (int)value;
+    } else if (ParseNumber(arg, "--rounds", &value)) {
+      harness.rounds = (int)value;
+    } else if (ParseNumber(arg, "--threads", &value)) {
+      if (value < 1 || value > MAX_THREADS) {
+        fprintf(stderr, "invalid number of threads\n");
+        return 1;
+      }
+      harness.num_threads = (int)value;
+    } else if (strcmp(arg, "--verbose") == 0) {
+      harness.verbose = BROTLI_TRUE;
+    } else if (strcmp(arg, "--help") == 0) {
+      PrintHelp(FileName(argv[0]));
+      return 0;
+    } else if (arg[0] == '-' && arg[1] == '-') {
+      fprintf(stderr, "unknown option [%s]\n", arg);
+      return 1;
+    } else {
+      Blob* blob;
+      if (harness.num_resources == MAX_RESOURCES) {
+        fprintf(stderr, "too many resources\n");
+        return 1;
+      }
+      blob = &harness.resources[harness.num_resources++];
+      if (!ReadBlob(arg, blob)) return 1;
+      sprintf(blob->url, "/res/%.240s", FileName(blob->path));
+    }
+  }
+  if (harness.num_dictionaries == 0 || harness.num_resources == 0) {
+    PrintHelp(FileName(argv[0]));
+    return 1;
+  }
+#if !HARNESS_THREADS
+  harness.num_threads = 1;
+#endif
+
+  harness.cache = BrotliSharedDictCacheCreate(
+      (size_t)memory_limit, harness.quality);
+  if (!harness.cache) {
+    fprintf(stderr, "failed to create cache\n");
+    return 1;
+  }
+  if (!CheckWrongHash(&harness)) {
+    fprintf(stderr, "dictionary with wrong hash was accepted\n");
+    return 1;
+  }
+
+  for (t = 0; t < harness.num_threads; ++t) {
+    memset(&workers[t], 0, sizeof(Worker));
+    workers[t].harness = &harness;
+    workers[t].index = t;
+  }
+#if HARNESS_THREADS
+  {
+    pthread_t threads[MAX_THREADS];
+    for (t = 0; t < harness.num_threads; ++t) {
+      if (pthread_create(&threads[t], NULL, WorkerThread, &workers[t]) != 0) {
+        fprintf(stderr, "failed to start thread\n");
+        return 1;
+      }
+    }
+    for (t = 0; t < harness.num_threads; ++t) pthread_join(threads[t], NULL);
+  }
+#else
+  RunWorker(&workers[0]);
+#endif
+
+  for (t = 0; t < harness.num_threads; ++t) {
+    num_requests += workers[t].num_requests;
+    num_sbr += workers[t].num_sbr;
+    num_failures += workers[t].num_failures;
+  }
+  BrotliSharedDictCacheGetStats(harness.cache, &stats);
+  fprintf(stdout, "requests: %lu (sbr: %lu), failures: %lu\n",
+      (unsigned long)num_requests, (unsigned long)num_sbr,
+      (unsigned long)num_failures);
+  fprintf(stdout, "cache: %lu hits, %lu misses, %lu evictions, "
+      "%lu entries, %lu bytes\n",
+      (unsigned long)stats.hits, (unsigned long)stats.misses,
+      (unsigned long)stats.evictions, (unsigned long)stats.num_entries,
+      (unsigned long)stats.memory_usage);
+
+  BrotliSharedDictCacheDestroy(harness.cache);
+  for (i = 0; i < harness.num_dictionaries; ++i) {
+    free(harness.dictionaries[i].data);
+  }
+  for (i = 0; i < harness.num_resources; ++i) {
+    free(harness.resources[i].data);
+  }
+  return num_failures ? 1 : 0;
+}
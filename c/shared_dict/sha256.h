@@ -0,0 +1,27 @@
+/* Copyright 2026 The Brotli Authors. All Rights Reserved.
+
+   Distributed under MIT license.
+   See file LICENSE for detail or copy at https://opensource.org/licenses/MIT
+*/
+
+/* SHA-256 (FIPS 180-4) used to identify shared dictionaries. */
+
+#ifndef BROTLI_SHARED_DICT_SHA256_H_
+#define BROTLI_SHARED_DICT_SHA256_H_
+
+#include <brotli/types.h>
+
+#if defined(__cplusplus) || defined(c_plusplus)
+extern "C" {
+#endif
+
+#define BROTLI_SHA256_SIZE 32
+
+void BrotliSha256(const uint8_t* data, size_t size,
+                  uint8_t digest[BROTLI_SHA256_SIZE]);
+
+#if defined(__cplusplus) || defined(c_plusplus)
+}  /* extern "C" */
+#endif
+
+#endif  /* BROTLI_SHARED_DICT_SHA256_H_ */
@@ -0,0 +1,403 @@
+/* Copyright 2026 The Brotli Authors. All Rights Reserved.
+
+   Distributed under MIT license.
+   See file LICENSE for detail or copy at https://opensource.org/licenses/MIT
+*/
+
+/* Cache of prepared shared dictionaries, keyed by content hash. */
+
+#include "./shared_dict.h"
+
+#include <assert.h>
+#include <stdlib.h>  /* free, malloc */
+#include <string.h>  /* memcmp, memcpy */
+
+#include <brotli/encode.h>
+#include <brotli/types.h>
+#include "./sha256.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+typedef CRITICAL_SECTION BrotliMutex;
+#define BROTLI_MUTEX_INIT(M) (InitializeCriticalSection(M), 1)
+#define BROTLI_MUTEX_DESTROY(M) DeleteCriticalSection(M)
+#define BROTLI_MUTEX_LOCK(M) EnterCriticalSection(M)
+#define BROTLI_MUTEX_UNLOCK(M) LeaveCriticalSection(M)
+#else
+#include <pthread.h>
+typedef pthread_mutex_t BrotliMutex;
+#define BROTLI_MUTEX_INIT(M) (pthread_mutex_init(M, NULL) == 0)
+#define BROTLI_MUTEX_DESTROY(M) pthread_mutex_destroy(M)
+#define BROTLI_MUTEX_LOCK(M) pthread_mutex_lock(M)
+#define BROTLI_MUTEX_UNLOCK(M) pthread_mutex_unlock(M)
+#endif
+
+#if defined(__cplusplus) || defined(c_plusplus)
+extern "C" {
+#endif
+
+/* Entries are bucketed by the first byte of hash; SHA-256 is uniform. */
+#define NUM_BUCKETS 256
+
+struct BrotliSharedDictStruct {
+  uint8_t hash[BROTLI_SHARED_DICT_HASH_SIZE];
+  uint8_t* data;
+  size_t size;
+  BrotliEncoderPreparedDictionary* prepared;
+  /* Accounted against memory limit: data + search index. */
+  size_t memory;
+  /* Number of outstanding references; guarded by cache mutex. */
+  size_t ref_count;
+  /* BROTLI_TRUE while entry is reachable from buckets / LRU list. */
+  BROTLI_BOOL is_cached;
+  struct BrotliSharedDictStruct* bucket_next;
+  /* LRU list: head is most recently used. */
+  struct BrotliSharedDictStruct* lru_prev;
+  struct BrotliSharedDictStruct* lru_next;
+};
+
+struct BrotliSharedDictCacheStruct {
+  BrotliMutex mutex;
+  size_t memory_limit;
+  int quality;
+  BrotliSharedDict* buckets[NUM_BUCKETS];
+  BrotliSharedDict* lru_head;
+  BrotliSharedDict* lru_tail;
+  BrotliSharedDictCacheStats stats;
+  /* Dictionaries handed out and not released yet; guarded by mutex. */
+  size_t num_references;
+};
+
+static void DestroyEntry(BrotliSharedDict* entry) {
+  if (entry->prepared) BrotliEncoderDestroyPreparedDictionary(entry->prepared);
+  free(entry->data);
+  free(entry);
+}
+
+static BrotliSharedDict* CreateEntry(size_t size, const uint8_t* data,
+    const uint8_t* hash, int quality) {
+  BrotliSharedDict* entry = (BrotliSharedDict*)malloc(sizeof(BrotliSharedDict));
+  if (!entry) return NULL;
+  memset(entry, 0, sizeof(BrotliSharedDict));
+  /* Prepared dictionary refers to data, so keep a private copy. */
+  entry->data = (uint8_t*)malloc(size ? size : 1);
+  if (!entry->data) {
+    DestroyEntry(entry);
+    return NULL;
+  }
+  memcpy(entry->data, data, size);
+  entry->size = size;
+  if (hash) {
+    memcpy(entry->hash, hash, BROTLI_SHARED_DICT_HASH_SIZE);
+  } else {
+    BrotliSha256(data, size, entry->hash);
+  }
+  entry->prepared = BrotliEncoderPrepareDictionary(
+      size, entry->data, quality, NULL, NULL, NULL);
+  if (!entry->prepared) {
+    DestroyEntry(entry);
+    return NULL;
+  }
+  entry->memory = size + sizeof(BrotliSharedDict) +
+      BrotliEncoderGetPreparedDictionarySerializedSize(entry->prepared);
+  entry->ref_count = 1;
+  return entry;
+}
+
+/* Following functions MUST be called with cache mutex held. */
+
+static BrotliSharedDict* FindEntry(BrotliSharedDictCache* cache,
+    const uint8_t* hash) {
+  BrotliSharedDict* entry = cache->buckets[hash[0]];
+  while (entry) {
+    if (memcmp(entry->hash, hash, BROTLI_SHARED_DICT_HASH_SIZE) == 0) {
+      return entry;
+    }
+    entry = entry->bucket_next;
+  }
+  return NULL;
+}
+
+static void LruUnlink(BrotliSharedDictCache* cache, BrotliSharedDict* entry) {
+  if (entry->lru_prev) {
+    entry->lru_prev->lru_next = entry->lru_next;
+  } else {
+    cache->lru_head = entry->lru_next;
+  }
+  if (entry->lru_next) {
+    entry->lru_next->lru_prev = entry->lru_prev;
+  } else {
+    cache->lru_tail = entry->lru_prev;
+  }
+  entry->lru_prev = NULL;
+  entry->lru_next = NULL;
+}
+
+static void LruPushFront(BrotliSharedDictCache* cache,
+    BrotliSharedDict* entry) {
+  entry->lru_prev = NULL;
+  entry->lru_next = cache->lru_head;
+  if (cache->lru_head) {
+    cache->lru_head->lru_prev = entry;
+  } else {
+    cache->lru_tail = entry;
+  }
+  cache->lru_head = entry;
+}
+
+/* Unlinks entry from the cache; returns BROTLI_TRUE if it is not used. */
+static BROTLI_BOOL RemoveEntry(BrotliSharedDictCache* cache,
+    BrotliSharedDict* entry) {
+  BrotliSharedDict** link = &cache->buckets[entry->hash[0]];
+  while (*link != entry) link = &(*link)->bucket_next;
+  *link = entry->bucket_next;
+  entry->bucket_next = NULL;
+  LruUnlink(cache, entry);
+  entry->is_cached = BROTLI_FALSE;
+  cache->stats.num_entries--;
+  cache->stats.memory_usage -= entry->memory;
+  return TO_BROTLI_BOOL(entry->ref_count == 0);
+}
+
+/* Evicts least recently used entries until |extra| bytes fit the limit.
+   Unused evicted entries are chained via |bucket_next| to |*garbage|. */
+static void MakeRoom(BrotliSharedDictCache* cache, size_t extra,
+    BrotliSharedDict** garbage) {
+  while (cache->lru_tail &&
+      cache->stats.memory_usage + extra > cache->memory_limit) {
+    BrotliSharedDict* victim = cache->lru_tail;
+    cache->stats.evictions++;
+    if (RemoveEntry(cache, victim)) {
+      victim->bucket_next = *garbage;
+      *garbage = victim;
+    }
+  }
+}
+
+static void InsertEntry(BrotliSharedDictCache* cache,
+    BrotliSharedDict* entry) {
+  BrotliSharedDict** bucket = &cache->buckets[entry->hash[0]];
+  entry->bucket_next = *bucket;
+  *bucket = entry;
+  LruPushFront(cache, entry);
+  entry->is_cached = BROTLI_TRUE;
+  cache->stats.num_entries++;
+  cache->stats.memory_usage += entry->memory;
+}
+
+static void DestroyGarbage(BrotliSharedDict* garbage) {
+  while (garbage) {
+    BrotliSharedDict* next = garbage->bucket_next;
+    DestroyEntry(garbage);
+    garbage = next;
+  }
+}
+
+BrotliSharedDictCache* BrotliSharedDictCacheCreate(
+    size_t memory_limit, int quality) {
+  BrotliSharedDictCache* cache =
+      (BrotliSharedDictCache*)malloc(sizeof(BrotliSharedDictCache));
+  if (!cache) return NULL;
+  memset(cache, 0, sizeof(BrotliSharedDictCache));
+  if (!BROTLI_MUTEX_INIT(&cache->mutex)) {
+    free(cache);
+    return NULL;
+  }
+  cache->memory_limit = memory_limit;
+  cache->quality = quality;
+  return cache;
+}
+
+void BrotliSharedDictCacheDestroy(BrotliSharedDictCache* cache) {
+  if (!cache) return;
+  /* Entries still in use would be freed under their users. */
+  assert(cache->num_references == 0);
+  while (cache->lru_head) {
+    BrotliSharedDict* entry = cache->lru_head;
+    RemoveEntry(cache, entry);
+    DestroyEntry(entry);
+  }
+  BROTLI_MUTEX_DESTROY(&cache->mutex);
+  free(cache);
+}
+
+const BrotliSharedDict* BrotliSharedDictCacheLookup(
+    BrotliSharedDictCache* cache,
+    const uint8_t hash[BROTLI_SHARED_DICT_HASH_SIZE]) {
+  BrotliSharedDict* entry;
+  BROTLI_MUTEX_LOCK(&cache->mutex);
+  entry = FindEntry(cache, hash);
+  if (entry) {
+    entry->ref_count++;
+    cache->num_references++;
+    LruUnlink(cache, entry);
+    LruPushFront(cache, entry);
+    cache->stats.hits++;
+  } else {
+    cache->stats.misses++;
+  }
+  BROTLI_MUTEX_UNLOCK(&cache->mutex);
+  return entry;
+}
+
+const BrotliSharedDict* BrotliSharedDictCacheLookupOrPrepare(
+    BrotliSharedDictCache* cache, size_t size, const uint8_t* data,
+    const uint8_t* hash) {
+  uint8_t computed_hash[BROTLI_SHARED_DICT_HASH_SIZE];
+  BrotliSharedDict* entry;
+  BrotliSharedDict* existing;
+  BrotliSharedDict* garbage = NULL;
+  if (!hash) {
+    BrotliSha256(data, size, computed_hash);
+    hash = computed_hash;
+  }
+  entry = (BrotliSharedDict*)BrotliSharedDictCacheLookup(cache, hash);
+  if (entry) return entry;
+  if (hash != computed_hash) {
+    /* Do not let a wrong hash poison the cache. */
+    BrotliSha256(data, size, computed_hash);
+    if (memcmp(computed_hash, hash, BROTLI_SHARED_DICT_HASH_SIZE) != 0) {
+      return NULL;
+    }
+  }
+
+  /* Preparation takes a while; do not block other users meanwhile. */
+  entry = CreateEntry(size, data, hash, cache->quality);
+  if (!entry) return NULL;
+
+  BROTLI_MUTEX_LOCK(&cache->mutex);
+  existing = FindEntry(cache, hash);
+  if (existing) {
+    /* Lost the race; prefer the instance other users already hold. */
+    existing->ref_count++;
+    cache->num_references++;
+    LruUnlink(cache, existing);
+    LruPushFront(cache, existing);
+    BROTLI_MUTEX_UNLOCK(&cache->mutex);
+    DestroyEntry(entry);
+    return existing;
+  }
+  cache->num_references++;
+  if (entry->memory <= cache->memory_limit) {
+    MakeRoom(cache, entry->memory, &garbage);
+    InsertEntry(cache, entry);
+  }
+  BROTLI_MUTEX_UNLOCK(&cache->mutex);
+  DestroyGarbage(garbage);
+  return entry;
+}
+
+void BrotliSharedDictCacheRelease(
+    BrotliSharedDictCache* cache, const BrotliSharedDict* dictionary) {
+  BrotliSharedDict* entry = (BrotliSharedDict*)dictionary;
+  BROTLI_BOOL is_garbage;
+  if (!entry) return;
+  BROTLI_MUTEX_LOCK(&cache->mutex);
+  entry->ref_count--;
+  cache->num_references--;
+  is_garbage = TO_BROTLI_BOOL(entry->ref_count == 0 && !entry->is_cached);
+  BROTLI_MUTEX_UNLOCK(&cache->mutex);
+  if (is_garbage) DestroyEntry(entry);
+}
+
+void BrotliSharedDictCacheGetStats(
+    BrotliSharedDictCache* cache, BrotliSharedDictCacheStats* stats) {
+  BROTLI_MUTEX_LOCK(&cache->mutex);
+  *stats = cache->stats;
+  BROTLI_MUTEX_UNLOCK(&cache->mutex);
+}
+
+const BrotliEncoderPreparedDictionary* BrotliSharedDictPrepared(
+    const BrotliSharedDict* dictionary) {
+  return dictionary->prepared;
+}
+
+const uint8_t* BrotliSharedDictData(
+    const BrotliSharedDict* dictionary, size_t* size) {
+  *size = dictionary->size;
+  return dictionary->data;
+}
+
+const uint8_t* BrotliSharedDictHash(const BrotliSharedDict* dictionary) {
+  return dictionary->hash;
+}
+
+void BrotliSharedDictComputeHash(size_t size, const uint8_t* data,
+    uint8_t hash[BROTLI_SHARED_DICT_HASH_SIZE]) {
+  BrotliSha256(data, size, hash);
+}
+
+static const char kHashIdPrefix[] = "sha256-";
+#define HASH_ID_PREFIX_SIZE (sizeof(kHashIdPrefix) - 1)
+
+static const char kBase64Alphabet[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+void BrotliSharedDictFormatHashId(
+    const uint8_t hash[BROTLI_SHARED_DICT_HASH_SIZE], char* id) {
+  size_t i;
+  char* out = id + HASH_ID_PREFIX_SIZE;
+  memcpy(id, kHashIdPrefix, HASH_ID_PREFIX_SIZE);
+  for (i = 0; i + 3 <= BROTLI_SHARED_DICT_HASH_SIZE; i += 3) {
+    uint32_t v = ((uint32_t)hash[i] << 16) | ((uint32_t)hash[i + 1] << 8) |
+        hash[i + 2];
+    *out++ = kBase64Alphabet[(v >> 18) & 63];
+    *out++ = kBase64Alphabet[(v >> 12) & 63];
+    *out++ = kBase64Alphabet[(v >> 6) & 63];
+    *out++ = kBase64Alphabet[v & 63];
+  }
+  /* 32 = 3 * 10 + 2: last group has 2 bytes and one padding character. */
+  {
+    uint32_t v = ((uint32_t)hash[i] << 16) | ((uint32_t)hash[i + 1] << 8);
+    *out++ = kBase64Alphabet[(v >> 18) & 63];
+    *out++ = kBase64Alphabet[(v >> 12) & 63];
+    *out++ = kBase64Alphabet[(v >> 6) & 63];
+    *out++ = '=';
+  }
+  *out = 0;
+}
+
+static int Base64Value(char c) {
+  if (c >= 'A' && c <= 'Z') return c - 'A';
+  if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+  if (c >= '0' && c <= '9') return c - '0' + 52;
+  /* Accept both standard and URL-safe alphabets. */
+  if (c == '+' || c == '-') return 62;
+  if (c == '/' || c == '_') return 63;
+  return -1;
+}
+
+BROTLI_BOOL BrotliSharedDictParseHashId(size_t length, const char* id,
+    uint8_t hash[BROTLI_SHARED_DICT_HASH_SIZE]) {
+  /* 32 bytes are encoded with 43 characters; padding is optional. */
+  const size_t kDigits = 43;
+  uint32_t acc = 0;
+  size_t bits = 0;
+  size_t pos = 0;
+  size_t i;
+  if (length < HASH_ID_PREFIX_SIZE ||
+      memcmp(id, kHashIdPrefix, HASH_ID_PREFIX_SIZE) != 0) {
+    return BROTLI_FALSE;
+  }
+  id += HASH_ID_PREFIX_SIZE;
+  length -= HASH_ID_PREFIX_SIZE;
+  if (length == kDigits + 1 && id[kDigits] == '=') length--;
+  if (length != kDigits) return BROTLI_FALSE;
+  for (i = 0; i < kDigits; ++i) {
+    int v = Base64Value(id[i]);
+    if (v < 0) return BROTLI_FALSE;
+    acc = (acc << 6) | (uint32_t)v;
+    bits += 6;
+    if (bits >= 8) {
+      bits -= 8;
+      hash[pos++] = (uint8_t)(acc >> bits);
+      acc &= (1u << bits) - 1;
+    }
+  }
+  /* Non-canonical encodings have non-zero trailing bits. */
+  return TO_BROTLI_BOOL(acc == 0);
+}
+
+#if defined(__cplusplus) || defined(c_plusplus)
+}  /* extern "C" */
+#endif
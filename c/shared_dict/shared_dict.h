@@ -0,0 +1,169 @@
+/* Copyright 2026 The Brotli Authors. All Rights Reserved.
+
+   Distributed under MIT license.
+   See file LICENSE for detail or copy at https://opensource.org/licenses/MIT
+*/
+
+/**
+ * @file
+ * Cache of prepared shared dictionaries, keyed by content hash.
+ *
+ * Helps servers that implement "Shared Brotli" negotiation (see
+ * fetch-spec/shared-brotli-fetch-spec.txt): client advertises cached
+ * dictionaries with @c Available-Dict header, server picks one it knows and
+ * announces it with @c Sbr-Dict header. Dictionary is identified by SHA-256
+ * of its contents, formatted as Subresource Integrity token
+ * (@c "sha256-<base64>"), so the same dictionary served from different URLs
+ * is prepared only once.
+ *
+ * All cache functions are thread-safe.
+ */
+
+#ifndef BROTLI_SHARED_DICT_SHARED_DICT_H_
+#define BROTLI_SHARED_DICT_SHARED_DICT_H_
+
+#include <brotli/encode.h>
+#include <brotli/types.h>
+
+#if defined(__cplusplus) || defined(c_plusplus)
+extern "C" {
+#endif
+
+/** Size of dictionary hash (SHA-256) in bytes. */
+#define BROTLI_SHARED_DICT_HASH_SIZE 32
+
+/** Buffer size required for ::BrotliSharedDictFormatHashId output. */
+#define BROTLI_SHARED_DICT_HASH_ID_SIZE 52
+
+/** Opaque cache instance. */
+typedef struct BrotliSharedDictCacheStruct BrotliSharedDictCache;
+
+/** Opaque cached dictionary; valid until released. */
+typedef struct BrotliSharedDictStruct BrotliSharedDict;
+
+/** Cache counters, see ::BrotliSharedDictCacheGetStats. */
+typedef struct BrotliSharedDictCacheStats {
+  /** Lookups that found the dictionary in cache. */
+  uint64_t hits;
+  /** Lookups that did not find the dictionary in cache. */
+  uint64_t misses;
+  /** Dictionaries evicted to stay within the memory limit. */
+  uint64_t evictions;
+  /** Number of dictionaries currently in cache. */
+  size_t num_entries;
+  /** Memory used by dictionaries currently in cache, in bytes. */
+  size_t memory_usage;
+} BrotliSharedDictCacheStats;
+
+/**
+ * Creates a cache instance.
+ *
+ * @param memory_limit upper bound of memory used by cached dictionaries
+ *        (data and search index); least recently used dictionaries are
+ *        evicted to stay below it
+ * @param quality quality dictionaries are prepared for, see
+ *        ::BrotliEncoderPrepareDictionary
+ * @returns @c 0 if memory allocation failed
+ */
+BrotliSharedDictCache* BrotliSharedDictCacheCreate(
+    size_t memory_limit, int quality);
+
+/**
+ * Destroys the cache instance.
+ *
+ * @warning All dictionaries obtained from the cache @b MUST be released
+ *          before; debug builds assert that no references are left.
+ */
+void BrotliSharedDictCacheDestroy(BrotliSharedDictCache* cache);
+
+/**
+ * Finds dictionary with the given hash.
+ *
+ * @returns @c 0 if the dictionary is not in cache
+ * @returns dictionary that @b MUST be released with
+ *          ::BrotliSharedDictCacheRelease otherwise
+ */
+const BrotliSharedDict* BrotliSharedDictCacheLookup(
+    BrotliSharedDictCache* cache,
+    const uint8_t hash[BROTLI_SHARED_DICT_HASH_SIZE]);
+
+/**
+ * Finds dictionary with the given contents, or prepares and caches it.
+ *
+ * Data is copied, so it could be discarded right after the call. Expensive
+ * preparation runs without holding the cache lock; concurrent callers that
+ * prepare the same dictionary all get the instance cached first.
+ *
+ * Dictionary larger than the memory limit is prepared, but not cached.
+ *
+ * Before dictionary is prepared and cached, @p hash is checked against
+ * @p data, so a wrong hash could not make later lookups find another
+ * dictionary.
+ *
+ * @param size size of @p data
+ * @param data dictionary contents
+ * @param hash hash of @p data, if known; otherwise @c 0
+ * @returns @c 0 if memory allocation failed, or @p hash does not match
+ *          @p data
+ * @returns dictionary that @b MUST be released with
+ *          ::BrotliSharedDictCacheRelease otherwise
+ */
+const BrotliSharedDict* BrotliSharedDictCacheLookupOrPrepare(
+    BrotliSharedDictCache* cache, size_t size, const uint8_t* data,
+    const uint8_t* hash);
+
+/**
+ * Releases the dictionary obtained from the cache.
+ *
+ * Evicted dictionaries are deallocated when the last user releases them.
+ */
+void BrotliSharedDictCacheRelease(
+    BrotliSharedDictCache* cache, const BrotliSharedDict* dictionary);
+
+/** Takes a consistent snapshot of cache counters. */
+void BrotliSharedDictCacheGetStats(
+    BrotliSharedDictCache* cache, BrotliSharedDictCacheStats* stats);
+
+/** Returns prepared dictionary to attach to encoder instances. */
+const BrotliEncoderPreparedDictionary* BrotliSharedDictPrepared(
+    const BrotliSharedDict* dictionary);
+
+/** Returns dictionary contents; @p size is set to the contents size. */
+const uint8_t* BrotliSharedDictData(
+    const BrotliSharedDict* dictionary, size_t* size);
+
+/** Returns SHA-256 of dictionary contents. */
+const uint8_t* BrotliSharedDictHash(const BrotliSharedDict* dictionary);
+
+/** Calculates SHA-256 of dictionary contents. */
+void BrotliSharedDictComputeHash(size_t size, const uint8_t* data,
+    uint8_t hash[BROTLI_SHARED_DICT_HASH_SIZE]);
+
+/**
+ * Formats hash as Subresource Integrity token, e.g. @c "sha256-47DEQp...=".
+ *
+ * @param hash SHA-256 value
+ * @param[out] id buffer of ::BROTLI_SHARED_DICT_HASH_ID_SIZE bytes; result
+ *             is zero-terminated
+ */
+void BrotliSharedDictFormatHashId(
+    const uint8_t hash[BROTLI_SHARED_DICT_HASH_SIZE], char* id);
+
+/**
+ * Parses Subresource Integrity token produced by
+ * ::BrotliSharedDictFormatHashId.
+ *
+ * @param length length of @p id
+ * @param id token; does not have to be zero-terminated
+ * @param[out] hash SHA-256 value
+ * @returns ::BROTLI_FALSE if algorithm is not @c sha256, or digest is not
+ *          a valid base64 encoding of 32 bytes
+ */
+BROTLI_BOOL BrotliSharedDictParseHashId(size_t length, const char* id,
+    uint8_t hash[BROTLI_SHARED_DICT_HASH_SIZE]);
+
+#if defined(__cplusplus) || defined(c_plusplus)
+}  /* extern "C" */
+#endif
+
+#endif  /* BROTLI_SHARED_DICT_SHARED_DICT_H_ */
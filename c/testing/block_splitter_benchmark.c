@@ -0,0 +1,95 @@
+/* Copyright 2026 The Brotli Authors. All Rights Reserved.
+
+   Distributed under MIT license.
+   See file LICENSE for detail or copy at https://opensource.org/licenses/MIT
+*/
+
+/* Micro-benchmark for SplitByteVectorLiteral.
+
+   Every input file is a recorded literal stream, i.e. the concatenated
+   literals of a metablock as they are passed to the block splitter. Plain
+   text files are a reasonable stand-in. Usage:
+
+     block_splitter_benchmark <quality> <repeats> <file>... */
+
+#include "../enc/block_splitter.c"
+#include "../enc/cluster.c"
+#include "../enc/memory.c"
+#include "../enc/bit_cost.c"
+#include "../enc/histogram.c"
+#include "../enc/entropy_encode.c"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static double Now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static uint8_t* ReadLiteralStream(const char* path, size_t* size) {
+  FILE* file = fopen(path, "rb");
+  uint8_t* data;
+  long file_size;
+  if (file == NULL) {
+    perror("fopen failed");
+    return NULL;
+  }
+  fseek(file, 0, SEEK_END);
+  file_size = ftell(file);
+  fseek(file, 0, SEEK_SET);
+  data = (uint8_t*)malloc(file_size > 0 ? (size_t)file_size : 1);
+  if (data == NULL ||
+      fread(data, 1, (size_t)file_size, file) != (size_t)file_size) {
+    fprintf(stderr, "failed to read %s\n", path);
+    free(data);
+    fclose(file);
+    return NULL;
+  }
+  fclose(file);
+  *size = (size_t)file_size;
+  return data;
+}
+
+int main(int argc, char** argv) {
+  BrotliEncoderParams params;
+  MemoryManager m;
+  int repeats;
+  int i;
+  if (argc < 4) {
+    fprintf(stderr, "usage: %s <quality> <repeats> <file>...\n", argv[0]);
+    return 1;
+  }
+  memset(&params, 0, sizeof(params));
+  params.quality = atoi(argv[1]);
+  repeats = atoi(argv[2]);
+  if (repeats <= 0) repeats = 1;
+  BrotliInitMemoryManager(&m, 0, 0, 0);
+  for (i = 3; i < argc; ++i) {
+    size_t size = 0;
+    uint8_t* literals = ReadLiteralStream(argv[i], &size);
+    BlockSplit split;
+    double start;
+    double elapsed;
+    int r;
+    if (literals == NULL) return 1;
+    BrotliInitBlockSplit(&split);
+    start = Now();
+    for (r = 0; r < repeats; ++r) {
+      split.num_blocks = 0;
+      SplitByteVectorLiteral(&m, literals, size, kSymbolsPerLiteralHistogram,
+          kMaxLiteralHistograms, kLiteralStrideLength,
+          kLiteralBlockSwitchCost, &params, &split);
+    }
+    elapsed = Now() - start;
+    printf("%s: %zu literals, %zu blocks, %zu types, %.3f ms/run, "
+           "%.2f MB/s\n", argv[i], size, split.num_blocks, split.num_types,
+           elapsed * 1e3 / repeats,
+           (double)size * repeats / (elapsed > 0 ? elapsed : 1e-9) / 1e6);
+    BrotliDestroyBlockSplit(&m, &split);
+    free(literals);
+  }
+  return 0;
+}
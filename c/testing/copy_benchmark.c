@@ -0,0 +1,174 @@
+/* Copyright 2026 The Brotli Authors. All Rights Reserved.
+
+   Distributed under MIT license.
+   See file LICENSE for detail or copy at https://opensource.org/licenses/MIT
+*/
+
+/* Micro-benchmark for decoding of short-distance back-references.
+
+   Inputs are compressed once and then decoded with one-shot
+   BrotliDecoderDecompress. Without files, two generated inputs are used:
+   binary records that repeat 1..12-byte periods, and JSON with space
+   padding and zero runs; both are dominated by copies with distance
+   smaller than length. Usage:
+
+     copy_benchmark <quality> <repeats> [<file>...] */
+
+#include <brotli/decode.h>
+#include <brotli/encode.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define GENERATED_SIZE (8 << 20)
+
+static double Now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/* Simple LCG; results only need to be repeatable. */
+static uint32_t Random(uint32_t* seed) {
+  *seed = *seed * 1103515245u + 12345u;
+  return *seed >> 8;
+}
+
+static uint8_t* GenerateRecords(size_t size) {
+  uint8_t* data = (uint8_t*)malloc(size);
+  uint32_t seed = 1;
+  size_t pos = 0;
+  if (data == NULL) return NULL;
+  while (pos < size) {
+    size_t period = 1 + Random(&seed) % 12;
+    size_t length = 16 + Random(&seed) % 240;
+    size_t k;
+    for (k = 0; k < period && pos < size; ++k) {
+      data[pos++] = (uint8_t)Random(&seed);
+    }
+    for (k = 0; k < length && pos < size; ++k, ++pos) {
+      data[pos] = data[pos - period];
+    }
+  }
+  return data;
+}
+
+static uint8_t* GenerateJson(size_t size) {
+  uint8_t* data = (uint8_t*)malloc(size + 256);
+  uint32_t seed = 2;
+  size_t pos = 0;
+  if (data == NULL) return NULL;
+  while (pos < size) {
+    int padding = (int)(Random(&seed) % 48);
+    int zeros = (int)(Random(&seed) % 24);
+    pos += (size_t)sprintf((char*)data + pos,
+        "{\"id\": %u, \"value\": %u.%0*u, \"tag\": \"%c%*s\"},\n",
+        (unsigned)(Random(&seed) % 100000), (unsigned)(Random(&seed) % 1000),
+        zeros + 1, 0u, 'a' + (int)(Random(&seed) % 26), padding, "");
+  }
+  return data;
+}
+
+static uint8_t* ReadInput(const char* path, size_t* size) {
+  FILE* file = fopen(path, "rb");
+  uint8_t* data;
+  long file_size;
+  if (file == NULL) {
+    perror("fopen failed");
+    return NULL;
+  }
+  fseek(file, 0, SEEK_END);
+  file_size = ftell(file);
+  fseek(file, 0, SEEK_SET);
+  data = (uint8_t*)malloc(file_size > 0 ? (size_t)file_size : 1);
+  if (data == NULL ||
+      fread(data, 1, (size_t)file_size, file) != (size_t)file_size) {
+    fprintf(stderr, "failed to read %s\n", path);
+    free(data);
+    fclose(file);
+    return NULL;
+  }
+  fclose(file);
+  *size = (size_t)file_size;
+  return data;
+}
+
+static int Run(const char* name, const uint8_t* input, size_t size,
+    int quality, int repeats) {
+  size_t encoded_size = BrotliEncoderMaxCompressedSize(size);
+  uint8_t* encoded = (uint8_t*)malloc(encoded_size);
+  uint8_t* decoded = (uint8_t*)malloc(size ? size : 1);
+  double start;
+  double elapsed;
+  int r;
+  if (encoded == NULL || decoded == NULL ||
+      !BrotliEncoderCompress(quality, BROTLI_DEFAULT_WINDOW,
+          BROTLI_DEFAULT_MODE, size, input, &encoded_size, encoded,
+          NULL, 0, NULL, NULL)) {
+    fprintf(stderr, "failed to compress %s\n", name);
+    free(encoded);
+    free(decoded);
+    return 0;
+  }
+  start = Now();
+  for (r = 0; r < repeats; ++r) {
+    size_t decoded_size = size;
+    if (BrotliDecoderDecompress(encoded_size, encoded, &decoded_size,
+            decoded, BROTLI_FALSE, NULL, NULL, NULL, NULL) !=
+            BROTLI_DECODER_RESULT_SUCCESS ||
+        decoded_size != size) {
+      fprintf(stderr, "failed to decompress %s\n", name);
+      free(encoded);
+      free(decoded);
+      return 0;
+    }
+  }
+  elapsed = Now() - start;
+  if (memcmp(decoded, input, size) != 0) {
+    fprintf(stderr, "%s: decoded data differs\n", name);
+    free(encoded);
+    free(decoded);
+    return 0;
+  }
+  printf("%s: %zu -> %zu bytes, %.3f ms/run, %.2f MB/s\n", name, size,
+         encoded_size, elapsed * 1e3 / repeats,
+         (double)size * repeats / (elapsed > 0 ? elapsed : 1e-9) / 1e6);
+  free(encoded);
+  free(decoded);
+  return 1;
+}
+
+int main(int argc, char** argv) {
+  int quality;
+  int repeats;
+  int i;
+  if (argc < 3) {
+    fprintf(stderr, "usage: %s <quality> <repeats> [<file>...]\n", argv[0]);
+    return 1;
+  }
+  quality = atoi(argv[1]);
+  repeats = atoi(argv[2]);
+  if (repeats <= 0) repeats = 1;
+  if (argc == 3) {
+    uint8_t* records = GenerateRecords(GENERATED_SIZE);
+    uint8_t* json = GenerateJson(GENERATED_SIZE);
+    int ok = records != NULL && json != NULL &&
+        Run("records", records, GENERATED_SIZE, quality, repeats) &&
+        Run("json", json, GENERATED_SIZE, quality, repeats);
+    free(records);
+    free(json);
+    return ok ? 0 : 1;
+  }
+  for (i = 3; i < argc; ++i) {
+    size_t size = 0;
+    uint8_t* input = ReadInput(argv[i], &size);
+    int ok;
+    if (input == NULL) return 1;
+    ok = Run(argv[i], input, size, quality, repeats);
+    free(input);
+    if (!ok) return 1;
+  }
+  return 0;
+}
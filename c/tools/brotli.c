@@ -21,6 +21,7 @@
 #include <brotli/encode.h>
 
 #if !defined(_WIN32)
+#include <sys/mman.h>
 #include <unistd.h>
 #include <utime.h>
 #define MAKE_BINARY(FILENO) (FILENO)
@@ -75,6 +76,7 @@ typedef enum {
   COMMAND_INVALID,
   COMMAND_TEST_INTEGRITY,
   COMMAND_NOOP,
+  COMMAND_PREPARE_DICTIONARY,
   COMMAND_VERSION
 } Command;
 
@@ -95,6 +97,8 @@ typedef struct {
   BROTLI_BOOL decompress;
   BROTLI_BOOL large_window;
   const char* output_path;
+  const char* dictionary_path;
+  const char* dictionary_index_path;
   const char* suffix;
   int not_input_indices[MAX_OPTIONS];
   size_t longest_path_len;
@@ -110,6 +114,12 @@ typedef struct {
   uint8_t* buffer;
   uint8_t* input;
   uint8_t* output;
+  uint8_t* dictionary;
+  size_t dictionary_size;
+  uint8_t* dictionary_index;
+  size_t dictionary_index_size;
+  BROTLI_BOOL is_dictionary_index_mapped;
+  BrotliEncoderPreparedDictionary* prepared_dictionary;
   const char* current_input_path;
   const char* current_output_path;
   int64_t input_file_length;  /* -1, if impossible to calculate */
@@ -324,6 +334,12 @@ static Command ParseParams(Context* params) {
             return COMMAND_INVALID;
           }
           params->output_path = argv[i];
+        } else if (c == 'D') {
+          if (params->dictionary_path) {
+            fprintf(stderr, "dictionary path already set\n");
+            return COMMAND_INVALID;
+          }
+          params->dictionary_path = argv[i];
         } else if (c == 'q') {
           if (quality_set) {
             fprintf(stderr, "quality already set\n");
@@ -439,7 +455,19 @@ static Command ParseParams(Context* params) {
         }
         key_len = (size_t)(value - arg);
         value++;
-        if (strncmp("lgwin", arg, key_len) == 0) {
+        if (strncmp("dictionary", arg, key_len) == 0) {
+          if (params->dictionary_path) {
+            fprintf(stderr, "dictionary path already set\n");
+            return COMMAND_INVALID;
+          }
+          params->dictionary_path = value;
+        } else if (strncmp("dictionary-index", arg, key_len) == 0) {
+          if (params->dictionary_index_path) {
+            fprintf(stderr, "dictionary index path already set\n");
+            return COMMAND_INVALID;
+          }
+          params->dictionary_index_path = value;
+        } else if (strncmp("lgwin", arg, key_len) == 0) {
           if (lgwin_set) {
             fprintf(stderr, "lgwin parameter already set\n");
             return COMMAND_INVALID;
@@ -474,6 +502,13 @@ static Command ParseParams(Context* params) {
                     params->lgwin, BROTLI_MIN_WINDOW_BITS);
             return COMMAND_INVALID;
           }
+        } else if (strncmp("prepare-dictionary", arg, key_len) == 0) {
+          if (params->dictionary_index_path) {
+            fprintf(stderr, "dictionary index path already set\n");
+            return COMMAND_INVALID;
+          }
+          command = COMMAND_PREPARE_DICTIONARY;
+          params->dictionary_index_path = value;
         } else if (strncmp("output", arg, key_len) == 0) {
           if (output_set) {
             fprintf(stderr,
@@ -520,6 +555,19 @@ static Command ParseParams(Context* params) {
   if (strchr(params->suffix, '/') || strchr(params->suffix, '\\')) {
     return COMMAND_INVALID;
   }
+  if (params->dictionary_index_path && !params->dictionary_path) {
+    fprintf(stderr, "dictionary index requires dictionary (-D)\n");
+    return COMMAND_INVALID;
+  }
+  if (command == COMMAND_PREPARE_DICTIONARY) {
+    if (input_count != 0 || output_set || params->output_path) {
+      return COMMAND_INVALID;
+    }
+  } else if (params->dictionary_index_path &&
+             command != COMMAND_COMPRESS) {
+    fprintf(stderr, "dictionary index is only used for compression\n");
+    return COMMAND_INVALID;
+  }
 
   return command;
 }
@@ -545,6 +593,11 @@ static void PrintHelp(const char* name, BROTLI_BOOL error) {
 "  -f, --force                 force output file overwrite\n"
 "  -h, --help                  display this help and exit\n");
   fprintf(media,
+"  -D FILE, --dictionary=FILE  use FILE as raw (LZ77) dictionary\n"
+"  --dictionary-index=FILE     use FILE as prepared index of -D dictionary\n"
+"  --prepare-dictionary=FILE   write prepared index of -D dictionary for\n"
+"                              the given quality to FILE, and exit\n");
+  fprintf(media,
 "  -j, --rm                    remove source file(s)\n"
 "  -k, --keep                  keep source file(s) (default)\n"
 "  -n, --no-copy-stat          do not copy source file(s) attributes\n"
@@ -671,6 +724,141 @@ static void CopyStat(const char* input_path, const char* output_path) {
   }
 }
 
+/* Reads the whole (at most |max_size| bytes) file into memory. */
+static BROTLI_BOOL ReadWholeFile(const char* path, int64_t max_size,
+                                 uint8_t** data, size_t* size) {
+  FILE* f;
+  int64_t file_size = FileSize(path);
+  BROTLI_BOOL is_ok = BROTLI_TRUE;
+  if (file_size < 0) {
+    fprintf(stderr, "could not read file size [%s]\n", PrintablePath(path));
+    return BROTLI_FALSE;
+  }
+  /* Limit could exceed size_t on 32-bit targets; leave room for the extra
+     byte allocated below. */
+  if ((uint64_t)max_size > (uint64_t)BROTLI_SIZE_MAX - 1) {
+    max_size = (int64_t)(BROTLI_SIZE_MAX - 1);
+  }
+  if (file_size > max_size) {
+    fprintf(stderr, "file is too large [%s]\n", PrintablePath(path));
+    return BROTLI_FALSE;
+  }
+  *size = (size_t)file_size;
+  /* Allocate at least one byte; empty dictionary is still a valid one. */
+  *data = (uint8_t*)malloc(*size + 1);
+  if (!*data) {
+    fprintf(stderr, "out of memory\n");
+    return BROTLI_FALSE;
+  }
+  if (!OpenInputFile(path, &f)) return BROTLI_FALSE;
+  if (fread(*data, 1, *size, f) != *size) {
+    fprintf(stderr, "failed to read file [%s]: %s\n",
+            PrintablePath(path), strerror(errno));
+    is_ok = BROTLI_FALSE;
+  }
+  fclose(f);
+  return is_ok;
+}
+
+/* Maps the dictionary index file, so that encoder uses it in place and its
+   pages are shared with other processes that use the same index. Falls
+   back to reading the file where mapping is not available or fails. */
+static BROTLI_BOOL MapDictionaryIndex(Context* context) {
+  const char* path = context->dictionary_index_path;
+  /* Index is 4 bytes per dictionary byte plus up to 64 MiB of buckets. */
+  const int64_t max_size = (int64_t)5 << 30;
+#if !defined(_WIN32)
+  int64_t file_size = FileSize(path);
+  if (file_size > 0 && file_size <= max_size &&
+      (uint64_t)file_size <= (uint64_t)BROTLI_SIZE_MAX) {
+    int fd = open(path, O_RDONLY);
+    if (fd >= 0) {
+      void* image =
+          mmap(NULL, (size_t)file_size, PROT_READ, MAP_SHARED, fd, 0);
+      close(fd);
+      if (image != MAP_FAILED) {
+        context->dictionary_index = (uint8_t*)image;
+        context->dictionary_index_size = (size_t)file_size;
+        context->is_dictionary_index_mapped = BROTLI_TRUE;
+        return BROTLI_TRUE;
+      }
+    }
+  }
+#endif
+  return ReadWholeFile(path, max_size, &context->dictionary_index,
+                       &context->dictionary_index_size);
+}
+
+static void FreeDictionaryIndex(Context* context) {
+#if !defined(_WIN32)
+  if (context->is_dictionary_index_mapped) {
+    munmap(context->dictionary_index, context->dictionary_index_size);
+    context->dictionary_index = NULL;
+    return;
+  }
+#endif
+  free(context->dictionary_index);
+  context->dictionary_index = NULL;
+}
+
+/* Dictionary is at most 1 GiB; it is loaded once and used for all files.
+   Index is mapped, if specified; otherwise it is built when compressing. */
+static BROTLI_BOOL ReadDictionary(Context* context, Command command) {
+  if (!ReadWholeFile(context->dictionary_path, (int64_t)1 << 30,
+                     &context->dictionary, &context->dictionary_size)) {
+    return BROTLI_FALSE;
+  }
+  if (command == COMMAND_COMPRESS && context->dictionary_index_path) {
+    if (!MapDictionaryIndex(context)) return BROTLI_FALSE;
+    context->prepared_dictionary = BrotliEncoderLoadPreparedDictionary(
+        context->dictionary_index_size, context->dictionary_index,
+        context->dictionary_size, context->dictionary, NULL, NULL, NULL);
+    if (!context->prepared_dictionary) {
+      fprintf(stderr, "invalid dictionary index [%s]\n",
+              PrintablePath(context->dictionary_index_path));
+      return BROTLI_FALSE;
+    }
+  } else if (command == COMMAND_COMPRESS ||
+             command == COMMAND_PREPARE_DICTIONARY) {
+    context->prepared_dictionary = BrotliEncoderPrepareDictionary(
+        context->dictionary_size, context->dictionary, context->quality,
+        NULL, NULL, NULL);
+    if (!context->prepared_dictionary) {
+      fprintf(stderr, "out of memory\n");
+      return BROTLI_FALSE;
+    }
+  }
+  return BROTLI_TRUE;
+}
+
+static BROTLI_BOOL WriteDictionaryIndex(Context* context) {
+  size_t size = BrotliEncoderGetPreparedDictionarySerializedSize(
+      context->prepared_dictionary);
+  uint8_t* image = (uint8_t*)malloc(size);
+  FILE* f = NULL;
+  BROTLI_BOOL is_ok = BROTLI_TRUE;
+  if (!image) {
+    fprintf(stderr, "out of memory\n");
+    return BROTLI_FALSE;
+  }
+  BrotliEncoderSerializePreparedDictionary(
+      context->prepared_dictionary, &size, image);
+  is_ok = OpenOutputFile(
+      context->dictionary_index_path, &f, context->force_overwrite);
+  if (is_ok) {
+    fwrite(image, 1, size, f);
+    if (ferror(f)) {
+      fprintf(stderr, "failed to write output [%s]: %s\n",
+              PrintablePath(context->dictionary_index_path), strerror(errno));
+      is_ok = BROTLI_FALSE;
+    }
+    if (fclose(f) != 0) is_ok = BROTLI_FALSE;
+    if (!is_ok) unlink(context->dictionary_index_path);
+  }
+  free(image);
+  return is_ok;
+}
+
 static BROTLI_BOOL NextFile(Context* context) {
   const char* arg;
   size_t arg_len;
@@ -919,6 +1107,13 @@ static BROTLI_BOOL DecompressFiles(Context* context) {
        it is better from used experience perspective. */
     BrotliDecoderSetParameter(s, BROTLI_DECODER_PARAM_LARGE_WINDOW, 1u);
     BrotliDecoderSetParameter(s, BROTLI_DECODER_PARAM_LARGE_WINDOW, 0u);
+    if (context->dictionary && !BrotliDecoderAttachDictionary(s,
+        BROTLI_SHARED_DICTIONARY_RAW, context->dictionary_size,
+        context->dictionary)) {
+      fprintf(stderr, "failed to attach dictionary\n");
+      BrotliDecoderDestroyInstance(s);
+      return BROTLI_FALSE;
+    }
     is_ok = OpenFiles(context);
     if (is_ok && !context->current_input_path &&
         !context->force_overwrite && isatty(STDIN_FILENO)) {
@@ -1005,6 +1200,12 @@ static BROTLI_BOOL CompressFiles(Context* context) {
           (uint32_t)context->input_file_length : (1u << 30);
       BrotliEncoderSetParameter(s, BROTLI_PARAM_SIZE_HINT, size_hint);
     }
+    if (context->prepared_dictionary && !BrotliEncoderAttachPreparedDictionary(
+        s, context->prepared_dictionary)) {
+      fprintf(stderr, "failed to attach dictionary\n");
+      BrotliEncoderDestroyInstance(s);
+      return BROTLI_FALSE;
+    }
     is_ok = OpenFiles(context);
     if (is_ok && !context->current_output_path &&
         !context->force_overwrite && isatty(STDOUT_FILENO)) {
@@ -1036,6 +1237,8 @@ int main(int argc, char** argv) {
   context.decompress = BROTLI_FALSE;
   context.large_window = BROTLI_FALSE;
   context.output_path = NULL;
+  context.dictionary_path = NULL;
+  context.dictionary_index_path = NULL;
   context.suffix = DEFAULT_SUFFIX;
   for (i = 0; i < MAX_OPTIONS; ++i) context.not_input_indices[i] = 0;
   context.longest_path_len = 1;
@@ -1048,6 +1251,12 @@ int main(int argc, char** argv) {
   context.ignore = 0;
   context.iterator_error = BROTLI_FALSE;
   context.buffer = NULL;
+  context.dictionary = NULL;
+  context.dictionary_size = 0;
+  context.dictionary_index = NULL;
+  context.dictionary_index_size = 0;
+  context.is_dictionary_index_mapped = BROTLI_FALSE;
+  context.prepared_dictionary = NULL;
   context.current_input_path = NULL;
   context.current_output_path = NULL;
   context.fin = NULL;
@@ -1071,6 +1280,13 @@ int main(int argc, char** argv) {
       }
     }
   }
+  if (command == COMMAND_COMPRESS || command == COMMAND_DECOMPRESS ||
+      command == COMMAND_TEST_INTEGRITY ||
+      command == COMMAND_PREPARE_DICTIONARY) {
+    if (is_ok && context.dictionary_path) {
+      is_ok = ReadDictionary(&context, command);
+    }
+  }
 
   if (!is_ok) command = COMMAND_NOOP;
 
@@ -1091,6 +1307,10 @@ int main(int argc, char** argv) {
       is_ok = DecompressFiles(&context);
       break;
 
+    case COMMAND_PREPARE_DICTIONARY:
+      is_ok = WriteDictionaryIndex(&context);
+      break;
+
     case COMMAND_HELP:
     case COMMAND_INVALID:
     default:
@@ -1101,6 +1321,9 @@ int main(int argc, char** argv) {
 
   if (context.iterator_error) is_ok = BROTLI_FALSE;
 
+  BrotliEncoderDestroyPreparedDictionary(context.prepared_dictionary);
+  FreeDictionaryIndex(&context);
+  free(context.dictionary);
   free(context.modified_path);
   free(context.buffer);
 
@@ -193,6 +193,7 @@ EXT_MODULES = [
             'c/enc/block_splitter.c',
             'c/enc/brotli_bit_stream.c',
             'c/enc/cluster.c',
+            'c/enc/compound_dictionary.c',
             'c/enc/compress_fragment.c',
             'c/enc/compress_fragment_two_pass.c',
             'c/enc/dictionary_hash.c',
@@ -229,6 +230,7 @@ EXT_MODULES = [
             'c/enc/cluster.h',
             'c/enc/cluster_inc.h',
             'c/enc/command.h',
+            'c/enc/compound_dictionary.h',
             'c/enc/compress_fragment.h',
             'c/enc/compress_fragment_two_pass.h',
             'c/enc/dictionary_hash.h',
@@ -0,0 +1,1369 @@
+/* Copyright 2026 The Brotli Authors. All Rights Reserved.
+
+   Distributed under MIT license.
+   See file LICENSE for detail or copy at https://opensource.org/licenses/MIT
+*/
+
+/* Tests of decoder instance API: reset, seek and parameters. Input file is
+   compressed with the encoder, then decoded in different ways and compared
+   to the original. Usage:
+
+     decode_test <test> <file> */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <brotli/decode.h>
+#include <brotli/encode.h>
+#include <brotli/types.h>
+
+/* Counts live allocations made through the instance allocator. If
+   |fail_at| is not 0, allocation with that number fails. */
+typedef struct Allocator {
+  size_t live;
+  size_t count;
+  size_t fail_at;
+} Allocator;
+
+static void* CountingAlloc(void* opaque, size_t size) {
+  Allocator* allocator = (Allocator*)opaque;
+  void* p;
+  if (++allocator->count == allocator->fail_at) return NULL;
+  p = malloc(size);
+  if (p) allocator->live++;
+  return p;
+}
+
+static void CountingFree(void* opaque, void* address) {
+  Allocator* allocator = (Allocator*)opaque;
+  if (!address) return;
+  allocator->live--;
+  free(address);
+}
+
+static uint8_t* ReadInput(const char* path, size_t* size) {
+  FILE* file = fopen(path, "rb");
+  uint8_t* data;
+  long file_size;
+  if (file == NULL) {
+    perror("fopen failed");
+    return NULL;
+  }
+  fseek(file, 0, SEEK_END);
+  file_size = ftell(file);
+  fseek(file, 0, SEEK_SET);
+  data = (uint8_t*)malloc(file_size > 0 ? (size_t)file_size : 1);
+  if (data == NULL ||
+      fread(data, 1, (size_t)file_size, file) != (size_t)file_size) {
+    fprintf(stderr, "failed to read %s\n", path);
+    free(data);
+    fclose(file);
+    return NULL;
+  }
+  fclose(file);
+  *size = (size_t)file_size;
+  return data;
+}
+
+/* Compresses |data| with a streaming encoder; |chunk_size| is in KiB, see
+   BROTLI_PARAM_CHUNK_SIZE. Returned buffer is owned by the caller. */
+static uint8_t* Compress(const uint8_t* data, size_t size, int quality,
+    int lgwin, uint32_t chunk_size, size_t* encoded_size) {
+  BrotliEncoderState* s = BrotliEncoderCreateInstance(NULL, NULL, NULL);
+  /* Chunk index adds a few bytes per chunk on top of the bound. */
+  size_t capacity = BrotliEncoderMaxCompressedSize(size) + (size >> 6) + 1024;
+  uint8_t* encoded = (uint8_t*)malloc(capacity);
+  size_t available_in = size;
+  const uint8_t* next_in = data;
+  size_t available_out = capacity;
+  uint8_t* next_out = encoded;
+  BROTLI_BOOL ok = TO_BROTLI_BOOL(s && encoded);
+  if (ok) {
+    BrotliEncoderSetParameter(s, BROTLI_PARAM_QUALITY, (uint32_t)quality);
+    BrotliEncoderSetParameter(s, BROTLI_PARAM_LGWIN, (uint32_t)lgwin);
+    BrotliEncoderSetParameter(s, BROTLI_PARAM_SIZE_HINT, (uint32_t)size);
+    BrotliEncoderSetParameter(s, BROTLI_PARAM_CHUNK_SIZE, chunk_size);
+  }
+  while (ok && !BrotliEncoderIsFinished(s)) {
+    ok = BrotliEncoderCompressStream(s, BROTLI_OPERATION_FINISH,
+        &available_in, &next_in, &available_out, &next_out, NULL);
+    if (ok && available_out == 0 && !BrotliEncoderIsFinished(s)) {
+      ok = BROTLI_FALSE;
+    }
+  }
+  BrotliEncoderDestroyInstance(s);
+  if (!ok) {
+    fprintf(stderr, "failed to compress\n");
+    free(encoded);
+    return NULL;
+  }
+  *encoded_size = capacity - available_out;
+  return encoded;
+}
+
+/* Compresses |data| at quality 5 with |num_dictionaries| prepared
+   dictionaries attached in order; |lgblock| is BROTLI_PARAM_LGBLOCK.
+   Returned buffer is owned by the caller. */
+static uint8_t* CompressWithDictionaries(const uint8_t* data, size_t size,
+    int lgwin, int lgblock, const uint8_t* const* dictionaries,
+    const size_t* dictionary_sizes, size_t num_dictionaries,
+    size_t* encoded_size) {
+  BrotliEncoderPreparedDictionary* prepared[4] = {NULL, NULL, NULL, NULL};
+  BrotliEncoderState* s = BrotliEncoderCreateInstance(NULL, NULL, NULL);
+  size_t capacity = BrotliEncoderMaxCompressedSize(size);
+  uint8_t* encoded = (uint8_t*)malloc(capacity);
+  size_t available_in = size;
+  const uint8_t* next_in = data;
+  size_t available_out = capacity;
+  uint8_t* next_out = encoded;
+  BROTLI_BOOL ok = TO_BROTLI_BOOL(s && encoded && num_dictionaries <= 4);
+  size_t i;
+  for (i = 0; ok && i < num_dictionaries; ++i) {
+    prepared[i] = BrotliEncoderPrepareDictionary(dictionary_sizes[i],
+        dictionaries[i], 5, NULL, NULL, NULL);
+    ok = TO_BROTLI_BOOL(prepared[i] &&
+        BrotliEncoderAttachPreparedDictionary(s, prepared[i]));
+  }
+  if (ok) {
+    BrotliEncoderSetParameter(s, BROTLI_PARAM_QUALITY, 5);
+    BrotliEncoderSetParameter(s, BROTLI_PARAM_LGWIN, (uint32_t)lgwin);
+    BrotliEncoderSetParameter(s, BROTLI_PARAM_LGBLOCK, (uint32_t)lgblock);
+  }
+  while (ok && !BrotliEncoderIsFinished(s)) {
+    ok = BrotliEncoderCompressStream(s, BROTLI_OPERATION_FINISH,
+        &available_in, &next_in, &available_out, &next_out, NULL);
+    if (ok && available_out == 0 && !BrotliEncoderIsFinished(s)) {
+      ok = BROTLI_FALSE;
+    }
+  }
+  BrotliEncoderDestroyInstance(s);
+  for (i = 0; i < num_dictionaries && i < 4; ++i) {
+    BrotliEncoderDestroyPreparedDictionary(prepared[i]);
+  }
+  if (!ok) {
+    fprintf(stderr, "failed to compress\n");
+    free(encoded);
+    return NULL;
+  }
+  *encoded_size = capacity - available_out;
+  return encoded;
+}
+
+/* Decodes |encoded| with |s|, feeding input in pieces of up to |in_step|
+   bytes and taking output in pieces of up to |out_step| bytes, and checks
+   that the output matches |size| bytes of |expected|. Each piece gets a
+   buffer of its own size, so that accesses past it are caught by
+   sanitizers. */
+static BROTLI_BOOL DecodeInPiecesAndCheck(BrotliDecoderState* s,
+    const uint8_t* encoded, size_t encoded_size, size_t in_step,
+    size_t out_step, const uint8_t* expected, size_t size) {
+  uint8_t* decoded = (uint8_t*)malloc(size + 1);
+  uint8_t* input = NULL;
+  const uint8_t* next_in = NULL;
+  size_t available_in = 0;
+  size_t consumed = 0;
+  size_t total_out = 0;
+  BrotliDecoderResult result = BROTLI_DECODER_RESULT_NEEDS_MORE_INPUT;
+  BROTLI_BOOL ok;
+  if (!decoded) return BROTLI_FALSE;
+  while ((result == BROTLI_DECODER_RESULT_NEEDS_MORE_INPUT &&
+      consumed < encoded_size) ||
+      (result == BROTLI_DECODER_RESULT_NEEDS_MORE_OUTPUT &&
+      total_out <= size)) {
+    size_t out_piece = size + 1 - total_out;
+    uint8_t* output;
+    uint8_t* next_out;
+    size_t available_out;
+    if (available_in == 0) {
+      size_t piece = encoded_size - consumed;
+      if (piece > in_step) piece = in_step;
+      free(input);
+      input = (uint8_t*)malloc(piece ? piece : 1);
+      if (!input) break;
+      memcpy(input, encoded + consumed, piece);
+      consumed += piece;
+      available_in = piece;
+      next_in = input;
+    }
+    if (out_piece > out_step) out_piece = out_step;
+    /* The last piece already ends with the buffer. */
+    output = (out_piece == size + 1 - total_out) ? decoded + total_out :
+        (uint8_t*)malloc(out_piece);
+    if (!output) break;
+    available_out = out_piece;
+    next_out = output;
+    result = BrotliDecoderDecompressStream(
+        s, &available_in, &next_in, &available_out, &next_out, NULL);
+    if (output != decoded + total_out) {
+      memcpy(decoded + total_out, output, out_piece - available_out);
+      free(output);
+    }
+    total_out += out_piece - available_out;
+  }
+  free(input);
+  ok = TO_BROTLI_BOOL(result == BROTLI_DECODER_RESULT_SUCCESS &&
+      total_out == size && memcmp(decoded, expected, size) == 0);
+  if (!ok) {
+    fprintf(stderr, "decoding failed: result %d, %s, %lu of %lu bytes\n",
+        (int)result, BrotliDecoderErrorString(BrotliDecoderGetErrorCode(s)),
+        (unsigned long)total_out, (unsigned long)size);
+  }
+  free(decoded);
+  return ok;
+}
+
+static BROTLI_BOOL DecodeAndCheck(BrotliDecoderState* s,
+    const uint8_t* encoded, size_t encoded_size, size_t step,
+    const uint8_t* expected, size_t size) {
+  return DecodeInPiecesAndCheck(
+      s, encoded, encoded_size, step, size + 1, expected, size);
+}
+
+/* Decodes 2 different streams in turns with one instance, and checks that
+   Reset neither leaks nor accumulates memory. */
+static BROTLI_BOOL CheckReset(const uint8_t* data, size_t size,
+    BROTLI_BOOL save_info) {
+  Allocator allocator = {0};
+  size_t half = size / 2;
+  size_t encoded_size[2];
+  uint8_t* encoded[2];
+  BrotliDecoderState* s;
+  size_t live = 0;
+  BROTLI_BOOL ok = BROTLI_TRUE;
+  int i;
+  encoded[0] = Compress(data, size, 5, 22, 0, &encoded_size[0]);
+  encoded[1] = Compress(data + half, size - half, 11, 18, 0,
+      &encoded_size[1]);
+  s = BrotliDecoderCreateInstance(CountingAlloc, CountingFree, &allocator);
+  if (!encoded[0] || !encoded[1] || !s) ok = BROTLI_FALSE;
+  if (ok && save_info) {
+    ok = BrotliDecoderSetParameter(s, BROTLI_DECODER_PARAM_SAVE_INFO, 1);
+  }
+  for (i = 0; ok && i < 6; ++i) {
+    int k = i & 1;
+    /* Commands are collected for one call with the whole input. */
+    size_t step = save_info ? encoded_size[k] : 4096;
+    ok = DecodeAndCheck(s, encoded[k], encoded_size[k], step,
+        k ? data + half : data, k ? size - half : size);
+    BrotliDecoderReset(s);
+    if (i == 1) {
+      live = allocator.live;
+    } else if (i > 1 && allocator.live != live) {
+      fprintf(stderr, "live allocations after reset: %lu, expected %lu\n",
+          (unsigned long)allocator.live, (unsigned long)live);
+      ok = BROTLI_FALSE;
+    }
+  }
+  BrotliDecoderDestroyInstance(s);
+  if (allocator.live != 0) {
+    fprintf(stderr, "%lu allocations leaked\n", (unsigned long)allocator.live);
+    ok = BROTLI_FALSE;
+  }
+  free(encoded[0]);
+  free(encoded[1]);
+  return ok;
+}
+
+/* Writes |num_bits| lowest bits of |value| at bit position |*pos|. */
+static void WriteBits(uint8_t* data, size_t* pos, size_t num_bits,
+    uint32_t value) {
+  size_t i;
+  for (i = 0; i < num_bits; ++i, ++*pos) {
+    if ((value >> i) & 1) data[*pos >> 3] |= (uint8_t)(1u << (*pos & 7));
+  }
+}
+
+/* Stream with 1020 literals 'a' and a 4-byte static dictionary word
+   "time" that ends at the end of 1 KiB ring-buffer; distance of the word
+   counts |dictionary_size| bytes of attached dictionaries. */
+static size_t MakeWordAtRingBufferEnd(uint8_t* data, size_t dictionary_size) {
+  /* Word 0 is right after the window and dictionaries. */
+  uint32_t distance = (1u << 10) - 16 + 1 + (uint32_t)dictionary_size;
+  size_t pos = 0;
+  memset(data, 0, 16);
+  WriteBits(data, &pos, 4, 1);     /* WBITS: 10 */
+  WriteBits(data, &pos, 3, 2);
+  WriteBits(data, &pos, 2, 1);     /* ISLAST, not ISLASTEMPTY */
+  WriteBits(data, &pos, 2, 0);     /* MNIBBLES: 4 */
+  WriteBits(data, &pos, 16, 1023); /* MLEN - 1 */
+  WriteBits(data, &pos, 3, 0);     /* NBLTYPESL, NBLTYPESI, NBLTYPESD: 1 */
+  WriteBits(data, &pos, 6, 0);     /* NPOSTFIX, NDIRECT: 0 */
+  WriteBits(data, &pos, 2, 0);     /* Literal context mode */
+  WriteBits(data, &pos, 2, 0);     /* NTREESL, NTREESD: 1 */
+  /* Simple prefix codes with a single symbol each. */
+  WriteBits(data, &pos, 4, 1);     /* Literals: 'a' */
+  WriteBits(data, &pos, 8, 'a');
+  WriteBits(data, &pos, 4, 1);     /* Commands: insert 578.., copy 4 */
+  WriteBits(data, &pos, 10, 474);
+  WriteBits(data, &pos, 4, 1);     /* Distances: 19 extra bits */
+  WriteBits(data, &pos, 6, 52);
+  WriteBits(data, &pos, 9, 1020 - 578);  /* Insert length extra bits */
+  WriteBits(data, &pos, 19, distance - 1 - ((2u << 19) - 4));
+  return (pos + 7) >> 3;
+}
+
+/* Stops decoding in the middle of a copy from the attached dictionary,
+   which is resumed after output is taken, and checks that the copy does not
+   leak into the next stream: Reset keeps attached dictionaries. Pending
+   copy is resumed after the next write of ring-buffer that ends with a
+   static dictionary word; encoder does not use static dictionary with
+   attached ones, so the next stream is crafted. */
+static BROTLI_BOOL CheckResetDuringDictionaryCopy(void) {
+  const size_t dictionary_size = (size_t)1 << 20;
+  const size_t input_size = 200000;
+  uint8_t* dictionary = (uint8_t*)malloc(dictionary_size);
+  uint8_t* encoded = NULL;
+  size_t encoded_size = 0;
+  uint8_t crafted[16];
+  size_t crafted_size = 0;
+  uint8_t expected[1024];
+  BrotliDecoderState* s = BrotliDecoderCreateInstance(NULL, NULL, NULL);
+  BrotliDecoderResult result = BROTLI_DECODER_RESULT_NEEDS_MORE_OUTPUT;
+  size_t available_in = 0;
+  const uint8_t* next_in = NULL;
+  size_t total_out = 0;
+  uint32_t seed = 1;
+  BROTLI_BOOL ok = TO_BROTLI_BOOL(dictionary && s);
+  size_t i;
+  if (ok) {
+    const uint8_t* dictionaries[1];
+    for (i = 0; i < dictionary_size; ++i) {
+      seed = seed * 1103515245u + 12345u;
+      dictionary[i] = (uint8_t)(seed >> 16);
+    }
+    dictionaries[0] = dictionary;
+    /* Input blocks are larger than window, so copies are not cut. */
+    encoded = CompressWithDictionaries(dictionary + 1000, input_size,
+        16, 20, dictionaries, &dictionary_size, 1, &encoded_size);
+    crafted_size = MakeWordAtRingBufferEnd(crafted, dictionary_size);
+    memset(expected, 'a', 1020);
+    memcpy(expected + 1020, "time", 4);
+    ok = TO_BROTLI_BOOL(encoded &&
+        BrotliDecoderAttachDictionary(s, BROTLI_SHARED_DICTIONARY_RAW,
+            dictionary_size, dictionary));
+  }
+  if (ok) {
+    available_in = encoded_size;
+    next_in = encoded;
+  }
+  while (ok && result == BROTLI_DECODER_RESULT_NEEDS_MORE_OUTPUT &&
+      total_out < 1000) {
+    uint8_t byte;
+    size_t available_out = 1;
+    uint8_t* next_out = &byte;
+    result = BrotliDecoderDecompressStream(
+        s, &available_in, &next_in, &available_out, &next_out, &total_out);
+    if (available_out == 0 && byte != dictionary[1000 + total_out - 1]) {
+      ok = BROTLI_FALSE;
+    }
+  }
+  if (ok && result != BROTLI_DECODER_RESULT_NEEDS_MORE_OUTPUT) {
+    fprintf(stderr, "dictionary copy is not interrupted: result %d\n",
+        (int)result);
+    ok = BROTLI_FALSE;
+  }
+  if (ok) {
+    BrotliDecoderReset(s);
+    ok = DecodeAndCheck(s, crafted, crafted_size, crafted_size,
+        expected, sizeof(expected));
+  }
+  BrotliDecoderDestroyInstance(s);
+  free(encoded);
+  free(dictionary);
+  return ok;
+}
+
+static BROTLI_BOOL TestReset(const uint8_t* data, size_t size) {
+  return CheckReset(data, size, BROTLI_FALSE) &&
+      CheckResetDuringDictionaryCopy();
+}
+
+static BROTLI_BOOL TestResetSaveInfo(const uint8_t* data, size_t size) {
+  return CheckReset(data, size, BROTLI_TRUE);
+}
+
+/* Seeks to several offsets with one instance; seek resets the instance. */
+static BROTLI_BOOL TestSeek(const uint8_t* data, size_t size) {
+  Allocator allocator = {0};
+  size_t encoded_size = 0;
+  uint8_t* encoded = Compress(data, size, 5, 22, 16, &encoded_size);
+  BrotliDecoderState* s =
+      BrotliDecoderCreateInstance(CountingAlloc, CountingFree, &allocator);
+  size_t live = 0;
+  BROTLI_BOOL ok = TO_BROTLI_BOOL(encoded && s);
+  int i;
+  if (ok) {
+    ok = BrotliDecoderSetParameter(s, BROTLI_DECODER_PARAM_SAVE_INFO, 1);
+  }
+  for (i = 0; ok && i < 8; ++i) {
+    size_t offset = (size / 8) * (size_t)i + (size_t)i * 977 % (size / 8);
+    size_t input_offset = 0;
+    ok = BrotliDecoderSeek(s, encoded_size, encoded, offset, &input_offset);
+    if (!ok) {
+      fprintf(stderr, "seek to %lu failed\n", (unsigned long)offset);
+      break;
+    }
+    if (i == 1) {
+      live = allocator.live;
+    } else if (i > 1 && allocator.live != live) {
+      fprintf(stderr, "live allocations after seek: %lu, expected %lu\n",
+          (unsigned long)allocator.live, (unsigned long)live);
+      ok = BROTLI_FALSE;
+    }
+    if (ok) {
+      ok = DecodeAndCheck(s, encoded + input_offset,
+          encoded_size - input_offset, encoded_size - input_offset,
+          data + offset, size - offset);
+    }
+  }
+  BrotliDecoderDestroyInstance(s);
+  if (allocator.live != 0) {
+    fprintf(stderr, "%lu allocations leaked\n", (unsigned long)allocator.live);
+    ok = BROTLI_FALSE;
+  }
+  free(encoded);
+  return ok;
+}
+
+/* Changes word cache size between streams; cache is kept by Reset. */
+static BROTLI_BOOL TestWordCache(const uint8_t* data, size_t size) {
+  static const uint32_t kSizes[] = {1, 4096, 4096, 0, 64, 1};
+  Allocator allocator = {0};
+  size_t encoded_size = 0;
+  uint8_t* encoded = Compress(data, size, 11, 22, 0, &encoded_size);
+  BrotliDecoderState* s =
+      BrotliDecoderCreateInstance(CountingAlloc, CountingFree, &allocator);
+  BROTLI_BOOL ok = TO_BROTLI_BOOL(encoded && s);
+  size_t i;
+  for (i = 0; ok && i < sizeof(kSizes) / sizeof(kSizes[0]); ++i) {
+    ok = BrotliDecoderSetParameter(s, BROTLI_DECODER_PARAM_WORD_CACHE_SIZE,
+        kSizes[i]);
+    if (ok) ok = DecodeAndCheck(s, encoded, encoded_size, 4096, data, size);
+    BrotliDecoderReset(s);
+  }
+  if (ok && BrotliDecoderSetParameter(s,
+      BROTLI_DECODER_PARAM_WORD_CACHE_SIZE,
+      BROTLI_DECODER_MAX_WORD_CACHE_SIZE + 1)) {
+    fprintf(stderr, "word cache size above maximum is accepted\n");
+    ok = BROTLI_FALSE;
+  }
+  BrotliDecoderDestroyInstance(s);
+  if (allocator.live != 0) {
+    fprintf(stderr, "%lu allocations leaked\n", (unsigned long)allocator.live);
+    ok = BROTLI_FALSE;
+  }
+  free(encoded);
+  return ok;
+}
+
+/* Decodes the same stream several times with one instance; cache is kept by
+   Reset, and a table is cached when its code is seen the second time, so
+   the third pass should take tables from cache. In a 1-entry cache codes of
+   one metablock evict each other, so it is only checked for output. */
+static BROTLI_BOOL TestHuffmanCache(const uint8_t* data, size_t size) {
+  static const uint32_t kSizes[] =
+      {0, 1, 16, BROTLI_DECODER_MAX_HUFFMAN_CACHE_SIZE};
+  size_t encoded_size = 0;
+  uint8_t* encoded = Compress(data, size, 9, 16, 0, &encoded_size);
+  BROTLI_BOOL ok = TO_BROTLI_BOOL(encoded != NULL);
+  size_t i;
+  int pass;
+  for (i = 0; ok && i < sizeof(kSizes) / sizeof(kSizes[0]); ++i) {
+    Allocator allocator = {0};
+    BrotliDecoderState* s =
+        BrotliDecoderCreateInstance(CountingAlloc, CountingFree, &allocator);
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t first_hits = 0;
+    ok = TO_BROTLI_BOOL(s != NULL);
+    if (ok) {
+      ok = BrotliDecoderSetParameter(s,
+          BROTLI_DECODER_PARAM_HUFFMAN_CACHE_SIZE, kSizes[i]);
+    }
+    for (pass = 0; ok && pass < 3; ++pass) {
+      ok = DecodeAndCheck(s, encoded, encoded_size, 4096, data, size);
+      BrotliDecoderReset(s);
+      BrotliDecoderGetHuffmanCacheStats(s, &hits, &misses);
+      if (pass == 0) first_hits = hits;
+    }
+    if (ok && kSizes[i] == 0 && (hits != 0 || misses != 0)) {
+      fprintf(stderr, "disabled cache counted %lu hits, %lu misses\n",
+          (unsigned long)hits, (unsigned long)misses);
+      ok = BROTLI_FALSE;
+    } else if (ok && kSizes[i] >= 16 &&
+        (misses == 0 || hits <= first_hits)) {
+      fprintf(stderr, "cache of %lu entries: %lu hits after first pass, "
+          "%lu hits and %lu misses after third\n", (unsigned long)kSizes[i],
+          (unsigned long)first_hits, (unsigned long)hits,
+          (unsigned long)misses);
+      ok = BROTLI_FALSE;
+    }
+    if (ok && BrotliDecoderSetParameter(s,
+        BROTLI_DECODER_PARAM_HUFFMAN_CACHE_SIZE,
+        BROTLI_DECODER_MAX_HUFFMAN_CACHE_SIZE + 1)) {
+      fprintf(stderr, "Huffman cache size above maximum is accepted\n");
+      ok = BROTLI_FALSE;
+    }
+    BrotliDecoderDestroyInstance(s);
+    if (allocator.live != 0) {
+      fprintf(stderr, "%lu allocations leaked\n",
+          (unsigned long)allocator.live);
+      ok = BROTLI_FALSE;
+    }
+  }
+  free(encoded);
+  return ok;
+}
+
+/* Flips different bits in each 1000-byte block of text, so that encoder
+   uses many literal block types. */
+static uint8_t* MixLiterals(const uint8_t* data, size_t size) {
+  uint8_t* mixed = (uint8_t*)malloc(size ? size : 1);
+  size_t i;
+  if (!mixed) return NULL;
+  for (i = 0; i < size; ++i) {
+    mixed[i] = (uint8_t)(data[i] ^ (((i / 1000) * 7 % 11) * 23));
+  }
+  return mixed;
+}
+
+/* Literal trees of a block type are built when the type is first used.
+   Decodes a stream with many literal block types with output taken in
+   small pieces, so that block switches happen across calls; then makes
+   each allocation in turn fail, so that building trees on a block switch
+   fails too. */
+static BROTLI_BOOL TestLiteralTypes(const uint8_t* data, size_t size) {
+  static const size_t kSteps[][2] = {
+    {4096, 1}, {1, 13}, {64, 4096}, {~(size_t)0, 1000}
+  };
+  uint8_t* mixed = MixLiterals(data, size);
+  size_t encoded_size = 0;
+  uint8_t* encoded = mixed ?
+      Compress(mixed, size, 11, 22, 0, &encoded_size) : NULL;
+  Allocator allocator = {0};
+  BrotliDecoderState* s =
+      BrotliDecoderCreateInstance(CountingAlloc, CountingFree, &allocator);
+  BROTLI_BOOL ok = TO_BROTLI_BOOL(encoded && s);
+  BROTLI_BOOL done = BROTLI_FALSE;
+  size_t fail_at;
+  size_t i;
+  uint32_t cache_size;
+  for (cache_size = 0; ok && cache_size <= 16; cache_size += 16) {
+    ok = BrotliDecoderSetParameter(s,
+        BROTLI_DECODER_PARAM_HUFFMAN_CACHE_SIZE, cache_size);
+    for (i = 0; ok && i < sizeof(kSteps) / sizeof(kSteps[0]); ++i) {
+      ok = DecodeInPiecesAndCheck(s, encoded, encoded_size, kSteps[i][0],
+          kSteps[i][1], mixed, size);
+      BrotliDecoderReset(s);
+    }
+  }
+  for (fail_at = 1; ok && !done; ++fail_at) {
+    uint8_t* decoded = (uint8_t*)malloc(size + 1);
+    size_t available_in = encoded_size;
+    const uint8_t* next_in = encoded;
+    size_t available_out = size + 1;
+    uint8_t* next_out = decoded;
+    BrotliDecoderResult result;
+    if (!decoded) {
+      ok = BROTLI_FALSE;
+      break;
+    }
+    allocator.count = 0;
+    allocator.fail_at = fail_at;
+    result = BrotliDecoderDecompressStream(
+        s, &available_in, &next_in, &available_out, &next_out, NULL);
+    /* Allocations made after the failing one are not checked. */
+    done = TO_BROTLI_BOOL(allocator.count < fail_at);
+    if (result == BROTLI_DECODER_RESULT_SUCCESS) {
+      ok = TO_BROTLI_BOOL((size_t)(next_out - decoded) == size &&
+          memcmp(decoded, mixed, size) == 0);
+    } else {
+      BrotliDecoderErrorCode error = BrotliDecoderGetErrorCode(s);
+      ok = TO_BROTLI_BOOL(!done && result == BROTLI_DECODER_RESULT_ERROR &&
+          error <= BROTLI_DECODER_ERROR_ALLOC_CONTEXT_MODES &&
+          error >= BROTLI_DECODER_ERROR_ALLOC_BLOCK_TYPE_TREES);
+    }
+    if (!ok) {
+      fprintf(stderr, "failing allocation %lu: result %d, %s\n",
+          (unsigned long)fail_at, (int)result,
+          BrotliDecoderErrorString(BrotliDecoderGetErrorCode(s)));
+    }
+    free(decoded);
+    BrotliDecoderReset(s);
+  }
+  allocator.fail_at = 0;
+  BrotliDecoderDestroyInstance(s);
+  if (allocator.live != 0) {
+    fprintf(stderr, "%lu allocations leaked\n", (unsigned long)allocator.live);
+    ok = BROTLI_FALSE;
+  }
+  free(encoded);
+  free(mixed);
+  return ok;
+}
+
+/* Decodes |encoded| with a new instance that has |param| set to |value|,
+   feeding input in pieces of up to |step| bytes. Output produced so far
+   must match |expected|, and with BROTLI_DECODER_PARAM_MAX_OUTPUT_RATIO
+   it must never exceed |value| times the consumed input. Returns error code
+   of the decoder, or BROTLI_DECODER_SUCCESS if all |size| bytes are
+   decoded. */
+static BrotliDecoderErrorCode DecodeWithLimit(BrotliDecoderParameter param,
+    uint32_t value, const uint8_t* encoded, size_t encoded_size, size_t step,
+    const uint8_t* expected, size_t size) {
+  BrotliDecoderState* s = BrotliDecoderCreateInstance(NULL, NULL, NULL);
+  uint8_t* decoded = (uint8_t*)malloc(size + 1);
+  size_t available_out = size + 1;
+  uint8_t* next_out = decoded;
+  size_t consumed = 0;
+  BrotliDecoderResult result = BROTLI_DECODER_RESULT_NEEDS_MORE_INPUT;
+  BrotliDecoderErrorCode error = BROTLI_DECODER_ERROR_UNREACHABLE;
+  if (!s || !decoded || !BrotliDecoderSetParameter(s, param, value)) {
+    BrotliDecoderDestroyInstance(s);
+    free(decoded);
+    return error;
+  }
+  while (result == BROTLI_DECODER_RESULT_NEEDS_MORE_INPUT &&
+      consumed < encoded_size) {
+    size_t available_in = encoded_size - consumed;
+    const uint8_t* next_in = encoded + consumed;
+    size_t total_out;
+    if (available_in > step) available_in = step;
+    result = BrotliDecoderDecompressStream(
+        s, &available_in, &next_in, &available_out, &next_out, NULL);
+    consumed = (size_t)(next_in - encoded);
+    total_out = (size_t)(next_out - decoded);
+    if (memcmp(decoded, expected, total_out) != 0 ||
+        (param == BROTLI_DECODER_PARAM_MAX_OUTPUT_RATIO &&
+        total_out / value > consumed)) {
+      fprintf(stderr, "%lu bytes decoded from %lu are wrong or too many\n",
+          (unsigned long)total_out, (unsigned long)consumed);
+      result = BROTLI_DECODER_RESULT_NEEDS_MORE_INPUT;
+      break;
+    }
+  }
+  if (result == BROTLI_DECODER_RESULT_SUCCESS) {
+    if ((size_t)(next_out - decoded) == size) error = BROTLI_DECODER_SUCCESS;
+  } else if (result == BROTLI_DECODER_RESULT_ERROR) {
+    error = BrotliDecoderGetErrorCode(s);
+  }
+  BrotliDecoderDestroyInstance(s);
+  free(decoded);
+  return error;
+}
+
+static BROTLI_BOOL ExpectError(BrotliDecoderErrorCode error,
+    BrotliDecoderErrorCode expected, const char* what, uint32_t value,
+    size_t step) {
+  if (error == expected) return BROTLI_TRUE;
+  fprintf(stderr, "%s %lu, input pieces of %lu bytes: %s, expected %s\n",
+      what, (unsigned long)value, (unsigned long)step,
+      BrotliDecoderErrorString(error), BrotliDecoderErrorString(expected));
+  return BROTLI_FALSE;
+}
+
+/* Seeks to |offset| with output ratio limited to |ratio| and decodes
+   |size| bytes, feeding input byte by byte. */
+static BROTLI_BOOL SeekWithRatio(uint32_t ratio, const uint8_t* encoded,
+    size_t encoded_size, size_t offset, const uint8_t* expected,
+    size_t size) {
+  BrotliDecoderState* s = BrotliDecoderCreateInstance(NULL, NULL, NULL);
+  uint8_t* decoded = (uint8_t*)malloc(size);
+  size_t available_out = size;
+  uint8_t* next_out = decoded;
+  size_t consumed = 0;
+  BrotliDecoderResult result = BROTLI_DECODER_RESULT_NEEDS_MORE_INPUT;
+  BROTLI_BOOL ok = TO_BROTLI_BOOL(s && decoded);
+  if (ok) {
+    ok = BrotliDecoderSetParameter(s, BROTLI_DECODER_PARAM_MAX_OUTPUT_RATIO,
+        ratio) && BrotliDecoderSeek(s, encoded_size, encoded, offset,
+        &consumed);
+  }
+  while (ok && available_out != 0 &&
+      result == BROTLI_DECODER_RESULT_NEEDS_MORE_INPUT &&
+      consumed < encoded_size) {
+    size_t available_in = 1;
+    const uint8_t* next_in = encoded + consumed;
+    result = BrotliDecoderDecompressStream(
+        s, &available_in, &next_in, &available_out, &next_out, NULL);
+    consumed = (size_t)(next_in - encoded);
+  }
+  if (ok && (available_out != 0 || memcmp(decoded, expected, size) != 0)) {
+    fprintf(stderr, "seek to %lu with output ratio %lu: %s\n",
+        (unsigned long)offset, (unsigned long)ratio,
+        BrotliDecoderErrorString(BrotliDecoderGetErrorCode(s)));
+    ok = BROTLI_FALSE;
+  }
+  BrotliDecoderDestroyInstance(s);
+  free(decoded);
+  return ok;
+}
+
+/* Memory limit: decoding fails with LIMIT_MEMORY below the smallest limit
+   that is enough, and succeeds at or above it. Output ratio limit: highly
+   compressible input fails with LIMIT_OUTPUT_RATIO before output goes
+   beyond the ratio; bytes dropped by seek do not count. */
+static BROTLI_BOOL TestLimits(const uint8_t* data, size_t size) {
+  static const size_t kSteps[] = {1, 4096, ~(size_t)0};
+  const BrotliDecoderParameter kMemory = BROTLI_DECODER_PARAM_MAX_MEMORY;
+  const BrotliDecoderParameter kRatio = BROTLI_DECODER_PARAM_MAX_OUTPUT_RATIO;
+  size_t repeated_size = (size_t)1 << 20;
+  uint8_t* repeated = (uint8_t*)malloc(repeated_size);
+  size_t encoded_size = 0;
+  uint8_t* encoded = Compress(data, size, 5, 22, 0, &encoded_size);
+  size_t repeated_encoded_size = 0;
+  uint8_t* repeated_encoded = NULL;
+  BROTLI_BOOL ok = TO_BROTLI_BOOL(repeated && encoded && size >= 100);
+  uint32_t low = 1;
+  uint32_t high = 1u << 26;
+  size_t i;
+  if (ok) {
+    for (i = 0; i < repeated_size; ++i) repeated[i] = data[i % 100];
+    repeated_encoded = Compress(repeated, repeated_size, 5, 22, 0,
+        &repeated_encoded_size);
+    ok = TO_BROTLI_BOOL(repeated_encoded != NULL);
+  }
+  /* Finds the smallest limit that is enough; |high| is always enough. */
+  if (ok) {
+    ok = ExpectError(DecodeWithLimit(kMemory, high, encoded, encoded_size,
+        4096, data, size), BROTLI_DECODER_SUCCESS, "memory limit", high,
+        4096);
+  }
+  while (ok && low < high) {
+    uint32_t middle = low + (high - low) / 2;
+    BrotliDecoderErrorCode error = DecodeWithLimit(kMemory, middle, encoded,
+        encoded_size, 4096, data, size);
+    if (error == BROTLI_DECODER_SUCCESS) {
+      high = middle;
+    } else {
+      ok = ExpectError(error, BROTLI_DECODER_ERROR_LIMIT_MEMORY,
+          "memory limit", middle, 4096);
+      low = middle + 1;
+    }
+  }
+  for (i = 0; ok && i < sizeof(kSteps) / sizeof(kSteps[0]); ++i) {
+    ok = ExpectError(DecodeWithLimit(kMemory, 1, encoded, encoded_size,
+        kSteps[i], data, size), BROTLI_DECODER_ERROR_LIMIT_MEMORY,
+        "memory limit", 1, kSteps[i]);
+    if (ok && kSteps[i] == 4096) {
+      ok = ExpectError(DecodeWithLimit(kMemory, high - 1, encoded,
+          encoded_size, kSteps[i], data, size),
+          BROTLI_DECODER_ERROR_LIMIT_MEMORY, "memory limit", high - 1,
+          kSteps[i]);
+    }
+    if (ok) {
+      ok = ExpectError(DecodeWithLimit(kMemory, 1u << 26, encoded,
+          encoded_size, kSteps[i], data, size), BROTLI_DECODER_SUCCESS,
+          "memory limit", 1u << 26, kSteps[i]);
+    }
+  }
+  for (i = 0; ok && i < sizeof(kSteps) / sizeof(kSteps[0]); ++i) {
+    ok = ExpectError(DecodeWithLimit(kRatio, 16, repeated_encoded,
+        repeated_encoded_size, kSteps[i], repeated, repeated_size),
+        BROTLI_DECODER_ERROR_LIMIT_OUTPUT_RATIO, "output ratio", 16,
+        kSteps[i]);
+    if (ok) {
+      ok = ExpectError(DecodeWithLimit(kRatio, 2, encoded, encoded_size,
+          kSteps[i], data, size), BROTLI_DECODER_ERROR_LIMIT_OUTPUT_RATIO,
+          "output ratio", 2, kSteps[i]);
+    }
+    if (ok) {
+      ok = ExpectError(DecodeWithLimit(kRatio, (uint32_t)repeated_size,
+          repeated_encoded, repeated_encoded_size, kSteps[i], repeated,
+          repeated_size), BROTLI_DECODER_SUCCESS, "output ratio",
+          (uint32_t)repeated_size, kSteps[i]);
+    }
+  }
+  free(repeated_encoded);
+  repeated_encoded = NULL;
+  if (ok) {
+    repeated_encoded = Compress(repeated, repeated_size, 5, 22, 64,
+        &repeated_encoded_size);
+    ok = TO_BROTLI_BOOL(repeated_encoded != NULL);
+  }
+  if (ok) {
+    /* 64 KiB chunks take about 80 bytes each; output after the offset is
+       well within the ratio, though the whole chunk is not. */
+    size_t offset = ((size_t)3 << 16) + 60000;
+    ok = SeekWithRatio(256, repeated_encoded, repeated_encoded_size, offset,
+        repeated + offset, 1000);
+  }
+  free(repeated);
+  free(repeated_encoded);
+  free(encoded);
+  return ok;
+}
+
+/* Feeds input in pieces of different sizes, down to single bytes, so that
+   bit reader refills hit the end of input at every position. */
+static BROTLI_BOOL TestInputPieces(const uint8_t* data, size_t size) {
+  static const size_t kSteps[] = {1, 3, 7, 8, 9, 31, 32, 33, 4096};
+  static const int kQualities[] = {1, 5, 11};
+  BROTLI_BOOL ok = BROTLI_TRUE;
+  size_t i;
+  size_t j;
+  for (i = 0; ok && i < sizeof(kQualities) / sizeof(kQualities[0]); ++i) {
+    size_t encoded_size = 0;
+    uint8_t* encoded =
+        Compress(data, size, kQualities[i], 22, 0, &encoded_size);
+    BrotliDecoderState* s = BrotliDecoderCreateInstance(NULL, NULL, NULL);
+    ok = TO_BROTLI_BOOL(encoded && s);
+    for (j = 0; ok && j < sizeof(kSteps) / sizeof(kSteps[0]); ++j) {
+      ok = DecodeAndCheck(s, encoded, encoded_size, kSteps[j], data, size);
+      BrotliDecoderReset(s);
+    }
+    BrotliDecoderDestroyInstance(s);
+    free(encoded);
+  }
+  return ok;
+}
+
+/* One-shot decoding into buffers of exactly |capacity| bytes. Buffers are
+   used as the window while decoded data and write-ahead slack fit; then
+   decoder continues with its own ring-buffer. */
+static BROTLI_BOOL CheckOneShot(const uint8_t* encoded, size_t encoded_size,
+    const uint8_t* expected, size_t size, size_t capacity) {
+  uint8_t* decoded = (uint8_t*)malloc(capacity ? capacity : 1);
+  size_t decoded_size = capacity;
+  BrotliDecoderResult result;
+  BROTLI_BOOL ok;
+  if (!decoded) return BROTLI_FALSE;
+  result = BrotliDecoderDecompress(encoded_size, encoded, &decoded_size,
+      decoded, BROTLI_FALSE, NULL, NULL, NULL, NULL);
+  if (capacity < size) {
+    ok = TO_BROTLI_BOOL(result == BROTLI_DECODER_RESULT_ERROR);
+  } else {
+    ok = TO_BROTLI_BOOL(result == BROTLI_DECODER_RESULT_SUCCESS &&
+        decoded_size == size && memcmp(decoded, expected, size) == 0);
+  }
+  if (!ok) {
+    fprintf(stderr, "one-shot decoding of %lu bytes into %lu failed: "
+        "result %d, %lu bytes\n", (unsigned long)size,
+        (unsigned long)capacity, (int)result, (unsigned long)decoded_size);
+  }
+  free(decoded);
+  return ok;
+}
+
+static BROTLI_BOOL TestOneShot(const uint8_t* data, size_t size) {
+  static const size_t kPrefixes[] = {0, 1, 2, 43, 44, 1000, 65536};
+  static const size_t kSpare[] = {0, 1, 16, 41, 42, 43, 44, 64, 4096};
+  const size_t num_prefixes = sizeof(kPrefixes) / sizeof(kPrefixes[0]);
+  size_t random_size = 100000;
+  uint8_t* random = (uint8_t*)malloc(random_size);
+  uint32_t seed = 1;
+  BROTLI_BOOL ok = TO_BROTLI_BOOL(random != NULL);
+  size_t i;
+  size_t j;
+  for (i = 0; ok && i < random_size; ++i) {
+    seed = seed * 1103515245u + 12345u;
+    random[i] = (uint8_t)(seed >> 16);
+  }
+  for (i = 0; ok && i < num_prefixes + 2; ++i) {
+    /* The last passes are for the whole input and for stored metablocks
+       longer than window; both with a small window. */
+    const uint8_t* input = i <= num_prefixes ? data : random;
+    size_t length = i < num_prefixes ? kPrefixes[i] :
+        (i == num_prefixes ? size : random_size);
+    int lgwin = i < num_prefixes ? 22 : 16;
+    size_t encoded_size = 0;
+    uint8_t* encoded = Compress(input, length, 5, lgwin, 0, &encoded_size);
+    ok = TO_BROTLI_BOOL(encoded != NULL);
+    if (ok && length != 0) {
+      ok = CheckOneShot(encoded, encoded_size, input, length, length - 1);
+    }
+    for (j = 0; ok && j < sizeof(kSpare) / sizeof(kSpare[0]); ++j) {
+      ok = CheckOneShot(encoded, encoded_size, input, length,
+          length + kSpare[j]);
+    }
+    if (ok) {
+      ok = CheckOneShot(encoded, encoded_size, input, length, 2 * length);
+    }
+    free(encoded);
+  }
+  /* Metablocks of chunked streams end at 5 KiB boundaries, so decoder
+     leaves the output in the middle of a window, or after the window
+     would have wrapped. */
+  for (i = 0; ok && i < 2; ++i) {
+    size_t encoded_size = 0;
+    uint8_t* encoded =
+        Compress(data, size, 5, i == 0 ? 22 : 16, 5, &encoded_size);
+    ok = TO_BROTLI_BOOL(encoded != NULL);
+    for (j = 0; ok && j < sizeof(kSpare) / sizeof(kSpare[0]); ++j) {
+      ok = CheckOneShot(encoded, encoded_size, data, size, size + kSpare[j]);
+    }
+    free(encoded);
+  }
+  free(random);
+  return ok;
+}
+
+/* Uncompressed metablocks are copied straight to output when it has room.
+   Input consists of random bytes, which are stored, text, and a repeat of
+   random bytes, which refers back to stored ones when window is large
+   enough. Output is taken in pieces that end inside stored metablocks;
+   with the smaller window, stored parts are longer than the window. */
+static BROTLI_BOOL TestStored(const uint8_t* data, size_t size) {
+  static const size_t kSteps[][2] = {
+    {~(size_t)0, 1}, {~(size_t)0, 7}, {~(size_t)0, 100}, {1000, 4096},
+    {4096, 65539}, {~(size_t)0, ~(size_t)0}
+  };
+  static const int kWindows[] = {16, 22};
+  size_t text_size = size < 65536 ? size : 65536;
+  size_t mixed_size = 3 * 131072 + text_size + 65536;
+  uint8_t* mixed = (uint8_t*)malloc(mixed_size);
+  uint32_t seed = 1;
+  BROTLI_BOOL ok = TO_BROTLI_BOOL(mixed != NULL);
+  size_t i;
+  size_t j;
+  if (ok) {
+    uint8_t* p = mixed;
+    for (i = 0; i < 2 * 131072; ++i) {
+      seed = seed * 1103515245u + 12345u;
+      *p++ = (uint8_t)(seed >> 16);
+    }
+    memcpy(p, data, text_size);
+    p += text_size;
+    memcpy(p, mixed + 1000, 131072);
+    p += 131072;
+    for (i = 0; i < 65536; ++i) {
+      seed = seed * 1103515245u + 12345u;
+      *p++ = (uint8_t)(seed >> 16);
+    }
+  }
+  for (i = 0; ok && i < sizeof(kWindows) / sizeof(kWindows[0]); ++i) {
+    size_t encoded_size = 0;
+    uint8_t* encoded =
+        Compress(mixed, mixed_size, 5, kWindows[i], 0, &encoded_size);
+    BrotliDecoderState* s = BrotliDecoderCreateInstance(NULL, NULL, NULL);
+    ok = TO_BROTLI_BOOL(encoded && s);
+    for (j = 0; ok && j < sizeof(kSteps) / sizeof(kSteps[0]); ++j) {
+      ok = DecodeInPiecesAndCheck(s, encoded, encoded_size, kSteps[j][0],
+          kSteps[j][1], mixed, mixed_size);
+      BrotliDecoderReset(s);
+    }
+    if (ok) {
+      ok = CheckOneShot(encoded, encoded_size, mixed, mixed_size, mixed_size);
+    }
+    BrotliDecoderDestroyInstance(s);
+    free(encoded);
+  }
+  free(mixed);
+  return ok;
+}
+
+/* Stream with a single 10-byte copy at distance 4 from the start, i.e.
+   from the last 4 bytes of the dictionary and on into the stream. */
+static size_t MakeCopyPastDictionary(uint8_t* data) {
+  size_t pos = 0;
+  memset(data, 0, 16);
+  WriteBits(data, &pos, 1, 0);     /* WBITS: 16 */
+  WriteBits(data, &pos, 2, 1);     /* ISLAST, not ISLASTEMPTY */
+  WriteBits(data, &pos, 2, 0);     /* MNIBBLES: 4 */
+  WriteBits(data, &pos, 16, 9);    /* MLEN - 1 */
+  WriteBits(data, &pos, 3, 0);     /* NBLTYPESL, NBLTYPESI, NBLTYPESD: 1 */
+  WriteBits(data, &pos, 6, 0);     /* NPOSTFIX, NDIRECT: 0 */
+  WriteBits(data, &pos, 2, 0);     /* Literal context mode */
+  WriteBits(data, &pos, 2, 0);     /* NTREESL, NTREESD: 1 */
+  /* Simple prefix codes with a single symbol each. */
+  WriteBits(data, &pos, 4, 1);     /* Literals: 'a' */
+  WriteBits(data, &pos, 8, 'a');
+  WriteBits(data, &pos, 4, 1);     /* Commands: insert 0, copy 10-11 */
+  WriteBits(data, &pos, 10, 192);
+  WriteBits(data, &pos, 4, 1);     /* Distances: the last one, i.e. 4 */
+  WriteBits(data, &pos, 6, 0);
+  WriteBits(data, &pos, 1, 0);     /* Copy length extra bit: 10 */
+  return (pos + 7) >> 3;
+}
+
+/* Decodes |encoded| in one call with a new instance that has
+   |num_dictionaries| raw dictionaries attached. Returns error code of the
+   decoder, or BROTLI_DECODER_SUCCESS if |size| bytes of |expected| are
+   decoded. */
+static BrotliDecoderErrorCode DecodeWithDictionaries(const uint8_t* encoded,
+    size_t encoded_size, const uint8_t* const* dictionaries,
+    const size_t* dictionary_sizes, size_t num_dictionaries,
+    const uint8_t* expected, size_t size) {
+  BrotliDecoderState* s = BrotliDecoderCreateInstance(NULL, NULL, NULL);
+  uint8_t* decoded = (uint8_t*)malloc(size + 1);
+  size_t available_in = encoded_size;
+  const uint8_t* next_in = encoded;
+  size_t available_out = size + 1;
+  uint8_t* next_out = decoded;
+  BrotliDecoderErrorCode error = BROTLI_DECODER_ERROR_UNREACHABLE;
+  BROTLI_BOOL ok = TO_BROTLI_BOOL(s && decoded);
+  size_t i;
+  for (i = 0; ok && i < num_dictionaries; ++i) {
+    ok = BrotliDecoderAttachDictionary(s, BROTLI_SHARED_DICTIONARY_RAW,
+        dictionary_sizes[i], dictionaries[i]);
+  }
+  if (ok) {
+    BrotliDecoderResult result = BrotliDecoderDecompressStream(
+        s, &available_in, &next_in, &available_out, &next_out, NULL);
+    if (result == BROTLI_DECODER_RESULT_SUCCESS) {
+      if ((size_t)(next_out - decoded) == size &&
+          memcmp(decoded, expected, size) == 0) {
+        error = BROTLI_DECODER_SUCCESS;
+      }
+    } else if (result == BROTLI_DECODER_RESULT_ERROR) {
+      error = BrotliDecoderGetErrorCode(s);
+    }
+  }
+  BrotliDecoderDestroyInstance(s);
+  free(decoded);
+  return error;
+}
+
+/* Custom dictionaries attached with BrotliDecoderAttachDictionary. There
+   are three of them, two random and one text; input takes long runs from
+   each, so it is encoded as a few long copies from the dictionaries. Window
+   is 16-bit and input blocks are 18-bit, so that encoder does not cut
+   copies at window boundaries, and copies cross the end of ring buffer;
+   output is taken in pieces, so copies are resumed after NEEDS_MORE_OUTPUT.
+   Stream does not decode with dictionaries in another order. A copy that
+   starts in the dictionary and goes past its end is rejected. */
+static BROTLI_BOOL TestDictionary(const uint8_t* data, size_t size) {
+  static const size_t kSteps[][2] = {
+    {~(size_t)0, 1}, {~(size_t)0, 1000}, {1, 65536}, {~(size_t)0, ~(size_t)0}
+  };
+  const size_t random_size = 100000;
+  size_t text_size = size < 60000 ? size : 60000;
+  uint8_t* random = (uint8_t*)malloc(2 * random_size);
+  uint8_t* input = (uint8_t*)malloc(2 * random_size + text_size);
+  const uint8_t* dictionaries[3];
+  size_t dictionary_sizes[3];
+  const uint8_t* swapped[3];
+  size_t input_size = 0;
+  size_t encoded_size = 0;
+  uint8_t* encoded = NULL;
+  BrotliDecoderState* s = BrotliDecoderCreateInstance(NULL, NULL, NULL);
+  uint8_t crafted[16];
+  size_t crafted_size;
+  uint32_t seed = 1;
+  BROTLI_BOOL ok = TO_BROTLI_BOOL(random && input && s);
+  size_t i;
+  if (ok) {
+    for (i = 0; i < 2 * random_size; ++i) {
+      seed = seed * 1103515245u + 12345u;
+      random[i] = (uint8_t)(seed >> 16);
+    }
+    dictionaries[0] = random;
+    dictionaries[1] = data;
+    dictionaries[2] = random + random_size;
+    dictionary_sizes[0] = random_size;
+    dictionary_sizes[1] = text_size;
+    dictionary_sizes[2] = random_size;
+    memcpy(input, random + random_size + 1000, 80000);
+    input_size += 80000;
+    memcpy(input + input_size, data, text_size);
+    input_size += text_size;
+    memcpy(input + input_size, random + 3000, 90000);
+    input_size += 90000;
+    memcpy(input + input_size, random + random_size + 50000, 10000);
+    input_size += 10000;
+    encoded = CompressWithDictionaries(input, input_size, 16, 18, dictionaries,
+        dictionary_sizes, 3, &encoded_size);
+    ok = TO_BROTLI_BOOL(encoded != NULL);
+  }
+  if (ok && encoded_size > input_size / 100) {
+    fprintf(stderr, "dictionaries are not used: %lu bytes\n",
+        (unsigned long)encoded_size);
+    ok = BROTLI_FALSE;
+  }
+  for (i = 0; ok && i < 3; ++i) {
+    ok = BrotliDecoderAttachDictionary(s, BROTLI_SHARED_DICTIONARY_RAW,
+        dictionary_sizes[i], dictionaries[i]);
+  }
+  /* Attached dictionaries are kept by BrotliDecoderReset. */
+  for (i = 0; ok && i < sizeof(kSteps) / sizeof(kSteps[0]); ++i) {
+    ok = DecodeInPiecesAndCheck(s, encoded, encoded_size, kSteps[i][0],
+        kSteps[i][1], input, input_size);
+    BrotliDecoderReset(s);
+  }
+  if (ok) {
+    swapped[0] = dictionaries[2];
+    swapped[1] = dictionaries[1];
+    swapped[2] = dictionaries[0];
+    if (DecodeWithDictionaries(encoded, encoded_size, swapped,
+        dictionary_sizes, 3, input, input_size) == BROTLI_DECODER_SUCCESS) {
+      fprintf(stderr, "decoded with dictionaries in another order\n");
+      ok = BROTLI_FALSE;
+    }
+  }
+  if (ok) {
+    BrotliDecoderErrorCode error;
+    crafted_size = MakeCopyPastDictionary(crafted);
+    error = DecodeWithDictionaries(crafted, crafted_size, dictionaries,
+        dictionary_sizes, 1, random, 10);
+    if (error != BROTLI_DECODER_ERROR_COMPOUND_DICTIONARY) {
+      fprintf(stderr, "copy past dictionary: %s\n",
+          BrotliDecoderErrorString(error));
+      ok = BROTLI_FALSE;
+    }
+  }
+  /* Dictionaries are attached only before decoding; up to 15 of them. */
+  if (ok && BrotliDecoderAttachDictionary(s, BROTLI_SHARED_DICTIONARY_RAW,
+      random_size, random) == BROTLI_FALSE) {
+    fprintf(stderr, "dictionary is not attached after reset\n");
+    ok = BROTLI_FALSE;
+  }
+  for (i = 4; ok && i < 15; ++i) {
+    ok = BrotliDecoderAttachDictionary(s, BROTLI_SHARED_DICTIONARY_RAW, 1,
+        random);
+  }
+  if (ok && BrotliDecoderAttachDictionary(s, BROTLI_SHARED_DICTIONARY_RAW, 1,
+      random)) {
+    fprintf(stderr, "16th dictionary is attached\n");
+    ok = BROTLI_FALSE;
+  }
+  BrotliDecoderDestroyInstance(s);
+  s = ok ? BrotliDecoderCreateInstance(NULL, NULL, NULL) : NULL;
+  if (s) {
+    size_t available_in = encoded_size;
+    const uint8_t* next_in = encoded;
+    size_t available_out = 0;
+    BrotliDecoderDecompressStream(s, &available_in, &next_in, &available_out,
+        NULL, NULL);
+    if (BrotliDecoderAttachDictionary(s, BROTLI_SHARED_DICTIONARY_RAW,
+        random_size, random)) {
+      fprintf(stderr, "dictionary is attached while decoding\n");
+      ok = BROTLI_FALSE;
+    }
+  }
+  BrotliDecoderDestroyInstance(s);
+  free(encoded);
+  free(input);
+  free(random);
+  return ok;
+}
+
+/* Fills |size| bytes with literals drawn uniformly from |num_frequent|
+   letters; if |rare_period| is not 0, about every |rare_period|-th byte is
+   one of 128 rare bytes instead. */
+static void MakeLiterals(uint8_t* data, size_t size, uint32_t num_frequent,
+    uint32_t rare_period) {
+  uint32_t seed = 1;
+  size_t i;
+  for (i = 0; i < size; ++i) {
+    seed = seed * 1103515245u + 12345u;
+    if (rare_period != 0 && (seed >> 8) % rare_period == 0) {
+      data[i] = (uint8_t)(128 + ((seed >> 20) & 127));
+    } else {
+      data[i] = (uint8_t)('0' + (seed >> 16) % num_frequent);
+    }
+  }
+}
+
+/* Stream with a 10000-literal insert of a single-symbol literal tree,
+   followed by 64 stored bytes, so that the whole insert is decoded with
+   enough input left for the fast loop. */
+static size_t MakeSingleLiteral(uint8_t* data, const uint8_t* stored) {
+  size_t pos = 0;
+  memset(data, 0, 96);
+  WriteBits(data, &pos, 1, 0);     /* WBITS: 16 */
+  WriteBits(data, &pos, 1, 0);     /* Not ISLAST */
+  WriteBits(data, &pos, 2, 0);     /* MNIBBLES: 4 */
+  WriteBits(data, &pos, 16, 9999); /* MLEN - 1 */
+  WriteBits(data, &pos, 1, 0);     /* Not ISUNCOMPRESSED */
+  WriteBits(data, &pos, 3, 0);     /* NBLTYPESL, NBLTYPESI, NBLTYPESD: 1 */
+  WriteBits(data, &pos, 6, 0);     /* NPOSTFIX, NDIRECT: 0 */
+  WriteBits(data, &pos, 2, 0);     /* Literal context mode */
+  WriteBits(data, &pos, 2, 0);     /* NTREESL, NTREESD: 1 */
+  /* Simple prefix codes with a single symbol each. */
+  WriteBits(data, &pos, 4, 1);     /* Literals: 'a' */
+  WriteBits(data, &pos, 8, 'a');
+  WriteBits(data, &pos, 4, 1);     /* Commands: insert 6210.., copy 2 */
+  WriteBits(data, &pos, 10, 496);
+  WriteBits(data, &pos, 4, 1);     /* Distances: never read */
+  WriteBits(data, &pos, 6, 0);
+  WriteBits(data, &pos, 14, 10000 - 6210);  /* Insert length extra bits */
+  WriteBits(data, &pos, 1, 0);     /* Not ISLAST */
+  WriteBits(data, &pos, 2, 0);     /* MNIBBLES: 4 */
+  WriteBits(data, &pos, 16, 63);   /* MLEN - 1 */
+  WriteBits(data, &pos, 1, 1);     /* ISUNCOMPRESSED */
+  pos = (pos + 7) & ~(size_t)7;
+  memcpy(&data[pos >> 3], stored, 64);
+  pos += 64 * 8;
+  WriteBits(data, &pos, 2, 3);     /* ISLAST, ISLASTEMPTY */
+  return (pos + 7) >> 3;
+}
+
+/* Literals of trivial context are decoded a pair per lookup with a
+   multi-symbol table when the tree qualifies. Streams are decoded with
+   the whole input at once, which takes the fast loop, and in 1-byte input
+   pieces, which decodes one literal at a time; both must match the input.
+   Literal trees are: short codes mixed with 11 to 15-bit ones, which are
+   looked up in second-level tables; a single symbol with 0-bit code; and
+   6-bit codes, which do not make pairs, so the tree does not qualify. */
+static BROTLI_BOOL TestMultiTable(const uint8_t* data, size_t size) {
+  static const size_t kSteps[][2] = {
+    {~(size_t)0, ~(size_t)0}, {1, ~(size_t)0}, {~(size_t)0, 1},
+    {~(size_t)0, 1000}
+  };
+  static const uint32_t kLiterals[][2] = {{16, 32}, {64, 0}};
+  static const int kQualities[] = {2, 5, 9};
+  const size_t literals_size = 200000;
+  uint8_t* literals = (uint8_t*)malloc(literals_size);
+  uint8_t crafted[96];
+  uint8_t expected[10064];
+  BrotliDecoderState* s = BrotliDecoderCreateInstance(NULL, NULL, NULL);
+  BROTLI_BOOL ok = TO_BROTLI_BOOL(literals && s);
+  size_t crafted_size;
+  size_t i;
+  size_t j;
+  size_t k;
+  (void)data;
+  (void)size;
+  for (i = 0; ok && i < sizeof(kLiterals) / sizeof(kLiterals[0]); ++i) {
+    MakeLiterals(literals, literals_size, kLiterals[i][0], kLiterals[i][1]);
+    for (j = 0; ok && j < sizeof(kQualities) / sizeof(kQualities[0]); ++j) {
+      size_t encoded_size = 0;
+      uint8_t* encoded = Compress(literals, literals_size, kQualities[j], 16,
+          0, &encoded_size);
+      ok = TO_BROTLI_BOOL(encoded != NULL);
+      for (k = 0; ok && k < sizeof(kSteps) / sizeof(kSteps[0]); ++k) {
+        ok = DecodeInPiecesAndCheck(s, encoded, encoded_size, kSteps[k][0],
+            kSteps[k][1], literals, literals_size);
+        BrotliDecoderReset(s);
+      }
+      free(encoded);
+    }
+  }
+  if (ok) {
+    memset(expected, 'a', 10000);
+    MakeLiterals(expected + 10000, 64, 64, 0);
+    crafted_size = MakeSingleLiteral(crafted, expected + 10000);
+  }
+  for (k = 0; ok && k < sizeof(kSteps) / sizeof(kSteps[0]); ++k) {
+    ok = DecodeInPiecesAndCheck(s, crafted, crafted_size, kSteps[k][0],
+        kSteps[k][1], expected, sizeof(expected));
+    BrotliDecoderReset(s);
+  }
+  BrotliDecoderDestroyInstance(s);
+  free(literals);
+  return ok;
+}
+
+/* Stores little-endian number into the stream. */
+static void StoreNumber(uint8_t* data, size_t num_bytes, uint64_t value) {
+  size_t i;
+  for (i = 0; i < num_bytes; ++i) {
+    data[i] = (uint8_t)(value >> (8 * i));
+  }
+}
+
+/* Chunk index of a 3-chunk stream is tampered with; every inconsistent
+   index is rejected as a whole, and single chunks that are still accepted
+   stay within the stream and the recorded decompressed size. */
+static BROTLI_BOOL TestChunkIndex(const uint8_t* data, size_t size) {
+  /* Index payload layout: 28-byte header, then 34-byte entries. */
+  const size_t header_size = 28;
+  const size_t entry_size = 34;
+  size_t encoded_size = 0;
+  uint8_t* encoded = Compress(data, size, 5, 22, 64, &encoded_size);
+  uint8_t* tampered = (uint8_t*)malloc(encoded_size);
+  BROTLI_BOOL ok = TO_BROTLI_BOOL(encoded && tampered);
+  size_t payload_offset = 0;
+  size_t payload_size;
+  int i;
+  if (ok && BrotliDecoderGetChunkCount(encoded_size, encoded) != 3) {
+    fprintf(stderr, "expected 3 chunks\n");
+    ok = BROTLI_FALSE;
+  }
+  if (ok) {
+    payload_size = (size_t)encoded[encoded_size - 9] |
+        ((size_t)encoded[encoded_size - 8] << 8) |
+        ((size_t)encoded[encoded_size - 7] << 16);
+    payload_offset = encoded_size - 1 - payload_size;
+  }
+  for (i = 0; ok && i < 6; ++i) {
+    uint8_t* payload = tampered + payload_offset;
+    uint8_t* entries = payload + header_size;
+    size_t j;
+    memcpy(tampered, encoded, encoded_size);
+    switch (i) {
+      case 0:  /* Last chunk and decompressed size are 10 bytes. */
+        StoreNumber(entries + 2 * entry_size + 8, 8, 10);
+        StoreNumber(payload + 12, 8, 10);
+        break;
+      case 1:  /* First chunk does not start the stream. */
+        StoreNumber(entries, 8, 1);
+        break;
+      case 2:  /* Compressed offsets go back. */
+        StoreNumber(entries + 2 * entry_size, 8, 1);
+        break;
+      case 3:  /* Empty chunk in the middle. */
+        memcpy(entries + entry_size + 8, entries + 2 * entry_size + 8, 8);
+        break;
+      case 4:  /* Chunks overlap the index. */
+        StoreNumber(payload + 20, 8, payload_offset + 1);
+        break;
+      default:  /* Decompressed size is less than the last offset. */
+        StoreNumber(payload + 12, 8, 100);
+        break;
+    }
+    if (BrotliDecoderGetChunkCount(encoded_size, tampered) != 0) {
+      fprintf(stderr, "tampered chunk index %d accepted\n", i);
+      ok = BROTLI_FALSE;
+    }
+    for (j = 0; ok && j < 3; ++j) {
+      BrotliDecoderChunk chunk;
+      if (!BrotliDecoderGetChunk(encoded_size, tampered, j, &chunk)) continue;
+      if (chunk.compressed_offset + chunk.compressed_size > payload_offset ||
+          chunk.uncompressed_offset + chunk.uncompressed_size > size) {
+        fprintf(stderr, "chunk %d of tampered index %d is out of range\n",
+            (int)j, i);
+        ok = BROTLI_FALSE;
+      }
+    }
+  }
+  free(tampered);
+  free(encoded);
+  return ok;
+}
+
+typedef BROTLI_BOOL (*TestFunc)(const uint8_t* data, size_t size);
+
+static const struct {
+  const char* name;
+  TestFunc func;
+} kTests[] = {
+  {"reset", TestReset},
+  {"reset-save-info", TestResetSaveInfo},
+  {"seek", TestSeek},
+  {"word-cache", TestWordCache},
+  {"huffman-cache", TestHuffmanCache},
+  {"literal-types", TestLiteralTypes},
+  {"limits", TestLimits},
+  {"input-pieces", TestInputPieces},
+  {"one-shot", TestOneShot},
+  {"stored", TestStored},
+  {"dictionary", TestDictionary},
+  {"multi-table", TestMultiTable},
+  {"chunk-index", TestChunkIndex},
+};
+
+int main(int argc, char** argv) {
+  size_t num_tests = sizeof(kTests) / sizeof(kTests[0]);
+  size_t size = 0;
+  uint8_t* data;
+  BROTLI_BOOL ok;
+  size_t i;
+  if (argc != 3) {
+    fprintf(stderr, "usage: %s <test> <file>\n", argv[0]);
+    return 1;
+  }
+  for (i = 0; i < num_tests; ++i) {
+    if (strcmp(argv[1], kTests[i].name) == 0) break;
+  }
+  if (i == num_tests) {
+    fprintf(stderr, "unknown test [%s]\n", argv[1]);
+    return 1;
+  }
+  data = ReadInput(argv[2], &size);
+  if (!data) return 1;
+  ok = kTests[i].func(data, size);
+  free(data);
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,814 @@
+/* Copyright 2026 The Brotli Authors. All Rights Reserved.
+
+   Distributed under MIT license.
+   See file LICENSE for detail or copy at https://opensource.org/licenses/MIT
+*/
+
+/* Tests of encoder parameters. Input file is compressed with different
+   settings, then decoded and compared to the original. Usage:
+
+     encode_test <test> <file> */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <brotli/decode.h>
+#include <brotli/encode.h>
+#include <brotli/types.h>
+
+typedef struct Param {
+  BrotliEncoderParameter key;
+  uint32_t value;
+} Param;
+
+/* Tracks bytes allocated through the instance allocator, and their peak. */
+typedef struct Allocator {
+  size_t current;
+  size_t peak;
+} Allocator;
+
+/* Size is stored in front of the block; 16 bytes keep it aligned. */
+#define ALLOC_HEADER_SIZE 16
+
+static void* TrackingAlloc(void* opaque, size_t size) {
+  Allocator* allocator = (Allocator*)opaque;
+  uint8_t* p = (uint8_t*)malloc(size + ALLOC_HEADER_SIZE);
+  if (!p) return NULL;
+  memcpy(p, &size, sizeof(size));
+  allocator->current += size;
+  if (allocator->current > allocator->peak) {
+    allocator->peak = allocator->current;
+  }
+  return p + ALLOC_HEADER_SIZE;
+}
+
+static void TrackingFree(void* opaque, void* address) {
+  Allocator* allocator = (Allocator*)opaque;
+  uint8_t* p = (uint8_t*)address;
+  size_t size;
+  if (!p) return;
+  p -= ALLOC_HEADER_SIZE;
+  memcpy(&size, p, sizeof(size));
+  allocator->current -= size;
+  free(p);
+}
+
+static uint8_t* ReadInput(const char* path, size_t* size) {
+  FILE* file = fopen(path, "rb");
+  uint8_t* data;
+  long file_size;
+  if (file == NULL) {
+    perror("fopen failed");
+    return NULL;
+  }
+  fseek(file, 0, SEEK_END);
+  file_size = ftell(file);
+  fseek(file, 0, SEEK_SET);
+  data = (uint8_t*)malloc(file_size > 0 ? (size_t)file_size : 1);
+  if (data == NULL ||
+      fread(data, 1, (size_t)file_size, file) != (size_t)file_size) {
+    fprintf(stderr, "failed to read %s\n", path);
+    free(data);
+    fclose(file);
+    return NULL;
+  }
+  fclose(file);
+  *size = (size_t)file_size;
+  return data;
+}
+
+/* Compresses |data| with a streaming encoder configured with |params|;
+   |allocator| is optional. If |stored_bytes| is not NULL, it receives
+   BrotliEncoderGetStoredBytes. Returned buffer is owned by the caller. */
+static uint8_t* CompressWithAllocator(const uint8_t* data, size_t size,
+    const Param* params, size_t num_params, Allocator* allocator,
+    size_t* stored_bytes, size_t* encoded_size) {
+  BrotliEncoderState* s = allocator ?
+      BrotliEncoderCreateInstance(TrackingAlloc, TrackingFree, allocator) :
+      BrotliEncoderCreateInstance(NULL, NULL, NULL);
+  size_t capacity = BrotliEncoderMaxCompressedSize(size);
+  uint8_t* encoded = (uint8_t*)malloc(capacity);
+  size_t available_in = size;
+  const uint8_t* next_in = data;
+  size_t available_out = capacity;
+  uint8_t* next_out = encoded;
+  BROTLI_BOOL ok = TO_BROTLI_BOOL(s && encoded);
+  size_t i;
+  for (i = 0; ok && i < num_params; ++i) {
+    ok = BrotliEncoderSetParameter(s, params[i].key, params[i].value);
+  }
+  while (ok && !BrotliEncoderIsFinished(s)) {
+    ok = BrotliEncoderCompressStream(s, BROTLI_OPERATION_FINISH,
+        &available_in, &next_in, &available_out, &next_out, NULL);
+    if (ok && available_out == 0 && !BrotliEncoderIsFinished(s)) {
+      ok = BROTLI_FALSE;
+    }
+  }
+  if (ok && stored_bytes) *stored_bytes = BrotliEncoderGetStoredBytes(s);
+  BrotliEncoderDestroyInstance(s);
+  if (!ok) {
+    fprintf(stderr, "failed to compress\n");
+    free(encoded);
+    return NULL;
+  }
+  *encoded_size = capacity - available_out;
+  return encoded;
+}
+
+static uint8_t* Compress(const uint8_t* data, size_t size,
+    const Param* params, size_t num_params, size_t* encoded_size) {
+  return CompressWithAllocator(
+      data, size, params, num_params, NULL, NULL, encoded_size);
+}
+
+/* Checks that |encoded| decodes to |size| bytes of |expected|. */
+static BROTLI_BOOL CheckDecoded(const uint8_t* encoded, size_t encoded_size,
+    const uint8_t* expected, size_t size) {
+  uint8_t* decoded = (uint8_t*)malloc(size ? size : 1);
+  size_t decoded_size = size;
+  BROTLI_BOOL ok = TO_BROTLI_BOOL(decoded &&
+      BrotliDecoderDecompress(encoded_size, encoded, &decoded_size, decoded,
+          BROTLI_FALSE, NULL, NULL, NULL, NULL) ==
+          BROTLI_DECODER_RESULT_SUCCESS &&
+      decoded_size == size && memcmp(decoded, expected, size) == 0);
+  if (!ok) fprintf(stderr, "decoded data differs\n");
+  free(decoded);
+  return ok;
+}
+
+/* Moves queued segments to |out|; each segment is acknowledged in two
+   parts, like after a short write. */
+static void DrainSegments(BrotliEncoderState* s, uint8_t* out,
+    size_t* out_size) {
+  BrotliEncoderOutputSegment segments[2];
+  while (BrotliEncoderGetOutputSegments(s, segments, 2) != 0) {
+    size_t part = (segments[0].size + 1) / 2;
+    memcpy(out + *out_size, segments[0].data, part);
+    *out_size += part;
+    BrotliEncoderReleaseOutput(s, part);
+  }
+}
+
+/* Runs |op| on |size| bytes of |data| until the operation is complete.
+   Output is appended to |encoded|; in segmented mode it is collected only
+   when stream is finished, and caller buffer must stay untouched. */
+static BROTLI_BOOL RunOperation(BrotliEncoderState* s,
+    BrotliEncoderOperation op, const uint8_t* data, size_t size,
+    BROTLI_BOOL segmented, uint8_t* encoded, size_t capacity,
+    size_t* out_size) {
+  uint8_t unused = 0;
+  size_t available_in = size;
+  const uint8_t* next_in = data;
+  BROTLI_BOOL ok;
+  do {
+    size_t available_out;
+    uint8_t* next_out;
+    if (segmented) {
+      available_out = 1;
+      next_out = &unused;
+    } else {
+      available_out = capacity - *out_size;
+      next_out = encoded + *out_size;
+    }
+    ok = BrotliEncoderCompressStream(s, op, &available_in, &next_in,
+        &available_out, &next_out, NULL);
+    if (segmented) {
+      size_t taken = 0;
+      if (available_out != 1 || next_out != &unused ||
+          BrotliEncoderTakeOutput(s, &taken) != NULL || taken != 0) {
+        fprintf(stderr, "segmented output used caller buffer\n");
+        ok = BROTLI_FALSE;
+      }
+      /* Stream is finished when all queued output is released. */
+      if (op == BROTLI_OPERATION_FINISH && available_in == 0) {
+        DrainSegments(s, encoded, out_size);
+      }
+    } else {
+      *out_size = capacity - available_out;
+    }
+  } while (ok && (available_in != 0 || (!segmented &&
+      BrotliEncoderHasMoreOutput(s)) ||
+      (op == BROTLI_OPERATION_FINISH && !BrotliEncoderIsFinished(s))));
+  return ok;
+}
+
+/* Compresses |data| in 32 KiB pieces, flushing after each one; encoder is
+   configured with |params|. If |metadata| is set, first 100 bytes of each
+   flushed piece are also emitted as a metadata block after it. In segmented
+   mode, output is collected after every second piece, so queued segments
+   must survive further BrotliEncoderCompressStream calls. Otherwise
+   |first_size| receives the size of output flushed after the first piece,
+   if it is not NULL. */
+static uint8_t* CompressPieces(const uint8_t* data, size_t size,
+    const Param* params, size_t num_params, BROTLI_BOOL segmented,
+    BROTLI_BOOL metadata, size_t* first_size, size_t* encoded_size) {
+  BrotliEncoderState* s = BrotliEncoderCreateInstance(NULL, NULL, NULL);
+  size_t capacity = BrotliEncoderMaxCompressedSize(size) + (size >> 10) +
+      (metadata ? (size >> 8) : 0) + 64;
+  uint8_t* encoded = (uint8_t*)malloc(capacity);
+  size_t pos = 0;
+  size_t out_size = 0;
+  int piece_index = 0;
+  BROTLI_BOOL ok = TO_BROTLI_BOOL(s && encoded);
+  size_t i;
+  for (i = 0; ok && i < num_params; ++i) {
+    ok = BrotliEncoderSetParameter(s, params[i].key, params[i].value);
+  }
+  if (ok) {
+    ok = BrotliEncoderSetParameter(
+        s, BROTLI_PARAM_SEGMENTED_OUTPUT, (uint32_t)segmented);
+  }
+  while (ok && !BrotliEncoderIsFinished(s)) {
+    size_t piece = size - pos < 32768 ? size - pos : 32768;
+    BrotliEncoderOperation op = (pos + piece == size) ?
+        BROTLI_OPERATION_FINISH : BROTLI_OPERATION_FLUSH;
+    ok = RunOperation(s, op, data + pos, piece, segmented, encoded, capacity,
+        &out_size);
+    if (ok && metadata && op == BROTLI_OPERATION_FLUSH) {
+      ok = RunOperation(s, BROTLI_OPERATION_EMIT_METADATA, data + pos,
+          piece < 100 ? piece : 100, segmented, encoded, capacity, &out_size);
+    }
+    pos += piece;
+    if (first_size && pos == piece) *first_size = out_size;
+    if (ok && segmented && ++piece_index % 2 == 0) {
+      DrainSegments(s, encoded, &out_size);
+    }
+  }
+  BrotliEncoderDestroyInstance(s);
+  if (!ok) {
+    fprintf(stderr, "failed to compress\n");
+    free(encoded);
+    return NULL;
+  }
+  *encoded_size = out_size;
+  return encoded;
+}
+
+/* Quality is adapted only between metablocks; flush ends a metablock, so
+   each 32 KiB piece is measured on its own. Budgets are extreme, so that
+   results do not depend on machine speed: 1 KB/s is always met, 4 TB/s
+   never is. Unmet target lowers quality by one level per metablock, down to
+   the lowest level that is compatible with stream parameters. */
+static BROTLI_BOOL TestTargetSpeed(const uint8_t* data, size_t size) {
+  Param params[2] = {
+    {BROTLI_PARAM_QUALITY, 11},
+    {BROTLI_PARAM_TARGET_SPEED, 0}
+  };
+  size_t fixed_size = 0;
+  size_t met_size = 0;
+  size_t missed_size = 0;
+  size_t fixed_first = 0;
+  size_t missed_first = 0;
+  uint8_t* fixed;
+  uint8_t* met;
+  uint8_t* missed;
+  BROTLI_BOOL ok;
+  if (size > 3 * 32768) size = 3 * 32768;
+  fixed = CompressPieces(data, size, params, 2, BROTLI_FALSE, BROTLI_FALSE,
+      &fixed_first, &fixed_size);
+  params[1].value = 1;
+  met = CompressPieces(data, size, params, 2, BROTLI_FALSE, BROTLI_FALSE,
+      NULL, &met_size);
+  params[1].value = 4000000000u;
+  missed = CompressPieces(data, size, params, 2, BROTLI_FALSE, BROTLI_FALSE,
+      &missed_first, &missed_size);
+  ok = TO_BROTLI_BOOL(fixed && met && missed);
+  if (ok && (met_size != fixed_size ||
+      memcmp(met, fixed, fixed_size) != 0)) {
+    fprintf(stderr, "output with met target differs from fixed quality\n");
+    ok = BROTLI_FALSE;
+  }
+  /* The first metablock is encoded with the requested quality. */
+  if (ok && (missed_first != fixed_first ||
+      memcmp(missed, fixed, fixed_first) != 0)) {
+    fprintf(stderr, "first metablock with missed target differs\n");
+    ok = BROTLI_FALSE;
+  }
+  if (ok && missed_size == fixed_size &&
+      memcmp(missed, fixed, fixed_size) == 0) {
+    fprintf(stderr, "missed target kept quality\n");
+    ok = BROTLI_FALSE;
+  }
+  if (ok) ok = CheckDecoded(met, met_size, data, size);
+  if (ok) ok = CheckDecoded(missed, missed_size, data, size);
+  free(fixed);
+  free(met);
+  free(missed);
+  /* The lowest level can not be lowered further. */
+  params[0].value = 2;
+  params[1].value = 0;
+  fixed = ok ? CompressPieces(data, size, params, 2, BROTLI_FALSE,
+      BROTLI_FALSE, NULL, &fixed_size) : NULL;
+  params[1].value = 4000000000u;
+  missed = ok ? CompressPieces(data, size, params, 2, BROTLI_FALSE,
+      BROTLI_FALSE, NULL, &missed_size) : NULL;
+  ok = TO_BROTLI_BOOL(ok && fixed && missed);
+  if (ok && (missed_size != fixed_size ||
+      memcmp(missed, fixed, fixed_size) != 0)) {
+    fprintf(stderr, "missed target changed the lowest quality\n");
+    ok = BROTLI_FALSE;
+  }
+  free(fixed);
+  free(missed);
+  return ok;
+}
+
+/* Segmented output has the same bytes as output to caller buffer, with
+   flushes and metadata blocks, for fast one- and two-pass compressors,
+   regular ones, and Zopfli. */
+static BROTLI_BOOL TestSegmentedOutput(const uint8_t* data, size_t size) {
+  static const int kQualities[] = {0, 1, 5, 10, 11};
+  BROTLI_BOOL ok = BROTLI_TRUE;
+  size_t i;
+  for (i = 0; ok && i < sizeof(kQualities) / sizeof(kQualities[0]); ++i) {
+    Param params[1] = {{BROTLI_PARAM_QUALITY, 0}};
+    size_t plain_size = 0;
+    size_t segmented_size = 0;
+    uint8_t* plain;
+    uint8_t* segmented;
+    params[0].value = (uint32_t)kQualities[i];
+    plain = CompressPieces(data, size, params, 1, BROTLI_FALSE, BROTLI_TRUE,
+        NULL, &plain_size);
+    segmented = CompressPieces(data, size, params, 1, BROTLI_TRUE,
+        BROTLI_TRUE, NULL, &segmented_size);
+    ok = TO_BROTLI_BOOL(plain && segmented);
+    if (ok && (segmented_size != plain_size ||
+        memcmp(segmented, plain, plain_size) != 0)) {
+      fprintf(stderr, "q%d segmented output differs: %lu vs %lu bytes\n",
+          kQualities[i], (unsigned long)segmented_size,
+          (unsigned long)plain_size);
+      ok = BROTLI_FALSE;
+    }
+    if (ok) ok = CheckDecoded(segmented, segmented_size, data, size);
+    free(plain);
+    free(segmented);
+  }
+  return ok;
+}
+
+/* Encoder with memory budget stays within it, at any quality and window,
+   and estimate is close to the real peak without budget. Budget is the
+   estimate for quality 5 with 256 KiB window. Estimate is not checked for
+   16 MiB window, where hasher tables of qualities 10 and 11 alone take
+   hundreds of megabytes. */
+static BROTLI_BOOL TestMemoryLimit(const uint8_t* data, size_t size) {
+  static const int kQualities[] = {1, 5, 9, 10, 11};
+  const size_t budget = BrotliEncoderEstimatePeakMemory(5, 18, size);
+  BROTLI_BOOL ok = BROTLI_TRUE;
+  size_t i;
+  int lgwin;
+  if (BrotliEncoderEstimatePeakMemory(11, 24, 0) <=
+          BrotliEncoderEstimatePeakMemory(5, 24, 0) ||
+      BrotliEncoderEstimatePeakMemory(5, 24, 0) <=
+          BrotliEncoderEstimatePeakMemory(1, 24, 0) ||
+      BrotliEncoderEstimatePeakMemory(9, 24, size) >
+          BrotliEncoderEstimatePeakMemory(9, 24, 0) ||
+      BrotliEncoderEstimatePeakMemory(9, 16, 0) >
+          BrotliEncoderEstimatePeakMemory(9, 24, 0)) {
+    fprintf(stderr, "estimate does not grow with quality and window\n");
+    return BROTLI_FALSE;
+  }
+  for (i = 0; ok && i < sizeof(kQualities) / sizeof(kQualities[0]); ++i) {
+    for (lgwin = 16; ok && lgwin <= 24; lgwin += 4) {
+      Param params[4] = {
+        {BROTLI_PARAM_QUALITY, 0},
+        {BROTLI_PARAM_LGWIN, 0},
+        {BROTLI_PARAM_SIZE_HINT, 0},
+        {BROTLI_PARAM_MEMORY_LIMIT, 0}
+      };
+      Allocator unlimited = {0, 0};
+      Allocator limited = {0, 0};
+      size_t estimate =
+          BrotliEncoderEstimatePeakMemory(kQualities[i], lgwin, size);
+      size_t encoded_size = 0;
+      uint8_t* encoded;
+      params[0].value = (uint32_t)kQualities[i];
+      params[1].value = (uint32_t)lgwin;
+      params[2].value = (uint32_t)size;
+      if (lgwin <= 20) {
+        encoded = CompressWithAllocator(
+            data, size, params, 3, &unlimited, NULL, &encoded_size);
+        free(encoded);
+      }
+      params[3].value = (uint32_t)(budget >> 10);
+      encoded = CompressWithAllocator(
+          data, size, params, 4, &limited, NULL, &encoded_size);
+      ok = TO_BROTLI_BOOL(encoded != NULL);
+      /* Instance itself is not in the estimate. */
+      if (ok && estimate + estimate / 8 < unlimited.peak) {
+        fprintf(stderr, "q%d w%d: estimate %lu, peak %lu\n", kQualities[i],
+            lgwin, (unsigned long)estimate, (unsigned long)unlimited.peak);
+        ok = BROTLI_FALSE;
+      }
+      if (ok && limited.peak > (budget >> 10) << 10) {
+        fprintf(stderr, "q%d w%d: budget %lu, peak %lu\n", kQualities[i],
+            lgwin, (unsigned long)budget, (unsigned long)limited.peak);
+        ok = BROTLI_FALSE;
+      }
+      if (ok) ok = CheckDecoded(encoded, encoded_size, data, size);
+      free(encoded);
+    }
+  }
+  return ok;
+}
+
+/* Fills |out| with bytes of a simple LCG; repeatable, and incompressible
+   for the encoder. */
+static void FillRandom(uint8_t* out, size_t size, uint32_t seed) {
+  size_t i;
+  for (i = 0; i < size; ++i) {
+    seed = seed * 1103515245u + 12345u;
+    out[i] = (uint8_t)(seed >> 16);
+  }
+}
+
+/* Compresses |data| at |quality| with |dictionary| attached. If
+   |stored_bytes| is not NULL, it receives BrotliEncoderGetStoredBytes.
+   Returned buffer is owned by the caller. */
+static uint8_t* CompressWithDictionary(const uint8_t* data, size_t size,
+    int quality, const BrotliEncoderPreparedDictionary* dictionary,
+    size_t* stored_bytes, size_t* encoded_size) {
+  BrotliEncoderState* s = BrotliEncoderCreateInstance(NULL, NULL, NULL);
+  size_t capacity = BrotliEncoderMaxCompressedSize(size);
+  uint8_t* encoded = (uint8_t*)malloc(capacity);
+  size_t available_in = size;
+  const uint8_t* next_in = data;
+  size_t available_out = capacity;
+  uint8_t* next_out = encoded;
+  BROTLI_BOOL ok = TO_BROTLI_BOOL(s && encoded &&
+      BrotliEncoderSetParameter(s, BROTLI_PARAM_QUALITY, (uint32_t)quality) &&
+      BrotliEncoderAttachPreparedDictionary(s, dictionary));
+  while (ok && !BrotliEncoderIsFinished(s)) {
+    ok = TO_BROTLI_BOOL(available_out != 0 &&
+        BrotliEncoderCompressStream(s, BROTLI_OPERATION_FINISH,
+            &available_in, &next_in, &available_out, &next_out, NULL));
+  }
+  if (ok && stored_bytes) *stored_bytes = BrotliEncoderGetStoredBytes(s);
+  BrotliEncoderDestroyInstance(s);
+  if (!ok) {
+    fprintf(stderr, "failed to compress\n");
+    free(encoded);
+    return NULL;
+  }
+  *encoded_size = capacity - available_out;
+  return encoded;
+}
+
+/* Checks that |encoded| decodes to |size| bytes of |expected| with raw
+   |dictionary| attached to decoder. */
+static BROTLI_BOOL CheckDecodedWithDictionary(const uint8_t* encoded,
+    size_t encoded_size, const uint8_t* dictionary, size_t dictionary_size,
+    const uint8_t* expected, size_t size) {
+  BrotliDecoderState* s = BrotliDecoderCreateInstance(NULL, NULL, NULL);
+  uint8_t* decoded = (uint8_t*)malloc(size + 1);
+  size_t available_in = encoded_size;
+  const uint8_t* next_in = encoded;
+  size_t available_out = size + 1;
+  uint8_t* next_out = decoded;
+  BROTLI_BOOL ok = TO_BROTLI_BOOL(s && decoded &&
+      BrotliDecoderAttachDictionary(s, BROTLI_SHARED_DICTIONARY_RAW,
+          dictionary_size, dictionary) &&
+      BrotliDecoderDecompressStream(s, &available_in, &next_in,
+          &available_out, &next_out, NULL) == BROTLI_DECODER_RESULT_SUCCESS &&
+      available_out == 1 && memcmp(decoded, expected, size) == 0);
+  if (!ok) fprintf(stderr, "decoded data differs\n");
+  BrotliDecoderDestroyInstance(s);
+  free(decoded);
+  return ok;
+}
+
+/* Random input that is also an attached dictionary is not stored, but
+   compressed to references into the dictionary; hasher of quality 2 finds
+   only a part of them, so at least twice is expected. */
+static BROTLI_BOOL CheckDictionaryCovered(const uint8_t* data, size_t size,
+    int quality) {
+  BrotliEncoderPreparedDictionary* dictionary =
+      BrotliEncoderPrepareDictionary(size, data, quality, NULL, NULL, NULL);
+  size_t stored = 0;
+  size_t encoded_size = 0;
+  uint8_t* encoded = dictionary ? CompressWithDictionary(data, size, quality,
+      dictionary, &stored, &encoded_size) : NULL;
+  BROTLI_BOOL ok = TO_BROTLI_BOOL(encoded != NULL);
+  if (ok && (stored != 0 || encoded_size > size / 2)) {
+    fprintf(stderr, "q%d covered by dictionary: %lu stored, %lu encoded "
+        "of %lu bytes\n", quality, (unsigned long)stored,
+        (unsigned long)encoded_size, (unsigned long)size);
+    ok = BROTLI_FALSE;
+  }
+  if (ok) {
+    ok = CheckDecodedWithDictionary(encoded, encoded_size, data, size, data,
+        size);
+  }
+  BrotliEncoderDestroyPreparedDictionary(dictionary);
+  free(encoded);
+  return ok;
+}
+
+/* Random input is stored as is, and stored bytes are counted. In mixed
+   input only random part is stored; text around it is still compressed.
+   Input blocks of higher qualities take up to 256 KiB, and blocks that
+   start with text are compressed as a whole, so only at least a half of
+   random part is expected to be stored there. */
+static BROTLI_BOOL TestIncompressible(const uint8_t* data, size_t size) {
+  static const int kQualities[] = {2, 5, 9, 11};
+  size_t random_size = 1 << 20;
+  size_t text_size = size < (64 << 10) ? size : (64 << 10);
+  size_t mixed_size = random_size + 2 * text_size;
+  uint8_t* mixed = (uint8_t*)malloc(mixed_size);
+  BROTLI_BOOL ok = TO_BROTLI_BOOL(mixed != NULL);
+  size_t i;
+  if (ok) {
+    memcpy(mixed, data, text_size);
+    FillRandom(mixed + text_size, random_size, 1);
+    memcpy(mixed + text_size + random_size, data + size - text_size,
+        text_size);
+  }
+  for (i = 0; ok && i < sizeof(kQualities) / sizeof(kQualities[0]); ++i) {
+    Param params[1] = {{BROTLI_PARAM_QUALITY, 0}};
+    size_t stored = 0;
+    size_t encoded_size = 0;
+    uint8_t* encoded;
+    params[0].value = (uint32_t)kQualities[i];
+    encoded = CompressWithAllocator(mixed + text_size, random_size, params, 1,
+        NULL, &stored, &encoded_size);
+    ok = TO_BROTLI_BOOL(encoded != NULL);
+    if (ok && (stored != random_size || encoded_size < random_size ||
+        encoded_size > random_size + (random_size >> 10) + 16)) {
+      fprintf(stderr, "q%d random: %lu stored, %lu encoded of %lu bytes\n",
+          kQualities[i], (unsigned long)stored, (unsigned long)encoded_size,
+          (unsigned long)random_size);
+      ok = BROTLI_FALSE;
+    }
+    if (ok) {
+      ok = CheckDecoded(encoded, encoded_size, mixed + text_size,
+          random_size);
+    }
+    free(encoded);
+    encoded = ok ? CompressWithAllocator(mixed, mixed_size, params, 1, NULL,
+        &stored, &encoded_size) : NULL;
+    ok = TO_BROTLI_BOOL(ok && encoded);
+    /* Text is compressed at least twice. */
+    if (ok && (stored < random_size / 2 || stored > random_size ||
+        encoded_size > random_size + text_size)) {
+      fprintf(stderr, "q%d mixed: %lu stored, %lu encoded of %lu bytes\n",
+          kQualities[i], (unsigned long)stored, (unsigned long)encoded_size,
+          (unsigned long)mixed_size);
+      ok = BROTLI_FALSE;
+    }
+    if (ok) ok = CheckDecoded(encoded, encoded_size, mixed, mixed_size);
+    free(encoded);
+    if (ok) {
+      ok = CheckDictionaryCovered(mixed + text_size, random_size,
+          kQualities[i]);
+    }
+  }
+  free(mixed);
+  return ok;
+}
+
+/* Checks that encoder in stable input mode rejects input that does not
+   continue the data passed before. */
+static BROTLI_BOOL CheckStableInputGap(const uint8_t* data, size_t size) {
+  BrotliEncoderState* s = BrotliEncoderCreateInstance(NULL, NULL, NULL);
+  uint8_t out[1024];
+  size_t available_in = size < 1000 ? size / 2 : 1000;
+  const uint8_t* next_in = data;
+  size_t available_out = sizeof(out);
+  uint8_t* next_out = out;
+  BROTLI_BOOL ok = TO_BROTLI_BOOL(s &&
+      BrotliEncoderSetParameter(s, BROTLI_PARAM_STABLE_INPUT, 1) &&
+      BrotliEncoderCompressStream(s, BROTLI_OPERATION_PROCESS, &available_in,
+          &next_in, &available_out, &next_out, NULL));
+  if (ok) {
+    next_in += 1;
+    available_in = 1;
+    if (BrotliEncoderCompressStream(s, BROTLI_OPERATION_FLUSH, &available_in,
+        &next_in, &available_out, &next_out, NULL)) {
+      fprintf(stderr, "stable input with a gap is accepted\n");
+      ok = BROTLI_FALSE;
+    }
+  }
+  BrotliEncoderDestroyInstance(s);
+  return ok;
+}
+
+/* Stable input is read from caller buffer, and gives the same stream as
+   input copied to ring buffer, except that last bytes of each passed piece
+   are not searched for references, so size could differ by a few bytes.
+   Input is passed in 32 KiB pieces with flush after each one, or at once;
+   it is larger than window, so ring buffer wraps. Qualities 0 and 1 do not
+   use ring buffer; for others, peak memory is lower by at least the
+   window. */
+static BROTLI_BOOL TestStableInput(const uint8_t* data, size_t size) {
+  static const int kQualities[] = {1, 5, 9, 11};
+  const size_t max_diff = 8 * ((size + 32767) / 32768);
+  BROTLI_BOOL ok = CheckStableInputGap(data, size);
+  size_t i;
+  for (i = 0; ok && i < sizeof(kQualities) / sizeof(kQualities[0]); ++i) {
+    Param params[3] = {
+      {BROTLI_PARAM_QUALITY, 0},
+      {BROTLI_PARAM_LGWIN, 16},
+      {BROTLI_PARAM_STABLE_INPUT, 1}
+    };
+    Allocator copied_allocator = {0, 0};
+    Allocator stable_allocator = {0, 0};
+    size_t copied_size = 0;
+    size_t stable_size = 0;
+    uint8_t* copied;
+    uint8_t* stable;
+    int pass;
+    params[0].value = (uint32_t)kQualities[i];
+    for (pass = 0; ok && pass < 2; ++pass) {
+      if (pass == 0) {
+        copied = CompressPieces(data, size, params, 2, BROTLI_FALSE,
+            BROTLI_FALSE, NULL, &copied_size);
+        stable = CompressPieces(data, size, params, 3, BROTLI_FALSE,
+            BROTLI_FALSE, NULL, &stable_size);
+      } else {
+        copied = CompressWithAllocator(data, size, params, 2,
+            &copied_allocator, NULL, &copied_size);
+        stable = CompressWithAllocator(data, size, params, 3,
+            &stable_allocator, NULL, &stable_size);
+      }
+      ok = TO_BROTLI_BOOL(copied && stable);
+      if (ok && (stable_size > copied_size + max_diff ||
+          copied_size > stable_size + max_diff)) {
+        fprintf(stderr, "q%d stable input: %lu bytes, copied: %lu bytes\n",
+            kQualities[i], (unsigned long)stable_size,
+            (unsigned long)copied_size);
+        ok = BROTLI_FALSE;
+      }
+      if (ok) ok = CheckDecoded(stable, stable_size, data, size);
+      free(copied);
+      free(stable);
+    }
+    if (ok && kQualities[i] > 1 &&
+        stable_allocator.peak + (1u << 16) > copied_allocator.peak) {
+      fprintf(stderr, "q%d stable input peak: %lu bytes, copied: %lu bytes\n",
+          kQualities[i], (unsigned long)stable_allocator.peak,
+          (unsigned long)copied_allocator.peak);
+      ok = BROTLI_FALSE;
+    }
+  }
+  return ok;
+}
+
+/* Loads |image_size| bytes of |image| for |dictionary|; returns whether it
+   is accepted. */
+static BROTLI_BOOL IsImageAccepted(const uint8_t* image, size_t image_size,
+    const uint8_t* dictionary, size_t dictionary_size) {
+  BrotliEncoderPreparedDictionary* loaded =
+      BrotliEncoderLoadPreparedDictionary(image_size, image, dictionary_size,
+          dictionary, NULL, NULL, NULL);
+  BrotliEncoderDestroyPreparedDictionary(loaded);
+  return TO_BROTLI_BOOL(loaded != NULL);
+}
+
+/* Serialized prepared dictionary gives the same output as the original one,
+   whether the image is used in place or, when misaligned, copied. Images
+   that are stale (dictionary data changed), truncated, or have a damaged
+   header are rejected. Index body is not checksummed, so that loading does
+   not touch every page; an index filled with garbage must only hurt
+   compression, and output still has to decode. */
+static BROTLI_BOOL TestPreparedDictionary(const uint8_t* data, size_t size) {
+  static const int kQualities[] = {5, 11};
+  const uint8_t* dictionary = data + size / 2;
+  const size_t dictionary_size = size - size / 2;
+  BrotliEncoderPreparedDictionary* prepared = BrotliEncoderPrepareDictionary(
+      dictionary_size, dictionary, 5, NULL, NULL, NULL);
+  size_t image_size = BrotliEncoderGetPreparedDictionarySerializedSize(
+      prepared);
+  /* One extra byte allows a misaligned copy. */
+  uint8_t* image = (uint8_t*)malloc(image_size + 1);
+  uint8_t* stale = (uint8_t*)malloc(dictionary_size);
+  size_t reference_size = 0;
+  uint8_t* reference = NULL;
+  uint32_t seed = 1;
+  BROTLI_BOOL ok = TO_BROTLI_BOOL(prepared && image && stale &&
+      BrotliEncoderSerializePreparedDictionary(prepared, &image_size, image));
+  size_t i;
+  if (ok) {
+    reference = CompressWithDictionary(data, size, 5, prepared, NULL,
+        &reference_size);
+    ok = TO_BROTLI_BOOL(reference != NULL);
+  }
+  for (i = 0; ok && i < 2; ++i) {
+    const uint8_t* loaded_image = image + i;
+    BrotliEncoderPreparedDictionary* loaded;
+    size_t encoded_size = 0;
+    uint8_t* encoded;
+    if (i == 1) memmove(image + 1, image, image_size);
+    loaded = BrotliEncoderLoadPreparedDictionary(image_size, loaded_image,
+        dictionary_size, dictionary, NULL, NULL, NULL);
+    encoded = loaded ? CompressWithDictionary(data, size, 5, loaded, NULL,
+        &encoded_size) : NULL;
+    ok = TO_BROTLI_BOOL(encoded && encoded_size == reference_size &&
+        memcmp(encoded, reference, reference_size) == 0);
+    if (!ok) fprintf(stderr, "loaded dictionary %lu differs\n",
+        (unsigned long)i);
+    BrotliEncoderDestroyPreparedDictionary(loaded);
+    free(encoded);
+    if (i == 1) memmove(image, image + 1, image_size);
+  }
+  if (ok) {
+    memcpy(stale, dictionary, dictionary_size);
+    stale[dictionary_size / 2] ^= 1;
+    if (IsImageAccepted(image, image_size, stale, dictionary_size) ||
+        IsImageAccepted(image, image_size, dictionary, dictionary_size - 1)) {
+      fprintf(stderr, "stale image is accepted\n");
+      ok = BROTLI_FALSE;
+    }
+  }
+  if (ok) {
+    static const size_t kCuts[] = {1, 4, 4096};
+    if (IsImageAccepted(image, 0, dictionary, dictionary_size) ||
+        IsImageAccepted(image, 39, dictionary, dictionary_size) ||
+        IsImageAccepted(image, 40, dictionary, dictionary_size)) {
+      fprintf(stderr, "image without index is accepted\n");
+      ok = BROTLI_FALSE;
+    }
+    for (i = 0; ok && i < sizeof(kCuts) / sizeof(kCuts[0]); ++i) {
+      if (IsImageAccepted(image, image_size - kCuts[i], dictionary,
+          dictionary_size)) {
+        fprintf(stderr, "image truncated by %lu bytes is accepted\n",
+            (unsigned long)kCuts[i]);
+        ok = BROTLI_FALSE;
+      }
+    }
+  }
+  /* Header is 40 bytes, protected by a hash. */
+  for (i = 0; ok && i < 40; ++i) {
+    image[i] ^= 0x10;
+    if (IsImageAccepted(image, image_size, dictionary, dictionary_size)) {
+      fprintf(stderr, "image with damaged byte %lu is accepted\n",
+          (unsigned long)i);
+      ok = BROTLI_FALSE;
+    }
+    image[i] ^= 0x10;
+  }
+  if (ok) {
+    for (i = 40; i < image_size; ++i) {
+      seed = seed * 1103515245u + 12345u;
+      image[i] = (uint8_t)(seed >> 16);
+    }
+  }
+  for (i = 0; ok && i < sizeof(kQualities) / sizeof(kQualities[0]); ++i) {
+    BrotliEncoderPreparedDictionary* loaded =
+        BrotliEncoderLoadPreparedDictionary(image_size, image,
+            dictionary_size, dictionary, NULL, NULL, NULL);
+    size_t encoded_size = 0;
+    uint8_t* encoded = loaded ? CompressWithDictionary(data, size,
+        kQualities[i], loaded, NULL, &encoded_size) : NULL;
+    ok = TO_BROTLI_BOOL(encoded != NULL);
+    if (ok) {
+      ok = CheckDecodedWithDictionary(encoded, encoded_size, dictionary,
+          dictionary_size, data, size);
+    }
+    BrotliEncoderDestroyPreparedDictionary(loaded);
+    free(encoded);
+  }
+  BrotliEncoderDestroyPreparedDictionary(prepared);
+  free(reference);
+  free(stale);
+  free(image);
+  return ok;
+}
+
+typedef BROTLI_BOOL (*TestFunc)(const uint8_t* data, size_t size);
+
+static const struct {
+  const char* name;
+  TestFunc func;
+} kTests[] = {
+  {"target-speed", TestTargetSpeed},
+  {"segmented-output", TestSegmentedOutput},
+  {"memory-limit", TestMemoryLimit},
+  {"incompressible", TestIncompressible},
+  {"stable-input", TestStableInput},
+  {"prepared-dictionary", TestPreparedDictionary},
+};
+
+int main(int argc, char** argv) {
+  size_t num_tests = sizeof(kTests) / sizeof(kTests[0]);
+  size_t size = 0;
+  uint8_t* data;
+  BROTLI_BOOL ok;
+  size_t i;
+  if (argc != 3) {
+    fprintf(stderr, "usage: %s <test> <file>\n", argv[0]);
+    return 1;
+  }
+  for (i = 0; i < num_tests; ++i) {
+    if (strcmp(argv[1], kTests[i].name) == 0) break;
+  }
+  if (i == num_tests) {
+    fprintf(stderr, "unknown test [%s]\n", argv[1]);
+    return 1;
+  }
+  data = ReadInput(argv[2], &size);
+  if (!data) return 1;
+  ok = kTests[i].func(data, size);
+  free(data);
+  return ok ? 0 : 1;
+}
@@ -1,8 +1,24 @@
 set(ENV{QEMU_LD_PREFIX} "${BROTLI_WRAPPER_LD_PREFIX}")
 
+if(DICTIONARY)
+  set(DICTIONARY_ARG "--dictionary=${DICTIONARY}")
+endif()
+
+if(DICTIONARY_INDEX)
+  execute_process(
+    WORKING_DIRECTORY "${CMAKE_CURRENT_SOURCE_DIR}"
+    COMMAND ${BROTLI_WRAPPER} ${BROTLI_CLI} --force --quality=${QUALITY} ${DICTIONARY_ARG} --prepare-dictionary=${DICTIONARY_INDEX}
+    RESULT_VARIABLE result
+    ERROR_VARIABLE result_stderr)
+  if(result)
+    message(FATAL_ERROR "Dictionary preparation failed: ${result_stderr}")
+  endif()
+  set(COMPRESS_DICTIONARY_ARG "--dictionary-index=${DICTIONARY_INDEX}")
+endif()
+
 execute_process(
   WORKING_DIRECTORY "${CMAKE_CURRENT_SOURCE_DIR}"
-  COMMAND ${BROTLI_WRAPPER} ${BROTLI_CLI} --force --quality=${QUALITY} ${INPUT} --output=${OUTPUT}.br
+  COMMAND ${BROTLI_WRAPPER} ${BROTLI_CLI} --force --quality=${QUALITY} ${DICTIONARY_ARG} ${COMPRESS_DICTIONARY_ARG} ${INPUT} --output=${OUTPUT}.br
   RESULT_VARIABLE result
   ERROR_VARIABLE result_stderr)
 if(result)
@@ -11,7 +27,7 @@ endif()
 
 execute_process(
   WORKING_DIRECTORY "${CMAKE_CURRENT_SOURCE_DIR}"
-  COMMAND ${BROTLI_WRAPPER} ${BROTLI_CLI} --force --decompress ${OUTPUT}.br --output=${OUTPUT}.unbr
+  COMMAND ${BROTLI_WRAPPER} ${BROTLI_CLI} --force --decompress ${DICTIONARY_ARG} ${OUTPUT}.br --output=${OUTPUT}.unbr
   RESULT_VARIABLE result)
 if(result)
   message(FATAL_ERROR "Decompression failed")
@@ -0,0 +1,176 @@
+/* Copyright 2026 The Brotli Authors. All Rights Reserved.
+
+   Distributed under MIT license.
+   See file LICENSE for detail or copy at https://opensource.org/licenses/MIT
+*/
+
+/* Checks SHA-256 against FIPS 180-2 known answers, hash id formatting, and
+   reference accounting of the shared dictionary cache. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <brotli/types.h>
+#include "../c/shared_dict/shared_dict.h"
+
+typedef struct KnownAnswer {
+  const char* message;
+  size_t repeat;
+  const char* digest;
+} KnownAnswer;
+
+static const KnownAnswer kKnownAnswers[] = {
+  {"abc", 1,
+    "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"},
+  {"", 1,
+    "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855"},
+  {"abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq", 1,
+    "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1"},
+  {"abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmn"
+    "hijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu", 1,
+    "cf5b16a778af8380036ce59e7b0492370b249b11e8f07a51afac45037afee9d1"},
+  {"a", 1000000,
+    "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0"},
+};
+
+#define NUM_KNOWN_ANSWERS (sizeof(kKnownAnswers) / sizeof(kKnownAnswers[0]))
+
+static void FormatHex(const uint8_t* hash, char* hex) {
+  static const char kHex[] = "0123456789abcdef";
+  size_t i;
+  for (i = 0; i < BROTLI_SHARED_DICT_HASH_SIZE; ++i) {
+    hex[2 * i] = kHex[hash[i] >> 4];
+    hex[2 * i + 1] = kHex[hash[i] & 15];
+  }
+  hex[2 * BROTLI_SHARED_DICT_HASH_SIZE] = 0;
+}
+
+static BROTLI_BOOL TestKnownAnswers(void) {
+  size_t i;
+  for (i = 0; i < NUM_KNOWN_ANSWERS; ++i) {
+    const KnownAnswer* answer = &kKnownAnswers[i];
+    size_t length = strlen(answer->message);
+    size_t size = length * answer->repeat;
+    uint8_t* data = (uint8_t*)malloc(size + 1);
+    uint8_t hash[BROTLI_SHARED_DICT_HASH_SIZE];
+    char hex[2 * BROTLI_SHARED_DICT_HASH_SIZE + 1];
+    size_t j;
+    if (!data) return BROTLI_FALSE;
+    for (j = 0; j < answer->repeat; ++j) {
+      memcpy(data + j * length, answer->message, length);
+    }
+    BrotliSharedDictComputeHash(size, data, hash);
+    free(data);
+    FormatHex(hash, hex);
+    if (strcmp(hex, answer->digest) != 0) {
+      fprintf(stderr, "SHA-256 of message %d: got %s, expected %s\n",
+          (int)i, hex, answer->digest);
+      return BROTLI_FALSE;
+    }
+  }
+  return BROTLI_TRUE;
+}
+
+static BROTLI_BOOL TestHashId(void) {
+  static const char kEmptyId[] =
+      "sha256-47DEQpj8HBSa+/TImW+5JCeuQeRkm5NMpJWZG3hSuFU=";
+  uint8_t hash[BROTLI_SHARED_DICT_HASH_SIZE];
+  uint8_t parsed[BROTLI_SHARED_DICT_HASH_SIZE];
+  char id[BROTLI_SHARED_DICT_HASH_ID_SIZE];
+  BrotliSharedDictComputeHash(0, (const uint8_t*)"", hash);
+  BrotliSharedDictFormatHashId(hash, id);
+  if (strcmp(id, kEmptyId) != 0) {
+    fprintf(stderr, "hash id: got %s, expected %s\n", id, kEmptyId);
+    return BROTLI_FALSE;
+  }
+  if (!BrotliSharedDictParseHashId(strlen(id), id, parsed) ||
+      memcmp(parsed, hash, BROTLI_SHARED_DICT_HASH_SIZE) != 0) {
+    fprintf(stderr, "hash id does not parse back\n");
+    return BROTLI_FALSE;
+  }
+  /* Padding is optional; other algorithms and truncated digests are not
+     accepted. */
+  if (!BrotliSharedDictParseHashId(strlen(id) - 1, id, parsed) ||
+      BrotliSharedDictParseHashId(strlen(id) - 2, id, parsed) ||
+      BrotliSharedDictParseHashId(6, "sha384", parsed)) {
+    fprintf(stderr, "malformed hash id accepted\n");
+    return BROTLI_FALSE;
+  }
+  return BROTLI_TRUE;
+}
+
+static const BrotliSharedDict* Prepare(BrotliSharedDictCache* cache,
+    const uint8_t* data, size_t size) {
+  const BrotliSharedDict* dictionary =
+      BrotliSharedDictCacheLookupOrPrepare(cache, size, data, NULL);
+  size_t dictionary_size = 0;
+  if (!dictionary ||
+      BrotliSharedDictData(dictionary, &dictionary_size) == NULL ||
+      dictionary_size != size) {
+    fprintf(stderr, "dictionary preparation failed\n");
+    return NULL;
+  }
+  return dictionary;
+}
+
+/* Dictionaries are released after they were evicted, or without being
+   cached at all; destroying the cache afterwards must not trip the
+   outstanding reference check. */
+static BROTLI_BOOL TestReferences(void) {
+  uint8_t data[3][8192];
+  const BrotliSharedDict* first;
+  const BrotliSharedDict* again;
+  const BrotliSharedDict* second;
+  const BrotliSharedDict* oversized;
+  BrotliSharedDictCacheStats stats;
+  BrotliSharedDictCache* cache;
+  size_t entry_memory;
+  size_t i;
+  for (i = 0; i < sizeof(data[0]); ++i) {
+    data[0][i] = (uint8_t)(i * 7 + (i >> 8));
+    data[1][i] = (uint8_t)(i * 13 + (i >> 8));
+    data[2][i] = (uint8_t)(i * 17 + (i >> 8));
+  }
+
+  /* Measure the memory accounted for one dictionary. */
+  cache = BrotliSharedDictCacheCreate((size_t)1 << 30, 5);
+  if (!cache) return BROTLI_FALSE;
+  first = Prepare(cache, data[0], 4096);
+  if (!first) return BROTLI_FALSE;
+  BrotliSharedDictCacheRelease(cache, first);
+  BrotliSharedDictCacheGetStats(cache, &stats);
+  entry_memory = stats.memory_usage;
+  BrotliSharedDictCacheDestroy(cache);
+
+  /* Room for one dictionary: the second one evicts the first in use. */
+  cache = BrotliSharedDictCacheCreate(entry_memory, 5);
+  if (!cache) return BROTLI_FALSE;
+  first = Prepare(cache, data[0], 4096);
+  if (!first) return BROTLI_FALSE;
+  again = BrotliSharedDictCacheLookup(cache, BrotliSharedDictHash(first));
+  second = Prepare(cache, data[1], 4096);
+  oversized = Prepare(cache, data[2], sizeof(data[2]));
+  if (again != first || !second || !oversized) {
+    fprintf(stderr, "cache lookup failed\n");
+    return BROTLI_FALSE;
+  }
+  BrotliSharedDictCacheGetStats(cache, &stats);
+  if (stats.num_entries != 1 || stats.evictions != 1) {
+    fprintf(stderr, "unexpected cache contents\n");
+    return BROTLI_FALSE;
+  }
+  BrotliSharedDictCacheRelease(cache, first);
+  BrotliSharedDictCacheRelease(cache, oversized);
+  BrotliSharedDictCacheRelease(cache, second);
+  BrotliSharedDictCacheRelease(cache, again);
+  BrotliSharedDictCacheDestroy(cache);
+  return BROTLI_TRUE;
+}
+
+int main(void) {
+  if (!TestKnownAnswers()) return 1;
+  if (!TestHashId()) return 1;
+  if (!TestReferences()) return 1;
+  return 0;
+}
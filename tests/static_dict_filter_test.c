@@ -0,0 +1,90 @@
+/* Copyright 2026 The Brotli Authors. All Rights Reserved.
+
+   Distributed under MIT license.
+   See file LICENSE for detail or copy at https://opensource.org/licenses/MIT
+*/
+
+/* Rebuilds kStaticDictionaryPrefixFilter from the static dictionary and
+   the encoder word table, and checks that the committed table matches.
+   With --print, writes the table in the layout of static_dict_lut.h. */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <brotli/types.h>
+#include "../c/common/dictionary.h"
+#include "../c/enc/static_dict_lut.h"
+
+#define FILTER_SIZE (sizeof(kStaticDictionaryPrefixFilter) / sizeof(uint32_t))
+
+static void BuildFilter(uint32_t* filter) {
+  const BrotliDictionary* dictionary = BrotliGetDictionary();
+  size_t bucket;
+  memset(filter, 0, FILTER_SIZE * sizeof(uint32_t));
+  for (bucket = 0; bucket < (1u << kDictNumBits); ++bucket) {
+    size_t offset = kStaticDictionaryBuckets[bucket];
+    BROTLI_BOOL end = !offset;
+    while (!end) {
+      const DictWord w = kStaticDictionaryWords[offset++];
+      const size_t len = w.len & 0x1F;
+      uint8_t prefix[4];
+      uint32_t h;
+      int k;
+      end = !!(w.len & 0x80);
+      memcpy(prefix, &dictionary->data[
+          dictionary->offsets_by_length[len] + len * w.idx], 4);
+      /* Transform 10 uppercases the first letter, 11 all of them. */
+      for (k = 0; k < 4; ++k) {
+        if ((w.transform == 10 && k == 0) || w.transform == 11) {
+          if (prefix[k] >= 'a' && prefix[k] <= 'z') prefix[k] ^= 32;
+        }
+      }
+      h = (uint32_t)prefix[0] | ((uint32_t)prefix[1] << 8) |
+          ((uint32_t)prefix[2] << 16) | ((uint32_t)prefix[3] << 24);
+      h = (h * kDictHashMul32) >> (32 - kDictFilterBits);
+      filter[h >> 5] |= 1u << (h & 31);
+    }
+  }
+}
+
+static void PrintFilter(const uint32_t* filter) {
+  size_t column = 0;
+  size_t i;
+  printf("static const uint32_t kStaticDictionaryPrefixFilter[%u] = {\n",
+      (unsigned)FILTER_SIZE);
+  for (i = 0; i < FILTER_SIZE; ++i) {
+    char item[16];
+    size_t length = (size_t)sprintf(item, "%u%s", (unsigned)filter[i],
+        (i + 1 < FILTER_SIZE) ? "," : "};");
+    if (column + length > 80) {
+      printf("\n");
+      column = 0;
+    }
+    printf("%s", item);
+    column += length;
+  }
+  printf("\n");
+}
+
+int main(int argc, char** argv) {
+  static uint32_t filter[FILTER_SIZE];
+  size_t i;
+  if (FILTER_SIZE != ((size_t)1 << kDictFilterBits) / 32) {
+    fprintf(stderr, "filter size does not match kDictFilterBits\n");
+    return 1;
+  }
+  BuildFilter(filter);
+  if (argc == 2 && strcmp(argv[1], "--print") == 0) {
+    PrintFilter(filter);
+    return 0;
+  }
+  for (i = 0; i < FILTER_SIZE; ++i) {
+    if (filter[i] != kStaticDictionaryPrefixFilter[i]) {
+      fprintf(stderr, "kStaticDictionaryPrefixFilter[%u] is %u, expected %u;"
+          " regenerate it with --print\n", (unsigned)i,
+          (unsigned)kStaticDictionaryPrefixFilter[i], (unsigned)filter[i]);
+      return 1;
+    }
+  }
+  return 0;
+}